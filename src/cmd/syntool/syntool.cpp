@@ -17,6 +17,7 @@
 
 #include "synergy/ToolApp.h"
 #include "arch/Arch.h"
+#include "base/Log.h"
 
 int
 main(int argc, char** argv) 
@@ -29,6 +30,8 @@ main(int argc, char** argv)
 	CArch arch;
 	arch.init();
 
+	CLog log;
+
 	CToolApp app;
 	return app.run(argc, argv);
 }
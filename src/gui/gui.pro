@@ -38,6 +38,7 @@ SOURCES += src/main.cpp \
 	src/SetupWizard.cpp \
 	src/IpcClient.cpp \
 	src/IpcReader.cpp \
+	src/LogModel.cpp \
 	src/Ipc.cpp \
 	src/SynergyLocale.cpp \
 	src/QUtility.cpp \
@@ -71,6 +72,7 @@ HEADERS += src/MainWindow.h \
 	src/SetupWizard.h \
 	src/IpcClient.h \
 	src/IpcReader.h \
+	src/LogModel.h \
 	src/Ipc.h \
 	src/SynergyLocale.h \
 	src/QUtility.h \
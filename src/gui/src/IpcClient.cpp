@@ -35,6 +35,7 @@ m_Enabled(false)
 
 	m_Reader = new IpcReader(m_Socket);
 	connect(m_Reader, SIGNAL(readLogLine(const QString&)), this, SLOT(handleReadLogLine(const QString&)));
+	connect(m_Reader, SIGNAL(errorMessage(const QString&)), this, SLOT(handleReadError(const QString&)));
 }
 
 IpcClient::~IpcClient()
@@ -123,6 +124,11 @@ void IpcClient::handleReadLogLine(const QString& text)
 	readLogLine(text);
 }
 
+void IpcClient::handleReadError(const QString& text)
+{
+	errorMessage(text);
+}
+
 // TODO: qt must have a built in way of converting int to bytes.
 void IpcClient::intToBytes(int value, char *buffer, int size)
 {
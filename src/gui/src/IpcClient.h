@@ -47,6 +47,7 @@ private slots:
 	void connected();
 	void error(QAbstractSocket::SocketError error);
 	void handleReadLogLine(const QString& text);
+	void handleReadError(const QString& text);
 
 signals:
 	void readLogLine(const QString& text);
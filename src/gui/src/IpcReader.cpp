@@ -19,7 +19,6 @@
 #include "IpcReader.h"
 #include <QTcpSocket>
 #include "Ipc.h"
-#include <iostream>
 #include <QMutex>
 #include <QByteArray>
 
@@ -40,72 +39,53 @@ void IpcReader::start()
 void IpcReader::stop()
 {
 	disconnect(m_Socket, SIGNAL(readyRead()), this, SLOT(read()));
+
+	QMutexLocker locker(&m_Mutex);
+	m_Buffer.clear();
 }
 
 void IpcReader::read()
 {
-	QMutexLocker locker(&m_Mutex);
-	std::cout << "ready read" << std::endl;
-
-	while (m_Socket->bytesAvailable()) {
-		std::cout << "bytes available" << std::endl;
-
-		char codeBuf[5];
-		readStream(codeBuf, 4);
-		codeBuf[4] = 0;
-		std::cout << "ipc read: " << codeBuf << std::endl;
-
-		if (memcmp(codeBuf, kIpcMsgLogLine, 4) == 0) {
-			std::cout << "reading log line" << std::endl;
+	append(m_Socket->readAll());
+}
 
-			char lenBuf[4];
-			readStream(lenBuf, 4);
-			int len = bytesToInt(lenBuf, 4);
+void IpcReader::append(const QByteArray& data)
+{
+	QMutexLocker locker(&m_Mutex);
 
-			char* data = new char[len];
-			readStream(data, len);
-			QString line = QString::fromUtf8(data, len);
-			delete data;
+	m_Buffer.append(data);
+	const char* buffer = m_Buffer.constData();
+	int size = m_Buffer.size();
 
-			readLogLine(line);
-		}
-		else {
-			std::cerr << "aborting, message invalid" << std::endl;
+	int offset = 0;
+	while (size - offset >= 4) {
+		const char* message = buffer + offset;
+		if (memcmp(message, kIpcMsgLogLine, 4) != 0) {
+			errorMessage("invalid ipc message, discarding what was received");
+			m_Buffer.clear();
 			return;
 		}
-	}
 
-	std::cout << "read done" << std::endl;
-}
-
-bool IpcReader::readStream(char* buffer, int length)
-{
-	std::cout << "reading stream" << std::endl;
-
-	int read = 0;
-	while (read < length) {
-		int ask = length - read;
-		if (m_Socket->bytesAvailable() < ask) {
-			std::cout << "buffer too short, waiting" << std::endl;
-			m_Socket->waitForReadyRead(-1);
+		// code, 4 byte length, then the text
+		if (size - offset < 8) {
+			break;
 		}
-
-		int got = m_Socket->read(buffer, ask);
-		read += got;
-
-		std::cout << "> ask=" << ask << " got=" << got
-			<< " read=" << read << std::endl;
-
-		if (got == -1) {
-			std::cout << "socket ended, aborting" << std::endl;
-			return false;
+		int len = bytesToInt(message + 4, 4);
+		if (len < 0) {
+			errorMessage("invalid ipc message, discarding what was received");
+			m_Buffer.clear();
+			return;
 		}
-		else if (length - read > 0) {
-			std::cout << "more remains, seek to " << got << std::endl;
-			buffer += got;
+		if (size - offset - 8 < len) {
+			break;
 		}
+
+		offset += 8 + len;
+		readLogLine(QString::fromUtf8(message + 8, len));
 	}
-	return true;
+
+	// keep only the part of a message that's still to come
+	m_Buffer.remove(0, offset);
 }
 
 int IpcReader::bytesToInt(const char *buffer, int size)
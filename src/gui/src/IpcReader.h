@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QByteArray>
 
 class QTcpSocket;
 
@@ -33,11 +34,16 @@ public:
 	void start();
 	void stop();
 
+	// parses bytes received from the daemon and emits readLogLine for
+	// each whole message.  the start of a message that hasn't all
+	// arrived is kept until the rest does, so this never waits.
+	void append(const QByteArray& data);
+
 signals:
 	void readLogLine(const QString& text);
+	void errorMessage(const QString& text);
 
 private:
-	bool readStream(char* buffer, int length);
 	int bytesToInt(const char* buffer, int size);
 
 private slots:
@@ -46,4 +52,5 @@ private slots:
 private:
 	QTcpSocket* m_Socket;
 	QMutex m_Mutex;
+	QByteArray m_Buffer;
 };
@@ -0,0 +1,128 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "LogModel.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+LogModel::LogModel(int capacity, QObject* parent) :
+	QAbstractListModel(parent),
+	m_Lines(capacity),
+	m_First(0),
+	m_Count(0)
+{
+	Q_ASSERT(capacity > 0);
+}
+
+LogModel::~LogModel()
+{
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : m_Count;
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid() || index.row() >= m_Count)
+		return QVariant();
+
+	// the tool tip shows lines too long for the view
+	if (role == Qt::DisplayRole || role == Qt::ToolTipRole)
+		return line(index.row());
+
+	return QVariant();
+}
+
+const QString& LogModel::line(int row) const
+{
+	return m_Lines[(m_First + row) % m_Lines.size()];
+}
+
+QString LogModel::text(const QModelIndexList& indexes) const
+{
+	// indexes come in the order the rows were selected
+	QList<int> rows;
+	foreach(const QModelIndex& index, indexes)
+	{
+		if (index.isValid() && index.row() < m_Count)
+			rows.append(index.row());
+	}
+	std::sort(rows.begin(), rows.end());
+
+	QStringList lines;
+	foreach(int row, rows)
+		lines.append(line(row));
+	return lines.join("\n");
+}
+
+void LogModel::appendLines(const QString& text)
+{
+	// split on any mix of \r and \n without a regular expression
+	QStringList lines;
+	const QChar* data = text.constData();
+	int size = text.size();
+	int start = 0;
+	for (int i = 0; i <= size; i++)
+	{
+		if (i == size || data[i] == '\n' || data[i] == '\r')
+		{
+			if (i > start)
+				lines.append(QString(data + start, i - start));
+			start = i + 1;
+		}
+	}
+
+	// only the last lines of a huge chunk can be kept
+	int capacity = m_Lines.size();
+	int n = lines.size();
+	int skip = n > capacity ? n - capacity : 0;
+	n -= skip;
+	if (n == 0)
+		return;
+
+	// make room by dropping the oldest lines
+	int drop = m_Count + n - capacity;
+	if (drop > 0)
+	{
+		beginRemoveRows(QModelIndex(), 0, drop - 1);
+		for (int i = 0; i < drop; i++)
+			m_Lines[(m_First + i) % capacity].clear();
+		m_First = (m_First + drop) % capacity;
+		m_Count -= drop;
+		endRemoveRows();
+	}
+
+	beginInsertRows(QModelIndex(), m_Count, m_Count + n - 1);
+	for (int i = 0; i < n; i++)
+		m_Lines[(m_First + m_Count + i) % capacity] = lines[skip + i];
+	m_Count += n;
+	endInsertRows();
+}
+
+void LogModel::clear()
+{
+	beginResetModel();
+	m_Lines.fill(QString());
+	m_First = 0;
+	m_Count = 0;
+	endResetModel();
+}
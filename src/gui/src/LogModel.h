@@ -0,0 +1,58 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QString>
+
+// the lines of the log, oldest first, for the log view.  at most a
+// fixed number of lines are kept in a ring;  once it's full each new
+// line replaces the oldest.  a list view with uniform item sizes only
+// lays out and paints the visible lines, so a busy log costs the same
+// as a quiet one.
+class LogModel : public QAbstractListModel
+{
+	Q_OBJECT
+
+public:
+	enum { kDefaultCapacity = 10000 };
+
+	LogModel(int capacity = kDefaultCapacity, QObject* parent = NULL);
+	virtual ~LogModel();
+
+	int rowCount(const QModelIndex& parent = QModelIndex()) const;
+	QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+
+	int capacity() const { return m_Lines.size(); }
+	const QString& line(int row) const;
+
+	// the lines at indexes, oldest first, as text for the clipboard
+	QString text(const QModelIndexList& indexes) const;
+
+public slots:
+	// splits text into lines and appends them, skipping empty lines
+	void appendLines(const QString& text);
+	void clear();
+
+private:
+	QVector<QString> m_Lines;
+	int m_First;
+	int m_Count;
+};
@@ -35,6 +35,8 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QScrollBar>
+#include <QClipboard>
 
 #if defined(Q_OS_MAC)
 #include <ApplicationServices/ApplicationServices.h>
@@ -81,6 +83,21 @@ MainWindow::MainWindow(QSettings& settings, AppConfig& appConfig) :
 {
 	setupUi(this);
 
+	m_pLogOutput->setModel(&m_LogModel);
+
+	// the log is shared for support so it must be easy to copy
+	QAction* pActionCopyLog = new QAction(tr("&Copy"), m_pLogOutput);
+	pActionCopyLog->setShortcut(QKeySequence::Copy);
+	pActionCopyLog->setShortcutContext(Qt::WidgetShortcut);
+	connect(pActionCopyLog, SIGNAL(triggered()), this, SLOT(copyLog()));
+	QAction* pActionSelectLog = new QAction(tr("Select &All"), m_pLogOutput);
+	pActionSelectLog->setShortcut(QKeySequence::SelectAll);
+	pActionSelectLog->setShortcutContext(Qt::WidgetShortcut);
+	connect(pActionSelectLog, SIGNAL(triggered()), m_pLogOutput, SLOT(selectAll()));
+	m_pLogOutput->addAction(pActionCopyLog);
+	m_pLogOutput->addAction(pActionSelectLog);
+	m_pLogOutput->setContextMenuPolicy(Qt::ActionsContextMenu);
+
 	createMenuBar();
 	loadSettings();
 	initConnections();
@@ -307,14 +324,7 @@ void MainWindow::logOutput()
 {
 	if (m_pSynergy)
 	{
-		QString text(m_pSynergy->readAllStandardOutput());
-		foreach(QString line, text.split(QRegExp("\r|\n|\r\n")))
-		{
-			if (!line.isEmpty())
-			{
-				appendLogRaw(line);				
-			}
-		}
+		appendLogRaw(m_pSynergy->readAllStandardOutput());
 	}
 }
 
@@ -348,12 +358,18 @@ void MainWindow::appendLogError(const QString& text)
 
 void MainWindow::appendLogRaw(const QString& text)
 {
-	foreach(QString line, text.split(QRegExp("\r|\n|\r\n"))) {
-		if (!line.isEmpty()) {
-			m_pLogOutput->append(line);
-			updateStateFromLogLine(line);
-		}
-	}
+	// follow the end of the log unless the user has scrolled back
+	QScrollBar* scrollBar = m_pLogOutput->verticalScrollBar();
+	bool atEnd = scrollBar->value() == scrollBar->maximum();
+
+	m_LogModel.appendLines(text);
+
+	// none of the state messages span lines, so the whole chunk can be
+	// searched at once.
+	updateStateFromLogLine(text);
+
+	if (atEnd)
+		m_pLogOutput->scrollToBottom();
 }
 
 void MainWindow::updateStateFromLogLine(const QString &line)
@@ -369,7 +385,14 @@ void MainWindow::updateStateFromLogLine(const QString &line)
 
 void MainWindow::clearLog()
 {
-	m_pLogOutput->clear();
+	m_LogModel.clear();
+}
+
+void MainWindow::copyLog()
+{
+	QModelIndexList selected = m_pLogOutput->selectionModel()->selectedIndexes();
+	if (!selected.isEmpty())
+		QApplication::clipboard()->setText(m_LogModel.text(selected));
 }
 
 void MainWindow::startSynergy()
@@ -440,7 +463,7 @@ void MainWindow::startSynergy()
 	}
 
 	// put a space between last log output and new instance.
-	if (!m_pLogOutput->toPlainText().isEmpty())
+	if (m_LogModel.rowCount() > 0)
 		appendLogRaw("");
 
 	appendLogNote("starting " + QString(synergyType() == synergyServer ? "server" : "client"));
@@ -33,6 +33,7 @@
 #include "VersionChecker.h"
 #include "IpcClient.h"
 #include "Ipc.h"
+#include "LogModel.h"
 
 class QAction;
 class QMenu;
@@ -120,6 +121,7 @@ class MainWindow : public QMainWindow, public Ui::MainWindowBase
 		void stopSynergy();
 		void logOutput();
 		void logError();
+		void copyLog();
 		void updateFound(const QString& version);
 
 	protected:
@@ -161,6 +163,7 @@ class MainWindow : public QMainWindow, public Ui::MainWindowBase
 		bool m_AlreadyHidden;
 		VersionChecker m_VersionChecker;
 		IpcClient m_IpcClient;
+		LogModel m_LogModel;
 		bool m_ElevateProcess;
 		bool m_SuppressElevateWarning;
 		QMenuBar* m_pMenuBar;
@@ -20,6 +20,7 @@
 
 #include "common/IInterface.h"
 #include "common/stdstring.h"
+#include "common/stdvector.h"
 
 //! Interface for architecture dependent file system operations
 /*!
@@ -61,5 +62,41 @@ public:
 							const std::string& prefix,
 							const std::string& suffix) = 0;
 
+	//! Get temporary directory
+	/*!
+	Returns the directory for temporary files.
+	*/
+	virtual std::string	getTempDirectory() = 0;
+
+	//! Test for a directory
+	/*!
+	Returns true iff \c path names an existing directory.
+	*/
+	virtual bool		isDirectory(const std::string& path) = 0;
+
+	//! List a directory
+	/*!
+	Appends the names (not paths) of the entries in directory \c path,
+	except for \c . and \c .., to \c names in no particular order.
+	Returns false if the directory can't be read.
+	*/
+	virtual bool		listDirectory(const std::string& path,
+							std::vector<std::string>& names) = 0;
+
+	//! Create a directory
+	/*!
+	Creates directory \c path.  Its parent must exist.  Returns true
+	iff the directory exists afterwards.
+	*/
+	virtual bool		makeDirectory(const std::string& path) = 0;
+
+	//! Get private directory
+	/*!
+	Returns a directory only the current user can use, for sockets and
+	spool files, creating it if necessary.  Returns the empty string if
+	there's no such directory, e.g. because another user made it first.
+	*/
+	virtual std::string	getPrivateDirectory() = 0;
+
 	//@}
 };
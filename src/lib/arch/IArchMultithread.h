@@ -88,6 +88,16 @@ public:
 	};
 	//! Type of signal handler function
 	typedef void		(*SignalFunc)(ESignal, void* userData);
+	//! Thread scheduling policies
+	/*!
+	Not all platforms support all policies.
+	*/
+	enum ESchedulingPolicy {
+		kSCHEDULE_NORMAL,		//!< Time sharing at normal priority
+		kSCHEDULE_NICE,			//!< Time sharing at a given niceness
+		kSCHEDULE_ROUND_ROBIN,	//!< Real-time, round robin
+		kSCHEDULE_FIFO			//!< Real-time, first in first out
+	};
 
 	//! @name manipulators
 	//@{
@@ -201,6 +211,33 @@ public:
 	*/
 	virtual void		setPriorityOfThread(CArchThread, int n) = 0;
 
+	//! Change thread scheduling policy
+	/*!
+	Schedules \c thread using \c policy.  For \c kSCHEDULE_NICE,
+	\c priority is the niceness (negative is a higher priority).  For the
+	real-time policies it's the real-time priority, clamped to the range
+	the system allows.  It's ignored for \c kSCHEDULE_NORMAL.  Returns
+	false if the policy isn't supported or the process isn't permitted
+	to use it, in which case the thread's scheduling is unchanged.
+	*/
+	virtual bool		setSchedulingOfThread(CArchThread thread,
+							ESchedulingPolicy policy, int priority) = 0;
+
+	//! Pin thread to a CPU
+	/*!
+	Restricts \c thread to run only on CPU number \c cpu.  Returns false
+	if that isn't supported or permitted.
+	*/
+	virtual bool		setAffinityOfThread(CArchThread thread, int cpu) = 0;
+
+	//! Lock process memory
+	/*!
+	Locks all current and future pages of the process into memory so
+	that time critical threads never wait for a page to be read back in.
+	Returns false if that isn't supported or permitted.
+	*/
+	virtual bool		lockMemory() = 0;
+
 	//! Cancellation point
 	/*!
 	This method does nothing but is a cancellation point.  Clients
@@ -64,6 +64,7 @@ public:
 	enum EAddressFamily {
 		kUNKNOWN,
 		kINET,
+		kUNIX
 	};
 
 	//! Supported socket types
@@ -215,6 +216,26 @@ public:
 	virtual size_t		writeSocket(CArchSocket s,
 							const void* buf, size_t len) = 0;
 
+	//! Read a datagram from socket
+	/*!
+	Read the next datagram on socket \c s into \c buf and return its
+	size, discarding any part beyond \c len bytes.  Returns 0 if no
+	datagram is waiting.  If one was read and \c addr isn't NULL then
+	\c *addr is set to a new copy of the sender's address, which the
+	caller must close.
+	*/
+	virtual size_t		readFromSocket(CArchSocket s, void* buf, size_t len,
+							CArchNetAddress* addr) = 0;
+
+	//! Write a datagram to socket
+	/*!
+	Send \c len bytes from \c buf as one datagram on socket \c s to
+	\c addr.  Returns the number of bytes sent, which is 0 if the
+	datagram was dropped because the internal buffers are full.
+	*/
+	virtual size_t		writeToSocket(CArchSocket s, const void* buf,
+							size_t len, CArchNetAddress addr) = 0;
+
 	//! Check error on socket
 	/*!
 	If the socket \c s is in an error state then throws an appropriate
@@ -248,6 +269,14 @@ public:
 	//! Convert a name to a network address
 	virtual CArchNetAddress	nameToAddr(const std::string&) = 0;
 
+	//! Create a local address
+	/*!
+	Returns a kUNIX address for the socket file at \c path.  Throws
+	XArchNetworkSupport if the platform has no local sockets and
+	XArchNetworkNameUnsupported if \c path is too long.
+	*/
+	virtual CArchNetAddress	newLocalAddr(const std::string& path) = 0;
+
 	//! Destroy a network address
 	virtual void			closeAddr(CArchNetAddress) = 0;
 
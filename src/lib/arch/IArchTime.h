@@ -19,6 +19,7 @@
 #pragma once
 
 #include "common/IInterface.h"
+#include "common/basic_types.h"
 
 //! Interface for architecture dependent time operations
 /*!
@@ -33,9 +34,27 @@ public:
 	//! Get the current time
 	/*!
 	Returns the number of seconds since some arbitrary starting time.
-	This should return as high a precision as reasonable.
+	This should return as high a precision as reasonable.  The time is
+	monotonic:  it never goes backwards and doesn't jump when the wall
+	clock is changed, so it's only useful for measuring intervals.
 	*/
 	virtual double		time() = 0;
 
+	//! Get the current time in nanoseconds
+	/*!
+	Returns the same time as time() as an integral number of nanoseconds,
+	for callers that need to measure short intervals without losing
+	precision.
+	*/
+	virtual UInt64		nanoTime() = 0;
+
+	//! Get the current time cheaply
+	/*!
+	Returns the same time as time() but may be cached or read from a low
+	resolution clock (resolution of a few milliseconds) if that's faster.
+	Use it on hot paths that only need coarse timestamps.
+	*/
+	virtual double		coarseTime() = 0;
+
 	//@}
 };
@@ -22,6 +22,10 @@
 #include <unistd.h>
 #include <pwd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <cstdlib>
 #include <cstring>
 
 //
@@ -101,3 +105,80 @@ CArchFileUnix::concatPath(const std::string& prefix,
 	path += suffix;
 	return path;
 }
+
+std::string
+CArchFileUnix::getTempDirectory()
+{
+	const char* dir = getenv("TMPDIR");
+	if (dir != NULL && dir[0] != '\0') {
+		return dir;
+	}
+	return "/tmp";
+}
+
+bool
+CArchFileUnix::isDirectory(const std::string& path)
+{
+	struct stat info;
+	return (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode));
+}
+
+bool
+CArchFileUnix::listDirectory(const std::string& path,
+				std::vector<std::string>& names)
+{
+	DIR* dir = opendir(path.c_str());
+	if (dir == NULL) {
+		return false;
+	}
+
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") != 0 &&
+			strcmp(entry->d_name, "..") != 0) {
+			names.push_back(entry->d_name);
+		}
+	}
+	closedir(dir);
+	return true;
+}
+
+bool
+CArchFileUnix::makeDirectory(const std::string& path)
+{
+	if (mkdir(path.c_str(), 0777) == 0) {
+		return true;
+	}
+	return (errno == EEXIST && isDirectory(path));
+}
+
+std::string
+CArchFileUnix::getPrivateDirectory()
+{
+	// use the session's runtime directory if there is one, otherwise
+	// a directory named for the user in the shared temp directory
+	std::string dir;
+	const char* runtime = getenv("XDG_RUNTIME_DIR");
+	if (runtime != NULL && runtime[0] != '\0') {
+		dir = concatPath(runtime, "synergy");
+	}
+	else {
+		char name[32];
+		sprintf(name, "synergy-%lu", static_cast<unsigned long>(getuid()));
+		dir = concatPath(getTempDirectory(), name);
+	}
+	if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+		return "";
+	}
+
+	// anyone can make the directory first in a shared temp directory,
+	// so check it's a real directory that's ours and closed to others
+	struct stat info;
+	if (lstat(dir.c_str(), &info) != 0 ||
+		!S_ISDIR(info.st_mode) ||
+		info.st_uid != getuid() ||
+		(info.st_mode & 077) != 0) {
+		return "";
+	}
+	return dir;
+}
@@ -34,4 +34,10 @@ public:
 	virtual std::string	getSystemDirectory();
 	virtual std::string	concatPath(const std::string& prefix,
 							const std::string& suffix);
+	virtual std::string	getTempDirectory();
+	virtual bool		isDirectory(const std::string& path);
+	virtual bool		listDirectory(const std::string& path,
+							std::vector<std::string>& names);
+	virtual bool		makeDirectory(const std::string& path);
+	virtual std::string	getPrivateDirectory();
 };
@@ -32,10 +32,63 @@
 #		include <time.h>
 #	endif
 #endif
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
 #include <cerrno>
+#if defined(__linux__)
+#	include <sys/syscall.h>
+#endif
 
 #define SIGWAKEUP SIGUSR1
 
+// time condition variable waits against the monotonic clock so that
+// setting the wall clock doesn't end or stretch them.  OS X can't.
+#if HAVE_CLOCK_GETTIME && !defined(__APPLE__)
+#	define USE_MONOTONIC_COND 1
+#	include <time.h>
+#endif
+
+// how many times setSchedulingOfThread() yields waiting for a new
+// thread to note its kernel thread id
+static const int s_threadStartTries = 1000;
+
+// get the current time on the clock condition variable waits use
+static void
+getWaitClock(struct timespec& time)
+{
+#if USE_MONOTONIC_COND
+	clock_gettime(CLOCK_MONOTONIC, &time);
+#else
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	time.tv_sec  = now.tv_sec;
+	time.tv_nsec = now.tv_usec * 1000;
+#endif
+}
+
+static void
+addWaitTime(struct timespec& time, double seconds)
+{
+	long sec     = (long)seconds;
+	long nsec    = (long)(1.0e+9 * (seconds - sec));
+	time.tv_sec  += sec;
+	time.tv_nsec += nsec;
+	if (time.tv_nsec >= 1000000000) {
+		time.tv_nsec -= 1000000000;
+		time.tv_sec  += 1;
+	}
+}
+
+// note the calling thread holds mutex
+static void
+setMutexOwner(CArchMutexImpl* mutex)
+{
+	mutex->m_owner = pthread_self();
+	mutex->m_owned = true;
+}
+
 #if !HAVE_PTHREAD_SIGNAL
 	// boy, is this platform broken.  forget about pthread signal
 	// handling and let signals through to every process.  synergy
@@ -70,6 +123,7 @@ public:
 	int					m_refCount;
 	IArchMultithread::ThreadID		m_id;
 	pthread_t			m_thread;
+	volatile int		m_tid;
 	IArchMultithread::ThreadFunc	m_func;
 	void*				m_userData;
 	bool				m_cancel;
@@ -77,18 +131,25 @@ public:
 	bool				m_exited;
 	void*				m_result;
 	void*				m_networkData;
+	CArchCond			m_waitCond;
+	CArchMutex			m_waitMutex;
+	int					m_wakers;
 };
 
 CArchThreadImpl::CArchThreadImpl() :
 	m_refCount(1),
 	m_id(0),
+	m_tid(0),
 	m_func(NULL),
 	m_userData(NULL),
 	m_cancel(false),
 	m_cancelling(false),
 	m_exited(false),
 	m_result(NULL),
-	m_networkData(NULL)
+	m_networkData(NULL),
+	m_waitCond(NULL),
+	m_waitMutex(NULL),
+	m_wakers(0)
 {
 	// do nothing
 }
@@ -117,11 +178,36 @@ CArchMultithreadPosix::CArchMultithreadPosix() :
 	// create mutex for thread list
 	m_threadMutex = newMutex();
 
+	// create key for each thread's own thread object
+	int status = pthread_key_create(&m_self, NULL);
+	(void)status;
+	assert(status == 0);
+
+	// create objects for waking waiting threads
+	m_waitLock    = newMutex();
+	m_wakersDone  = newCondVar();
+	m_exitMutex   = newMutex();
+	m_exitCond    = newCondVar();
+
+	// note how the process is scheduled before anyone changes it.  new
+	// threads start like this rather than like the thread creating them.
+	errno         = 0;
+	m_defaultNice = getpriority(PRIO_PROCESS, 0);
+	if (errno != 0) {
+		m_defaultNice = 0;
+	}
+#if defined(__linux__)
+	m_hasDefaultCPUs = (sched_getaffinity(0, sizeof(m_defaultCPUs),
+							&m_defaultCPUs) == 0);
+#endif
+
 	// create thread for calling (main) thread and add it to our
 	// list.  no need to lock the mutex since we're the only thread.
 	m_mainThread           = new CArchThreadImpl;
 	m_mainThread->m_thread = pthread_self();
+	m_mainThread->m_tid    = getKernelThreadID();
 	insert(m_mainThread);
+	pthread_setspecific(m_self, m_mainThread);
 
 	// install SIGWAKEUP handler.  this causes SIGWAKEUP to interrupt
 	// system calls.  we use that when cancelling a thread to force it
@@ -153,6 +239,11 @@ CArchMultithreadPosix::~CArchMultithreadPosix()
 {
 	assert(s_instance != NULL);
 
+	closeCondVar(m_exitCond);
+	closeMutex(m_exitMutex);
+	closeCondVar(m_wakersDone);
+	closeMutex(m_waitLock);
+	pthread_key_delete(m_self);
 	closeMutex(m_threadMutex);
 	s_instance = NULL;
 }
@@ -160,8 +251,8 @@ CArchMultithreadPosix::~CArchMultithreadPosix()
 void
 CArchMultithreadPosix::setNetworkDataForCurrentThread(void* data)
 {
+	CArchThreadImpl* thread = findSelf();
 	lockMutex(m_threadMutex);
-	CArchThreadImpl* thread = find(pthread_self());
 	thread->m_networkData = data;
 	unlockMutex(m_threadMutex);
 }
@@ -185,7 +276,17 @@ CArchCond
 CArchMultithreadPosix::newCondVar()
 {
 	CArchCondImpl* cond = new CArchCondImpl;
+#if USE_MONOTONIC_COND
+	pthread_condattr_t attr;
+	int status = pthread_condattr_init(&attr);
+	assert(status == 0);
+	status = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	assert(status == 0);
+	status = pthread_cond_init(&cond->m_cond, &attr);
+	pthread_condattr_destroy(&attr);
+#else
 	int status = pthread_cond_init(&cond->m_cond, NULL);
+#endif
 	(void)status;
 	assert(status == 0);
 	return cond;
@@ -220,43 +321,43 @@ bool
 CArchMultithreadPosix::waitCondVar(CArchCond cond,
 							CArchMutex mutex, double timeout)
 {
-	// we can't wait on a condition variable and also wake it up for
-	// cancellation since we don't use posix cancellation.  so we
-	// must wake up periodically to check for cancellation.  we
-	// can't simply go back to waiting after the check since the
-	// condition may have changed and we'll have lost the signal.
-	// so we have to return to the caller.  since the caller will
-	// always check for spurious wakeups the only drawback here is
-	// performance:  we're waking up a lot more than desired.
-	static const double maxCancellationLatency = 0.1;
-	if (timeout < 0.0 || timeout > maxCancellationLatency) {
-		timeout = maxCancellationLatency;
+	// we don't use posix cancellation so cancelThread() can't interrupt
+	// the wait itself.  instead we note what we're waiting on so it can
+	// broadcast the condition variable to wake us.  the caller always
+	// checks for spurious wakeups so that's harmless to other waiters.
+	CArchThreadImpl* self = findSelf();
+	beginWait(self, cond, mutex);
+
+	// see if we should cancel this thread.  we must check after noting
+	// the wait or we could miss a cancel.
+	try {
+		testCancelThreadImpl(self);
+	}
+	catch (...) {
+		endWait(self, mutex);
+		throw;
 	}
 
-	// see if we should cancel this thread
-	testCancelThread();
-
-	// get final time
-	struct timeval now;
-	gettimeofday(&now, NULL);
-	struct timespec finalTime;
-	finalTime.tv_sec   = now.tv_sec;
-	finalTime.tv_nsec  = now.tv_usec * 1000;
-	long timeout_sec   = (long)timeout;
-	long timeout_nsec  = (long)(1.0e+9 * (timeout - timeout_sec));
-	finalTime.tv_sec  += timeout_sec;
-	finalTime.tv_nsec += timeout_nsec;
-	if (finalTime.tv_nsec >= 1000000000) {
-		finalTime.tv_nsec -= 1000000000;
-		finalTime.tv_sec  += 1;
-	}
-
-	// wait
-	int status = pthread_cond_timedwait(&cond->m_cond,
-							&mutex->m_mutex, &finalTime);
+	// wait for the whole timeout.  we've held the mutex since the check
+	// and cancelThread() broadcasts holding it too, so its wakeup can't
+	// be lost.
+	int status;
+	mutex->m_owned = false;
+	if (timeout < 0.0) {
+		status = pthread_cond_wait(&cond->m_cond, &mutex->m_mutex);
+	}
+	else {
+		struct timespec finalTime;
+		getWaitClock(finalTime);
+		addWaitTime(finalTime, timeout);
+		status = pthread_cond_timedwait(&cond->m_cond, &mutex->m_mutex,
+							&finalTime);
+	}
+	setMutexOwner(mutex);
+	endWait(self, mutex);
 
 	// check for cancel again
-	testCancelThread();
+	testCancelThreadImpl(self);
 
 	switch (status) {
 	case 0:
@@ -281,6 +382,7 @@ CArchMultithreadPosix::newMutex()
 	CArchMutexImpl* mutex = new CArchMutexImpl;
 	status = pthread_mutex_init(&mutex->m_mutex, &attr);
 	assert(status == 0);
+	mutex->m_owned = false;
 	return mutex;
 }
 
@@ -301,6 +403,7 @@ CArchMultithreadPosix::lockMutex(CArchMutex mutex)
 	switch (status) {
 	case 0:
 		// success
+		setMutexOwner(mutex);
 		return;
 
 	case EDEADLK:
@@ -320,6 +423,7 @@ CArchMultithreadPosix::lockMutex(CArchMutex mutex)
 void
 CArchMultithreadPosix::unlockMutex(CArchMutex mutex)
 {
+	mutex->m_owned = false;
 	int status = pthread_mutex_unlock(&mutex->m_mutex);
 
 	switch (status) {
@@ -368,6 +472,7 @@ CArchMultithreadPosix::newThread(ThreadFunc func, void* data)
 	pthread_attr_t attr;
 	int status = pthread_attr_init(&attr);
 	if (status == 0) {
+		initThreadAttr(attr);
 		status = pthread_create(&thread->m_thread, &attr,
 							&CArchMultithreadPosix::threadFunc, thread);
 		pthread_attr_destroy(&attr);
@@ -396,10 +501,9 @@ CArchMultithreadPosix::newThread(ThreadFunc func, void* data)
 CArchThread
 CArchMultithreadPosix::newCurrentThread()
 {
-	lockMutex(m_threadMutex);
-	CArchThreadImpl* thread = find(pthread_self());
-	unlockMutex(m_threadMutex);
+	CArchThreadImpl* thread = findSelf();
 	assert(thread != NULL);
+	refThread(thread);
 	return thread;
 }
 
@@ -409,7 +513,7 @@ CArchMultithreadPosix::closeThread(CArchThread thread)
 	assert(thread != NULL);
 
 	// decrement ref count and clean up thread if no more references
-	if (--thread->m_refCount == 0) {
+	if (__sync_sub_and_fetch(&thread->m_refCount, 1) == 0) {
 		// detach from thread (unless it's the main thread)
 		if (thread->m_func != NULL) {
 			pthread_detach(thread->m_thread);
@@ -447,8 +551,41 @@ CArchMultithreadPosix::cancelThread(CArchThread thread)
 	}
 	unlockMutex(m_threadMutex);
 
-	// force thread to exit system calls if wakeup is true
 	if (wakeup) {
+		// wake the thread if it's waiting on a condition variable.  the
+		// thread won't leave waitCondVar() (and the condition variable
+		// won't go away) until we've finished.
+		lockMutex(m_waitLock);
+		CArchCond cond   = thread->m_waitCond;
+		CArchMutex mutex = thread->m_waitMutex;
+		if (cond != NULL) {
+			++thread->m_wakers;
+		}
+		unlockMutex(m_waitLock);
+
+		if (cond != NULL) {
+			// broadcast holding the mutex it's waiting with so we can't
+			// come between its check for cancellation and the wait.  if
+			// our caller holds the mutex then the thread is already
+			// waiting, since it holds the mutex from the check on.
+			bool locked = false;
+			if (!mutex->m_owned ||
+				!pthread_equal(mutex->m_owner, pthread_self())) {
+				lockMutex(mutex);
+				locked = true;
+			}
+			broadcastCondVar(cond);
+			if (locked) {
+				unlockMutex(mutex);
+			}
+
+			lockMutex(m_waitLock);
+			--thread->m_wakers;
+			broadcastCondVar(m_wakersDone);
+			unlockMutex(m_waitLock);
+		}
+
+		// force thread to exit system calls
 		pthread_kill(thread->m_thread, SIGWAKEUP);
 	}
 }
@@ -461,15 +598,95 @@ CArchMultithreadPosix::setPriorityOfThread(CArchThread thread, int /*n*/)
 	// FIXME
 }
 
+bool
+CArchMultithreadPosix::setSchedulingOfThread(CArchThread thread,
+				ESchedulingPolicy policy, int priority)
+{
+	assert(thread != NULL);
+
+	int posixPolicy;
+	switch (policy) {
+	case kSCHEDULE_ROUND_ROBIN:
+		posixPolicy = SCHED_RR;
+		break;
+
+	case kSCHEDULE_FIFO:
+		posixPolicy = SCHED_FIFO;
+		break;
+
+	default:
+		posixPolicy = SCHED_OTHER;
+		break;
+	}
+
+	// time sharing threads have no real-time priority
+	struct sched_param param;
+	param.sched_priority = 0;
+	if (posixPolicy != SCHED_OTHER) {
+		int minPriority = sched_get_priority_min(posixPolicy);
+		int maxPriority = sched_get_priority_max(posixPolicy);
+		if (priority < minPriority) {
+			priority = minPriority;
+		}
+		else if (priority > maxPriority) {
+			priority = maxPriority;
+		}
+		param.sched_priority = priority;
+	}
+	if (pthread_setschedparam(thread->m_thread, posixPolicy, &param) != 0) {
+		return false;
+	}
+	if (posixPolicy != SCHED_OTHER) {
+		return true;
+	}
+
+	// niceness is per process except on linux, where it's per kernel
+	// thread.  a thread we just created may not have noted its kernel
+	// thread id yet.
+#if defined(__linux__)
+	for (int i = 0; thread->m_tid == 0 && i < s_threadStartTries; ++i) {
+		sched_yield();
+	}
+	if (thread->m_tid == 0) {
+		return false;
+	}
+	int nice = (policy == kSCHEDULE_NICE) ? priority : 0;
+	return (setpriority(PRIO_PROCESS, thread->m_tid, nice) == 0);
+#else
+	return (policy == kSCHEDULE_NORMAL);
+#endif
+}
+
+bool
+CArchMultithreadPosix::setAffinityOfThread(CArchThread thread, int cpu)
+{
+	assert(thread != NULL);
+
+#if defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE) {
+		return false;
+	}
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	return (pthread_setaffinity_np(thread->m_thread,
+							sizeof(cpus), &cpus) == 0);
+#else
+	return false;
+#endif
+}
+
+bool
+CArchMultithreadPosix::lockMemory()
+{
+	return (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+}
+
 void
 CArchMultithreadPosix::testCancelThread()
 {
-	// find current thread
-	lockMutex(m_threadMutex);
-	CArchThreadImpl* thread = findNoRef(pthread_self());
-	unlockMutex(m_threadMutex);
-
 	// test cancel on thread
+	CArchThreadImpl* thread = findSelf();
 	testCancelThreadImpl(thread);
 }
 
@@ -478,22 +695,17 @@ CArchMultithreadPosix::wait(CArchThread target, double timeout)
 {
 	assert(target != NULL);
 
-	lockMutex(m_threadMutex);
-
 	// find current thread
-	CArchThreadImpl* self = findNoRef(pthread_self());
+	CArchThreadImpl* self = findSelf();
 
 	// ignore wait if trying to wait on ourself
 	if (target == self) {
-		unlockMutex(m_threadMutex);
 		return false;
 	}
 
 	// ref the target so it can't go away while we're watching it
 	refThread(target);
 
-	unlockMutex(m_threadMutex);
-
 	try {
 		// do first test regardless of timeout
 		testCancelThreadImpl(self);
@@ -502,26 +714,32 @@ CArchMultithreadPosix::wait(CArchThread target, double timeout)
 			return true;
 		}
 
-		// wait and repeat test if there's a timeout
+		// wait for the thread to exit if there's a timeout
+		bool exited = false;
 		if (timeout != 0.0) {
 			const double start = ARCH->time();
-			do {
-				// wait a little
-				ARCH->sleep(0.05);
-
-				// repeat test
-				testCancelThreadImpl(self);
-				if (isExitedThread(target)) {
-					closeThread(target);
-					return true;
+			lockMutex(m_exitMutex);
+			try {
+				while (!(exited = isExitedThread(target))) {
+					double remaining = -1.0;
+					if (timeout > 0.0) {
+						remaining = timeout - (ARCH->time() - start);
+						if (remaining <= 0.0) {
+							break;
+						}
+					}
+					waitCondVar(m_exitCond, m_exitMutex, remaining);
 				}
-
-				// repeat wait and test until timed out
-			} while (timeout < 0.0 || (ARCH->time() - start) <= timeout);
+			}
+			catch (...) {
+				unlockMutex(m_exitMutex);
+				throw;
+			}
+			unlockMutex(m_exitMutex);
 		}
 
 		closeThread(target);
-		return false;
+		return exited;
 	}
 	catch (...) {
 		closeThread(target);
@@ -599,6 +817,7 @@ CArchMultithreadPosix::startSignalHandler()
 	pthread_attr_t attr;
 	int status = pthread_attr_init(&attr);
 	if (status == 0) {
+		initThreadAttr(attr);
 		status = pthread_create(&m_signalThread, &attr,
 							&CArchMultithreadPosix::threadSignalHandler,
 							NULL);
@@ -621,6 +840,23 @@ CArchMultithreadPosix::find(pthread_t thread)
 	return impl;
 }
 
+CArchThreadImpl*
+CArchMultithreadPosix::findSelf()
+{
+	// threads we created (and the main thread) know their own object
+	CArchThreadImpl* self =
+		reinterpret_cast<CArchThreadImpl*>(pthread_getspecific(m_self));
+	if (self != NULL) {
+		return self;
+	}
+
+	// some other thread.  search for it.
+	lockMutex(m_threadMutex);
+	self = findNoRef(pthread_self());
+	unlockMutex(m_threadMutex);
+	return self;
+}
+
 CArchThreadImpl*
 CArchMultithreadPosix::findNoRef(pthread_t thread)
 {
@@ -668,8 +904,65 @@ void
 CArchMultithreadPosix::refThread(CArchThreadImpl* thread)
 {
 	assert(thread != NULL);
-	assert(findNoRef(thread->m_thread) != NULL);
-	++thread->m_refCount;
+	assert(thread->m_refCount > 0);
+
+	// threads take references to themselves without locking so the
+	// count must be updated atomically
+	__sync_add_and_fetch(&thread->m_refCount, 1);
+}
+
+void
+CArchMultithreadPosix::beginWait(CArchThreadImpl* thread,
+				CArchCond cond, CArchMutex mutex)
+{
+	if (thread != NULL) {
+		lockMutex(m_waitLock);
+		thread->m_waitCond  = cond;
+		thread->m_waitMutex = mutex;
+		unlockMutex(m_waitLock);
+	}
+}
+
+void
+CArchMultithreadPosix::endWait(CArchThreadImpl* thread, CArchMutex mutex)
+{
+	// note -- mutex is locked on entry and exit
+	if (thread == NULL) {
+		return;
+	}
+
+	lockMutex(m_waitLock);
+	thread->m_waitCond  = NULL;
+	thread->m_waitMutex = NULL;
+	if (thread->m_wakers > 0) {
+		// cancelThread() is waking us and needs our mutex.  let it have
+		// the mutex and wait until it's done with the condition variable.
+		unlockMutex(mutex);
+		while (thread->m_wakers > 0) {
+			m_waitLock->m_owned = false;
+			pthread_cond_wait(&m_wakersDone->m_cond, &m_waitLock->m_mutex);
+			setMutexOwner(m_waitLock);
+		}
+		unlockMutex(m_waitLock);
+		lockMutex(mutex);
+	}
+	else {
+		unlockMutex(m_waitLock);
+	}
+}
+
+void
+CArchMultithreadPosix::threadExited(CArchThreadImpl* thread, void* result)
+{
+	lockMutex(m_threadMutex);
+	thread->m_result = result;
+	thread->m_exited = true;
+	unlockMutex(m_threadMutex);
+
+	// wake threads in wait()
+	lockMutex(m_exitMutex);
+	broadcastCondVar(m_exitCond);
+	unlockMutex(m_exitMutex);
 }
 
 void
@@ -710,6 +1003,24 @@ CArchMultithreadPosix::threadFunc(void* vrep)
 	return NULL;
 }
 
+void
+CArchMultithreadPosix::initThreadAttr(pthread_attr_t& attr)
+{
+	// only the threads a scheduling profile is applied to should get
+	// its policy and affinity, not every thread they start
+	struct sched_param param;
+	param.sched_priority = 0;
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+	pthread_attr_setschedparam(&attr, &param);
+#if defined(__linux__)
+	if (m_hasDefaultCPUs) {
+		pthread_attr_setaffinity_np(&attr, sizeof(m_defaultCPUs),
+							&m_defaultCPUs);
+	}
+#endif
+}
+
 void
 CArchMultithreadPosix::doThreadFunc(CArchThread thread)
 {
@@ -720,6 +1031,16 @@ CArchMultithreadPosix::doThreadFunc(CArchThread thread)
 	lockMutex(m_threadMutex);
 	unlockMutex(m_threadMutex);
 
+	// note our thread object so we can find it without searching
+	pthread_setspecific(m_self, thread);
+	thread->m_tid = getKernelThreadID();
+
+	// niceness is inherited from the creating thread on linux and
+	// there's no attribute for it
+#if defined(__linux__)
+	setpriority(PRIO_PROCESS, thread->m_tid, m_defaultNice);
+#endif
+
 	void* result = NULL;
 	try {
 		// go
@@ -731,23 +1052,28 @@ CArchMultithreadPosix::doThreadFunc(CArchThread thread)
 	}
 	catch (...) {
 		// note -- don't catch (...) to avoid masking bugs
-		lockMutex(m_threadMutex);
-		thread->m_exited = true;
-		unlockMutex(m_threadMutex);
+		threadExited(thread, NULL);
 		closeThread(thread);
 		throw;
 	}
 
 	// thread has exited
-	lockMutex(m_threadMutex);
-	thread->m_result = result;
-	thread->m_exited = true;
-	unlockMutex(m_threadMutex);
+	threadExited(thread, result);
 
 	// done with thread
 	closeThread(thread);
 }
 
+int
+CArchMultithreadPosix::getKernelThreadID()
+{
+#if defined(__linux__)
+	return static_cast<int>(syscall(SYS_gettid));
+#else
+	return static_cast<int>(getpid());
+#endif
+}
+
 void
 CArchMultithreadPosix::threadCancel(int)
 {
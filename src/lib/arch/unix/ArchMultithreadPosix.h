@@ -22,6 +22,9 @@
 #include "common/stdlist.h"
 
 #include <pthread.h>
+#if defined(__linux__)
+#	include <sched.h>
+#endif
 
 #define ARCH_MULTITHREAD CArchMultithreadPosix
 
@@ -33,6 +36,11 @@ public:
 class CArchMutexImpl {
 public:
 	pthread_mutex_t		m_mutex;
+
+	// the thread holding the mutex, so cancelThread() can tell if it
+	// already has it.  only meaningful to the owner.
+	volatile bool		m_owned;
+	pthread_t			m_owner;
 };
 
 //! Posix implementation of IArchMultithread
@@ -72,6 +80,10 @@ public:
 	virtual void		closeThread(CArchThread);
 	virtual void		cancelThread(CArchThread);
 	virtual void		setPriorityOfThread(CArchThread, int n);
+	virtual bool		setSchedulingOfThread(CArchThread,
+							ESchedulingPolicy, int priority);
+	virtual bool		setAffinityOfThread(CArchThread, int cpu);
+	virtual bool		lockMemory();
 	virtual void		testCancelThread();
 	virtual bool		wait(CArchThread, double timeout);
 	virtual bool		isSameThread(CArchThread, CArchThread);
@@ -84,6 +96,7 @@ public:
 private:
 	void				startSignalHandler();
 
+	CArchThreadImpl*	findSelf();
 	CArchThreadImpl*	find(pthread_t thread);
 	CArchThreadImpl*	findNoRef(pthread_t thread);
 	void				insert(CArchThreadImpl* thread);
@@ -92,8 +105,21 @@ private:
 	void				refThread(CArchThreadImpl* rep);
 	void				testCancelThreadImpl(CArchThreadImpl* rep);
 
+	// note the condition variable a thread is waiting on so that
+	// cancelThread() can wake it
+	void				beginWait(CArchThreadImpl*, CArchCond, CArchMutex);
+	void				endWait(CArchThreadImpl*, CArchMutex);
+
+	// mark a thread exited and wake threads waiting for it
+	void				threadExited(CArchThreadImpl*, void* result);
+
+	// set up attributes for a new thread so it's scheduled as the
+	// process was at startup, not as the thread creating it
+	void				initThreadAttr(pthread_attr_t& attr);
+
 	void				doThreadFunc(CArchThread thread);
 	static void*		threadFunc(void* vrep);
+	static int			getKernelThreadID();
 	static void			threadCancel(int);
 	static void*		threadSignalHandler(void* vrep);
 
@@ -105,10 +131,22 @@ private:
 	bool				m_newThreadCalled;
 
 	CArchMutex			m_threadMutex;
+	pthread_key_t		m_self;
+	CArchMutex			m_waitLock;
+	CArchCond			m_wakersDone;
+	CArchMutex			m_exitMutex;
+	CArchCond			m_exitCond;
 	CArchThread			m_mainThread;
 	CThreadList			m_threadList;
 	ThreadID			m_nextID;
 
+	// scheduling at startup, before any profile was applied
+	int					m_defaultNice;
+#if defined(__linux__)
+	bool				m_hasDefaultCPUs;
+	cpu_set_t			m_defaultCPUs;
+#endif
+
 	pthread_t			m_signalThread;
 	SignalFunc			m_signalFunc[kNUM_SIGNALS];
 	void*				m_signalUserData[kNUM_SIGNALS];
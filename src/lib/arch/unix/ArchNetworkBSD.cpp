@@ -52,7 +52,8 @@
 
 static const int s_family[] = {
 	PF_UNSPEC,
-	PF_INET
+	PF_INET,
+	PF_UNIX
 };
 static const int s_type[] = {
 	SOCK_DGRAM,
@@ -201,8 +202,9 @@ CArchNetworkBSD::listenOnSocket(CArchSocket s)
 {
 	assert(s != NULL);
 
-	// hardcoding backlog
-	if (listen(s->m_fd, 3) == -1) {
+	// let the system queue as many connections as it will.  the server
+	// decides which to keep;  a short queue just makes clients wait.
+	if (listen(s->m_fd, SOMAXCONN) == -1) {
 		throwError(errno);
 	}
 }
@@ -538,6 +540,43 @@ CArchNetworkBSD::writeSocket(CArchSocket s, const void* buf, size_t len)
 	return n;
 }
 
+size_t
+CArchNetworkBSD::readFromSocket(CArchSocket s, void* buf, size_t len,
+				CArchNetAddress* addr)
+{
+	assert(s != NULL);
+
+	CArchNetAddressImpl from;
+	ssize_t n = recvfrom(s->m_fd, buf, len, 0, &from.m_addr, &from.m_len);
+	if (n == -1) {
+		if (errno == EINTR || errno == EAGAIN) {
+			return 0;
+		}
+		throwError(errno);
+	}
+	if (addr != NULL) {
+		*addr = copyAddr(&from);
+	}
+	return n;
+}
+
+size_t
+CArchNetworkBSD::writeToSocket(CArchSocket s, const void* buf, size_t len,
+				CArchNetAddress addr)
+{
+	assert(s    != NULL);
+	assert(addr != NULL);
+
+	ssize_t n = sendto(s->m_fd, buf, len, 0, &addr->m_addr, addr->m_len);
+	if (n == -1) {
+		if (errno == EINTR || errno == EAGAIN || errno == ENOBUFS) {
+			return 0;
+		}
+		throwError(errno);
+	}
+	return n;
+}
+
 void
 CArchNetworkBSD::throwErrorOnSocket(CArchSocket s)
 {
@@ -722,6 +761,22 @@ CArchNetworkBSD::nameToAddr(const std::string& name)
 	return addr;
 }
 
+CArchNetAddress
+CArchNetworkBSD::newLocalAddr(const std::string& path)
+{
+	CArchNetAddressImpl* addr = new CArchNetAddressImpl;
+	if (path.size() >= sizeof(addr->m_unixAddr.sun_path)) {
+		delete addr;
+		throw XArchNetworkNameUnsupported("The socket path is too long");
+	}
+
+	memset(&addr->m_unixAddr, 0, sizeof(addr->m_unixAddr));
+	addr->m_unixAddr.sun_family = AF_UNIX;
+	memcpy(addr->m_unixAddr.sun_path, path.c_str(), path.size());
+	addr->m_len = (socklen_t)sizeof(addr->m_unixAddr);
+	return addr;
+}
+
 void
 CArchNetworkBSD::closeAddr(CArchNetAddress addr)
 {
@@ -735,6 +790,10 @@ CArchNetworkBSD::addrToName(CArchNetAddress addr)
 {
 	assert(addr != NULL);
 
+	if (addr->m_addr.sa_family == AF_UNIX) {
+		return addrToString(addr);
+	}
+
 	// mutexed name lookup (ugh)
 	ARCH->lockMutex(m_mutex);
 	struct hostent* info = gethostbyaddr(
@@ -769,6 +828,13 @@ CArchNetworkBSD::addrToString(CArchNetAddress addr)
 		return s;
 	}
 
+	case kUNIX:
+		// unnamed (e.g. accepted) sockets have no path
+		if (addr->m_len <= (socklen_t)sizeof(sa_family_t)) {
+			return "";
+		}
+		return addr->m_unixAddr.sun_path;
+
 	default:
 		assert(0 && "unknown address family");
 		return "";
@@ -784,6 +850,9 @@ CArchNetworkBSD::getAddrFamily(CArchNetAddress addr)
 	case AF_INET:
 		return kINET;
 
+	case AF_UNIX:
+		return kUNIX;
+
 	default:
 		return kUNKNOWN;
 	}
@@ -802,6 +871,10 @@ CArchNetworkBSD::setAddrPort(CArchNetAddress addr, int port)
 		break;
 	}
 
+	case kUNIX:
+		// local addresses have no port
+		break;
+
 	default:
 		assert(0 && "unknown address family");
 		break;
@@ -820,6 +893,9 @@ CArchNetworkBSD::getAddrPort(CArchNetAddress addr)
 		return ntohs(ipAddr->sin_port);
 	}
 
+	case kUNIX:
+		return 0;
+
 	default:
 		assert(0 && "unknown address family");
 		return 0;
@@ -839,6 +915,9 @@ CArchNetworkBSD::isAnyAddr(CArchNetAddress addr)
 				addr->m_len == (socklen_t)sizeof(struct sockaddr_in));
 	}
 
+	case kUNIX:
+		return false;
+
 	default:
 		assert(0 && "unknown address family");
 		return true;
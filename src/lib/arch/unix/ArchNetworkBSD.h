@@ -26,6 +26,7 @@
 #endif
 #if HAVE_SYS_SOCKET_H
 #	include <sys/socket.h>
+#	include <sys/un.h>
 #endif
 
 #if !HAVE_SOCKLEN_T
@@ -47,10 +48,13 @@ public:
 
 class CArchNetAddressImpl {
 public:
-	CArchNetAddressImpl() : m_len(sizeof(m_addr)) { }
+	CArchNetAddressImpl() : m_len(sizeof(m_unixAddr)) { }
 
 public:
-	struct sockaddr		m_addr;
+	union {
+		struct sockaddr		m_addr;
+		struct sockaddr_un	m_unixAddr;
+	};
 	socklen_t			m_len;
 };
 
@@ -76,6 +80,10 @@ public:
 	virtual size_t		readSocket(CArchSocket s, void* buf, size_t len);
 	virtual size_t		writeSocket(CArchSocket s,
 							const void* buf, size_t len);
+	virtual size_t		readFromSocket(CArchSocket s, void* buf, size_t len,
+							CArchNetAddress* addr);
+	virtual size_t		writeToSocket(CArchSocket s, const void* buf,
+							size_t len, CArchNetAddress addr);
 	virtual void		throwErrorOnSocket(CArchSocket);
 	virtual bool		setNoDelayOnSocket(CArchSocket, bool noDelay);
 	virtual bool		setReuseAddrOnSocket(CArchSocket, bool reuse);
@@ -83,6 +91,7 @@ public:
 	virtual CArchNetAddress	newAnyAddr(EAddressFamily);
 	virtual CArchNetAddress	copyAddr(CArchNetAddress);
 	virtual CArchNetAddress	nameToAddr(const std::string&);
+	virtual CArchNetAddress	newLocalAddr(const std::string&);
 	virtual void			closeAddr(CArchNetAddress);
 	virtual std::string		addrToName(CArchNetAddress);
 	virtual std::string		addrToString(CArchNetAddress);
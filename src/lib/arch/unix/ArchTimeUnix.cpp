@@ -28,6 +28,11 @@
 #		include <time.h>
 #	endif
 #endif
+#if HAVE_CLOCK_GETTIME
+#	include <time.h>
+#elif defined(__APPLE__)
+#	include <mach/mach_time.h>
+#endif
 
 //
 // CArchTimeUnix
@@ -46,7 +51,41 @@ CArchTimeUnix::~CArchTimeUnix()
 double
 CArchTimeUnix::time()
 {
+	return 1.0e-9 * (double)nanoTime();
+}
+
+UInt64
+CArchTimeUnix::nanoTime()
+{
+#if HAVE_CLOCK_GETTIME
+	// the monotonic clock doesn't jump when the wall clock is set
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (UInt64)t.tv_sec * 1000000000 + (UInt64)t.tv_nsec;
+#elif defined(__APPLE__)
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0) {
+		mach_timebase_info(&timebase);
+	}
+	return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+	// no monotonic clock.  fall back to the wall clock.
 	struct timeval t;
 	gettimeofday(&t, NULL);
-	return (double)t.tv_sec + 1.0e-6 * (double)t.tv_usec;
+	return (UInt64)t.tv_sec * 1000000000 + (UInt64)t.tv_usec * 1000;
+#endif
+}
+
+double
+CArchTimeUnix::coarseTime()
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_MONOTONIC_COARSE)
+	// the coarse clock is read without a system call and counts from
+	// the same starting point as CLOCK_MONOTONIC
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &t);
+	return (double)t.tv_sec + 1.0e-9 * (double)t.tv_nsec;
+#else
+	return time();
+#endif
 }
@@ -30,4 +30,6 @@ public:
 
 	// IArchTime overrides
 	virtual double		time();
+	virtual UInt64		nanoTime();
+	virtual double		coarseTime();
 };
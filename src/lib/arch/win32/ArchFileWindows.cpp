@@ -136,3 +136,65 @@ CArchFileWindows::concatPath(const std::string& prefix,
 	path += suffix;
 	return path;
 }
+
+std::string
+CArchFileWindows::getTempDirectory()
+{
+	char dir[MAX_PATH];
+	DWORD result = GetTempPath(sizeof(dir), dir);
+	if (result != 0 && result <= sizeof(dir)) {
+		return dir;
+	}
+	else {
+		// can't get it.  use C:\ as a default.
+		return "C:";
+	}
+}
+
+bool
+CArchFileWindows::isDirectory(const std::string& path)
+{
+	DWORD attr = GetFileAttributes(path.c_str());
+	return (attr != INVALID_FILE_ATTRIBUTES &&
+			(attr & FILE_ATTRIBUTE_DIRECTORY) != 0);
+}
+
+bool
+CArchFileWindows::listDirectory(const std::string& path,
+				std::vector<std::string>& names)
+{
+	WIN32_FIND_DATA data;
+	HANDLE find = FindFirstFile(concatPath(path, "*").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	do {
+		if (strcmp(data.cFileName, ".") != 0 &&
+			strcmp(data.cFileName, "..") != 0) {
+			names.push_back(data.cFileName);
+		}
+	} while (FindNextFile(find, &data));
+	FindClose(find);
+	return true;
+}
+
+bool
+CArchFileWindows::makeDirectory(const std::string& path)
+{
+	if (CreateDirectory(path.c_str(), NULL)) {
+		return true;
+	}
+	return (GetLastError() == ERROR_ALREADY_EXISTS && isDirectory(path));
+}
+
+std::string
+CArchFileWindows::getPrivateDirectory()
+{
+	// the temp directory is in the user's profile
+	std::string dir = concatPath(getTempDirectory(), "synergy");
+	if (!makeDirectory(dir)) {
+		return "";
+	}
+	return dir;
+}
@@ -435,6 +435,65 @@ CArchMultithreadWindows::setPriorityOfThread(CArchThread thread, int n)
 	SetThreadPriority(thread->m_thread, s_pClass[index].m_level);
 }
 
+bool
+CArchMultithreadWindows::setSchedulingOfThread(CArchThread thread,
+				ESchedulingPolicy policy, int priority)
+{
+	assert(thread != NULL);
+
+	// windows has no real-time policies within a priority class so use
+	// the highest level in the current class
+	int level;
+	switch (policy) {
+	case kSCHEDULE_ROUND_ROBIN:
+	case kSCHEDULE_FIFO:
+		level = THREAD_PRIORITY_TIME_CRITICAL;
+		break;
+
+	case kSCHEDULE_NICE:
+		if (priority < -10) {
+			level = THREAD_PRIORITY_HIGHEST;
+		}
+		else if (priority < 0) {
+			level = THREAD_PRIORITY_ABOVE_NORMAL;
+		}
+		else if (priority == 0) {
+			level = THREAD_PRIORITY_NORMAL;
+		}
+		else if (priority <= 10) {
+			level = THREAD_PRIORITY_BELOW_NORMAL;
+		}
+		else {
+			level = THREAD_PRIORITY_LOWEST;
+		}
+		break;
+
+	default:
+		level = THREAD_PRIORITY_NORMAL;
+		break;
+	}
+	return (SetThreadPriority(thread->m_thread, level) != 0);
+}
+
+bool
+CArchMultithreadWindows::setAffinityOfThread(CArchThread thread, int cpu)
+{
+	assert(thread != NULL);
+
+	if (cpu < 0 || cpu >= static_cast<int>(8 * sizeof(DWORD_PTR))) {
+		return false;
+	}
+	DWORD_PTR mask = static_cast<DWORD_PTR>(1) << cpu;
+	return (SetThreadAffinityMask(thread->m_thread, mask) != 0);
+}
+
+bool
+CArchMultithreadWindows::lockMemory()
+{
+	// not supported
+	return false;
+}
+
 void
 CArchMultithreadWindows::testCancelThread()
 {
@@ -79,6 +79,10 @@ public:
 	virtual void		closeThread(CArchThread);
 	virtual void		cancelThread(CArchThread);
 	virtual void		setPriorityOfThread(CArchThread, int n);
+	virtual bool		setSchedulingOfThread(CArchThread,
+							ESchedulingPolicy, int priority);
+	virtual bool		setAffinityOfThread(CArchThread, int cpu);
+	virtual bool		lockMemory();
 	virtual void		testCancelThread();
 	virtual bool		wait(CArchThread, double timeout);
 	virtual bool		isSameThread(CArchThread, CArchThread);
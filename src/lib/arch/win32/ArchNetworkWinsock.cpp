@@ -26,7 +26,8 @@
 
 static const int s_family[] = {
 	PF_UNSPEC,
-	PF_INET
+	PF_INET,
+	PF_UNSPEC		// kUNIX is not supported
 };
 static const int s_type[] = {
 	SOCK_DGRAM,
@@ -49,6 +50,8 @@ static u_short (PASCAL FAR *ntohs_winsock)(u_short v);
 static int (PASCAL FAR *recv_winsock)(SOCKET s, void FAR * buf, int len, int flags);
 static int (PASCAL FAR *select_winsock)(int nfds, fd_set FAR *readfds, fd_set FAR *writefds, fd_set FAR *exceptfds, const struct timeval FAR *timeout);
 static int (PASCAL FAR *send_winsock)(SOCKET s, const void FAR * buf, int len, int flags);
+static int (PASCAL FAR *recvfrom_winsock)(SOCKET s, void FAR * buf, int len, int flags, struct sockaddr FAR *from, int FAR * fromlen);
+static int (PASCAL FAR *sendto_winsock)(SOCKET s, const void FAR * buf, int len, int flags, const struct sockaddr FAR *to, int tolen);
 static int (PASCAL FAR *setsockopt_winsock)(SOCKET s, int level, int optname, const void FAR * optval, int optlen);
 static int (PASCAL FAR *shutdown_winsock)(SOCKET s, int how);
 static SOCKET (PASCAL FAR *socket_winsock)(int af, int type, int protocol);
@@ -181,6 +184,8 @@ CArchNetworkWinsock::initModule(HMODULE module)
 	setfunc(recv_winsock, recv, int (PASCAL FAR *)(SOCKET s, void FAR * buf, int len, int flags));
 	setfunc(select_winsock, select, int (PASCAL FAR *)(int nfds, fd_set FAR *readfds, fd_set FAR *writefds, fd_set FAR *exceptfds, const struct timeval FAR *timeout));
 	setfunc(send_winsock, send, int (PASCAL FAR *)(SOCKET s, const void FAR * buf, int len, int flags));
+	setfunc(recvfrom_winsock, recvfrom, int (PASCAL FAR *)(SOCKET s, void FAR * buf, int len, int flags, struct sockaddr FAR *from, int FAR * fromlen));
+	setfunc(sendto_winsock, sendto, int (PASCAL FAR *)(SOCKET s, const void FAR * buf, int len, int flags, const struct sockaddr FAR *to, int tolen));
 	setfunc(setsockopt_winsock, setsockopt, int (PASCAL FAR *)(SOCKET s, int level, int optname, const void FAR * optval, int optlen));
 	setfunc(shutdown_winsock, shutdown, int (PASCAL FAR *)(SOCKET s, int how));
 	setfunc(socket_winsock, socket, SOCKET (PASCAL FAR *)(int af, int type, int protocol));
@@ -301,8 +306,9 @@ CArchNetworkWinsock::listenOnSocket(CArchSocket s)
 {
 	assert(s != NULL);
 
-	// hardcoding backlog
-	if (listen_winsock(s->m_socket, 3) == SOCKET_ERROR) {
+	// let the system queue as many connections as it will.  the server
+	// decides which to keep;  a short queue just makes clients wait.
+	if (listen_winsock(s->m_socket, SOMAXCONN) == SOCKET_ERROR) {
 		throwError(getsockerror_winsock());
 	}
 }
@@ -573,6 +579,53 @@ CArchNetworkWinsock::writeSocket(CArchSocket s, const void* buf, size_t len)
 	return static_cast<size_t>(n);
 }
 
+size_t
+CArchNetworkWinsock::readFromSocket(CArchSocket s, void* buf, size_t len,
+				CArchNetAddress* addr)
+{
+	assert(s != NULL);
+
+	CArchNetAddress from = CArchNetAddressImpl::alloc(sizeof(struct sockaddr));
+	int n = recvfrom_winsock(s->m_socket, buf, (int)len, 0,
+							&from->m_addr, &from->m_len);
+	if (n == SOCKET_ERROR) {
+		int err = getsockerror_winsock();
+		free(from);
+		if (err == WSAEINTR || err == WSAEWOULDBLOCK) {
+			return 0;
+		}
+		// the rest of a long datagram is discarded
+		if (err == WSAEMSGSIZE) {
+			return len;
+		}
+		throwError(err);
+	}
+	if (addr != NULL) {
+		*addr = copyAddr(from);
+	}
+	free(from);
+	return static_cast<size_t>(n);
+}
+
+size_t
+CArchNetworkWinsock::writeToSocket(CArchSocket s, const void* buf, size_t len,
+				CArchNetAddress addr)
+{
+	assert(s    != NULL);
+	assert(addr != NULL);
+
+	int n = sendto_winsock(s->m_socket, buf, (int)len, 0,
+							&addr->m_addr, addr->m_len);
+	if (n == SOCKET_ERROR) {
+		int err = getsockerror_winsock();
+		if (err == WSAEINTR || err == WSAEWOULDBLOCK || err == WSAENOBUFS) {
+			return 0;
+		}
+		throwError(err);
+	}
+	return static_cast<size_t>(n);
+}
+
 void
 CArchNetworkWinsock::throwErrorOnSocket(CArchSocket s)
 {
@@ -736,6 +789,12 @@ CArchNetworkWinsock::nameToAddr(const std::string& name)
 	return addr;
 }
 
+CArchNetAddress
+CArchNetworkWinsock::newLocalAddr(const std::string&)
+{
+	throw XArchNetworkSupport("Local sockets are not supported");
+}
+
 void
 CArchNetworkWinsock::closeAddr(CArchNetAddress addr)
 {
@@ -74,6 +74,10 @@ public:
 	virtual size_t		readSocket(CArchSocket s, void* buf, size_t len);
 	virtual size_t		writeSocket(CArchSocket s,
 							const void* buf, size_t len);
+	virtual size_t		readFromSocket(CArchSocket s, void* buf, size_t len,
+							CArchNetAddress* addr);
+	virtual size_t		writeToSocket(CArchSocket s, const void* buf,
+							size_t len, CArchNetAddress addr);
 	virtual void		throwErrorOnSocket(CArchSocket);
 	virtual bool		setNoDelayOnSocket(CArchSocket, bool noDelay);
 	virtual bool		setReuseAddrOnSocket(CArchSocket, bool reuse);
@@ -81,6 +85,7 @@ public:
 	virtual CArchNetAddress	newAnyAddr(EAddressFamily);
 	virtual CArchNetAddress	copyAddr(CArchNetAddress);
 	virtual CArchNetAddress	nameToAddr(const std::string&);
+	virtual CArchNetAddress	newLocalAddr(const std::string&);
 	virtual void			closeAddr(CArchNetAddress);
 	virtual std::string		addrToName(CArchNetAddress);
 	virtual std::string		addrToString(CArchNetAddress);
@@ -36,6 +36,7 @@
 typedef WINMMAPI DWORD (WINAPI *PTimeGetTime)(void);
 
 static double			s_freq       = 0.0;
+static LONGLONG			s_ticks      = 0;
 static HINSTANCE		s_mmInstance = NULL;
 static PTimeGetTime		s_tgt        = NULL;
 
@@ -50,7 +51,8 @@ CArchTimeWindows::CArchTimeWindows()
 
 	LARGE_INTEGER freq;
 	if (QueryPerformanceFrequency(&freq) && freq.QuadPart != 0) {
-		s_freq = 1.0 / static_cast<double>(freq.QuadPart);
+		s_freq  = 1.0 / static_cast<double>(freq.QuadPart);
+		s_ticks = freq.QuadPart;
 	}
 	else {
 		// load winmm.dll and get timeGetTime
@@ -63,7 +65,8 @@ CArchTimeWindows::CArchTimeWindows()
 
 CArchTimeWindows::~CArchTimeWindows()
 {
-	s_freq = 0.0;
+	s_freq  = 0.0;
+	s_ticks = 0;
 	if (s_mmInstance == NULL) {
 		FreeLibrary(reinterpret_cast<HMODULE>(s_mmInstance));
 		s_tgt        = NULL;
@@ -87,3 +90,30 @@ CArchTimeWindows::time()
 		return 0.001 * static_cast<double>(GetTickCount());
 	}
 }
+
+UInt64
+CArchTimeWindows::nanoTime()
+{
+	if (s_freq != 0.0) {
+		// split the count so the multiply can't overflow
+		LARGE_INTEGER c;
+		QueryPerformanceCounter(&c);
+		LONGLONG seconds = c.QuadPart / s_ticks;
+		LONGLONG ticks   = c.QuadPart % s_ticks;
+		return static_cast<UInt64>(seconds) * 1000000000 +
+				static_cast<UInt64>(ticks * 1000000000 / s_ticks);
+	}
+	else if (s_tgt != NULL) {
+		return static_cast<UInt64>(s_tgt()) * 1000000;
+	}
+	else {
+		return static_cast<UInt64>(GetTickCount()) * 1000000;
+	}
+}
+
+double
+CArchTimeWindows::coarseTime()
+{
+	// the performance counter is already cheap to read
+	return time();
+}
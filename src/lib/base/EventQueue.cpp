@@ -26,6 +26,7 @@
 #include "base/IEventJob.h"
 #include "base/EventTypes.h"
 #include "base/Log.h"
+#include "base/Metrics.h"
 #include "base/XBase.h"
 
 EVENT_TYPE_ACCESSOR(CClient)
@@ -39,6 +40,7 @@ EVENT_TYPE_ACCESSOR(IListenSocket)
 EVENT_TYPE_ACCESSOR(ISocket)
 EVENT_TYPE_ACCESSOR(COSXScreen)
 EVENT_TYPE_ACCESSOR(CClientListener)
+EVENT_TYPE_ACCESSOR(CLivenessMonitor)
 EVENT_TYPE_ACCESSOR(CClientProxy)
 EVENT_TYPE_ACCESSOR(CClientProxyUnknown)
 EVENT_TYPE_ACCESSOR(CServer)
@@ -47,6 +49,10 @@ EVENT_TYPE_ACCESSOR(IKeyState)
 EVENT_TYPE_ACCESSOR(IPrimaryScreen)
 EVENT_TYPE_ACCESSOR(IScreen)
 
+static CCounter			s_dispatched("eventQueue.dispatched");
+static CGauge			s_depth("eventQueue.depth");
+static CGauge			s_timers("eventQueue.timers");
+
 // interrupt handler.  this just adds a quit event to the queue.
 static
 void
@@ -75,6 +81,7 @@ CEventQueue::CEventQueue() :
 	m_typesForISocket(NULL),
 	m_typesForCOSXScreen(NULL),
 	m_typesForCClientListener(NULL),
+	m_typesForCLivenessMonitor(NULL),
 	m_typesForCClientProxy(NULL),
 	m_typesForCClientProxyUnknown(NULL),
 	m_typesForCServer(NULL),
@@ -83,7 +90,8 @@ CEventQueue::CEventQueue() :
 	m_typesForIPrimaryScreen(NULL),
 	m_typesForIScreen(NULL),
 	m_readyMutex(new CMutex),
-	m_readyCondVar(new CCondVar<bool>(m_readyMutex, false))
+	m_readyCondVar(new CCondVar<bool>(m_readyMutex, false)),
+	m_dispatchDepth(0)
 {
 	m_mutex = ARCH->newMutex();
 	ARCH->setSignalHandler(CArch::kINTERRUPT, &interrupt, this);
@@ -107,17 +115,19 @@ CEventQueue::loop()
 {
 	m_buffer->init();
 	{
+		// add the pending events before any other thread can add to
+		// the buffer so they stay in order
 		CLock lock(m_readyMutex);
+		while (!m_pending.empty()) {
+			LOG((CLOG_DEBUG "add pending events to buffer"));
+			CEvent& event = m_pending.front();
+			addEventToBuffer(event);
+			m_pending.pop();
+		}
 		*m_readyCondVar = true;
 		m_readyCondVar->signal();
 	}
 	LOG((CLOG_DEBUG "event queue is ready"));
-	while (!m_pending.empty()) {
-		LOG((CLOG_DEBUG "add pending events to buffer"));
-		CEvent& event = m_pending.front();
-		addEventToBuffer(event);
-		m_pending.pop();
-	}
 	
 	CEvent event;
 	getEvent(event);
@@ -188,6 +198,7 @@ CEventQueue::adoptBuffer(IEventQueueBuffer* buffer)
 	}
 	m_events.clear();
 	m_oldEventIDs.clear();
+	s_depth.set(0);
 
 	// use new buffer
 	m_buffer = buffer;
@@ -263,11 +274,23 @@ CEventQueue::dispatchEvent(const CEvent& event)
 	if (job == NULL) {
 		job = getHandler(CEvent::kUnknown, target);
 	}
-	if (job != NULL) {
+	if (job == NULL) {
+		return false;
+	}
+
+	s_dispatched.add();
+	++m_dispatchDepth;
+	try {
 		job->run(event);
-		return true;
 	}
-	return false;
+	catch (...) {
+		--m_dispatchDepth;
+		throw;
+	}
+	if (--m_dispatchDepth == 0) {
+		endDispatch();
+	}
+	return true;
 }
 
 void
@@ -287,13 +310,17 @@ CEventQueue::addEvent(const CEvent& event)
 	if ((event.getFlags() & CEvent::kDeliverImmediately) != 0) {
 		dispatchEvent(event);
 		CEvent::deleteData(event);
+		return;
 	}
-	else if (!(*m_readyCondVar)) {
-		m_pending.push(event);
-	}
-	else {
-		addEventToBuffer(event);
+
+	{
+		CLock lock(m_readyMutex);
+		if (!(*m_readyCondVar)) {
+			m_pending.push(event);
+			return;
+		}
 	}
+	addEventToBuffer(event);
 }
 
 void
@@ -323,6 +350,7 @@ CEventQueue::newTimer(double duration, void* target)
 	}
 	CArchMutexLock lock(m_mutex);
 	m_timers.insert(timer);
+	s_timers.set(m_timers.size());
 	// initial duration is requested duration plus whatever's on
 	// the clock currently because the latter will be subtracted
 	// the next time we check for timers.
@@ -342,6 +370,7 @@ CEventQueue::newOneShotTimer(double duration, void* target)
 	}
 	CArchMutexLock lock(m_mutex);
 	m_timers.insert(timer);
+	s_timers.set(m_timers.size());
 	// initial duration is requested duration plus whatever's on
 	// the clock currently because the latter will be subtracted
 	// the next time we check for timers.
@@ -364,6 +393,7 @@ CEventQueue::deleteTimer(CEventQueueTimer* timer)
 	CTimers::iterator index = m_timers.find(timer);
 	if (index != m_timers.end()) {
 		m_timers.erase(index);
+		s_timers.set(m_timers.size());
 	}
 	m_buffer->deleteTimer(timer);
 }
@@ -421,6 +451,74 @@ CEventQueue::removeHandlers(void* target)
 	}
 }
 
+void
+CEventQueue::adoptEndDispatchHandler(void* target, IEventJob* handler)
+{
+	CArchMutexLock lock(m_mutex);
+	IEventJob*& job = m_endDispatchHandlers[target];
+	delete job;
+	job = handler;
+}
+
+void
+CEventQueue::removeEndDispatchHandler(void* target)
+{
+	IEventJob* handler = NULL;
+	{
+		CArchMutexLock lock(m_mutex);
+		CEndDispatchTable::iterator index = m_endDispatchHandlers.find(target);
+		if (index != m_endDispatchHandlers.end()) {
+			handler = index->second;
+			m_endDispatchHandlers.erase(index);
+		}
+	}
+	delete handler;
+}
+
+void
+CEventQueue::endDispatch()
+{
+	// handlers may add or remove handlers so look each one up again
+	std::vector<void*> targets;
+	{
+		CArchMutexLock lock(m_mutex);
+		if (m_endDispatchHandlers.empty()) {
+			return;
+		}
+		targets.reserve(m_endDispatchHandlers.size());
+		for (CEndDispatchTable::const_iterator index =
+								m_endDispatchHandlers.begin();
+								index != m_endDispatchHandlers.end(); ++index) {
+			targets.push_back(index->first);
+		}
+	}
+
+	// handlers may dispatch events but those don't end a dispatch
+	++m_dispatchDepth;
+	try {
+		for (std::vector<void*>::const_iterator index = targets.begin();
+								index != targets.end(); ++index) {
+			IEventJob* job = NULL;
+			{
+				CArchMutexLock lock(m_mutex);
+				CEndDispatchTable::const_iterator index2 =
+								m_endDispatchHandlers.find(*index);
+				if (index2 != m_endDispatchHandlers.end()) {
+					job = index2->second;
+				}
+			}
+			if (job != NULL) {
+				job->run(CEvent(CEvent::kUnknown, *index));
+			}
+		}
+	}
+	catch (...) {
+		--m_dispatchDepth;
+		throw;
+	}
+	--m_dispatchDepth;
+}
+
 bool
 CEventQueue::isEmpty() const
 {
@@ -459,6 +557,7 @@ CEventQueue::saveEvent(const CEvent& event)
 
 	// save data
 	m_events[id] = event;
+	s_depth.set(m_events.size());
 	return id;
 }
 
@@ -474,6 +573,7 @@ CEventQueue::removeEvent(UInt32 eventID)
 	// get data
 	CEvent event = index->second;
 	m_events.erase(index);
+	s_depth.set(m_events.size());
 
 	// save old id for reuse
 	m_oldEventIDs.push_back(eventID);
@@ -56,6 +56,9 @@ public:
 							void* target, IEventJob* handler);
 	virtual void		removeHandler(CEvent::Type type, void* target);
 	virtual void		removeHandlers(void* target);
+	virtual void		adoptEndDispatchHandler(void* target,
+							IEventJob* handler);
+	virtual void		removeEndDispatchHandler(void* target);
 	virtual CEvent::Type
 						registerTypeOnce(CEvent::Type& type, const char* name);
 	virtual bool		isEmpty() const;
@@ -72,6 +75,7 @@ private:
 	bool				hasTimerExpired(CEvent& event);
 	double				getNextTimerTimeout() const;
 	void				addEventToBuffer(const CEvent& event);
+	void				endDispatch();
 	
 private:
 	class CTimer {
@@ -110,6 +114,7 @@ private:
 	typedef std::map<CString, CEvent::Type> CNameMap;
 	typedef std::map<CEvent::Type, IEventJob*> CTypeHandlerTable;
 	typedef std::map<void*, CTypeHandlerTable> CHandlerTable;
+	typedef std::map<void*, IEventJob*> CEndDispatchTable;
 
 	int					m_systemTarget;
 	CArchMutex			m_mutex;
@@ -134,6 +139,10 @@ private:
 
 	// event handlers
 	CHandlerTable		m_handlers;
+	CEndDispatchTable	m_endDispatchHandlers;
+
+	// number of dispatchEvent() calls in progress
+	UInt32				m_dispatchDepth;
 
 public:
 	//
@@ -150,6 +159,7 @@ public:
 	ISocketEvents&				forISocket();
 	COSXScreenEvents&			forCOSXScreen();
 	CClientListenerEvents&		forCClientListener();
+	CLivenessMonitorEvents&		forCLivenessMonitor();
 	CClientProxyEvents&			forCClientProxy();
 	CClientProxyUnknownEvents&	forCClientProxyUnknown();
 	CServerEvents&				forCServer();
@@ -170,6 +180,7 @@ private:
 	ISocketEvents*				m_typesForISocket;
 	COSXScreenEvents*			m_typesForCOSXScreen;
 	CClientListenerEvents*		m_typesForCClientListener;
+	CLivenessMonitorEvents*		m_typesForCLivenessMonitor;
 	CClientProxyEvents*			m_typesForCClientProxy;
 	CClientProxyUnknownEvents*	m_typesForCClientProxyUnknown;
 	CServerEvents*				m_typesForCServer;
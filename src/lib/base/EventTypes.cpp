@@ -108,6 +108,12 @@ REGISTER_EVENT(COSXScreen, confirmSleep)
 
 REGISTER_EVENT(CClientListener, connected)
 
+//
+// CLivenessMonitor
+//
+
+REGISTER_EVENT(CLivenessMonitor, dead)
+
 //
 // CClientProxy
 //
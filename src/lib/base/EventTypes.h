@@ -337,6 +337,27 @@ private:
 	CEvent::Type		m_connected;
 };
 
+class CLivenessMonitorEvents : public CEventTypes {
+public:
+	CLivenessMonitorEvents() :
+		m_dead(CEvent::kUnknown) { }
+
+	//! @name accessors
+	//@{
+
+	//! Get dead event type
+	/*!
+	Returns the dead event type.  This is sent to a watched target when
+	it has been silent for longer than its timeout.
+	*/
+	CEvent::Type		dead();
+
+	//@}
+
+private:
+	CEvent::Type		m_dead;
+};
+
 class CClientProxyEvents : public CEventTypes {
 public:
 	CClientProxyEvents() :
@@ -41,6 +41,7 @@ class IListenSocketEvents;
 class ISocketEvents;
 class COSXScreenEvents;
 class CClientListenerEvents;
+class CLivenessMonitorEvents;
 class CClientProxyEvents;
 class CClientProxyUnknownEvents;
 class CServerEvents;
@@ -166,6 +167,26 @@ public:
 	*/
 	virtual void		removeHandlers(void* target) = 0;
 
+	//! Register a handler for the end of each dispatch
+	/*!
+	Registers \p handler to run each time \c dispatchEvent() is done
+	with an event that wasn't dispatched from another handler, so it
+	runs once the event loop has handled each event, busy or not.
+	Unlike a timer it can't be held off by a queue that never empties.
+	The \p handler is adopted and gets an event of type \c kUnknown for
+	\p target.  Any existing handler for \p target is deleted.  Events
+	must be dispatched on one thread to use this.
+	*/
+	virtual void		adoptEndDispatchHandler(void* target,
+							IEventJob* handler) = 0;
+
+	//! Unregister an end of dispatch handler
+	/*!
+	Unregisters the end of dispatch handler for \p target and deletes
+	it.  A handler may remove itself.
+	*/
+	virtual void		removeEndDispatchHandler(void* target) = 0;
+
 	//! Creates a new event type
 	/*!
 	If \p type contains \c kUnknown then it is set to a unique event
@@ -237,6 +258,7 @@ public:
 	virtual ISocketEvents&				forISocket() = 0;
 	virtual COSXScreenEvents&			forCOSXScreen() = 0;
 	virtual CClientListenerEvents&		forCClientListener() = 0;
+	virtual CLivenessMonitorEvents&		forCLivenessMonitor() = 0;
 	virtual CClientProxyEvents&			forCClientProxy() = 0;
 	virtual CClientProxyUnknownEvents&	forCClientProxyUnknown() = 0;
 	virtual CServerEvents&				forCServer() = 0;
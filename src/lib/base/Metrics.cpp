@@ -0,0 +1,432 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "base/Metrics.h"
+
+#include "common/stdvector.h"
+
+#include <algorithm>
+#include <sstream>
+
+#if SYSAPI_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+//
+// atomic operations on 64 bit values
+//
+
+static
+SInt64
+atomicAdd(volatile SInt64* value, SInt64 delta)
+{
+#if SYSAPI_WIN32
+	return InterlockedExchangeAdd64(value, delta) + delta;
+#else
+	return __sync_add_and_fetch(value, delta);
+#endif
+}
+
+static
+bool
+atomicCompareAndSwap(volatile SInt64* value, SInt64 expected, SInt64 desired)
+{
+#if SYSAPI_WIN32
+	return InterlockedCompareExchange64(value, desired, expected) == expected;
+#else
+	return __sync_bool_compare_and_swap(value, expected, desired);
+#endif
+}
+
+static
+bool
+atomicCompareAndSwap(CMetric* volatile* value, CMetric* expected, CMetric* desired)
+{
+#if SYSAPI_WIN32
+	return InterlockedCompareExchangePointer(
+							reinterpret_cast<void* volatile*>(value),
+							desired, expected) == expected;
+#else
+	return __sync_bool_compare_and_swap(value, expected, desired);
+#endif
+}
+
+static
+SInt64
+atomicGet(const volatile SInt64* value)
+{
+	// an add of zero reads all 64 bits at once, even on 32 bit cpus
+	return atomicAdd(const_cast<volatile SInt64*>(value), 0);
+}
+
+static
+void
+atomicSet(volatile SInt64* value, SInt64 newValue)
+{
+#if SYSAPI_WIN32
+	InterlockedExchange64(value, newValue);
+#else
+	__sync_lock_test_and_set(value, newValue);
+#endif
+}
+
+static
+CString
+formatLine(const char* name, const char* suffix, SInt64 value)
+{
+	std::ostringstream line;
+	line << name << suffix << " " << value << "\n";
+	return line.str();
+}
+
+//
+// CMetric
+//
+
+// the list of metrics.  a plain pointer is zero before any constructor
+// runs, so metrics in any translation unit can add themselves.
+static CMetric* volatile s_metrics = NULL;
+
+CMetric::CMetric(const char* name) :
+	m_name(name),
+	m_next(NULL)
+{
+	// push onto the list.  another thread may be pushing too.
+	CMetric* next;
+	do {
+		next   = s_metrics;
+		m_next = next;
+	} while (!atomicCompareAndSwap(&s_metrics, next, this));
+}
+
+CMetric::~CMetric()
+{
+	// do nothing.  metrics live until the process exits.
+}
+
+CString
+CMetric::snapshot()
+{
+	std::vector<CString> lines;
+	for (const CMetric* metric = s_metrics;
+							metric != NULL; metric = metric->m_next) {
+		CString text;
+		metric->format(text);
+
+		// split into lines for sorting
+		CString::size_type start = 0;
+		CString::size_type end;
+		while ((end = text.find('\n', start)) != CString::npos) {
+			lines.push_back(text.substr(start, end + 1 - start));
+			start = end + 1;
+		}
+	}
+	std::sort(lines.begin(), lines.end());
+
+	CString result;
+	for (std::vector<CString>::const_iterator i = lines.begin();
+							i != lines.end(); ++i) {
+		result += *i;
+	}
+	return result;
+}
+
+//
+// CCounter
+//
+
+CCounter::CCounter(const char* name) :
+	CMetric(name),
+	m_count(0)
+{
+	// do nothing
+}
+
+void
+CCounter::add(UInt64 n)
+{
+	atomicAdd(&m_count, static_cast<SInt64>(n));
+}
+
+UInt64
+CCounter::get() const
+{
+	return static_cast<UInt64>(atomicGet(&m_count));
+}
+
+void
+CCounter::format(CString& snapshot) const
+{
+	snapshot += formatLine(getName(), "", atomicGet(&m_count));
+}
+
+//
+// CCodeCounter
+//
+
+CCodeCounter::CCodeCounter(const char* name) :
+	CMetric(name),
+	m_other(0)
+{
+	for (UInt32 i = 0; i < kSlots; ++i) {
+		m_slots[i].m_key   = 0;
+		m_slots[i].m_count = 0;
+	}
+}
+
+void
+CCodeCounter::add(const UInt8* code)
+{
+	SInt64 key = getKey(code);
+
+	// open addressing.  a slot is claimed for a code by setting its key
+	// and is never given up, so once a key is seen it stays put.
+	UInt32 start = static_cast<UInt32>(
+				(static_cast<UInt64>(key) * 0x9e3779b1u) >> 16) % kSlots;
+	for (UInt32 i = 0; i < kSlots; ++i) {
+		CSlot& slot = m_slots[(start + i) % kSlots];
+		SInt64 slotKey = atomicGet(&slot.m_key);
+		if (slotKey == 0) {
+			if (atomicCompareAndSwap(&slot.m_key, 0, key)) {
+				slotKey = key;
+			}
+			else {
+				// another thread claimed it first
+				slotKey = atomicGet(&slot.m_key);
+			}
+		}
+		if (slotKey == key) {
+			atomicAdd(&slot.m_count, 1);
+			return;
+		}
+	}
+	atomicAdd(&m_other, 1);
+}
+
+UInt64
+CCodeCounter::get(const char* code) const
+{
+	const CSlot* slot = findSlot(getKey(reinterpret_cast<const UInt8*>(code)));
+	if (slot == NULL) {
+		return 0;
+	}
+	return static_cast<UInt64>(atomicGet(&slot->m_count));
+}
+
+void
+CCodeCounter::format(CString& snapshot) const
+{
+	for (UInt32 i = 0; i < kSlots; ++i) {
+		SInt64 key = atomicGet(&m_slots[i].m_key);
+		if (key == 0) {
+			continue;
+		}
+
+		CString suffix(".");
+		if (key < 0x100) {
+			std::ostringstream code;
+			code << "#" << key;
+			suffix += code.str();
+		}
+		else {
+			appendCodeByte(suffix, static_cast<UInt8>(key >> 24));
+			appendCodeByte(suffix, static_cast<UInt8>(key >> 16));
+			appendCodeByte(suffix, static_cast<UInt8>(key >>  8));
+			appendCodeByte(suffix, static_cast<UInt8>(key));
+		}
+		snapshot += formatLine(getName(), suffix.c_str(),
+							atomicGet(&m_slots[i].m_count));
+	}
+
+	SInt64 other = atomicGet(&m_other);
+	if (other != 0) {
+		snapshot += formatLine(getName(), ".other", other);
+	}
+}
+
+void
+CCodeCounter::appendCodeByte(CString& suffix, UInt8 byte)
+{
+	// keep the snapshot one metric per line whatever the peer sent
+	if (byte > ' ' && byte < 0x7f && byte != '\\') {
+		suffix += static_cast<char>(byte);
+	}
+	else {
+		static const char s_hex[] = "0123456789abcdef";
+		suffix += "\\x";
+		suffix += s_hex[byte >> 4];
+		suffix += s_hex[byte & 0x0f];
+	}
+}
+
+SInt64
+CCodeCounter::getKey(const UInt8* code)
+{
+	// compact codes are 1 byte below the letters that start the 4 byte
+	// codes.  no code starts with a zero byte so no key is zero.
+	if (code[0] < 0x20) {
+		return code[0];
+	}
+	return (static_cast<SInt64>(code[0]) << 24) |
+			(static_cast<SInt64>(code[1]) << 16) |
+			(static_cast<SInt64>(code[2]) <<  8) |
+			 static_cast<SInt64>(code[3]);
+}
+
+const CCodeCounter::CSlot*
+CCodeCounter::findSlot(SInt64 key) const
+{
+	for (UInt32 i = 0; i < kSlots; ++i) {
+		if (atomicGet(&m_slots[i].m_key) == key) {
+			return &m_slots[i];
+		}
+	}
+	return NULL;
+}
+
+//
+// CGauge
+//
+
+CGauge::CGauge(const char* name) :
+	CMetric(name),
+	m_value(0)
+{
+	// do nothing
+}
+
+void
+CGauge::set(SInt64 value)
+{
+	atomicSet(&m_value, value);
+}
+
+void
+CGauge::add(SInt64 delta)
+{
+	atomicAdd(&m_value, delta);
+}
+
+SInt64
+CGauge::get() const
+{
+	return atomicGet(&m_value);
+}
+
+void
+CGauge::format(CString& snapshot) const
+{
+	snapshot += formatLine(getName(), "", atomicGet(&m_value));
+}
+
+//
+// CHistogram
+//
+
+CHistogram::CHistogram(const char* name) :
+	CMetric(name),
+	m_sum(0),
+	m_max(0)
+{
+	for (UInt32 i = 0; i < kBuckets; ++i) {
+		m_buckets[i] = 0;
+	}
+}
+
+void
+CHistogram::record(UInt64 value)
+{
+	// the bucket is the number of bits in the value
+	UInt32 bucket = 0;
+	for (UInt64 v = value; v != 0; v >>= 1) {
+		++bucket;
+	}
+	atomicAdd(&m_buckets[bucket], 1);
+	atomicAdd(&m_sum, static_cast<SInt64>(value));
+
+	SInt64 max = atomicGet(&m_max);
+	while (static_cast<UInt64>(max) < value &&
+			!atomicCompareAndSwap(&m_max, max, static_cast<SInt64>(value))) {
+		max = atomicGet(&m_max);
+	}
+}
+
+UInt64
+CHistogram::getCount() const
+{
+	SInt64 count = 0;
+	for (UInt32 i = 0; i < kBuckets; ++i) {
+		count += atomicGet(&m_buckets[i]);
+	}
+	return static_cast<UInt64>(count);
+}
+
+UInt64
+CHistogram::getSum() const
+{
+	return static_cast<UInt64>(atomicGet(&m_sum));
+}
+
+UInt64
+CHistogram::getMax() const
+{
+	return static_cast<UInt64>(atomicGet(&m_max));
+}
+
+UInt64
+CHistogram::getPercentile(double percent) const
+{
+	SInt64 counts[kBuckets];
+	SInt64 total = 0;
+	for (UInt32 i = 0; i < kBuckets; ++i) {
+		counts[i] = atomicGet(&m_buckets[i]);
+		total    += counts[i];
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	// the first bucket holding at least percent of the values
+	double wanted = total * percent / 100.0;
+	SInt64 seen = 0;
+	UInt32 bucket = 0;
+	for (; bucket < kBuckets - 1; ++bucket) {
+		seen += counts[bucket];
+		if (seen > 0 && seen >= wanted) {
+			break;
+		}
+	}
+
+	// the largest value with that many bits
+	UInt64 top = (bucket == 0) ? 0 :
+				(~static_cast<UInt64>(0) >> (kBuckets - 1 - bucket));
+	return std::min(top, getMax());
+}
+
+void
+CHistogram::format(CString& snapshot) const
+{
+	const char* name = getName();
+	snapshot += formatLine(name, ".count", getCount());
+	snapshot += formatLine(name, ".sum", getSum());
+	snapshot += formatLine(name, ".max", getMax());
+	snapshot += formatLine(name, ".p50", getPercentile(50.0));
+	snapshot += formatLine(name, ".p90", getPercentile(90.0));
+	snapshot += formatLine(name, ".p99", getPercentile(99.0));
+}
@@ -0,0 +1,242 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+
+//! A named runtime measurement
+/*!
+Metrics show how busy a running process is: messages and bytes moved,
+queue depths, sizes.  Each is a static object next to the code it
+measures, and adds itself to a process wide list when constructed, so
+updating one is a single atomic operation with no lookup and no lock.
+snapshot() formats every metric, e.g. for the daemon to pass on over
+IPC.  Metrics must have static storage duration;  they're never
+removed from the list.
+
+Names are dot separated, starting with the part of the program, e.g.
+\c net.bytesRead.
+*/
+class CMetric {
+public:
+	//! @name accessors
+	//@{
+
+	//! Get the name
+	const char*			getName() const { return m_name; }
+
+	//! Format all metrics
+	/*!
+	Returns one line per value, sorted by name, each the name and the
+	value separated by a space.  Metrics with several values add a
+	suffix to the name for each, e.g. \c .count.  Values are read one
+	at a time, so a snapshot taken while metrics are updated isn't
+	from one instant.
+	*/
+	static CString		snapshot();
+
+	//@}
+
+protected:
+	CMetric(const char* name);
+	virtual ~CMetric();
+
+	//! Append the value
+	/*!
+	Appends this metric's lines, each ending with a newline, to
+	\c snapshot.
+	*/
+	virtual void		format(CString& snapshot) const = 0;
+
+private:
+	const char*			m_name;
+	CMetric*			m_next;
+};
+
+//! A count of things that happened
+/*!
+Only goes up, e.g. the number of bytes written.
+*/
+class CCounter : public CMetric {
+public:
+	CCounter(const char* name);
+
+	//! @name manipulators
+	//@{
+
+	//! Count \c n more
+	void				add(UInt64 n = 1);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the count
+	UInt64				get() const;
+
+	//@}
+
+protected:
+	virtual void		format(CString& snapshot) const;
+
+private:
+	volatile SInt64		m_count;
+};
+
+//! Counts by message code
+/*!
+A counter for each 4 character message code, e.g. the number of each
+kind of message sent.  Compact message codes are 1 byte and show as
+\c #n.  Lines are \c name.code.  There's room for 64 codes;  any more
+are counted as \c name.other.
+*/
+class CCodeCounter : public CMetric {
+public:
+	CCodeCounter(const char* name);
+
+	//! @name manipulators
+	//@{
+
+	//! Count a message
+	/*!
+	Counts one more of the message with code \c code, which is 4 bytes
+	or 1 byte less than kMsgCompactLimit.
+	*/
+	void				add(const UInt8* code);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the count for a code
+	UInt64				get(const char* code) const;
+
+	//@}
+
+protected:
+	virtual void		format(CString& snapshot) const;
+
+private:
+	enum { kSlots = 64 };
+
+	class CSlot {
+	public:
+		volatile SInt64	m_key;
+		volatile SInt64	m_count;
+	};
+
+	static SInt64		getKey(const UInt8* code);
+	const CSlot*		findSlot(SInt64 key) const;
+
+	// append a code byte to a metric name, as \xNN if it isn't printable
+	static void			appendCodeByte(CString& suffix, UInt8 byte);
+
+private:
+	CSlot				m_slots[kSlots];
+	volatile SInt64		m_other;
+};
+
+//! A value that goes up and down
+/*!
+E.g. the number of connected clients.
+*/
+class CGauge : public CMetric {
+public:
+	CGauge(const char* name);
+
+	//! @name manipulators
+	//@{
+
+	//! Set the value
+	void				set(SInt64 value);
+
+	//! Add to the value
+	/*!
+	Adds \c delta, which may be negative.
+	*/
+	void				add(SInt64 delta);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the value
+	SInt64				get() const;
+
+	//@}
+
+protected:
+	virtual void		format(CString& snapshot) const;
+
+private:
+	volatile SInt64		m_value;
+};
+
+//! The spread of some size
+/*!
+Records values, e.g. the size of each clipboard, in power of two
+buckets.  Lines are the count, sum and largest value recorded (\c .count,
+\c .sum, \c .max) and the 50th, 90th and 99th percentiles (\c .p50 and
+so on), which are the top of the bucket the percentile falls in and so
+up to twice the actual value.
+*/
+class CHistogram : public CMetric {
+public:
+	CHistogram(const char* name);
+
+	//! @name manipulators
+	//@{
+
+	//! Record a value
+	void				record(UInt64 value);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the number of values recorded
+	UInt64				getCount() const;
+
+	//! Get the sum of the values recorded
+	UInt64				getSum() const;
+
+	//! Get the largest value recorded
+	UInt64				getMax() const;
+
+	//! Get a percentile
+	/*!
+	Returns the top of the bucket holding the \c percent percentile,
+	no more than getMax().  Returns 0 if nothing has been recorded.
+	*/
+	UInt64				getPercentile(double percent) const;
+
+	//@}
+
+protected:
+	virtual void		format(CString& snapshot) const;
+
+private:
+	// bucket n holds values n bits long
+	enum { kBuckets = 65 };
+
+	volatile SInt64		m_buckets[kBuckets];
+	volatile SInt64		m_sum;
+	volatile SInt64		m_max;
+};
@@ -21,6 +21,13 @@
 
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UNICODE_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define UNICODE_USE_SSE2 0
+#endif
+
 //
 // local utility functions
 //
@@ -89,6 +96,183 @@ setError(bool* errors)
 	}
 }
 
+inline
+static
+UInt8*
+encode16(UInt8* dst, UInt16 c)
+{
+	memcpy(dst, &c, 2);
+	return dst + 2;
+}
+
+inline
+static
+UInt8*
+encode32(UInt8* dst, UInt32 c)
+{
+	memcpy(dst, &c, 4);
+	return dst + 4;
+}
+
+//
+// ascii runs
+//
+// most clipboard text is mostly ascii, which is the same in every
+// encoding but for its width.  these find the ascii run at the start of
+// the data and copy it, 16 bytes at a time with SSE2 or 8 bytes at a
+// time without it, so the per character decoding only has to deal with
+// everything else.  each returns the length of the run.
+//
+
+#if !UNICODE_USE_SSE2
+
+inline
+static
+bool
+isASCII8(const UInt8* data)
+{
+	UInt32 w[2];
+	memcpy(w, data, 8);
+	return ((w[0] | w[1]) & 0x80808080u) == 0;
+}
+
+#endif
+
+static
+UInt32
+countASCII(const UInt8* data, UInt32 n)
+{
+	UInt32 i = 0;
+#if UNICODE_USE_SSE2
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		if (_mm_movemask_epi8(v) != 0) {
+			break;
+		}
+	}
+#else
+	for (; i + 8 <= n && isASCII8(data + i); i += 8) {
+		// do nothing
+	}
+#endif
+	for (; i < n && data[i] < 0x80; ++i) {
+		// do nothing
+	}
+	return i;
+}
+
+// copy ascii bytes to native endian 16 bit units
+static
+UInt32
+widenASCII16(UInt8* dst, const UInt8* data, UInt32 n)
+{
+	UInt32 i = 0;
+#if UNICODE_USE_SSE2
+	// SSE2 means x86, which is little endian
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		if (_mm_movemask_epi8(v) != 0) {
+			break;
+		}
+		__m128i* out = reinterpret_cast<__m128i*>(dst + 2 * i);
+		_mm_storeu_si128(out,     _mm_unpacklo_epi8(v, zero));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi8(v, zero));
+	}
+#endif
+	for (; i < n && data[i] < 0x80; ++i) {
+		encode16(dst + 2 * i, static_cast<UInt16>(data[i]));
+	}
+	return i;
+}
+
+// copy ascii bytes to native endian 32 bit units
+static
+UInt32
+widenASCII32(UInt8* dst, const UInt8* data, UInt32 n)
+{
+	UInt32 i = 0;
+#if UNICODE_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		if (_mm_movemask_epi8(v) != 0) {
+			break;
+		}
+		__m128i lo  = _mm_unpacklo_epi8(v, zero);
+		__m128i hi  = _mm_unpackhi_epi8(v, zero);
+		__m128i* out = reinterpret_cast<__m128i*>(dst + 4 * i);
+		_mm_storeu_si128(out,     _mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+	}
+#endif
+	for (; i < n && data[i] < 0x80; ++i) {
+		encode32(dst + 4 * i, static_cast<UInt32>(data[i]));
+	}
+	return i;
+}
+
+// copy native endian 16 bit ascii units to bytes
+static
+UInt32
+narrowASCII16(UInt8* dst, const UInt8* data, UInt32 n)
+{
+	UInt32 i = 0;
+#if UNICODE_USE_SSE2
+	const __m128i zero    = _mm_setzero_si128();
+	const __m128i nonASCII = _mm_set1_epi16(static_cast<short>(0xff80));
+	for (; i + 8 <= n; i += 8) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * i));
+		__m128i high = _mm_cmpeq_epi16(_mm_and_si128(v, nonASCII), zero);
+		if (_mm_movemask_epi8(high) != 0xffff) {
+			break;
+		}
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i),
+							_mm_packus_epi16(v, v));
+	}
+#endif
+	for (; i < n; ++i) {
+		UInt16 c = decode16(data + 2 * i, false);
+		if (c >= 0x80) {
+			break;
+		}
+		dst[i] = static_cast<UInt8>(c);
+	}
+	return i;
+}
+
+// copy native endian 32 bit ascii units to bytes
+static
+UInt32
+narrowASCII32(UInt8* dst, const UInt8* data, UInt32 n)
+{
+	UInt32 i = 0;
+#if UNICODE_USE_SSE2
+	const __m128i zero     = _mm_setzero_si128();
+	const __m128i nonASCII = _mm_set1_epi32(static_cast<int>(0xffffff80));
+	for (; i + 4 <= n; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 4 * i));
+		__m128i high = _mm_cmpeq_epi32(_mm_and_si128(v, nonASCII), zero);
+		if (_mm_movemask_epi8(high) != 0xffff) {
+			break;
+		}
+		v = _mm_packs_epi32(v, v);
+		int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+		memcpy(dst + i, &bytes, 4);
+	}
+#endif
+	for (; i < n; ++i) {
+		UInt32 c = decode32(data + 4 * i, false);
+		if (c >= 0x80) {
+			break;
+		}
+		dst[i] = static_cast<UInt8>(c);
+	}
+	return i;
+}
+
 
 //
 // CUnicode
@@ -100,10 +284,15 @@ UInt32					CUnicode::s_replacement = 0x0000fffd;
 bool
 CUnicode::isUTF8(const CString& src)
 {
-	// convert and test each character
+	// convert and test each character, skipping over ascii
 	const UInt8* data = reinterpret_cast<const UInt8*>(src.c_str());
 	for (UInt32 n = (UInt32)src.size(); n > 0; ) {
-		if (fromUTF8(data, n) == s_invalid) {
+		if (*data < 0x80) {
+			UInt32 k = countASCII(data, n);
+			data += k;
+			n    -= k;
+		}
+		else if (fromUTF8(data, n) == s_invalid) {
 			return false;
 		}
 	}
@@ -116,14 +305,25 @@ CUnicode::UTF8ToUCS2(const CString& src, bool* errors)
 	// default to success
 	resetError(errors);
 
-	// get size of input string and reserve some space in output
+	// get size of input string and make enough space in output
 	UInt32 n = (UInt32)src.size();
-	CString dst;
-	dst.reserve(2 * n);
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(2 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
 
 	// convert each character
 	const UInt8* data = reinterpret_cast<const UInt8*>(src.c_str());
 	while (n > 0) {
+		if (*data < 0x80) {
+			UInt32 k = widenASCII16(out, data, n);
+			data += k;
+			n    -= k;
+			out  += 2 * k;
+			continue;
+		}
 		UInt32 c = fromUTF8(data, n);
 		if (c == s_invalid) {
 			c = s_replacement;
@@ -132,10 +332,10 @@ CUnicode::UTF8ToUCS2(const CString& src, bool* errors)
 			setError(errors);
 			c = s_replacement;
 		}
-		UInt16 ucs2 = static_cast<UInt16>(c);
-		dst.append(reinterpret_cast<const char*>(&ucs2), 2);
+		out = encode16(out, static_cast<UInt16>(c));
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
@@ -145,21 +345,33 @@ CUnicode::UTF8ToUCS4(const CString& src, bool* errors)
 	// default to success
 	resetError(errors);
 
-	// get size of input string and reserve some space in output
+	// get size of input string and make enough space in output
 	UInt32 n = (UInt32)src.size();
-	CString dst;
-	dst.reserve(4 * n);
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(4 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
 
 	// convert each character
 	const UInt8* data = reinterpret_cast<const UInt8*>(src.c_str());
 	while (n > 0) {
+		if (*data < 0x80) {
+			UInt32 k = widenASCII32(out, data, n);
+			data += k;
+			n    -= k;
+			out  += 4 * k;
+			continue;
+		}
 		UInt32 c = fromUTF8(data, n);
 		if (c == s_invalid) {
 			c = s_replacement;
 		}
-		dst.append(reinterpret_cast<const char*>(&c), 4);
+		out = encode32(out, c);
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
@@ -169,14 +381,26 @@ CUnicode::UTF8ToUTF16(const CString& src, bool* errors)
 	// default to success
 	resetError(errors);
 
-	// get size of input string and reserve some space in output
+	// get size of input string and make enough space in output.  no
+	// character takes more UTF-16 units than it took UTF-8 bytes.
 	UInt32 n = (UInt32)src.size();
-	CString dst;
-	dst.reserve(2 * n);
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(2 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
 
 	// convert each character
 	const UInt8* data = reinterpret_cast<const UInt8*>(src.c_str());
 	while (n > 0) {
+		if (*data < 0x80) {
+			UInt32 k = widenASCII16(out, data, n);
+			data += k;
+			n    -= k;
+			out  += 2 * k;
+			continue;
+		}
 		UInt32 c = fromUTF8(data, n);
 		if (c == s_invalid) {
 			c = s_replacement;
@@ -186,18 +410,16 @@ CUnicode::UTF8ToUTF16(const CString& src, bool* errors)
 			c = s_replacement;
 		}
 		if (c < 0x00010000) {
-			UInt16 ucs2 = static_cast<UInt16>(c);
-			dst.append(reinterpret_cast<const char*>(&ucs2), 2);
+			out = encode16(out, static_cast<UInt16>(c));
 		}
 		else {
 			c -= 0x00010000;
-			UInt16 utf16h = static_cast<UInt16>((c >> 10) + 0xd800);
-			UInt16 utf16l = static_cast<UInt16>((c & 0x03ff) + 0xdc00);
-			dst.append(reinterpret_cast<const char*>(&utf16h), 2);
-			dst.append(reinterpret_cast<const char*>(&utf16l), 2);
+			out = encode16(out, static_cast<UInt16>((c >> 10) + 0xd800));
+			out = encode16(out, static_cast<UInt16>((c & 0x03ff) + 0xdc00));
 		}
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
@@ -207,14 +429,25 @@ CUnicode::UTF8ToUTF32(const CString& src, bool* errors)
 	// default to success
 	resetError(errors);
 
-	// get size of input string and reserve some space in output
+	// get size of input string and make enough space in output
 	UInt32 n = (UInt32)src.size();
-	CString dst;
-	dst.reserve(4 * n);
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(4 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
 
 	// convert each character
 	const UInt8* data = reinterpret_cast<const UInt8*>(src.c_str());
 	while (n > 0) {
+		if (*data < 0x80) {
+			UInt32 k = widenASCII32(out, data, n);
+			data += k;
+			n    -= k;
+			out  += 4 * k;
+			continue;
+		}
 		UInt32 c = fromUTF8(data, n);
 		if (c == s_invalid) {
 			c = s_replacement;
@@ -223,9 +456,10 @@ CUnicode::UTF8ToUTF32(const CString& src, bool* errors)
 			setError(errors);
 			c = s_replacement;
 		}
-		dst.append(reinterpret_cast<const char*>(&c), 4);
+		out = encode32(out, c);
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
@@ -381,10 +615,6 @@ CUnicode::wideCharToUTF8(const wchar_t* src, UInt32 size, bool* errors)
 CString
 CUnicode::doUCS2ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 {
-	// make some space
-	CString dst;
-	dst.reserve(n);
-
 	// check if first character is 0xfffe or 0xfeff
 	bool byteSwapped = false;
 	if (n >= 1) {
@@ -405,22 +635,38 @@ CUnicode::doUCS2ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 		}
 	}
 
+	// make enough space.  each character takes at most 3 bytes.
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(3 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
+
 	// convert each character
-	for (; n > 0; data += 2, --n) {
+	while (n > 0) {
+		if (!byteSwapped && decode16(data, false) < 0x80) {
+			UInt32 k = narrowASCII16(out, data, n);
+			if (k != 0) {
+				data += 2 * k;
+				n    -= k;
+				out  += k;
+				continue;
+			}
+		}
 		UInt32 c = decode16(data, byteSwapped);
-		toUTF8(dst, c, errors);
+		out = toUTF8(out, c, errors);
+		data += 2;
+		--n;
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
 CString
 CUnicode::doUCS4ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 {
-	// make some space
-	CString dst;
-	dst.reserve(n);
-
 	// check if first character is 0xfffe or 0xfeff
 	bool byteSwapped = false;
 	if (n >= 1) {
@@ -441,22 +687,38 @@ CUnicode::doUCS4ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 		}
 	}
 
+	// make enough space.  each character takes at most 6 bytes.
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(6 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
+
 	// convert each character
-	for (; n > 0; data += 4, --n) {
+	while (n > 0) {
+		if (!byteSwapped && decode32(data, false) < 0x80) {
+			UInt32 k = narrowASCII32(out, data, n);
+			if (k != 0) {
+				data += 4 * k;
+				n    -= k;
+				out  += k;
+				continue;
+			}
+		}
 		UInt32 c = decode32(data, byteSwapped);
-		toUTF8(dst, c, errors);
+		out = toUTF8(out, c, errors);
+		data += 4;
+		--n;
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
 CString
 CUnicode::doUTF16ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 {
-	// make some space
-	CString dst;
-	dst.reserve(n);
-
 	// check if first character is 0xfffe or 0xfeff
 	bool byteSwapped = false;
 	if (n >= 1) {
@@ -477,16 +739,36 @@ CUnicode::doUTF16ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 		}
 	}
 
+	// make enough space.  each word takes at most 3 bytes;  a surrogate
+	// pair takes 4 bytes for two words.
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(3 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
+
 	// convert each character
-	for (; n > 0; data += 2, --n) {
+	while (n > 0) {
+		if (!byteSwapped && decode16(data, false) < 0x80) {
+			UInt32 k = narrowASCII16(out, data, n);
+			if (k != 0) {
+				data += 2 * k;
+				n    -= k;
+				out  += k;
+				continue;
+			}
+		}
 		UInt32 c = decode16(data, byteSwapped);
+		data += 2;
+		--n;
 		if (c < 0x0000d800 || c > 0x0000dfff) {
-			toUTF8(dst, c, errors);
+			out = toUTF8(out, c, errors);
 		}
-		else if (n == 1) {
+		else if (n == 0) {
 			// error -- missing second word
 			setError(errors);
-			toUTF8(dst, s_replacement, NULL);
+			out = toUTF8(out, s_replacement, NULL);
 		}
 		else if (c >= 0x0000d800 && c <= 0x0000dbff) {
 			UInt32 c2 = decode16(data, byteSwapped);
@@ -495,30 +777,27 @@ CUnicode::doUTF16ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 			if (c2 < 0x0000dc00 || c2 > 0x0000dfff) {
 				// error -- [d800,dbff] not followed by [dc00,dfff]
 				setError(errors);
-				toUTF8(dst, s_replacement, NULL);
+				out = toUTF8(out, s_replacement, NULL);
 			}
 			else {
 				c = (((c - 0x0000d800) << 10) | (c2 - 0x0000dc00)) + 0x00010000;
-				toUTF8(dst, c, errors);
+				out = toUTF8(out, c, errors);
 			}
 		}
 		else {
 			// error -- [dc00,dfff] without leading [d800,dbff]
 			setError(errors);
-			toUTF8(dst, s_replacement, NULL);
+			out = toUTF8(out, s_replacement, NULL);
 		}
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
 CString
 CUnicode::doUTF32ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 {
-	// make some space
-	CString dst;
-	dst.reserve(n);
-
 	// check if first character is 0xfffe or 0xfeff
 	bool byteSwapped = false;
 	if (n >= 1) {
@@ -539,16 +818,36 @@ CUnicode::doUTF32ToUTF8(const UInt8* data, UInt32 n, bool* errors)
 		}
 	}
 
+	// make enough space.  each character takes at most 4 bytes.
+	if (n == 0) {
+		return CString();
+	}
+	CString dst(4 * n, '\0');
+	UInt8* begin = reinterpret_cast<UInt8*>(&dst[0]);
+	UInt8* out   = begin;
+
 	// convert each character
-	for (; n > 0; data += 4, --n) {
+	while (n > 0) {
+		if (!byteSwapped && decode32(data, false) < 0x80) {
+			UInt32 k = narrowASCII32(out, data, n);
+			if (k != 0) {
+				data += 4 * k;
+				n    -= k;
+				out  += k;
+				continue;
+			}
+		}
 		UInt32 c = decode32(data, byteSwapped);
 		if (c >= 0x00110000) {
 			setError(errors);
 			c = s_replacement;
 		}
-		toUTF8(dst, c, errors);
+		out = toUTF8(out, c, errors);
+		data += 4;
+		--n;
 	}
 
+	dst.resize(out - begin);
 	return dst;
 }
 
@@ -628,25 +927,25 @@ CUnicode::fromUTF8(const UInt8*& data, UInt32& n)
 	case 4:
 		c = ((static_cast<UInt32>(data[0]) & 0x07) << 18) |
 			((static_cast<UInt32>(data[1]) & 0x3f) << 12) |
-			((static_cast<UInt32>(data[1]) & 0x3f) <<  6) |
-			((static_cast<UInt32>(data[1]) & 0x3f)      );
+			((static_cast<UInt32>(data[2]) & 0x3f) <<  6) |
+			((static_cast<UInt32>(data[3]) & 0x3f)      );
 		break;
 
 	case 5:
 		c = ((static_cast<UInt32>(data[0]) & 0x03) << 24) |
 			((static_cast<UInt32>(data[1]) & 0x3f) << 18) |
-			((static_cast<UInt32>(data[1]) & 0x3f) << 12) |
-			((static_cast<UInt32>(data[1]) & 0x3f) <<  6) |
-			((static_cast<UInt32>(data[1]) & 0x3f)      );
+			((static_cast<UInt32>(data[2]) & 0x3f) << 12) |
+			((static_cast<UInt32>(data[3]) & 0x3f) <<  6) |
+			((static_cast<UInt32>(data[4]) & 0x3f)      );
 		break;
 
 	case 6:
 		c = ((static_cast<UInt32>(data[0]) & 0x01) << 30) |
 			((static_cast<UInt32>(data[1]) & 0x3f) << 24) |
-			((static_cast<UInt32>(data[1]) & 0x3f) << 18) |
-			((static_cast<UInt32>(data[1]) & 0x3f) << 12) |
-			((static_cast<UInt32>(data[1]) & 0x3f) <<  6) |
-			((static_cast<UInt32>(data[1]) & 0x3f)      );
+			((static_cast<UInt32>(data[2]) & 0x3f) << 18) |
+			((static_cast<UInt32>(data[3]) & 0x3f) << 12) |
+			((static_cast<UInt32>(data[4]) & 0x3f) <<  6) |
+			((static_cast<UInt32>(data[5]) & 0x3f)      );
 		break;
 
 	default:
@@ -727,11 +1026,9 @@ CUnicode::fromUTF8(const UInt8*& data, UInt32& n)
 	return c;
 }
 
-void
-CUnicode::toUTF8(CString& dst, UInt32 c, bool* errors)
+UInt8*
+CUnicode::toUTF8(UInt8* data, UInt32 c, bool* errors)
 {
-	UInt8 data[6];
-
 	// handle characters outside the valid range
 	if ((c >= 0x0000d800 && c <= 0x0000dfff) || c >= 0x80000000) {
 		setError(errors);
@@ -741,25 +1038,25 @@ CUnicode::toUTF8(CString& dst, UInt32 c, bool* errors)
 	// convert to UTF-8
 	if (c < 0x00000080) {
 		data[0] = static_cast<UInt8>(c);
-		dst.append(reinterpret_cast<char*>(data), 1);
+		return data + 1;
 	}
 	else if (c < 0x00000800) {
 		data[0] = static_cast<UInt8>(((c >>  6) & 0x0000001f) + 0xc0);
 		data[1] = static_cast<UInt8>((c         & 0x0000003f) + 0x80);
-		dst.append(reinterpret_cast<char*>(data), 2);
+		return data + 2;
 	}
 	else if (c < 0x00010000) {
 		data[0] = static_cast<UInt8>(((c >> 12) & 0x0000000f) + 0xe0);
 		data[1] = static_cast<UInt8>(((c >>  6) & 0x0000003f) + 0x80);
 		data[2] = static_cast<UInt8>((c         & 0x0000003f) + 0x80);
-		dst.append(reinterpret_cast<char*>(data), 3);
+		return data + 3;
 	}
 	else if (c < 0x00200000) {
 		data[0] = static_cast<UInt8>(((c >> 18) & 0x00000007) + 0xf0);
 		data[1] = static_cast<UInt8>(((c >> 12) & 0x0000003f) + 0x80);
 		data[2] = static_cast<UInt8>(((c >>  6) & 0x0000003f) + 0x80);
 		data[3] = static_cast<UInt8>((c         & 0x0000003f) + 0x80);
-		dst.append(reinterpret_cast<char*>(data), 4);
+		return data + 4;
 	}
 	else if (c < 0x04000000) {
 		data[0] = static_cast<UInt8>(((c >> 24) & 0x00000003) + 0xf8);
@@ -767,7 +1064,7 @@ CUnicode::toUTF8(CString& dst, UInt32 c, bool* errors)
 		data[2] = static_cast<UInt8>(((c >> 12) & 0x0000003f) + 0x80);
 		data[3] = static_cast<UInt8>(((c >>  6) & 0x0000003f) + 0x80);
 		data[4] = static_cast<UInt8>((c         & 0x0000003f) + 0x80);
-		dst.append(reinterpret_cast<char*>(data), 5);
+		return data + 5;
 	}
 	else if (c < 0x80000000) {
 		data[0] = static_cast<UInt8>(((c >> 30) & 0x00000001) + 0xfc);
@@ -776,9 +1073,10 @@ CUnicode::toUTF8(CString& dst, UInt32 c, bool* errors)
 		data[3] = static_cast<UInt8>(((c >> 12) & 0x0000003f) + 0x80);
 		data[4] = static_cast<UInt8>(((c >>  6) & 0x0000003f) + 0x80);
 		data[5] = static_cast<UInt8>((c         & 0x0000003f) + 0x80);
-		dst.append(reinterpret_cast<char*>(data), 6);
+		return data + 6;
 	}
 	else {
 		assert(0 && "character out of range");
+		return data;
 	}
 }
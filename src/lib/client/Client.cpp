@@ -21,8 +21,9 @@
 #include "client/ServerProxy.h"
 #include "synergy/Screen.h"
 #include "synergy/Clipboard.h"
-#include "synergy/DropHelper.h"
 #include "synergy/PacketStreamFilter.h"
+#include "synergy/PriorityStreamFilter.h"
+#include "synergy/CaptureStreamFilter.h"
 #include "synergy/ProtocolUtil.h"
 #include "synergy/protocol_types.h"
 #include "synergy/XSynergy.h"
@@ -73,9 +74,13 @@ CClient::CClient(
 	m_events(events),
 	m_cryptoStream(NULL),
 	m_crypto(crypto),
-	m_sendFileThread(NULL),
+	m_fileReceiver("client"),
+	m_fileSender(events, this),
 	m_writeToDropDirThread(NULL),
-	m_enableDragDrop(enableDragDrop)
+	m_enableDragDrop(enableDragDrop),
+	m_closedByServer(false),
+	m_retryHint(0.0),
+	m_motionChannel(false)
 {
 	assert(m_socketFactory != NULL);
 	assert(m_screen        != NULL);
@@ -99,6 +104,9 @@ CClient::CClient(
 								this,
 								new TMethodEventJob<CClient>(this,
 									&CClient::handleFileRecieveCompleted));
+
+		// pick up a transfer interrupted by a restart
+		m_fileReceiver.recover();
 	}
 }
 
@@ -131,6 +139,8 @@ CClient::connect()
 		m_connectOnResume = true;
 		return;
 	}
+	m_closedByServer = false;
+	m_retryHint      = 0.0;
 
 	try {
 		// resolve the server hostname.  do this every time we connect
@@ -165,6 +175,16 @@ CClient::connect()
 			m_stream = m_cryptoStream;
 		}
 
+		// capture the plain messages
+		if (!m_capturePath.empty()) {
+			m_stream = new CCaptureStreamFilter(m_events, m_stream,
+							CProtocolCapture::getNextPath(m_capturePath),
+							CProtocolCapture::kClient, true);
+		}
+
+		// keep file transfers from delaying other messages
+		m_stream = new CPriorityStreamFilter(m_events, m_stream, true);
+
 		// connect
 		LOG((CLOG_DEBUG1 "connecting to server"));
 		setupConnecting();
@@ -214,6 +234,52 @@ CClient::setDecryptIv(const UInt8* iv)
 	}
 }
 
+void
+CClient::setClosedByServer(double retryHint)
+{
+	m_closedByServer = true;
+	m_retryHint      = retryHint;
+}
+
+void
+CClient::setRetryHint(double retryHint)
+{
+	m_retryHint = retryHint;
+}
+
+void
+CClient::setCapturePath(const CString& path)
+{
+	m_capturePath = path;
+}
+
+void
+CClient::setMotionChannel(bool enabled)
+{
+	m_motionChannel = enabled;
+}
+
+IDatagramSocket*
+CClient::openMotionSocket()
+{
+	if (!m_motionChannel) {
+		return NULL;
+	}
+	return m_socketFactory->createDatagram();
+}
+
+bool
+CClient::isClosedByServer() const
+{
+	return m_closedByServer;
+}
+
+double
+CClient::getRetryHint() const
+{
+	return m_retryHint;
+}
+
 bool
 CClient::isConnected() const
 {
@@ -232,6 +298,15 @@ CClient::getServerAddress() const
 	return m_serverAddress;
 }
 
+const UInt8*
+CClient::getCryptoKey() const
+{
+	if (m_cryptoStream == NULL) {
+		return NULL;
+	}
+	return m_cryptoStream->getKey();
+}
+
 void*
 CClient::getEventTarget() const
 {
@@ -429,9 +504,13 @@ CClient::sendConnectionFailedEvent(const char* msg)
 void
 CClient::sendFileChunk(const void* data)
 {
-	CFileChunker::CFileChunk* fileChunk = reinterpret_cast<CFileChunker::CFileChunk*>(const_cast<void*>(data));
+	const CFileChunker::CFileChunk* fileChunk = reinterpret_cast<const CFileChunker::CFileChunk*>(data);
 	LOG((CLOG_DEBUG1 "sendFileChunk"));
-	assert(m_server != NULL);
+	if (m_server == NULL) {
+		// disconnected.  the server asks for the rest when it's back.
+		LOG((CLOG_DEBUG "dropped file chunk while disconnected"));
+		return;
+	}
 
 	// relay
 	m_server->fileChunkSending(fileChunk->m_chunk[0], &(fileChunk->m_chunk[1]), fileChunk->m_dataSize);
@@ -551,6 +630,9 @@ CClient::cleanupScreen()
 							getEventTarget());
 		delete m_server;
 		m_server = NULL;
+
+		// nowhere to send files until the server asks to resume
+		m_fileSender.suspend();
 	}
 }
 
@@ -685,6 +767,13 @@ CClient::handleHello(const CEvent&, void*)
 	setupScreen();
 	cleanupTimer();
 
+	// ask for the rest of a transfer the last connection interrupted
+	CString request;
+	if (m_enableDragDrop && m_fileReceiver.getResumeRequest(request)) {
+		LOG((CLOG_DEBUG "requesting file transfer resume: %s", request.c_str()));
+		m_server->fileChunkSending(kFileResume, &request[0], request.size());
+	}
+
 	// make sure we process any remaining messages later.  we won't
 	// receive another event for already pending messages so we fake
 	// one.
@@ -718,7 +807,7 @@ CClient::handleResume(const CEvent&, void*)
 void
 CClient::handleFileChunkSending(const CEvent& event, void*)
 {
-	sendFileChunk(event.getData());
+	sendFileChunk(event.getDataObject());
 }
 
 void
@@ -730,11 +819,13 @@ CClient::handleFileRecieveCompleted(const CEvent& event, void*)
 void
 CClient::onFileRecieveCompleted()
 {
-	if (isReceivedFileSizeValid()) {
-		m_writeToDropDirThread = new CThread(
-			new TMethodJob<CClient>(
-				this, &CClient::writeToDropDirThread));
+	// drop what arrived intact.  the rest is discarded.
+	if (!isReceivedFileSizeValid()) {
+		LOG((CLOG_WARN "some dropped files were not received intact"));
 	}
+	m_writeToDropDirThread = new CThread(
+		new TMethodJob<CClient>(
+			this, &CClient::writeToDropDirThread));
 }
 
 
@@ -747,27 +838,49 @@ CClient::writeToDropDirThread(void*)
 		ARCH->sleep(.1f);
 	}
 	
-	CDropHelper::writeToDir(m_screen->getDropTarget(), m_dragFileList,
-					m_receivedFileData);
+	m_fileReceiver.moveTo(m_screen->getDropTarget());
+	m_dragFileList.clear();
+}
+
+void
+CClient::fileStartReceived(CString header)
+{
+	// older servers don't name their files
+	CString defaultName;
+	UInt32 index = static_cast<UInt32>(m_fileReceiver.getFiles().size());
+	if (m_fileReceiver.isComplete()) {
+		index = 0;
+	}
+	if (index < m_dragFileList.size()) {
+		defaultName = m_dragFileList.at(index).getFilename();
+	}
+
+	m_fileReceiver.start(header, defaultName);
 }
 
 void
-CClient::clearReceivedFileData()
+CClient::fileChunkReceived(CString data)
+{
+	m_fileReceiver.write(data);
+}
+
+bool
+CClient::fileEndReceived()
 {
-	m_receivedFileData.clear();
+	return m_fileReceiver.end();
 }
 
 void
-CClient::setExpectedFileSize(CString data)
+CClient::fileCheckReceived(CString checksum)
 {
-	std::istringstream iss(data);
-	iss >> m_expectedFileSize;
+	m_fileReceiver.check(checksum);
 }
 
 void
-CClient::fileChunkReceived(CString data)
+CClient::fileResumeRequested(CString request)
 {
-	m_receivedFileData += data;
+	m_fileSender.setStream(m_stream);
+	m_fileSender.resume(request);
 }
 
 void
@@ -786,30 +899,14 @@ CClient::dragInfoReceived(UInt32 fileNum, CString data)
 bool
 CClient::isReceivedFileSizeValid()
 {
-	return m_expectedFileSize == m_receivedFileData.size();
-}
-
-void
-CClient::sendFileToServer(const char* filename)
-{
-	m_sendFileThread = new CThread(
-		new TMethodJob<CClient>(
-			this, &CClient::sendFileThread,
-			reinterpret_cast<void*>(const_cast<char*>(filename))));
+	return m_fileReceiver.isValid();
 }
 
 void
-CClient::sendFileThread(void* filename)
+CClient::sendFileToServer(const char* filenames)
 {
-	try {
-		char* name  = reinterpret_cast<char*>(filename);
-		CFileChunker::sendFileChunks(name, m_events, this);
-	}
-	catch (std::runtime_error error) {
-		LOG((CLOG_ERR "failed sending file chunks: %s", error.what()));
-	}
-
-	m_sendFileThread = NULL;
+	m_fileSender.setStream(m_stream);
+	m_fileSender.send(filenames);
 }
 
 void
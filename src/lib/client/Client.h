@@ -22,6 +22,8 @@
 
 #include "synergy/IClipboard.h"
 #include "synergy/DragInformation.h"
+#include "synergy/FileReceiver.h"
+#include "synergy/FileSender.h"
 #include "synergy/INode.h"
 #include "net/NetworkAddress.h"
 #include "io/CryptoOptions.h"
@@ -31,6 +33,7 @@ class CEventQueueTimer;
 class CScreen;
 class CServerProxy;
 class IDataSocket;
+class IDatagramSocket;
 class ISocketFactory;
 namespace synergy { class IStream; }
 class IStreamFilterFactory;
@@ -67,7 +70,7 @@ public:
 	~CClient();
 	
 #ifdef TEST_ENV
-	CClient() : m_mock(true) { }
+	CClient() : m_mock(true), m_fileSender(NULL, NULL) { }
 #endif
 
 	//! @name manipulators
@@ -95,23 +98,76 @@ public:
 	//! Set crypto IV for decryption
 	virtual void		setDecryptIv(const UInt8* iv);
 
-	//! Clears the file buffer
-	void				clearReceivedFileData();
-
-	//! Set the expected size of receiving file
-	void				setExpectedFileSize(CString data);
+	//! Received the start of a file
+	void				fileStartReceived(CString header);
 
 	//! Received a chunk of file data
 	void				fileChunkReceived(CString data);
 
+	//! Received the end of a file
+	/*!
+	Returns true if that was the last file of the transfer.
+	*/
+	bool				fileEndReceived();
+
+	//! Received a file chunk checksum
+	void				fileCheckReceived(CString checksum);
+
+	//! Received a request to resume sending files
+	void				fileResumeRequested(CString request);
+
 	//! Received drag information
 	void				dragInfoReceived(UInt32 fileNum, CString data);
 
-	//! Create a new thread and use it to send file to Server
-	void				sendFileToServer(const char* filename);
+	//! Create a new thread and use it to send files to Server
+	/*!
+	\c filenames is a newline separated list of files and directories.
+	If the connection is lost the server can resume the transfer after
+	reconnecting.
+	*/
+	void				sendFileToServer(const char* filenames);
 	
 	//! Send dragging file information back to server
 	void				sendDragInfo(UInt32 fileCount, CString& info, size_t size);
+
+	//! Note the server closed the connection
+	/*!
+	Records that the server asked us to hang up, and how many seconds
+	it asked us to wait before reconnecting (0 for no hint).  Call
+	before disconnect().  Cleared on the next connect().
+	*/
+	void				setClosedByServer(double retryHint);
+
+	//! Set retry hint
+	/*!
+	Records how many seconds the server asked us to wait before trying
+	again after it refused us.  Call before disconnect().  Cleared on
+	the next connect().
+	*/
+	void				setRetryHint(double retryHint);
+
+	//! Set capture path
+	/*!
+	Captures the messages of each connection to a new file named after
+	\p path (see CProtocolCapture::getNextPath()), or stops capturing
+	if \p path is empty.  Takes effect on the next connect().
+	*/
+	void				setCapturePath(const CString& path);
+
+	//! Enable the mouse motion channel
+	/*!
+	Accepts the mouse motion channel (see kMsgCMotionChannel) if the
+	server offers it and \p enabled is true.  Takes effect on the next
+	connect().
+	*/
+	void				setMotionChannel(bool enabled);
+
+	//! Open a mouse motion socket
+	/*!
+	Returns a new datagram socket for the mouse motion channel, or NULL
+	if the channel isn't enabled.  The caller adopts the socket.
+	*/
+	IDatagramSocket*	openMotionSocket();
 	
 	//@}
 	//! @name accessors
@@ -136,12 +192,33 @@ public:
 	to connect) to.
 	*/
 	CNetworkAddress		getServerAddress() const;
+
+	//! Get the crypto key
+	/*!
+	Returns the key of the connection's crypto stream, or NULL if the
+	connection isn't encrypted.
+	*/
+	const UInt8*		getCryptoKey() const;
 	
-	//! Return true if recieved file size is valid
+	//! Return true if every received file has the expected size and checksum
 	bool				isReceivedFileSizeValid();
 
 	//! Return expected file size
-	size_t				getExpectedFileSize() { return m_expectedFileSize; }
+	UInt64				getExpectedFileSize() { return m_fileReceiver.getExpectedSize(); }
+
+	//! Test if the server closed the connection
+	/*!
+	Returns true iff the last disconnection was requested by the server
+	rather than caused by an error or lost connection.
+	*/
+	bool				isClosedByServer() const;
+
+	//! Get retry hint
+	/*!
+	Returns the number of seconds the server asked us to wait before
+	reconnecting, or 0 if it didn't say.
+	*/
+	double				getRetryHint() const;
 
 	//@}
 
@@ -179,7 +256,6 @@ private:
 	void				sendEvent(CEvent::Type, void*);
 	void				sendConnectionFailedEvent(const char* msg);
 	void				sendFileChunk(const void* data);
-	void				sendFileThread(void*);
 	void				writeToDropDirThread(void*);
 	void				setupConnecting();
 	void				setupConnection();
@@ -226,11 +302,14 @@ private:
 	IEventQueue*			m_events;
 	CCryptoStream*			m_cryptoStream;
 	CCryptoOptions			m_crypto;
-	std::size_t				m_expectedFileSize;
-	CString					m_receivedFileData;
+	CFileReceiver			m_fileReceiver;
 	CDragFileList			m_dragFileList;
 	CString					m_dragFileExt;
-	CThread*				m_sendFileThread;
+	CFileSender				m_fileSender;
 	CThread*				m_writeToDropDirThread;
 	bool					m_enableDragDrop;
+	bool					m_closedByServer;
+	double					m_retryHint;
+	CString					m_capturePath;
+	bool					m_motionChannel;
 };
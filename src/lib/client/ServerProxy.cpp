@@ -21,11 +21,16 @@
 #include "client/Client.h"
 #include "synergy/Clipboard.h"
 #include "synergy/ProtocolUtil.h"
+#include "synergy/LivenessMonitor.h"
+#include "synergy/MotionChannel.h"
 #include "synergy/option_types.h"
 #include "synergy/protocol_types.h"
+#include "net/IDatagramSocket.h"
+#include "net/NetworkAddress.h"
 #include "io/IStream.h"
 #include "io/CryptoStream.h"
 #include "base/Log.h"
+#include "base/Metrics.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
 #include "base/XBase.h"
@@ -38,6 +43,12 @@
 
 const UInt16 CServerProxy::m_intervalThreshold = 1;
 
+// seconds between reports on the mouse motion channel
+static const double		s_motionReportRate = 0.25;
+
+// messages from the server, by code
+static CCodeCounter		s_received("client.received");
+
 CServerProxy::CServerProxy(CClient* client, synergy::IStream* stream, IEventQueue* events) :
 	m_client(client),
 	m_stream(stream),
@@ -49,8 +60,19 @@ CServerProxy::CServerProxy(CClient* client, synergy::IStream* stream, IEventQueu
 	m_dxMouse(0),
 	m_dyMouse(0),
 	m_ignoreMouse(false),
+	m_motionSocket(NULL),
+	m_motion(NULL),
+	m_motionTimer(NULL),
+	m_motionSeq(0),
+	m_datagramSeq(0),
+	m_reportSeq(0),
+	m_xRelative(0),
+	m_yRelative(0),
+	m_xCompact(0),
+	m_yCompact(0),
 	m_keepAliveAlarm(0.0),
-	m_keepAliveAlarmTimer(NULL),
+	m_lastActivity(0.0),
+	m_liveness(CLivenessMonitor::acquire(events)),
 	m_parser(&CServerProxy::parseHandshakeMessage),
 	m_events(events),
 	m_stopwatch(true),
@@ -70,59 +92,82 @@ CServerProxy::CServerProxy(CClient* client, synergy::IStream* stream, IEventQueu
 							new TMethodEventJob<CServerProxy>(this,
 								&CServerProxy::handleData));
 
+	// notice if the server goes silent
+	m_events->adoptHandler(m_events->forCLivenessMonitor().dead(), this,
+							new TMethodEventJob<CServerProxy>(this,
+								&CServerProxy::handleKeepAliveAlarm));
+
 	// send heartbeat
 	setKeepAliveRate(kKeepAliveRate);
 }
 
 CServerProxy::~CServerProxy()
 {
+	closeMotionChannel();
 	setKeepAliveRate(-1.0);
+	m_events->removeHandler(m_events->forCLivenessMonitor().dead(), this);
 	m_events->removeHandler(m_events->forIStream().inputReady(),
 							m_stream->getEventTarget());
+	CLivenessMonitor::release(m_liveness);
 }
 
 void
 CServerProxy::resetKeepAliveAlarm()
 {
-	if (m_keepAliveAlarmTimer != NULL) {
-		m_events->removeHandler(CEvent::kTimer, m_keepAliveAlarmTimer);
-		m_events->deleteTimer(m_keepAliveAlarmTimer);
-		m_keepAliveAlarmTimer = NULL;
-	}
-	if (m_keepAliveAlarm > 0.0) {
-		m_keepAliveAlarmTimer =
-			m_events->newOneShotTimer(m_keepAliveAlarm, NULL);
-		m_events->adoptHandler(CEvent::kTimer, m_keepAliveAlarmTimer,
-							new TMethodEventJob<CServerProxy>(this,
-								&CServerProxy::handleKeepAliveAlarm));
-	}
+	CLivenessMonitor::touch(m_lastActivity);
 }
 
 void
 CServerProxy::setKeepAliveRate(double rate)
 {
 	m_keepAliveAlarm = rate * kKeepAlivesUntilDeath;
-	resetKeepAliveAlarm();
+	if (m_keepAliveAlarm > 0.0) {
+		m_liveness->watch(this, &m_lastActivity, m_keepAliveAlarm);
+	}
+	else {
+		m_liveness->unwatch(this);
+	}
+}
+
+double
+CServerProxy::readRetryHint()
+{
+	// the server is at least our protocol version so it always sends
+	// the hint after the code
+	UInt32 hint;
+	if (!CProtocolUtil::readf(m_stream, "%4i", &hint)) {
+		return 0.0;
+	}
+	LOG((CLOG_DEBUG1 "server retry hint %dms", hint));
+	return hint / 1000.0;
 }
 
 void
 CServerProxy::handleData(const CEvent&, void*)
 {
-	// handle messages until there are no more.  first read message code.
+	// handle messages until there are no more.  first read message code,
+	// which is 1 byte for compact messages and 4 bytes otherwise.
 	UInt8 code[4];
-	UInt32 n = m_stream->read(code, 4);
+	UInt32 n = m_stream->read(code, 1);
 	while (n != 0) {
-		// verify we got an entire code
-		if (n != 4) {
-			LOG((CLOG_ERR "incomplete message from server: %d bytes", n));
-			m_client->disconnect("incomplete message from server");
-			return;
+		if (code[0] < kMsgCompactLimit) {
+			code[1] = code[2] = code[3] = 0;
+			LOG((CLOG_DEBUG2 "msg from server: compact %d", code[0]));
 		}
-
-		// parse message
-		LOG((CLOG_DEBUG2 "msg from server: %c%c%c%c", code[0], code[1], code[2], code[3]));
+		else {
+			// verify we got an entire code
+			n += m_stream->read(code + 1, 3);
+			if (n != 4) {
+				LOG((CLOG_ERR "incomplete message from server: %d bytes", n));
+				m_client->disconnect("incomplete message from server");
+				return;
+			}
+			LOG((CLOG_DEBUG2 "msg from server: %c%c%c%c", code[0], code[1], code[2], code[3]));
+		}
+		// parse message.  only count codes the parser knows.
 		switch ((this->*m_parser)(code)) {
 		case kOkay:
+			s_received.add(code);
 			break;
 
 		case kUnknown:
@@ -131,13 +176,17 @@ CServerProxy::handleData(const CEvent&, void*)
 			return;
 
 		case kDisconnect:
+			s_received.add(code);
 			return;
 		}
 
 		// next message
-		n = m_stream->read(code, 4);
+		n = m_stream->read(code, 1);
 	}
 
+	// any message shows the server is alive
+	resetKeepAliveAlarm();
+
 	flushCompressedMouse();
 }
 
@@ -174,9 +223,14 @@ CServerProxy::parseHandshakeMessage(const UInt8* code)
 		// accept and discard no-op
 	}
 
+	else if (memcmp(code, kMsgCMotionChannel, 4) == 0) {
+		motionChannel();
+	}
+
 	else if (memcmp(code, kMsgCClose, 4) == 0) {
 		// server wants us to hangup
 		LOG((CLOG_DEBUG1 "recv close"));
+		m_client->setClosedByServer(readRetryHint());
 		m_client->disconnect(NULL);
 		return kDisconnect;
 	}
@@ -192,6 +246,7 @@ CServerProxy::parseHandshakeMessage(const UInt8* code)
 
 	else if (memcmp(code, kMsgEBusy, 4) == 0) {
 		LOG((CLOG_ERR "server already has a connected client with name \"%s\"", m_client->getName().c_str()));
+		m_client->setRetryHint(readRetryHint());
 		m_client->disconnect("server already has a connected client with our name");
 		return kDisconnect;
 	}
@@ -217,7 +272,11 @@ CServerProxy::parseHandshakeMessage(const UInt8* code)
 CServerProxy::EResult
 CServerProxy::parseMessage(const UInt8* code)
 {
-	if (memcmp(code, kMsgDMouseMove, 4) == 0) {
+	if (code[0] < kMsgCompactLimit) {
+		return parseCompactMessage(code[0]);
+	}
+
+	else if (memcmp(code, kMsgDMouseMove, 4) == 0) {
 		mouseMove();
 	}
 
@@ -225,6 +284,10 @@ CServerProxy::parseMessage(const UInt8* code)
 		mouseRelativeMove();
 	}
 
+	else if (memcmp(code, kMsgDMouseMoveSeq, 4) == 0) {
+		mouseMoveSeq();
+	}
+
 	else if (memcmp(code, kMsgDMouseWheel, 4) == 0) {
 		mouseWheel();
 	}
@@ -299,6 +362,10 @@ CServerProxy::parseMessage(const UInt8* code)
 		cryptoIv();
 	}
 
+	else if (memcmp(code, kMsgCMotionChannel, 4) == 0) {
+		motionChannel();
+	}
+
 	else if (memcmp(code, kMsgDFileTransfer, 4) == 0) {
 		fileChunkReceived();
 	}
@@ -309,6 +376,7 @@ CServerProxy::parseMessage(const UInt8* code)
 	else if (memcmp(code, kMsgCClose, 4) == 0) {
 		// server wants us to hangup
 		LOG((CLOG_DEBUG1 "recv close"));
+		m_client->setClosedByServer(readRetryHint());
 		m_client->disconnect(NULL);
 		return kDisconnect;
 	}
@@ -333,6 +401,82 @@ CServerProxy::parseMessage(const UInt8* code)
 	return kOkay;
 }
 
+CServerProxy::EResult
+CServerProxy::parseCompactMessage(UInt8 code)
+{
+	if (code == kMsgDCompactMouseMove[0]) {
+		compactMouseMove();
+	}
+
+	else if (code == kMsgDCompactMouseRelMove[0]) {
+		compactMouseRelativeMove();
+	}
+
+	else if (code == kMsgDCompactMouseDown[0]) {
+		compactMouseDown();
+	}
+
+	else if (code == kMsgDCompactMouseUp[0]) {
+		compactMouseUp();
+	}
+
+	else if (code == kMsgDCompactMoveMouseDown[0]) {
+		compactMoveMouseDown();
+	}
+
+	else if (code == kMsgDCompactMoveMouseUp[0]) {
+		compactMoveMouseUp();
+	}
+
+	else if (code == kMsgDCompactMouseWheel[0]) {
+		compactMouseWheel();
+	}
+
+	else if (code == kMsgDCompactKeyDown[0]) {
+		compactKeyDown();
+	}
+
+	else if (code == kMsgDCompactKeyRepeat[0]) {
+		compactKeyRepeat();
+	}
+
+	else if (code == kMsgDCompactKeyUp[0]) {
+		compactKeyUp();
+	}
+
+	else {
+		return kUnknown;
+	}
+
+	return kOkay;
+}
+
+void
+CServerProxy::handleMotionData(const CEvent&, void*)
+{
+	CString data;
+	CNetworkAddress from;
+	while (m_motionSocket->receive(data, from)) {
+		CMotionChannel::CPacket packet;
+		if (!m_motion->decode(CMotionChannel::kToClient, data, packet) ||
+			packet.m_type == CMotionChannel::kReport) {
+			LOG((CLOG_DEBUG1 "ignored bad datagram from %s", from.getHostname().c_str()));
+			continue;
+		}
+		if (packet.m_seq > m_datagramSeq) {
+			m_datagramSeq = packet.m_seq;
+		}
+		applyMotion(packet.m_seq, static_cast<UInt8>(packet.m_type),
+							packet.m_a, packet.m_b, false);
+	}
+}
+
+void
+CServerProxy::handleMotionReport(const CEvent&, void*)
+{
+	sendMotionReport();
+}
+
 void
 CServerProxy::handleKeepAliveAlarm(const CEvent&, void*)
 {
@@ -362,9 +506,69 @@ CServerProxy::onGrabClipboard(ClipboardID id)
 void
 CServerProxy::onClipboardChanged(ClipboardID id, const IClipboard* clipboard)
 {
-	CString data = IClipboard::marshall(clipboard);
-	LOG((CLOG_DEBUG1 "sending clipboard %d seqnum=%d, size=%d", id, m_seqNum, data.size()));
-	CProtocolUtil::writef(m_stream, kMsgDClipboard, id, m_seqNum, &data);
+	CSharedBufferList data;
+	UInt32 size = IClipboard::marshall(clipboard, data);
+	LOG((CLOG_DEBUG1 "sending clipboard %d seqnum=%d, size=%d", id, m_seqNum, size));
+	CProtocolUtil::writefBuffers(m_stream, data, kMsgDClipboard, id, m_seqNum);
+}
+
+void
+CServerProxy::openMotionChannel(UInt32 token)
+{
+	closeMotionChannel();
+
+	m_motionSocket = m_client->openMotionSocket();
+	if (m_motionSocket == NULL) {
+		LOG((CLOG_DEBUG "motion channel not enabled, using the connection"));
+		return;
+	}
+
+	// encrypt datagrams with the stream's key, if it has one
+	m_motion = new CMotionChannel(token, m_client->getCryptoKey());
+	m_events->adoptHandler(m_events->forIStream().inputReady(),
+							m_motionSocket->getEventTarget(),
+							new TMethodEventJob<CServerProxy>(this,
+								&CServerProxy::handleMotionData));
+
+	// the server only uses the channel while we report on it.  reports
+	// also open the way through any NAT between us.
+	m_motionTimer = m_events->newTimer(s_motionReportRate, NULL);
+	m_events->adoptHandler(CEvent::kTimer, m_motionTimer,
+							new TMethodEventJob<CServerProxy>(this,
+								&CServerProxy::handleMotionReport));
+	sendMotionReport();
+	LOG((CLOG_INFO "using motion channel"));
+}
+
+void
+CServerProxy::closeMotionChannel()
+{
+	if (m_motionTimer != NULL) {
+		m_events->removeHandler(CEvent::kTimer, m_motionTimer);
+		m_events->deleteTimer(m_motionTimer);
+		m_motionTimer = NULL;
+	}
+	if (m_motionSocket != NULL) {
+		m_events->removeHandler(m_events->forIStream().inputReady(),
+							m_motionSocket->getEventTarget());
+		delete m_motionSocket;
+		m_motionSocket = NULL;
+	}
+	delete m_motion;
+	m_motion = NULL;
+}
+
+void
+CServerProxy::sendMotionReport()
+{
+	// report the last motion we have, and the last that came on the
+	// channel, so the server can tell if the channel is losing it
+	CMotionChannel::CPacket packet(++m_reportSeq, CMotionChannel::kReport,
+							static_cast<SInt32>(m_motionSeq),
+							static_cast<SInt32>(m_datagramSeq));
+	CString data = m_motion->encode(CMotionChannel::kToServer, packet);
+	m_motionSocket->sendTo(data.data(), (UInt32)data.size(),
+							m_client->getServerAddress());
 }
 
 void
@@ -528,6 +732,8 @@ CServerProxy::enter()
 	m_dxMouse               = 0;
 	m_dyMouse               = 0;
 	m_seqNum                = seqNum;
+	m_xCompact              = x;
+	m_yCompact              = y;
 
 	// forward
 	m_client->enter(x, y, seqNum, static_cast<KeyModifierMask>(mask), false);
@@ -563,7 +769,7 @@ CServerProxy::setClipboard()
 
 	// forward
 	CClipboard clipboard;
-	clipboard.unmarshall(data, 0);
+	clipboard.unmarshall(CSharedBuffer::adopt(data), 0);
 	m_client->setClipboard(id, &clipboard);
 }
 
@@ -588,20 +794,24 @@ CServerProxy::grabClipboard()
 void
 CServerProxy::keyDown()
 {
-	// get mouse up to date
-	flushCompressedMouse();
-
 	// parse
 	UInt16 id, mask, button;
 	CProtocolUtil::readf(m_stream, kMsgDKeyDown + 4, &id, &mask, &button);
+
+	applyKeyDown(id, mask, button);
+}
+
+void
+CServerProxy::applyKeyDown(KeyID id, KeyModifierMask mask, KeyButton button)
+{
+	// get mouse up to date
+	flushCompressedMouse();
 	LOG((CLOG_DEBUG1 "recv key down id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button));
 
 	// translate
-	KeyID id2             = translateKey(static_cast<KeyID>(id));
-	KeyModifierMask mask2 = translateModifierMask(
-								static_cast<KeyModifierMask>(mask));
-	if (id2   != static_cast<KeyID>(id) ||
-		mask2 != static_cast<KeyModifierMask>(mask))
+	KeyID id2             = translateKey(id);
+	KeyModifierMask mask2 = translateModifierMask(mask);
+	if (id2 != id || mask2 != mask)
 		LOG((CLOG_DEBUG1 "key down translated to id=0x%08x, mask=0x%04x", id2, mask2));
 
 	// forward
@@ -611,21 +821,26 @@ CServerProxy::keyDown()
 void
 CServerProxy::keyRepeat()
 {
-	// get mouse up to date
-	flushCompressedMouse();
-
 	// parse
 	UInt16 id, mask, count, button;
 	CProtocolUtil::readf(m_stream, kMsgDKeyRepeat + 4,
 								&id, &mask, &count, &button);
+
+	applyKeyRepeat(id, mask, count, button);
+}
+
+void
+CServerProxy::applyKeyRepeat(KeyID id, KeyModifierMask mask,
+				SInt32 count, KeyButton button)
+{
+	// get mouse up to date
+	flushCompressedMouse();
 	LOG((CLOG_DEBUG1 "recv key repeat id=0x%08x, mask=0x%04x, count=%d, button=0x%04x", id, mask, count, button));
 
 	// translate
-	KeyID id2             = translateKey(static_cast<KeyID>(id));
-	KeyModifierMask mask2 = translateModifierMask(
-								static_cast<KeyModifierMask>(mask));
-	if (id2   != static_cast<KeyID>(id) ||
-		mask2 != static_cast<KeyModifierMask>(mask))
+	KeyID id2             = translateKey(id);
+	KeyModifierMask mask2 = translateModifierMask(mask);
+	if (id2 != id || mask2 != mask)
 		LOG((CLOG_DEBUG1 "key repeat translated to id=0x%08x, mask=0x%04x", id2, mask2));
 
 	// forward
@@ -635,20 +850,24 @@ CServerProxy::keyRepeat()
 void
 CServerProxy::keyUp()
 {
-	// get mouse up to date
-	flushCompressedMouse();
-
 	// parse
 	UInt16 id, mask, button;
 	CProtocolUtil::readf(m_stream, kMsgDKeyUp + 4, &id, &mask, &button);
+
+	applyKeyUp(id, mask, button);
+}
+
+void
+CServerProxy::applyKeyUp(KeyID id, KeyModifierMask mask, KeyButton button)
+{
+	// get mouse up to date
+	flushCompressedMouse();
 	LOG((CLOG_DEBUG1 "recv key up id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button));
 
 	// translate
-	KeyID id2             = translateKey(static_cast<KeyID>(id));
-	KeyModifierMask mask2 = translateModifierMask(
-								static_cast<KeyModifierMask>(mask));
-	if (id2   != static_cast<KeyID>(id) ||
-		mask2 != static_cast<KeyModifierMask>(mask))
+	KeyID id2             = translateKey(id);
+	KeyModifierMask mask2 = translateModifierMask(mask);
+	if (id2 != id || mask2 != mask)
 		LOG((CLOG_DEBUG1 "key up translated to id=0x%08x, mask=0x%04x", id2, mask2));
 
 	// forward
@@ -658,46 +877,64 @@ CServerProxy::keyUp()
 void
 CServerProxy::mouseDown()
 {
-	// get mouse up to date
-	flushCompressedMouse();
-
 	// parse
 	SInt8 id;
 	CProtocolUtil::readf(m_stream, kMsgDMouseDown + 4, &id);
-	LOG((CLOG_DEBUG1 "recv mouse down id=%d", id));
 
-	// forward
-	m_client->mouseDown(static_cast<ButtonID>(id));
+	applyMouseDown(static_cast<ButtonID>(id));
 }
 
 void
-CServerProxy::mouseUp()
+CServerProxy::applyMouseDown(ButtonID id)
 {
 	// get mouse up to date
 	flushCompressedMouse();
+	LOG((CLOG_DEBUG1 "recv mouse down id=%d", id));
 
+	// forward
+	m_client->mouseDown(id);
+}
+
+void
+CServerProxy::mouseUp()
+{
 	// parse
 	SInt8 id;
 	CProtocolUtil::readf(m_stream, kMsgDMouseUp + 4, &id);
+
+	applyMouseUp(static_cast<ButtonID>(id));
+}
+
+void
+CServerProxy::applyMouseUp(ButtonID id)
+{
+	// get mouse up to date
+	flushCompressedMouse();
 	LOG((CLOG_DEBUG1 "recv mouse up id=%d", id));
 
 	// forward
-	m_client->mouseUp(static_cast<ButtonID>(id));
+	m_client->mouseUp(id);
 }
 
 void
 CServerProxy::mouseMove()
 {
 	// parse
-	bool ignore;
 	SInt16 x, y;
 	CProtocolUtil::readf(m_stream, kMsgDMouseMove + 4, &x, &y);
+	LOG((CLOG_DEBUG2 "recv mouse move %d,%d", x, y));
 
+	applyMouseMove(x, y, m_stream->isReady());
+}
+
+void
+CServerProxy::applyMouseMove(SInt32 x, SInt32 y, bool more)
+{
 	// note if we should ignore the move
-	ignore = m_ignoreMouse;
+	bool ignore = m_ignoreMouse;
 
 	// compress mouse motion events if more input follows
-	if (!ignore && !m_compressMouse && m_stream->isReady()) {
+	if (!ignore && !m_compressMouse && more) {
 		m_compressMouse = true;
 	}
 
@@ -710,7 +947,6 @@ CServerProxy::mouseMove()
 		m_dxMouse = 0;
 		m_dyMouse = 0;
 	}
-	LOG((CLOG_DEBUG2 "recv mouse move %d,%d", x, y));
 
 	// forward
 	if (!ignore) {
@@ -722,15 +958,21 @@ void
 CServerProxy::mouseRelativeMove()
 {
 	// parse
-	bool ignore;
 	SInt16 dx, dy;
 	CProtocolUtil::readf(m_stream, kMsgDMouseRelMove + 4, &dx, &dy);
+	LOG((CLOG_DEBUG2 "recv mouse relative move %d,%d", dx, dy));
+
+	applyMouseRelativeMove(dx, dy, m_stream->isReady());
+}
 
+void
+CServerProxy::applyMouseRelativeMove(SInt32 dx, SInt32 dy, bool more)
+{
 	// note if we should ignore the move
-	ignore = m_ignoreMouse;
+	bool ignore = m_ignoreMouse;
 
 	// compress mouse motion events if more input follows
-	if (!ignore && !m_compressMouseRelative && m_stream->isReady()) {
+	if (!ignore && !m_compressMouseRelative && more) {
 		m_compressMouseRelative = true;
 	}
 
@@ -740,7 +982,6 @@ CServerProxy::mouseRelativeMove()
 		m_dxMouse += dx;
 		m_dyMouse += dy;
 	}
-	LOG((CLOG_DEBUG2 "recv mouse relative move %d,%d", dx, dy));
 
 	// forward
 	if (!ignore) {
@@ -749,20 +990,199 @@ CServerProxy::mouseRelativeMove()
 }
 
 void
-CServerProxy::mouseWheel()
+CServerProxy::mouseMoveSeq()
 {
-	// get mouse up to date
-	flushCompressedMouse();
+	// parse
+	UInt32 seq;
+	UInt8 type;
+	SInt32 a, b;
+	CProtocolUtil::readf(m_stream, kMsgDMouseMoveSeq + 4, &seq, &type, &a, &b);
+	LOG((CLOG_DEBUG2 "recv mouse move %d %c %d,%d", seq, type, a, b));
 
+	applyMotion(seq, type, a, b, m_stream->isReady());
+}
+
+void
+CServerProxy::applyMotion(UInt32 seq, UInt8 type, SInt32 a, SInt32 b, bool more)
+{
+	// motion arrives on the stream and the motion channel, and datagrams
+	// may be reordered, so skip anything older than what we've applied
+	if (seq <= m_motionSeq) {
+		LOG((CLOG_DEBUG2 "skipped stale motion %d", seq));
+		return;
+	}
+	m_motionSeq = seq;
+
+	switch (type) {
+	case CMotionChannel::kMove:
+		applyMouseMove(a, b, more);
+		break;
+
+	case CMotionChannel::kRelative: {
+		// the server sends totals;  apply what's new since the last
+		UInt32 dx   = static_cast<UInt32>(a) - m_xRelative;
+		UInt32 dy   = static_cast<UInt32>(b) - m_yRelative;
+		m_xRelative = static_cast<UInt32>(a);
+		m_yRelative = static_cast<UInt32>(b);
+		applyMouseRelativeMove(static_cast<SInt32>(dx),
+							static_cast<SInt32>(dy), more);
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+void
+CServerProxy::mouseWheel()
+{
 	// parse
 	SInt16 xDelta, yDelta;
 	CProtocolUtil::readf(m_stream, kMsgDMouseWheel + 4, &xDelta, &yDelta);
+
+	applyMouseWheel(xDelta, yDelta);
+}
+
+void
+CServerProxy::applyMouseWheel(SInt32 xDelta, SInt32 yDelta)
+{
+	// get mouse up to date
+	flushCompressedMouse();
 	LOG((CLOG_DEBUG2 "recv mouse wheel %+d,%+d", xDelta, yDelta));
 
 	// forward
 	m_client->mouseWheel(xDelta, yDelta);
 }
 
+void
+CServerProxy::compactMouseMove()
+{
+	// parse
+	SInt32 dx, dy;
+	CProtocolUtil::readf(m_stream, kMsgDCompactMouseMove + 1, &dx, &dy);
+	m_xCompact += dx;
+	m_yCompact += dy;
+	LOG((CLOG_DEBUG2 "recv mouse move %d,%d", m_xCompact, m_yCompact));
+
+	applyMouseMove(m_xCompact, m_yCompact, m_stream->isReady());
+}
+
+void
+CServerProxy::compactMouseRelativeMove()
+{
+	// parse
+	SInt32 dx, dy;
+	CProtocolUtil::readf(m_stream, kMsgDCompactMouseRelMove + 1, &dx, &dy);
+	LOG((CLOG_DEBUG2 "recv mouse relative move %d,%d", dx, dy));
+
+	applyMouseRelativeMove(dx, dy, m_stream->isReady());
+}
+
+void
+CServerProxy::compactMouseDown()
+{
+	// parse
+	UInt8 id;
+	CProtocolUtil::readf(m_stream, kMsgDCompactMouseDown + 1, &id);
+
+	applyMouseDown(static_cast<ButtonID>(id));
+}
+
+void
+CServerProxy::compactMouseUp()
+{
+	// parse
+	UInt8 id;
+	CProtocolUtil::readf(m_stream, kMsgDCompactMouseUp + 1, &id);
+
+	applyMouseUp(static_cast<ButtonID>(id));
+}
+
+void
+CServerProxy::compactMoveMouseDown()
+{
+	// parse
+	SInt32 dx, dy;
+	UInt8 id;
+	CProtocolUtil::readf(m_stream, kMsgDCompactMoveMouseDown + 1,
+								&dx, &dy, &id);
+	m_xCompact += dx;
+	m_yCompact += dy;
+	LOG((CLOG_DEBUG2 "recv mouse move %d,%d", m_xCompact, m_yCompact));
+
+	// the button is pressed where the move ends
+	applyMouseMove(m_xCompact, m_yCompact, false);
+	applyMouseDown(static_cast<ButtonID>(id));
+}
+
+void
+CServerProxy::compactMoveMouseUp()
+{
+	// parse
+	SInt32 dx, dy;
+	UInt8 id;
+	CProtocolUtil::readf(m_stream, kMsgDCompactMoveMouseUp + 1,
+								&dx, &dy, &id);
+	m_xCompact += dx;
+	m_yCompact += dy;
+	LOG((CLOG_DEBUG2 "recv mouse move %d,%d", m_xCompact, m_yCompact));
+
+	applyMouseMove(m_xCompact, m_yCompact, false);
+	applyMouseUp(static_cast<ButtonID>(id));
+}
+
+void
+CServerProxy::compactMouseWheel()
+{
+	// parse
+	SInt32 xDelta, yDelta;
+	CProtocolUtil::readf(m_stream, kMsgDCompactMouseWheel + 1,
+								&xDelta, &yDelta);
+
+	applyMouseWheel(xDelta, yDelta);
+}
+
+void
+CServerProxy::compactKeyDown()
+{
+	// parse
+	UInt32 id, mask, button;
+	CProtocolUtil::readf(m_stream, kMsgDCompactKeyDown + 1,
+								&id, &mask, &button);
+
+	applyKeyDown(static_cast<KeyID>(id),
+							static_cast<KeyModifierMask>(mask),
+							static_cast<KeyButton>(button));
+}
+
+void
+CServerProxy::compactKeyRepeat()
+{
+	// parse
+	UInt32 id, mask, count, button;
+	CProtocolUtil::readf(m_stream, kMsgDCompactKeyRepeat + 1,
+								&id, &mask, &count, &button);
+
+	applyKeyRepeat(static_cast<KeyID>(id),
+							static_cast<KeyModifierMask>(mask),
+							static_cast<SInt32>(count),
+							static_cast<KeyButton>(button));
+}
+
+void
+CServerProxy::compactKeyUp()
+{
+	// parse
+	UInt32 id, mask, button;
+	CProtocolUtil::readf(m_stream, kMsgDCompactKeyUp + 1,
+								&id, &mask, &button);
+
+	applyKeyUp(static_cast<KeyID>(id),
+							static_cast<KeyModifierMask>(mask),
+							static_cast<KeyButton>(button));
+}
+
 void
 CServerProxy::cryptoIv()
 {
@@ -775,6 +1195,17 @@ CServerProxy::cryptoIv()
 	m_client->setDecryptIv(reinterpret_cast<const UInt8*>(s.c_str()));
 }
 
+void
+CServerProxy::motionChannel()
+{
+	// parse
+	UInt32 token;
+	CProtocolUtil::readf(m_stream, kMsgCMotionChannel + 4, &token);
+	LOG((CLOG_DEBUG1 "recv motion channel"));
+
+	openMotionChannel(token);
+}
+
 void
 CServerProxy::screensaver()
 {
@@ -875,10 +1306,9 @@ CServerProxy::fileChunkReceived()
 
 	switch (mark) {
 	case kFileStart:
-		m_client->clearReceivedFileData();
-		m_client->setExpectedFileSize(content);
+		m_client->fileStartReceived(content);
 		if (CLOG->getFilter() >= kDEBUG2) {
-			LOG((CLOG_DEBUG2 "recv file data from server: size=%s", content.c_str()));
+			LOG((CLOG_DEBUG2 "recv file data from server: header=%s", content.c_str()));
 			m_stopwatch.start();
 		}
 		break;
@@ -901,14 +1331,25 @@ CServerProxy::fileChunkReceived()
 		}
 		break;
 
+	case kFileCheck:
+		m_client->fileCheckReceived(content);
+		break;
+
+	case kFileResume:
+		LOG((CLOG_DEBUG "recv file resume request: %s", content.c_str()));
+		m_client->fileResumeRequested(content);
+		break;
+
 	case kFileEnd:
-		m_events->addEvent(CEvent(m_events->forIScreen().fileRecieveCompleted(), m_client));
+		if (m_client->fileEndReceived()) {
+			m_events->addEvent(CEvent(m_events->forIScreen().fileRecieveCompleted(), m_client));
+		}
 		if (CLOG->getFilter() >= kDEBUG2) {
 			LOG((CLOG_DEBUG2 "file data transfer finished"));
 			m_elapsedTime += m_stopwatch.getTime();
-			double averageSpeed = m_client->getExpectedFileSize() / m_elapsedTime / 1000;
+			double averageSpeed = (double)m_client->getExpectedFileSize() / m_elapsedTime / 1000;
 			LOG((CLOG_DEBUG2 "file data transfer finished: total time consumed=%f s", m_elapsedTime));
-			LOG((CLOG_DEBUG2 "file data transfer finished: total data received=%i kb", m_client->getExpectedFileSize() / 1000));
+			LOG((CLOG_DEBUG2 "file data transfer finished: total data received=%.0f kb", (double)m_client->getExpectedFileSize() / 1000));
 			LOG((CLOG_DEBUG2 "file data transfer finished: total average speed=%f kb/s", averageSpeed));
 		}
 		break;
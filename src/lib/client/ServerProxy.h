@@ -20,6 +20,7 @@
 
 #include "synergy/clipboard_types.h"
 #include "synergy/key_types.h"
+#include "synergy/mouse_types.h"
 #include "base/Event.h"
 #include "base/Stopwatch.h"
 #include "base/String.h"
@@ -27,7 +28,10 @@
 class CClient;
 class CClientInfo;
 class CEventQueueTimer;
+class CLivenessMonitor;
+class CMotionChannel;
 class IClipboard;
+class IDatagramSocket;
 namespace synergy { class IStream; }
 class IEventQueue;
 
@@ -68,6 +72,7 @@ protected:
 	enum EResult { kOkay, kUnknown, kDisconnect };
 	EResult				parseHandshakeMessage(const UInt8* code);
 	EResult				parseMessage(const UInt8* code);
+	EResult				parseCompactMessage(UInt8 code);
 
 private:
 	// if compressing mouse motion then send the last motion now
@@ -78,6 +83,31 @@ private:
 	void				resetKeepAliveAlarm();
 	void				setKeepAliveRate(double);
 
+	// input, from the 4 byte code and compact messages
+	void				applyKeyDown(KeyID, KeyModifierMask, KeyButton);
+	void				applyKeyRepeat(KeyID, KeyModifierMask,
+							SInt32 count, KeyButton);
+	void				applyKeyUp(KeyID, KeyModifierMask, KeyButton);
+	void				applyMouseDown(ButtonID);
+	void				applyMouseUp(ButtonID);
+	void				applyMouseWheel(SInt32 xDelta, SInt32 yDelta);
+
+	// mouse motion.  the more flag is true if more input follows.
+	void				applyMouseMove(SInt32 x, SInt32 y, bool more);
+	void				applyMouseRelativeMove(SInt32 dx, SInt32 dy, bool more);
+	void				applyMotion(UInt32 seq, UInt8 type,
+							SInt32 a, SInt32 b, bool more);
+
+	// mouse motion channel
+	void				openMotionChannel(UInt32 token);
+	void				closeMotionChannel();
+	void				sendMotionReport();
+
+	// read the 4 byte retry hint following the code of a close or busy
+	// message (see kMsgCCloseRetry).  returns seconds or 0 if the hint
+	// couldn't be read.
+	double				readRetryHint();
+
 	// modifier key translation
 	KeyID				translateKey(KeyID) const;
 	KeyModifierMask			translateModifierMask(KeyModifierMask) const;
@@ -85,6 +115,8 @@ private:
 	// event handlers
 	void				handleData(const CEvent&, void*);
 	void				handleKeepAliveAlarm(const CEvent&, void*);
+	void				handleMotionData(const CEvent&, void*);
+	void				handleMotionReport(const CEvent&, void*);
 
 	// message handlers
 	void				enter();
@@ -98,8 +130,10 @@ private:
 	void				mouseUp();
 	void				mouseMove();
 	void				mouseRelativeMove();
+	void				mouseMoveSeq();
 	void				mouseWheel();
 	void				cryptoIv();
+	void				motionChannel();
 	void				screensaver();
 	void				resetOptions();
 	void				setOptions();
@@ -108,6 +142,18 @@ private:
 	void				fileChunkReceived();
 	void				dragInfoReceived();
 
+	// compact message handlers
+	void				compactMouseMove();
+	void				compactMouseRelativeMove();
+	void				compactMouseDown();
+	void				compactMouseUp();
+	void				compactMoveMouseDown();
+	void				compactMoveMouseUp();
+	void				compactMouseWheel();
+	void				compactKeyDown();
+	void				compactKeyRepeat();
+	void				compactKeyUp();
+
 private:
 	typedef EResult (CServerProxy::*MessageParser)(const UInt8*);
 
@@ -123,10 +169,28 @@ private:
 
 	bool				m_ignoreMouse;
 
+	// mouse motion channel.  m_motionSeq is the sequence number of the
+	// last motion applied, m_datagramSeq the last one received on the
+	// channel and m_xRelative,m_yRelative the relative motion totals
+	// applied so far.
+	IDatagramSocket*	m_motionSocket;
+	CMotionChannel*		m_motion;
+	CEventQueueTimer*	m_motionTimer;
+	UInt32				m_motionSeq;
+	UInt32				m_datagramSeq;
+	UInt32				m_reportSeq;
+	UInt32				m_xRelative;
+	UInt32				m_yRelative;
+
+	// the position compact moves are relative to
+	SInt32				m_xCompact;
+	SInt32				m_yCompact;
+
 	KeyModifierID		m_modifierTranslationTable[kKeyModifierIDLast];
 
 	double				m_keepAliveAlarm;
-	CEventQueueTimer*	m_keepAliveAlarmTimer;
+	double				m_lastActivity;
+	CLivenessMonitor*	m_liveness;
 
 	MessageParser		m_parser;
 	IEventQueue*		m_events;
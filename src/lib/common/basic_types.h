@@ -45,6 +45,14 @@
 #	else
 #		define TYPE_OF_SIZE_4 long
 #	endif
+#endif
+
+#if !defined(TYPE_OF_SIZE_8)
+#	if defined(_MSC_VER)
+#		define TYPE_OF_SIZE_8 __int64
+#	else
+#		define TYPE_OF_SIZE_8 long long
+#	endif
 #endif
 
 	//
@@ -78,6 +86,8 @@ typedef signed TYPE_OF_SIZE_4	SInt32;
 typedef unsigned TYPE_OF_SIZE_1	UInt8;
 typedef unsigned TYPE_OF_SIZE_2	UInt16;
 typedef unsigned TYPE_OF_SIZE_4	UInt32;
+typedef signed TYPE_OF_SIZE_8	SInt64;
+typedef unsigned TYPE_OF_SIZE_8	UInt64;
 #endif
 //
 // clean up
@@ -86,3 +96,4 @@ typedef unsigned TYPE_OF_SIZE_4	UInt32;
 #undef TYPE_OF_SIZE_1
 #undef TYPE_OF_SIZE_2
 #undef TYPE_OF_SIZE_4
+#undef TYPE_OF_SIZE_8
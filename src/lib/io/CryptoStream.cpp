@@ -41,15 +41,33 @@ CCryptoStream::CCryptoStream(
 
 	m_key = new byte[kKeyLength];
 	if (!options.m_pass.empty()) {
-		createKey(m_key, options.m_pass, kKeyLength, static_cast<UInt8>(options.m_pass.length()));
-
 		byte iv[CRYPTO_IV_SIZE];
-		createKey(iv, options.m_pass, CRYPTO_IV_SIZE, static_cast<UInt8>(options.m_pass.length()) * 2);
+		createKeys(options, m_key, iv);
 		setEncryptIv(iv);
 		setDecryptIv(iv);
 	}
 }
 
+CCryptoStream::CCryptoStream(
+		IEventQueue* events,
+		synergy::IStream* stream,
+		const CCryptoOptions& options,
+		const byte* key,
+		const byte* iv,
+		bool adoptStream) :
+	CStreamFilter(events, stream, adoptStream),
+	m_key(NULL),
+	m_encryption(options.m_mode, true),
+	m_decryption(options.m_mode, false)
+{
+	LOG((CLOG_INFO "crypto mode: %s", options.m_modeString.c_str()));
+
+	m_key = new byte[kKeyLength];
+	memcpy(m_key, key, kKeyLength);
+	setEncryptIv(iv);
+	setDecryptIv(iv);
+}
+
 CCryptoStream::~CCryptoStream()
 {
 	delete[] m_key;
@@ -61,8 +79,9 @@ CCryptoStream::read(void* out, UInt32 n)
 	assert(m_key != NULL);
 	LOG((CLOG_DEBUG4 "crypto: read %i (decrypt)", n));
 
-	byte* cypher = new byte[n];
-	size_t result = getStream()->read(cypher, n);
+	// decrypt in place so a large message isn't held twice
+	byte* data = static_cast<byte*>(out);
+	size_t result = getStream()->read(data, n);
 	if (result == 0) {
 		// nothing to read.
 		return 0;
@@ -73,10 +92,9 @@ CCryptoStream::read(void* out, UInt32 n)
 		return 0;
 	}
 
-	logBuffer("cypher", cypher, n);
-	m_decryption.processData(static_cast<byte*>(out), cypher, n);
-	logBuffer("plaintext", static_cast<byte*>(out), n);
-	delete[] cypher;
+	logBuffer("cypher", data, n);
+	m_decryption.processData(data, data, n);
+	logBuffer("plaintext", data, n);
 	return static_cast<UInt32>(result);
 }
 
@@ -94,6 +112,40 @@ CCryptoStream::write(const void* in, UInt32 n)
 	delete[] cypher;
 }
 
+void
+CCryptoStream::writeBuffers(const CSharedBufferList& buffers)
+{
+	assert(m_key != NULL);
+
+	UInt32 n = 0;
+	for (CSharedBufferList::const_iterator i = buffers.begin();
+							i != buffers.end(); ++i) {
+		n += i->getSize();
+	}
+	LOG((CLOG_DEBUG4 "crypto: write %i in %i buffers (encrypt)", n, buffers.size()));
+
+	// encrypting copies the data anyway so encrypt each part into place
+	byte* cypher = new byte[n];
+	byte* scan   = cypher;
+	for (CSharedBufferList::const_iterator i = buffers.begin();
+							i != buffers.end(); ++i) {
+		if (i->getSize() != 0) {
+			m_encryption.processData(scan, i->getData(), i->getSize());
+			scan += i->getSize();
+		}
+	}
+	getStream()->write(cypher, n);
+	delete[] cypher;
+}
+
+void
+CCryptoStream::createKeys(const CCryptoOptions& options, byte* key, byte* iv)
+{
+	UInt8 length = static_cast<UInt8>(options.m_pass.length());
+	createKey(key, options.m_pass, kKeyLength, length);
+	createKey(iv, options.m_pass, CRYPTO_IV_SIZE, length * 2);
+}
+
 void
 CCryptoStream::createKey(byte* out, const CString& password, UInt8 keyLength, UInt8 hashCount)
 {
@@ -135,6 +187,18 @@ CCryptoStream::newIv(byte* out)
 	m_autoSeedRandomPool.GenerateBlock(out, CRYPTO_IV_SIZE);
 }
 
+const byte*
+CCryptoStream::getKey() const
+{
+	return m_key;
+}
+
+synergy::IStream*
+CCryptoStream::getFilteredStream() const
+{
+	return getStream();
+}
+
 void
 CCryptoStream::logBuffer(const char* name, const byte* buf, int length)
 {
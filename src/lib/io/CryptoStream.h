@@ -33,6 +33,14 @@ Encrypts (on write) and decrypts (on read) to and from an underlying stream.
 class CCryptoStream : public CStreamFilter {
 public:
 	CCryptoStream(IEventQueue* events, synergy::IStream* stream, const CCryptoOptions& options, bool adoptStream = true);
+
+	//! Create with precomputed key
+	/*!
+	Uses the \p key (kKeyLength bytes) and \p iv (CRYPTO_IV_SIZE bytes)
+	computed by createKeys() instead of deriving them from the password
+	again.  Useful when many streams share the same options.
+	*/
+	CCryptoStream(IEventQueue* events, synergy::IStream* stream, const CCryptoOptions& options, const byte* key, const byte* iv, bool adoptStream = true);
 	virtual ~CCryptoStream();
 
 	//! @name manipulators
@@ -50,6 +58,7 @@ public:
 	Write \c n bytes from \c buffer to the stream using encryption.
 	*/
 	virtual void		write(const void* in, UInt32 n);
+	virtual void		writeBuffers(const CSharedBufferList& buffers);
 
 	//! Set the IV for encryption
 	void				setEncryptIv(const byte* iv);
@@ -64,9 +73,27 @@ public:
 	*/
 	void				newIv(byte* out);
 
+	//! Get the key
+	/*!
+	Returns the kKeyLength byte key used by the stream, so other
+	channels to the same peer can be encrypted without another
+	exchange.
+	*/
+	const byte*			getKey() const;
+
+	//! Get the filtered stream
+	/*!
+	Returns the stream this filter encrypts, e.g. to reach a packet
+	filter beneath it.
+	*/
+	synergy::IStream*	getFilteredStream() const;
+
 	//! Creates a key from a password
 	static void			createKey(byte* out, const CString& password, UInt8 keyLength, UInt8 hashCount);
 
+	//! Creates the key and IV for the password in \p options
+	static void			createKeys(const CCryptoOptions& options, byte* key, byte* iv);
+
 private:
 	void				logBuffer(const char* name, const byte* buf, int length);
 	
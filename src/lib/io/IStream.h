@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "io/SharedBuffer.h"
 #include "common/IInterface.h"
 #include "base/Event.h"
 #include "base/IEventQueue.h"
@@ -65,6 +66,16 @@ public:
 	*/
 	virtual void		write(const void* buffer, UInt32 n) = 0;
 
+	//! Write buffers to stream
+	/*!
+	Write the bytes of all of \c buffers, in order, exactly as if they
+	had been copied together and passed to one \c write().  Filters that
+	treat each write as a message (e.g. adding a length) treat this as
+	one message.  Large messages can be written this way without first
+	copying their parts into one buffer.
+	*/
+	virtual void		writeBuffers(const CSharedBufferList& buffers) = 0;
+
 	//! Flush the stream
 	/*!
 	Waits until all buffered data has been written to the stream.
@@ -0,0 +1,157 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "io/SharedBuffer.h"
+
+#if SYSAPI_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+//
+// CSharedBuffer
+//
+
+CSharedBuffer::CSharedBuffer() :
+	m_storage(NULL),
+	m_offset(0),
+	m_size(0)
+{
+	// do nothing
+}
+
+CSharedBuffer::CSharedBuffer(const void* data, UInt32 n) :
+	m_storage(NULL),
+	m_offset(0),
+	m_size(n)
+{
+	if (n != 0) {
+		m_storage = new CStorage;
+		m_storage->m_data.assign(static_cast<const char*>(data), n);
+		m_storage->m_refCount = 1;
+	}
+}
+
+CSharedBuffer::CSharedBuffer(const CSharedBuffer& other) :
+	m_storage(other.m_storage),
+	m_offset(other.m_offset),
+	m_size(other.m_size)
+{
+	ref();
+}
+
+CSharedBuffer::~CSharedBuffer()
+{
+	unref();
+}
+
+CSharedBuffer&
+CSharedBuffer::operator=(const CSharedBuffer& other)
+{
+	// take the new reference first in case other shares our storage
+	other.ref();
+	unref();
+	m_storage = other.m_storage;
+	m_offset  = other.m_offset;
+	m_size    = other.m_size;
+	return *this;
+}
+
+CSharedBuffer
+CSharedBuffer::adopt(CString& data)
+{
+	CSharedBuffer buffer;
+	if (!data.empty()) {
+		buffer.m_storage = new CStorage;
+		buffer.m_storage->m_data.swap(data);
+		buffer.m_storage->m_refCount = 1;
+		buffer.m_size = static_cast<UInt32>(buffer.m_storage->m_data.size());
+	}
+	return buffer;
+}
+
+const UInt8*
+CSharedBuffer::getData() const
+{
+	if (m_storage == NULL) {
+		return NULL;
+	}
+	return reinterpret_cast<const UInt8*>(m_storage->m_data.data()) + m_offset;
+}
+
+UInt32
+CSharedBuffer::getSize() const
+{
+	return m_size;
+}
+
+CSharedBuffer
+CSharedBuffer::slice(UInt32 offset, UInt32 n) const
+{
+	if (offset > m_size) {
+		offset = m_size;
+	}
+	if (n > m_size - offset) {
+		n = m_size - offset;
+	}
+
+	CSharedBuffer buffer;
+	if (n != 0) {
+		buffer.m_storage = m_storage;
+		buffer.m_offset  = m_offset + offset;
+		buffer.m_size    = n;
+		ref();
+	}
+	return buffer;
+}
+
+CString
+CSharedBuffer::toString() const
+{
+	if (m_size == 0) {
+		return CString();
+	}
+	return CString(reinterpret_cast<const char*>(getData()), m_size);
+}
+
+void
+CSharedBuffer::ref() const
+{
+	if (m_storage != NULL) {
+#if SYSAPI_WIN32
+		InterlockedIncrement(&m_storage->m_refCount);
+#else
+		__sync_add_and_fetch(&m_storage->m_refCount, 1);
+#endif
+	}
+}
+
+void
+CSharedBuffer::unref()
+{
+	if (m_storage != NULL) {
+#if SYSAPI_WIN32
+		long count = InterlockedDecrement(&m_storage->m_refCount);
+#else
+		long count = __sync_sub_and_fetch(&m_storage->m_refCount, 1);
+#endif
+		if (count == 0) {
+			delete m_storage;
+		}
+		m_storage = NULL;
+	}
+}
@@ -0,0 +1,104 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+//! Reference counted byte buffer
+/*!
+An immutable sequence of bytes that can be copied without copying the
+bytes.  All copies share one block of memory, which is freed with the
+last copy.  A buffer can also be a slice of another buffer, sharing its
+memory.  Copies may be made and destroyed on different threads.
+*/
+class CSharedBuffer {
+public:
+	//! Create an empty buffer
+	CSharedBuffer();
+
+	//! Create a buffer from bytes
+	/*!
+	Copies \c n bytes from \c data.
+	*/
+	CSharedBuffer(const void* data, UInt32 n);
+
+	CSharedBuffer(const CSharedBuffer&);
+	~CSharedBuffer();
+
+	CSharedBuffer&		operator=(const CSharedBuffer&);
+
+	//! @name manipulators
+	//@{
+
+	//! Create a buffer from a string
+	/*!
+	Returns a buffer holding the bytes of \c data without copying them.
+	\c data is left empty.
+	*/
+	static CSharedBuffer	adopt(CString& data);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the bytes
+	/*!
+	Returns a pointer to the bytes, which remain valid as long as any
+	buffer sharing them.
+	*/
+	const UInt8*		getData() const;
+
+	//! Get the size
+	UInt32				getSize() const;
+
+	//! Get part of the buffer
+	/*!
+	Returns a buffer of the \c n bytes at \c offset, sharing this
+	buffer's memory.  The slice is clipped to the end of this buffer.
+	*/
+	CSharedBuffer		slice(UInt32 offset, UInt32 n) const;
+
+	//! Copy to a string
+	CString				toString() const;
+
+	//@}
+
+private:
+	class CStorage {
+	public:
+		CString			m_data;
+		volatile long	m_refCount;
+	};
+
+	void				ref() const;
+	void				unref();
+
+private:
+	CStorage*			m_storage;
+	UInt32				m_offset;
+	UInt32				m_size;
+};
+
+//! List of shared buffers
+/*!
+Bytes in several parts, e.g. a message header followed by data held
+elsewhere.  The bytes are the concatenation of the parts.
+*/
+typedef std::vector<CSharedBuffer> CSharedBufferList;
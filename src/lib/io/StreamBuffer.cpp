@@ -18,6 +18,8 @@
 
 #include "io/StreamBuffer.h"
 
+#include <cstring>
+
 //
 // CStreamBuffer
 //
@@ -47,19 +49,31 @@ CStreamBuffer::peek(UInt32 n)
 		return NULL;
 	}
 
-	// reserve space in first chunk
+	// a shared head chunk can be returned in place if it has n bytes,
+	// otherwise it has to be copied before other chunks are added to it
 	ChunkList::iterator head = m_chunks.begin();
-	head->reserve(n + m_headUsed);
+	if (head->isShared()) {
+		if (head->getSize() - m_headUsed >= n) {
+			return head->getData() + m_headUsed;
+		}
+		head->m_bytes.assign(head->getData(),
+							head->getData() + head->getSize());
+		head->m_shared = CSharedBuffer();
+	}
+
+	// reserve space in first chunk
+	head->m_bytes.reserve(n + m_headUsed);
 
 	// consolidate chunks into the first chunk until it has n bytes
 	ChunkList::iterator scan = head;
 	++scan;
-	while (head->size() - m_headUsed < n && scan != m_chunks.end()) {
-		head->insert(head->end(), scan->begin(), scan->end());
+	while (head->m_bytes.size() - m_headUsed < n && scan != m_chunks.end()) {
+		head->m_bytes.insert(head->m_bytes.end(),
+							scan->getData(), scan->getData() + scan->getSize());
 		scan = m_chunks.erase(scan);
 	}
 
-	return reinterpret_cast<const void*>(&(head->begin()[m_headUsed]));
+	return reinterpret_cast<const void*>(&(head->m_bytes[m_headUsed]));
 }
 
 void
@@ -79,8 +93,8 @@ CStreamBuffer::pop(UInt32 n)
 	// discard chunks until more than n bytes would've been discarded
 	ChunkList::iterator scan = m_chunks.begin();
 	assert(scan != m_chunks.end());
-	while (scan->size() - m_headUsed <= n) {
-		n         -= (UInt32)scan->size() - m_headUsed;
+	while (scan->getSize() - m_headUsed <= n) {
+		n         -= scan->getSize() - m_headUsed;
 		m_headUsed = 0;
 		scan       = m_chunks.erase(scan);
 		assert(scan != m_chunks.end());
@@ -92,6 +106,26 @@ CStreamBuffer::pop(UInt32 n)
 	}
 }
 
+void
+CStreamBuffer::read(void* vdata, UInt32 n)
+{
+	assert(n <= m_size);
+
+	// copy and discard one chunk at a time
+	UInt8* data = reinterpret_cast<UInt8*>(vdata);
+	while (n > 0) {
+		const Chunk& head = m_chunks.front();
+		UInt32 count = head.getSize() - m_headUsed;
+		if (count > n) {
+			count = n;
+		}
+		memcpy(data, head.getData() + m_headUsed, count);
+		pop(count);
+		data += count;
+		n    -= count;
+	}
+}
+
 void
 CStreamBuffer::write(const void* vdata, UInt32 n)
 {
@@ -110,7 +144,7 @@ CStreamBuffer::write(const void* vdata, UInt32 n)
 	ChunkList::iterator scan = m_chunks.end();
 	if (scan != m_chunks.begin()) {
 		--scan;
-		if (scan->size() >= kChunkSize) {
+		if (scan->isShared() || scan->m_bytes.size() >= kChunkSize) {
 			++scan;
 		}
 	}
@@ -121,13 +155,13 @@ CStreamBuffer::write(const void* vdata, UInt32 n)
 	// append data in chunks
 	while (n > 0) {
 		// choose number of bytes for next chunk
-		assert(scan->size() <= kChunkSize);
-		UInt32 count = kChunkSize - (UInt32)scan->size();
+		assert(scan->m_bytes.size() <= kChunkSize);
+		UInt32 count = kChunkSize - (UInt32)scan->m_bytes.size();
 		if (count > n)
 			count = n;
 
 		// transfer data
-		scan->insert(scan->end(), data, data + count);
+		scan->m_bytes.insert(scan->m_bytes.end(), data, data + count);
 		n    -= count;
 		data += count;
 
@@ -139,8 +173,71 @@ CStreamBuffer::write(const void* vdata, UInt32 n)
 	}
 }
 
+void
+CStreamBuffer::write(const CSharedBuffer& data)
+{
+	// copying small buffers is cheaper than tracking them
+	if (data.getSize() < kChunkSize) {
+		if (data.getSize() != 0) {
+			write(data.getData(), data.getSize());
+		}
+		return;
+	}
+
+	m_chunks.push_back(Chunk());
+	m_chunks.back().m_shared = data;
+	m_size += data.getSize();
+}
+
 UInt32
 CStreamBuffer::getSize() const
 {
 	return m_size;
 }
+
+UInt32
+CStreamBuffer::getRunSize() const
+{
+	if (m_chunks.empty()) {
+		return 0;
+	}
+
+	ChunkList::const_iterator scan = m_chunks.begin();
+	UInt32 n = scan->getSize() - m_headUsed;
+	if (scan->isShared()) {
+		return n;
+	}
+	for (++scan; scan != m_chunks.end() && !scan->isShared(); ++scan) {
+		n += scan->getSize();
+	}
+	return n;
+}
+
+
+//
+// CStreamBuffer::Chunk
+//
+
+const UInt8*
+CStreamBuffer::Chunk::getData() const
+{
+	if (isShared()) {
+		return m_shared.getData();
+	}
+	return m_bytes.empty() ? NULL : &m_bytes[0];
+}
+
+UInt32
+CStreamBuffer::Chunk::getSize() const
+{
+	if (isShared()) {
+		return m_shared.getSize();
+	}
+	return (UInt32)m_bytes.size();
+}
+
+bool
+CStreamBuffer::Chunk::isShared() const
+{
+	return (m_shared.getSize() != 0);
+}
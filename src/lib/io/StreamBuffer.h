@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "io/SharedBuffer.h"
 #include "base/EventTypes.h"
 #include "common/stdlist.h"
 #include "common/stdvector.h"
@@ -49,12 +50,28 @@ public:
 	*/
 	void				pop(UInt32 n);
 
+	//! Read data
+	/*!
+	Copies the next \c n bytes (which must be <= getSize()) to \c data
+	and discards them.  Unlike peek() this doesn't first gather the
+	bytes into one chunk, so it's cheaper for large reads.
+	*/
+	void				read(void* data, UInt32 n);
+
 	//! Write data to buffer
 	/*!
 	Appends \c n bytes from \c data to the buffer.
 	*/
 	void				write(const void* data, UInt32 n);
 
+	//! Write shared data to buffer
+	/*!
+	Appends the bytes of \c data to the buffer.  Large buffers are
+	queued by reference rather than copied, so the same bytes can be
+	queued on many streams.
+	*/
+	void				write(const CSharedBuffer& data);
+
 	//@}
 	//! @name accessors
 	//@{
@@ -65,12 +82,30 @@ public:
 	*/
 	UInt32				getSize() const;
 
+	//! Get size of next run
+	/*!
+	Returns the number of bytes that peek() can return without copying
+	a shared buffer:  the rest of the first chunk if it's shared,
+	otherwise the bytes up to the first shared chunk.
+	*/
+	UInt32				getRunSize() const;
+
 	//@}
 
 private:
 	static const UInt32	kChunkSize;
 
-	typedef std::vector<UInt8> Chunk;
+	// a chunk holds its own bytes or refers to a shared buffer
+	class Chunk {
+	public:
+		const UInt8*	getData() const;
+		UInt32			getSize() const;
+		bool			isShared() const;
+
+	public:
+		std::vector<UInt8>	m_bytes;
+		CSharedBuffer		m_shared;
+	};
 	typedef std::list<Chunk> ChunkList;
 
 	ChunkList			m_chunks;
@@ -62,6 +62,12 @@ CStreamFilter::write(const void* buffer, UInt32 n)
 	getStream()->write(buffer, n);
 }
 
+void
+CStreamFilter::writeBuffers(const CSharedBufferList& buffers)
+{
+	getStream()->writeBuffers(buffers);
+}
+
 void
 CStreamFilter::flush()
 {
@@ -42,6 +42,7 @@ public:
 	virtual void		close();
 	virtual UInt32		read(void* buffer, UInt32 n);
 	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		writeBuffers(const CSharedBufferList& buffers);
 	virtual void		flush();
 	virtual void		shutdownInput();
 	virtual void		shutdownOutput();
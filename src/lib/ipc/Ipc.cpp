@@ -18,7 +18,20 @@
 
 #include "ipc/Ipc.h"
 
+#include "arch/Arch.h"
+
 const char*				kIpcMsgHello		= "IHEL%1i";
 const char*				kIpcMsgLogLine		= "ILOG%s";
 const char*				kIpcMsgCommand		= "ICMD%s%1i";
 const char*				kIpcMsgShutdown		= "ISDN";
+const char*				kIpcMsgMetrics		= "IMET%s";
+
+CString
+getIpcLocalPath()
+{
+	CString dir = ARCH->getPrivateDirectory();
+	if (dir.empty()) {
+		return dir;
+	}
+	return ARCH->concatPath(dir, IPC_LOCAL_NAME);
+}
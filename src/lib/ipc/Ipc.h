@@ -18,24 +18,34 @@
 
 #pragma once
 
+#include "base/String.h"
+
 #define IPC_HOST "127.0.0.1"
 #define IPC_PORT 24801
 
+// the daemon also listens on a unix domain socket with this name in the
+// user's private directory, which the core uses instead of tcp loopback
+// where available.
+#define IPC_LOCAL_NAME "ipc"
+
 enum EIpcMessage {
 	kIpcHello,
 	kIpcLogLine,
 	kIpcCommand,
 	kIpcShutdown,
+	kIpcMetrics,
 };
 
 enum EIpcClientType {
 	kIpcClientUnknown,
 	kIpcClientGui,
 	kIpcClientNode,
+	kIpcClientMonitor,
 };
 
 // handshake: node/gui -> daemon
-// $1 = type, the client identifies it's self as gui or node (synergyc/s).
+// $1 = type, the client identifies it's self as gui, node (synergyc/s)
+// or monitor (syntool --metrics).
 extern const char*		kIpcMsgHello;
 
 // log line: daemon -> gui
@@ -50,3 +60,13 @@ extern const char*		kIpcMsgCommand;
 // shutdown: daemon -> node
 // the daemon tells synergys/c to shut down gracefully.
 extern const char*		kIpcMsgShutdown;
+
+// metrics: node -> daemon, daemon -> monitor
+// $1 = snapshot; every metric in the node, as from CMetric::snapshot().
+// nodes send one every few seconds and the daemon passes them on to
+// monitors only.
+extern const char*		kIpcMsgMetrics;
+
+// returns the path of the daemon's unix domain socket, or an empty
+// string if the user has no private directory to put it in.
+CString					getIpcLocalPath();
@@ -20,7 +20,11 @@
 #include "ipc/Ipc.h"
 #include "ipc/IpcServerProxy.h"
 #include "ipc/IpcMessage.h"
+#include "net/IDataSocket.h"
+#include "net/TCPSocketFactory.h"
+#include "net/XSocket.h"
 #include "base/TMethodEventJob.h"
+#include "base/Log.h"
 
 //
 // CIpcClient
@@ -28,42 +32,90 @@
 
 CIpcClient::CIpcClient(IEventQueue* events, CSocketMultiplexer* socketMultiplexer) :
 	m_serverAddress(CNetworkAddress(IPC_HOST, IPC_PORT)),
-	m_socket(events, socketMultiplexer),
+	m_socket(nullptr),
 	m_server(nullptr),
-	m_events(events)
+	m_clientType(kIpcClientNode),
+	m_events(events),
+	m_fallbackSocketMultiplexer(nullptr),
+	m_fallbackPort(0)
 {
-	init();
+	init(new CTCPSocketFactory(events, socketMultiplexer));
 }
 
 CIpcClient::CIpcClient(IEventQueue* events, CSocketMultiplexer* socketMultiplexer, int port) :
 	m_serverAddress(CNetworkAddress(IPC_HOST, port)),
-	m_socket(events, socketMultiplexer),
+	m_socket(nullptr),
 	m_server(nullptr),
-	m_events(events)
+	m_clientType(kIpcClientNode),
+	m_events(events),
+	m_fallbackSocketMultiplexer(nullptr),
+	m_fallbackPort(0)
 {
-	init();
+	init(new CTCPSocketFactory(events, socketMultiplexer));
+}
+
+CIpcClient::CIpcClient(IEventQueue* events,
+				ISocketFactory* adoptedFactory, const CNetworkAddress& address) :
+	m_serverAddress(address),
+	m_socket(nullptr),
+	m_server(nullptr),
+	m_clientType(kIpcClientNode),
+	m_events(events),
+	m_fallbackSocketMultiplexer(nullptr),
+	m_fallbackPort(0)
+{
+	init(adoptedFactory);
 }
 
 void
-CIpcClient::init()
+CIpcClient::init(ISocketFactory* adoptedFactory)
 {
 	m_serverAddress.resolve();
+
+	// the socket is all we need from the factory
+	m_socket = adoptedFactory->create();
+	delete adoptedFactory;
 }
 
 CIpcClient::~CIpcClient()
 {
+	delete m_socket;
+}
+
+void
+CIpcClient::setFallbackPort(CSocketMultiplexer* socketMultiplexer, int port)
+{
+	m_fallbackSocketMultiplexer = socketMultiplexer;
+	m_fallbackPort              = port;
 }
 
 void
 CIpcClient::connect()
 {
 	m_events->adoptHandler(
-		m_events->forIDataSocket().connected(), m_socket.getEventTarget(),
+		m_events->forIDataSocket().connected(), m_socket->getEventTarget(),
 		new TMethodEventJob<CIpcClient>(
 		this, &CIpcClient::handleConnected));
 
-	m_socket.connect(m_serverAddress);
-	m_server = new CIpcServerProxy(m_socket, m_events);
+	try {
+		m_socket->connect(m_serverAddress);
+	}
+	catch (XSocketConnect& e) {
+		m_events->removeHandler(m_events->forIDataSocket().connected(),
+							m_socket->getEventTarget());
+		if (m_fallbackSocketMultiplexer == nullptr) {
+			throw;
+		}
+
+		LOG((CLOG_DEBUG "failed to connect to ipc server at %s: %s, trying port %d", m_serverAddress.getHostname().c_str(), e.what(), m_fallbackPort));
+		delete m_socket;
+		m_serverAddress = CNetworkAddress(IPC_HOST, m_fallbackPort);
+		init(new CTCPSocketFactory(m_events, m_fallbackSocketMultiplexer));
+		m_fallbackSocketMultiplexer = nullptr;
+		connect();
+		return;
+	}
+	m_server = new CIpcServerProxy(*m_socket, m_events);
 
 	m_events->adoptHandler(
 		m_events->forCIpcServerProxy().messageReceived(), m_server,
@@ -74,7 +126,7 @@ CIpcClient::connect()
 void
 CIpcClient::disconnect()
 {
-	m_events->removeHandler(m_events->forIDataSocket().connected(), m_socket.getEventTarget());
+	m_events->removeHandler(m_events->forIDataSocket().connected(), m_socket->getEventTarget());
 	m_events->removeHandler(m_events->forCIpcServerProxy().messageReceived(), m_server);
 
 	m_server->disconnect();
@@ -95,7 +147,7 @@ CIpcClient::handleConnected(const CEvent&, void*)
 	m_events->addEvent(CEvent(
 		m_events->forCIpcClient().connected(), this, m_server, CEvent::kDontFreeData));
 
-	CIpcHelloMessage message(kIpcClientNode);
+	CIpcHelloMessage message(m_clientType);
 	send(message);
 }
 
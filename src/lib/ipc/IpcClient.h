@@ -18,13 +18,15 @@
 
 #pragma once
 
+#include "ipc/Ipc.h"
 #include "net/NetworkAddress.h"
-#include "net/TCPSocket.h"
 #include "base/EventTypes.h"
 
 class CIpcServerProxy;
 class CIpcMessage;
+class IDataSocket;
 class IEventQueue;
+class ISocketFactory;
 class CSocketMultiplexer;
 
 //! IPC client for communication between daemon and GUI.
@@ -35,11 +37,36 @@ class CIpcClient {
 public:
 	CIpcClient(IEventQueue* events, CSocketMultiplexer* socketMultiplexer);
 	CIpcClient(IEventQueue* events, CSocketMultiplexer* socketMultiplexer, int port);
+
+	//! Connect with another transport
+	/*!
+	Connects to \c address with a socket made by \c adoptedFactory, e.g.
+	a CLocalSocketFactory and a CNetworkAddress::local() address.
+	*/
+	CIpcClient(IEventQueue* events, ISocketFactory* adoptedFactory,
+							const CNetworkAddress& address);
 	virtual ~CIpcClient();
 
 	//! @name manipulators
 	//@{
 
+	//! Set what the client is
+	/*!
+	Sets the type the client says it is when it connects, which decides
+	the messages the daemon sends it.  The default is kIpcClientNode.
+	*/
+	void				setClientType(EIpcClientType type) { m_clientType = type; }
+
+	//! Fall back to TCP
+	/*!
+	If connecting to the server's address fails straight away, e.g.
+	because a local socket doesn't exist or belongs to another user,
+	connect() tries TCP \c port on localhost instead.  Daemons that
+	predate the local socket only listen there.
+	*/
+	void				setFallbackPort(CSocketMultiplexer* socketMultiplexer,
+							int port);
+
 	//! Connects to the IPC server at localhost.
 	void				connect();
 	
@@ -52,13 +79,16 @@ public:
 	//@}
 
 private:
-	void				init();
+	void				init(ISocketFactory* adoptedFactory);
 	void				handleConnected(const CEvent&, void*);
 	void				handleMessageReceived(const CEvent&, void*);
 
 private:
 	CNetworkAddress		m_serverAddress;
-	CTCPSocket			m_socket;
+	IDataSocket*		m_socket;
 	CIpcServerProxy*	m_server;
+	EIpcClientType		m_clientType;
 	IEventQueue*		m_events;
+	CSocketMultiplexer*	m_fallbackSocketMultiplexer;
+	int					m_fallbackPort;
 };
@@ -117,6 +117,9 @@ CIpcClientProxy::handleData(const CEvent&, void*)
 		else if (memcmp(code, kIpcMsgCommand, 4) == 0) {
 			m = parseCommand();
 		}
+		else if (memcmp(code, kIpcMsgMetrics, 4) == 0) {
+			m = parseMetrics();
+		}
 		else {
 			LOG((CLOG_ERR "invalid ipc message"));
 			disconnect();
@@ -155,6 +158,13 @@ CIpcClientProxy::send(const CIpcMessage& message)
 		CProtocolUtil::writef(&m_stream, kIpcMsgShutdown);
 		break;
 
+	case kIpcMetrics: {
+		const CIpcMetricsMessage& mm = static_cast<const CIpcMetricsMessage&>(message);
+		CString snapshot = mm.snapshot();
+		CProtocolUtil::writef(&m_stream, kIpcMsgMetrics, &snapshot);
+		break;
+	}
+
 	default:
 		LOG((CLOG_ERR "ipc message not supported: %d", message.type()));
 		break;
@@ -184,6 +194,16 @@ CIpcClientProxy::parseCommand()
 	return new CIpcCommandMessage(command, elevate != 0);
 }
 
+CIpcMetricsMessage*
+CIpcClientProxy::parseMetrics()
+{
+	CString snapshot;
+	CProtocolUtil::readf(&m_stream, kIpcMsgMetrics + 4, &snapshot);
+
+	// must be deleted by event handler.
+	return new CIpcMetricsMessage(snapshot);
+}
+
 void
 CIpcClientProxy::disconnect()
 {
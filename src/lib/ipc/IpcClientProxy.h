@@ -27,6 +27,7 @@ namespace synergy { class IStream; }
 class CIpcMessage;
 class CIpcCommandMessage;
 class CIpcHelloMessage;
+class CIpcMetricsMessage;
 class IEventQueue;
 
 class CIpcClientProxy {
@@ -43,6 +44,7 @@ private:
 	void				handleWriteError(const CEvent&, void*);
 	CIpcHelloMessage*	parseHello();
 	CIpcCommandMessage*	parseCommand();
+	CIpcMetricsMessage*	parseMetrics();
 	void				disconnect();
 	
 private:
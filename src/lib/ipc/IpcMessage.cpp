@@ -67,3 +67,13 @@ m_elevate(elevate)
 CIpcCommandMessage::~CIpcCommandMessage()
 {
 }
+
+CIpcMetricsMessage::CIpcMetricsMessage(const CString& snapshot) :
+CIpcMessage(kIpcMetrics),
+m_snapshot(snapshot)
+{
+}
+
+CIpcMetricsMessage::~CIpcMetricsMessage()
+{
+}
@@ -83,3 +83,15 @@ private:
 	CString				m_command;
 	bool				m_elevate;
 };
+
+class CIpcMetricsMessage : public CIpcMessage {
+public:
+	CIpcMetricsMessage(const CString& snapshot);
+	virtual ~CIpcMetricsMessage();
+
+	//! Gets the metrics, as from CMetric::snapshot().
+	CString				snapshot() const { return m_snapshot; }
+
+private:
+	CString				m_snapshot;
+};
@@ -22,11 +22,46 @@
 #include "ipc/IpcClientProxy.h"
 #include "ipc/IpcMessage.h"
 #include "net/IDataSocket.h"
+#include "net/ISocketFactory.h"
 #include "io/IStream.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
 #include "base/Event.h"
 #include "base/Log.h"
+#include "arch/XArch.h"
+
+#if SYSAPI_UNIX
+#	include <sys/types.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#if SYSAPI_UNIX
+
+// returns true if the local socket at path is left over from a process
+// that's gone, i.e. nothing accepts connections on it
+static bool
+isStaleSocket(const CString& path)
+{
+	CArchNetAddress address = ARCH->newLocalAddr(path);
+	CArchSocket socket = ARCH->newSocket(IArchNetwork::kUNIX,
+							IArchNetwork::kSTREAM);
+	bool stale = false;
+	try {
+		ARCH->connectSocket(socket, address);
+	}
+	catch (XArchNetworkConnectionRefused&) {
+		stale = true;
+	}
+	catch (XArchNetwork&) {
+		// someone may be using it
+	}
+	ARCH->closeSocket(socket);
+	ARCH->closeAddr(address);
+	return stale;
+}
+
+#endif
 
 //
 // CIpcServer
@@ -35,6 +70,8 @@
 CIpcServer::CIpcServer(IEventQueue* events, CSocketMultiplexer* socketMultiplexer) :
 	m_socket(events, socketMultiplexer),
 	m_address(CNetworkAddress(IPC_HOST, IPC_PORT)),
+	m_localSocketFactory(NULL),
+	m_localSocket(NULL),
 	m_events(events)
 {
 	init();
@@ -43,6 +80,8 @@ CIpcServer::CIpcServer(IEventQueue* events, CSocketMultiplexer* socketMultiplexe
 CIpcServer::CIpcServer(IEventQueue* events, CSocketMultiplexer* socketMultiplexer, int port) :
 	m_socket(events, socketMultiplexer),
 	m_address(CNetworkAddress(IPC_HOST, port)),
+	m_localSocketFactory(NULL),
+	m_localSocket(NULL),
 	m_events(events)
 {
 	init();
@@ -72,6 +111,13 @@ CIpcServer::~CIpcServer()
 	ARCH->closeMutex(m_clientsMutex);
 	
 	m_events->removeHandler(m_events->forIListenSocket().connecting(), &m_socket);
+
+	if (m_localSocket != NULL) {
+		m_events->removeHandler(m_events->forIListenSocket().connecting(),
+							m_localSocket->getEventTarget());
+		delete m_localSocket;
+	}
+	delete m_localSocketFactory;
 }
 
 void
@@ -81,9 +127,49 @@ CIpcServer::listen()
 }
 
 void
-CIpcServer::handleClientConnecting(const CEvent&, void*)
+CIpcServer::listen(ISocketFactory* adoptedFactory, const CString& path)
+{
+	assert(m_localSocket == NULL);
+
+	m_localSocketFactory = adoptedFactory;
+	m_localSocket        = m_localSocketFactory->createListen();
+
+	m_events->adoptHandler(
+		m_events->forIListenSocket().connecting(), m_localSocket->getEventTarget(),
+		new TMethodEventJob<CIpcServer>(
+		this, &CIpcServer::handleClientConnecting));
+
+#if SYSAPI_UNIX
+	// a socket left behind by a daemon that died makes bind fail.  only
+	// remove our own sockets, and only if nothing's listening on them;
+	// anything else at the path is left for bind to fail on.
+	struct stat info;
+	if (lstat(path.c_str(), &info) == 0 &&
+		S_ISSOCK(info.st_mode) && info.st_uid == getuid() &&
+		isStaleSocket(path)) {
+		LOG((CLOG_DEBUG "removing stale ipc socket %s", path.c_str()));
+		unlink(path.c_str());
+	}
+#endif
+
+	m_localSocket->bind(CNetworkAddress::local(path));
+
+#if SYSAPI_UNIX
+	// the directory should be private already but don't rely on it
+	chmod(path.c_str(), 0600);
+#endif
+}
+
+void
+CIpcServer::handleClientConnecting(const CEvent& e, void*)
 {
-	synergy::IStream* stream = m_socket.accept();
+	IListenSocket* socket = &m_socket;
+	if (m_localSocket != NULL &&
+		e.getTarget() == m_localSocket->getEventTarget()) {
+		socket = m_localSocket;
+	}
+
+	synergy::IStream* stream = socket->accept();
 	if (stream == NULL) {
 		return;
 	}
@@ -30,6 +30,8 @@ class CEvent;
 class CIpcClientProxy;
 class CIpcMessage;
 class IEventQueue;
+class IListenSocket;
+class ISocketFactory;
 class CSocketMultiplexer;
 
 //! IPC server for communication between daemon and GUI.
@@ -51,6 +53,17 @@ public:
 	//! Opens a TCP socket only allowing local connections.
 	void				listen();
 
+	//! Also listen on a local socket
+	/*!
+	Accepts clients on the unix domain socket at \c path as well, using
+	a listen socket made by \c adoptedFactory, e.g. a
+	CLocalSocketFactory.  Clients from either socket are treated the
+	same.  A socket file at \c path that nothing listens on is removed
+	first, and the new socket is only usable by the current user.
+	*/
+	void				listen(ISocketFactory* adoptedFactory,
+							const CString& path);
+
 	//! Send a message to all clients matching the filter type.
 	void				send(const CIpcMessage& message, EIpcClientType filterType);
 
@@ -75,6 +88,8 @@ private:
 
 	CTCPListenSocket	m_socket;
 	CNetworkAddress		m_address;
+	ISocketFactory*		m_localSocketFactory;
+	IListenSocket*		m_localSocket;
 	CClientList			m_clients;
 	CArchMutex			m_clientsMutex;
 	IEventQueue*		m_events;
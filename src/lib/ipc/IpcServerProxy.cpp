@@ -50,31 +50,51 @@ CIpcServerProxy::handleData(const CEvent&, void*)
 {
 	LOG((CLOG_DEBUG "start ipc handle data"));
 
-	UInt8 code[4];
-	UInt32 n = m_stream.read(code, 4);
+	// a message may arrive in pieces, especially when the log is busy,
+	// and the stream only tells us about new data once it's been
+	// drained.  so take everything and parse only whole messages.
+	UInt8 buffer[4096];
+	UInt32 n = m_stream.read(buffer, sizeof(buffer));
 	while (n != 0) {
+		m_input.write(buffer, n);
+		n = m_stream.read(buffer, sizeof(buffer));
+	}
+
+	while (m_input.getSize() >= 4) {
+		const UInt8* code = static_cast<const UInt8*>(m_input.peek(4));
 
 		LOG((CLOG_DEBUG "ipc read: %c%c%c%c",
 			code[0], code[1], code[2], code[3]));
-		
+
 		CIpcMessage* m = nullptr;
 		if (memcmp(code, kIpcMsgLogLine, 4) == 0) {
 			m = parseLogLine();
+			if (m == nullptr) {
+				// wait for the rest
+				break;
+			}
+		}
+		else if (memcmp(code, kIpcMsgMetrics, 4) == 0) {
+			m = parseMetrics();
+			if (m == nullptr) {
+				// wait for the rest
+				break;
+			}
 		}
 		else if (memcmp(code, kIpcMsgShutdown, 4) == 0) {
+			m_input.pop(4);
 			m = new CIpcShutdownMessage();
 		}
 		else {
 			LOG((CLOG_ERR "invalid ipc message"));
 			disconnect();
+			break;
 		}
-		
+
 		// don't delete with this event; the data is passed to a new event.
 		CEvent e(m_events->forCIpcServerProxy().messageReceived(), this, NULL, CEvent::kDontFreeData);
 		e.setDataObject(m);
 		m_events->addEvent(e);
-
-		n = m_stream.read(code, 4);
 	}
 	
 	LOG((CLOG_DEBUG "finished ipc handle data"));
@@ -99,6 +119,13 @@ CIpcServerProxy::send(const CIpcMessage& message)
 		break;
 	}
 
+	case kIpcMetrics: {
+		const CIpcMetricsMessage& mm = static_cast<const CIpcMetricsMessage&>(message);
+		CString snapshot = mm.snapshot();
+		CProtocolUtil::writef(&m_stream, kIpcMsgMetrics, &snapshot);
+		break;
+	}
+
 	default:
 		LOG((CLOG_ERR "ipc message not supported: %d", message.type()));
 		break;
@@ -109,12 +136,51 @@ CIpcLogLineMessage*
 CIpcServerProxy::parseLogLine()
 {
 	CString logLine;
-	CProtocolUtil::readf(&m_stream, kIpcMsgLogLine + 4, &logLine);
-	
+	if (!parseString(logLine)) {
+		return nullptr;
+	}
+
 	// must be deleted by event handler.
 	return new CIpcLogLineMessage(logLine);
 }
 
+CIpcMetricsMessage*
+CIpcServerProxy::parseMetrics()
+{
+	CString snapshot;
+	if (!parseString(snapshot)) {
+		return nullptr;
+	}
+
+	// must be deleted by event handler.
+	return new CIpcMetricsMessage(snapshot);
+}
+
+bool
+CIpcServerProxy::parseString(CString& string)
+{
+	// the code then a string, i.e. a 4 byte size and the bytes.  returns
+	// false if it hasn't all arrived yet.
+	if (m_input.getSize() < 8) {
+		return false;
+	}
+	const UInt8* header = static_cast<const UInt8*>(m_input.peek(8));
+	UInt32 size = (static_cast<UInt32>(header[4]) << 24) |
+					(static_cast<UInt32>(header[5]) << 16) |
+					(static_cast<UInt32>(header[6]) <<  8) |
+					 static_cast<UInt32>(header[7]);
+	if (m_input.getSize() - 8 < size) {
+		return false;
+	}
+	m_input.pop(8);
+
+	string.assign(size, '\0');
+	if (size != 0) {
+		m_input.read(&string[0], size);
+	}
+	return true;
+}
+
 void
 CIpcServerProxy::disconnect()
 {
@@ -20,10 +20,13 @@
 
 #include "base/Event.h"
 #include "base/EventTypes.h"
+#include "io/StreamBuffer.h"
+#include "base/String.h"
 
 namespace synergy { class IStream; }
 class CIpcMessage;
 class CIpcLogLineMessage;
+class CIpcMetricsMessage;
 class IEventQueue;
 
 class CIpcServerProxy {
@@ -38,9 +41,14 @@ private:
 
 	void				handleData(const CEvent&, void*);
 	CIpcLogLineMessage*	parseLogLine();
+	CIpcMetricsMessage*	parseMetrics();
+	bool				parseString(CString& string);
 	void				disconnect();
 
 private:
 	synergy::IStream&	m_stream;
 	IEventQueue*		m_events;
+
+	// bytes read but not yet parsed, e.g. part of a log line
+	CStreamBuffer		m_input;
 };
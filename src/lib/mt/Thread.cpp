@@ -84,6 +84,18 @@ CThread::setPriority(int n)
 	ARCH->setPriorityOfThread(m_thread, n);
 }
 
+bool
+CThread::setScheduling(IArchMultithread::ESchedulingPolicy policy, int priority)
+{
+	return ARCH->setSchedulingOfThread(m_thread, policy, priority);
+}
+
+bool
+CThread::setAffinity(int cpu)
+{
+	return ARCH->setAffinityOfThread(m_thread, cpu);
+}
+
 void
 CThread::unblockPollSocket()
 {
@@ -126,6 +126,23 @@ public:
 	*/
 	void				setPriority(int n);
 
+	//! Change thread scheduling policy
+	/*!
+	Schedule the thread using \c policy at \c priority.  See
+	IArchMultithread::setSchedulingOfThread().  Returns false if not
+	permitted, leaving the thread's scheduling unchanged.
+	*/
+	bool				setScheduling(
+							IArchMultithread::ESchedulingPolicy policy,
+							int priority);
+
+	//! Pin thread to a CPU
+	/*!
+	Restrict the thread to CPU number \c cpu.  Returns false if not
+	supported or permitted.
+	*/
+	bool				setAffinity(int cpu);
+
 	//! Force pollSocket() to return
 	/*!
 	Forces a currently blocked pollSocket() in the thread to return
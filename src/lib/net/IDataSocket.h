@@ -64,6 +64,7 @@ public:
 	// IStream overrides
 	virtual UInt32		read(void* buffer, UInt32 n) = 0;
 	virtual void		write(const void* buffer, UInt32 n) = 0;
+	virtual void		writeBuffers(const CSharedBufferList& buffers) = 0;
 	virtual void		flush() = 0;
 	virtual void		shutdownInput() = 0;
 	virtual void		shutdownOutput() = 0;
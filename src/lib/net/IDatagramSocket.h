@@ -0,0 +1,59 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "net/ISocket.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+
+class CNetworkAddress;
+
+//! Datagram socket interface
+/*!
+A socket that sends and receives datagrams, which may be lost,
+duplicated or reordered on the way.  It sends an IStream input ready
+event when datagrams arrive while none were waiting to be received.
+*/
+class IDatagramSocket : public ISocket {
+public:
+	//! @name manipulators
+	//@{
+
+	//! Send a datagram
+	/*!
+	Sends \c n bytes from \c data to \c address.  The datagram is
+	dropped if it can't be sent now.
+	*/
+	virtual void		sendTo(const void* data, UInt32 n,
+							const CNetworkAddress& address) = 0;
+
+	//! Receive a datagram
+	/*!
+	Takes the next datagram that arrived into \c data and its sender
+	into \c from.  Returns false if none is waiting.
+	*/
+	virtual bool		receive(CString& data, CNetworkAddress& from) = 0;
+
+	//@}
+
+	// ISocket overrides
+	virtual void		bind(const CNetworkAddress&) = 0;
+	virtual void		close() = 0;
+	virtual void*		getEventTarget() const = 0;
+};
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "net/ISocket.h"
+#include "base/String.h"
 #include "base/EventTypes.h"
 
 class IDataSocket;
@@ -41,6 +42,13 @@ public:
 	*/
 	virtual IDataSocket*	accept() = 0;
 
+	//! Accept connection and identify peer
+	/*!
+	Like accept() but also sets \p peer to the peer's address, without
+	the port, when a connection is accepted.
+	*/
+	virtual IDataSocket*	accept(CString& peer) = 0;
+
 	//@}
 
 	// ISocket overrides
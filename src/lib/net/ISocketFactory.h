@@ -21,6 +21,7 @@
 #include "common/IInterface.h"
 
 class IDataSocket;
+class IDatagramSocket;
 class IListenSocket;
 
 //! Socket factory
@@ -39,5 +40,11 @@ public:
 	//! Create listen socket
 	virtual IListenSocket*	createListen() const = 0;
 
+	//! Create datagram socket
+	/*!
+	Returns NULL if the factory has no datagram sockets.
+	*/
+	virtual IDatagramSocket*	createDatagram() const = 0;
+
 	//@}
 };
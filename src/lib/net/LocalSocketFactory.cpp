@@ -0,0 +1,56 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "net/LocalSocketFactory.h"
+
+#include "net/TCPSocket.h"
+#include "net/TCPListenSocket.h"
+
+//
+// CLocalSocketFactory
+//
+
+CLocalSocketFactory::CLocalSocketFactory(IEventQueue* events, CSocketMultiplexer* socketMultiplexer) :
+	m_events(events),
+	m_socketMultiplexer(socketMultiplexer)
+{
+	// do nothing
+}
+
+CLocalSocketFactory::~CLocalSocketFactory()
+{
+	// do nothing
+}
+
+IDataSocket*
+CLocalSocketFactory::create() const
+{
+	return new CTCPSocket(m_events, m_socketMultiplexer, IArchNetwork::kUNIX);
+}
+
+IListenSocket*
+CLocalSocketFactory::createListen() const
+{
+	return new CTCPListenSocket(m_events, m_socketMultiplexer, IArchNetwork::kUNIX);
+}
+
+IDatagramSocket*
+CLocalSocketFactory::createDatagram() const
+{
+	return NULL;
+}
@@ -0,0 +1,46 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "net/ISocketFactory.h"
+
+class IEventQueue;
+class CSocketMultiplexer;
+
+//! Socket factory for local sockets
+/*!
+Stream sockets are Unix domain sockets, which skip the TCP/IP stack
+and are cheaper than loopback TCP for talking to processes on the same
+host.  Connect and listen with CNetworkAddress::local() addresses.
+There are no datagram sockets.
+*/
+class CLocalSocketFactory : public ISocketFactory {
+public:
+	CLocalSocketFactory(IEventQueue* events, CSocketMultiplexer* socketMultiplexer);
+	virtual ~CLocalSocketFactory();
+
+	// ISocketFactory overrides
+	virtual IDataSocket*	create() const;
+	virtual IListenSocket*	createListen() const;
+	virtual IDatagramSocket*	createDatagram() const;
+
+private:
+	IEventQueue*		m_events;
+	CSocketMultiplexer* m_socketMultiplexer;
+};
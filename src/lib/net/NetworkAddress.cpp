@@ -109,6 +109,14 @@ CNetworkAddress::CNetworkAddress(const CString& hostname, int port) :
 	checkPort();
 }
 
+CNetworkAddress::CNetworkAddress(const CArchNetAddress& address) :
+	m_address(ARCH->copyAddr(address)),
+	m_hostname(ARCH->addrToString(address)),
+	m_port(ARCH->getAddrPort(address))
+{
+	// do nothing
+}
+
 CNetworkAddress::~CNetworkAddress()
 {
 	if (m_address != NULL) {
@@ -132,9 +140,31 @@ CNetworkAddress::operator=(const CNetworkAddress& addr)
 	return *this;
 }
 
+CNetworkAddress
+CNetworkAddress::local(const CString& path)
+{
+	CArchNetAddress address;
+	try {
+		address = ARCH->newLocalAddr(path);
+	}
+	catch (XArchNetwork&) {
+		throw XSocketAddress(XSocketAddress::kUnsupported, path, 0);
+	}
+
+	CNetworkAddress result(address);
+	ARCH->closeAddr(address);
+	return result;
+}
+
 void
 CNetworkAddress::resolve()
 {
+	// local addresses are paths, not names
+	if (m_address != NULL &&
+		ARCH->getAddrFamily(m_address) == IArchNetwork::kUNIX) {
+		return;
+	}
+
 	// discard previous address
 	if (m_address != NULL) {
 		ARCH->closeAddr(m_address);
@@ -171,6 +201,12 @@ CNetworkAddress::resolve()
 bool
 CNetworkAddress::operator==(const CNetworkAddress& addr) const
 {
+	// unresolved addresses can only be compared by name
+	if (m_address == NULL || addr.m_address == NULL) {
+		return (m_address == addr.m_address &&
+				m_hostname == addr.m_hostname &&
+				m_port == addr.m_port);
+	}
 	return ARCH->isEqualAddr(m_address, addr.m_address);
 }
 
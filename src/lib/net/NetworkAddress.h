@@ -51,6 +51,12 @@ public:
 	*/
 	CNetworkAddress(const CString& hostname, int port);
 
+	/*!
+	Construct the network address from a platform address, e.g. the
+	sender of a datagram.  \c address is copied.
+	*/
+	explicit CNetworkAddress(const CArchNetAddress& address);
+
 	CNetworkAddress(const CNetworkAddress&);
 
 	~CNetworkAddress();
@@ -60,10 +66,19 @@ public:
 	//! @name manipulators
 	//@{
 
+	//! Create a local address
+	/*!
+	Returns the address of the local (Unix domain) socket at \c path.
+	The address needs no resolving.  Throws XSocketAddress if the
+	platform has no local sockets or \c path is too long.
+	*/
+	static CNetworkAddress	local(const CString& path);
+
 	//! Resolve address
 	/*!
 	Resolves the hostname to an address.  This can be done any number of
 	times and is done automatically by the c'tor taking a hostname.
+	Local addresses are left unchanged.
 	Throws XSocketAddress if resolution is unsuccessful, after which
 	\c isValid returns false until the next call to this method.
 	*/
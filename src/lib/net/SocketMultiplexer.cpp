@@ -33,7 +33,7 @@
 // CSocketMultiplexer
 //
 
-CSocketMultiplexer::CSocketMultiplexer() :
+CSocketMultiplexer::CSocketMultiplexer(UInt32 numThreads) :
 	m_mutex(new CMutex),
 	m_thread(NULL),
 	m_update(false),
@@ -51,10 +51,23 @@ CSocketMultiplexer::CSocketMultiplexer() :
 	// start thread
 	m_thread = new CThread(new TMethodJob<CSocketMultiplexer>(
 								this, &CSocketMultiplexer::serviceThread));
+
+	// each other thread is a multiplexer of its own
+	if (numThreads < 1) {
+		numThreads = 1;
+	}
+	for (UInt32 i = 1; i < numThreads; ++i) {
+		m_shards.push_back(new CSocketMultiplexer);
+	}
+	m_shardSockets.resize(numThreads, 0);
 }
 
 CSocketMultiplexer::~CSocketMultiplexer()
 {
+	for (CShardList::iterator i = m_shards.begin(); i != m_shards.end(); ++i) {
+		delete *i;
+	}
+
 	m_thread->cancel();
 	m_thread->unblockPollSocket();
 	m_thread->wait();
@@ -79,6 +92,84 @@ CSocketMultiplexer::addSocket(ISocket* socket, ISocketMultiplexerJob* job)
 	assert(socket != NULL);
 	assert(job    != NULL);
 
+	getShard(socket, true, false)->addJob(socket, job);
+}
+
+void
+CSocketMultiplexer::removeSocket(ISocket* socket)
+{
+	assert(socket != NULL);
+
+	CSocketMultiplexer* shard = getShard(socket, false, true);
+	if (shard != NULL) {
+		shard->removeJob(socket);
+	}
+}
+
+UInt32
+CSocketMultiplexer::getNumServiceThreads() const
+{
+	return static_cast<UInt32>(m_shardSockets.size());
+}
+
+CThread*
+CSocketMultiplexer::getServiceThread(UInt32 index) const
+{
+	return getShardByIndex(index)->m_thread;
+}
+
+UInt32
+CSocketMultiplexer::getNumSockets(UInt32 index) const
+{
+	assert(index < m_shardSockets.size());
+
+	CLock lock(m_mutex);
+	return m_shardSockets[index];
+}
+
+CSocketMultiplexer*
+CSocketMultiplexer::getShard(ISocket* socket, bool assign, bool remove)
+{
+	CLock lock(m_mutex);
+	CSocketShardMap::iterator i = m_socketShards.find(socket);
+	UInt32 index;
+	if (i != m_socketShards.end()) {
+		index = i->second;
+		if (remove) {
+			--m_shardSockets[index];
+			m_socketShards.erase(i);
+		}
+	}
+	else if (assign) {
+		index = 0;
+		for (UInt32 j = 1; j < m_shardSockets.size(); ++j) {
+			if (m_shardSockets[j] < m_shardSockets[index]) {
+				index = j;
+			}
+		}
+		++m_shardSockets[index];
+		m_socketShards.insert(std::make_pair(socket, index));
+	}
+	else {
+		return NULL;
+	}
+	return getShardByIndex(index);
+}
+
+CSocketMultiplexer*
+CSocketMultiplexer::getShardByIndex(UInt32 index) const
+{
+	assert(index < m_shardSockets.size());
+
+	if (index == 0) {
+		return const_cast<CSocketMultiplexer*>(this);
+	}
+	return m_shards[index - 1];
+}
+
+void
+CSocketMultiplexer::addJob(ISocket* socket, ISocketMultiplexerJob* job)
+{
 	// prevent other threads from locking the job list
 	lockJobListLock();
 
@@ -112,10 +203,8 @@ CSocketMultiplexer::addSocket(ISocket* socket, ISocketMultiplexerJob* job)
 }
 
 void
-CSocketMultiplexer::removeSocket(ISocket* socket)
+CSocketMultiplexer::removeJob(ISocket* socket)
 {
-	assert(socket != NULL);
-
 	// prevent other threads from locking the job list
 	lockJobListLock();
 
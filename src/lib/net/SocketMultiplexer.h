@@ -19,8 +19,10 @@
 #pragma once
 
 #include "arch/IArchNetwork.h"
+#include "common/basic_types.h"
 #include "common/stdlist.h"
 #include "common/stdmap.h"
+#include "common/stdvector.h"
 
 template <class T>
 class CCondVar;
@@ -31,16 +33,27 @@ class ISocketMultiplexerJob;
 
 //! Socket multiplexer
 /*!
-A socket multiplexer services multiple sockets simultaneously.
+A socket multiplexer services multiple sockets simultaneously.  It can
+use several service threads, each polling its own set of sockets, so a
+socket busy with a large transfer only holds up the sockets that share
+its thread.
 */
 class CSocketMultiplexer {
 public:
-	CSocketMultiplexer();
+	/*!
+	Services sockets on \p numThreads threads.  A socket stays on the
+	thread it was first added to until it's removed.
+	*/
+	CSocketMultiplexer(UInt32 numThreads = 1);
 	~CSocketMultiplexer();
 
 	//! @name manipulators
 	//@{
 
+	//! Add or replace a socket's job
+	/*!
+	A new socket goes to the service thread with the fewest sockets.
+	*/
 	void				addSocket(ISocket*, ISocketMultiplexerJob*);
 
 	void				removeSocket(ISocket*);
@@ -53,6 +66,19 @@ public:
 	static CSocketMultiplexer*
 						getInstance();
 
+	//! Get the number of service threads
+	UInt32				getNumServiceThreads() const;
+
+	//! Get a service thread
+	/*!
+	Returns service thread \p index, which polls some of the sockets,
+	e.g. so its scheduling can be changed.
+	*/
+	CThread*			getServiceThread(UInt32 index = 0) const;
+
+	//! Get the number of sockets on a service thread
+	UInt32				getNumSockets(UInt32 index) const;
+
 	//@}
 
 private:
@@ -61,6 +87,22 @@ private:
 	typedef std::list<ISocketMultiplexerJob*> CSocketJobs;
 	typedef CSocketJobs::iterator CJobCursor;
 	typedef std::map<ISocket*, CJobCursor> CSocketJobMap;
+	typedef std::vector<CSocketMultiplexer*> CShardList;
+	typedef std::map<ISocket*, UInt32> CSocketShardMap;
+
+	// get the multiplexer servicing the socket, which is this one or
+	// one of m_shards.  if the socket is new it's assigned to the one
+	// with the fewest sockets when assign is true, otherwise NULL is
+	// returned.  if remove is true the socket is forgotten.  the job
+	// list locks must not be held, so a service thread adding a socket
+	// from inside a job can't deadlock against another thread.
+	CSocketMultiplexer*	getShard(ISocket*, bool assign, bool remove);
+	CSocketMultiplexer*	getShardByIndex(UInt32 index) const;
+
+	// add, replace or remove a socket's job on this multiplexer's own
+	// service thread
+	void				addJob(ISocket*, ISocketMultiplexerJob*);
+	void				removeJob(ISocket*);
 
 	// service sockets.  the service thread will only access m_sockets
 	// and m_update while m_pollable and m_polling are true.  all other
@@ -107,4 +149,10 @@ private:
 	CSocketJobs			m_socketJobs;
 	CSocketJobMap		m_socketJobMap;
 	ISocketMultiplexerJob*	m_cursorMark;
+
+	// the other service threads and which thread each socket is on.
+	// index 0 is this multiplexer and index i > 0 is m_shards[i - 1].
+	CShardList			m_shards;
+	CSocketShardMap		m_socketShards;
+	std::vector<UInt32>	m_shardSockets;
 };
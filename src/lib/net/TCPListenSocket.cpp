@@ -34,13 +34,15 @@
 // CTCPListenSocket
 //
 
-CTCPListenSocket::CTCPListenSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer) :
+CTCPListenSocket::CTCPListenSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer,
+				IArchNetwork::EAddressFamily family) :
 	m_events(events),
-	m_socketMultiplexer(socketMultiplexer)
+	m_socketMultiplexer(socketMultiplexer),
+	m_family(family)
 {
 	m_mutex = new CMutex;
 	try {
-		m_socket = ARCH->newSocket(IArchNetwork::kINET, IArchNetwork::kSTREAM);
+		m_socket = ARCH->newSocket(m_family, IArchNetwork::kSTREAM);
 	}
 	catch (XArchNetwork& e) {
 		throw XSocketCreate(e.what());
@@ -107,10 +109,36 @@ CTCPListenSocket::getEventTarget() const
 
 IDataSocket*
 CTCPListenSocket::accept()
+{
+	CArchNetAddress addr = NULL;
+	IDataSocket* socket = acceptSocket(&addr);
+	if (addr != NULL) {
+		ARCH->closeAddr(addr);
+	}
+	return socket;
+}
+
+IDataSocket*
+CTCPListenSocket::accept(CString& peer)
+{
+	CArchNetAddress addr = NULL;
+	IDataSocket* socket = acceptSocket(&addr);
+	if (addr != NULL) {
+		if (socket != NULL) {
+			peer = ARCH->addrToString(addr);
+		}
+		ARCH->closeAddr(addr);
+	}
+	return socket;
+}
+
+IDataSocket*
+CTCPListenSocket::acceptSocket(CArchNetAddress* addr)
 {
 	IDataSocket* socket = NULL;
 	try {
-		socket = new CTCPSocket(m_events, m_socketMultiplexer, ARCH->acceptSocket(m_socket, NULL));
+		socket = new CTCPSocket(m_events, m_socketMultiplexer,
+						ARCH->acceptSocket(m_socket, addr), m_family);
 		if (socket != NULL) {
 			m_socketMultiplexer->addSocket(this,
 							new TSocketMultiplexerMethodJob<CTCPListenSocket>(
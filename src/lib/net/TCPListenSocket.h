@@ -32,7 +32,8 @@ A listen socket using TCP.
 */
 class CTCPListenSocket : public IListenSocket {
 public:
-	CTCPListenSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer);
+	CTCPListenSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer,
+				IArchNetwork::EAddressFamily family = IArchNetwork::kINET);
 	~CTCPListenSocket();
 
 	// ISocket overrides
@@ -42,8 +43,11 @@ public:
 
 	// IListenSocket overrides
 	virtual IDataSocket*	accept();
+	virtual IDataSocket*	accept(CString& peer);
 
 private:
+	IDataSocket*		acceptSocket(CArchNetAddress* addr);
+
 	ISocketMultiplexerJob*
 						serviceListening(ISocketMultiplexerJob*,
 							bool, bool, bool);
@@ -53,4 +57,5 @@ private:
 	CMutex*				m_mutex;
 	IEventQueue*		m_events;
 	CSocketMultiplexer* m_socketMultiplexer;
+	IArchNetwork::EAddressFamily	m_family;
 };
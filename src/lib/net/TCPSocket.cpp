@@ -26,6 +26,7 @@
 #include "arch/Arch.h"
 #include "arch/XArch.h"
 #include "base/Log.h"
+#include "base/Metrics.h"
 #include "base/IEventQueue.h"
 #include "base/IEventJob.h"
 
@@ -33,11 +34,18 @@
 #include <cstdlib>
 #include <memory>
 
+static CCounter			s_bytesRead("net.bytesRead");
+static CCounter			s_bytesWritten("net.bytesWritten");
+static CGauge			s_sockets("net.sockets");
+static CHistogram		s_outputBuffered("net.outputBuffered");
+static CHistogram		s_connectionBytes("net.connectionBytes");
+
 //
 // CTCPSocket
 //
 
-CTCPSocket::CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer) :
+CTCPSocket::CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer,
+				IArchNetwork::EAddressFamily family) :
 	IDataSocket(events),
 	m_mutex(),
 	m_flushed(&m_mutex, true),
@@ -45,16 +53,18 @@ CTCPSocket::CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexe
 	m_socketMultiplexer(socketMultiplexer)
 {
 	try {
-		m_socket = ARCH->newSocket(IArchNetwork::kINET, IArchNetwork::kSTREAM);
+		m_socket = ARCH->newSocket(family, IArchNetwork::kSTREAM);
 	}
 	catch (XArchNetwork& e) {
 		throw XSocketCreate(e.what());
 	}
 
-	init();
+	init(family);
+	s_sockets.add(1);
 }
 
-CTCPSocket::CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer, CArchSocket socket) :
+CTCPSocket::CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer, CArchSocket socket,
+				IArchNetwork::EAddressFamily family) :
 	IDataSocket(events),
 	m_mutex(),
 	m_socket(socket),
@@ -65,7 +75,8 @@ CTCPSocket::CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexe
 	assert(m_socket != NULL);
 
 	// socket starts in connected state
-	init();
+	init(family);
+	s_sockets.add(1);
 	onConnected();
 	setJob(newJob());
 }
@@ -78,6 +89,7 @@ CTCPSocket::~CTCPSocket()
 	catch (...) {
 		// ignore
 	}
+	s_sockets.add(-1);
 }
 
 void
@@ -110,6 +122,12 @@ CTCPSocket::close()
 
 	// close the socket
 	if (m_socket != NULL) {
+		// sockets that never connected would swamp the ones that did
+		if (m_bytes != 0) {
+			s_connectionBytes.record(m_bytes);
+		}
+
+
 		CArchSocket socket = m_socket;
 		m_socket = NULL;
 		try {
@@ -137,10 +155,12 @@ CTCPSocket::read(void* buffer, UInt32 n)
 	if (n > size) {
 		n = size;
 	}
-	if (buffer != NULL && n != 0) {
-		memcpy(buffer, m_inputBuffer.peek(n), n);
+	if (buffer != NULL) {
+		m_inputBuffer.read(buffer, n);
+	}
+	else {
+		m_inputBuffer.pop(n);
 	}
-	m_inputBuffer.pop(n);
 
 	// if no more data and we cannot read or write then send disconnected
 	if (n > 0 && m_inputBuffer.getSize() == 0 && !m_readable && !m_writable) {
@@ -172,6 +192,44 @@ CTCPSocket::write(const void* buffer, UInt32 n)
 		// copy data to the output buffer
 		wasEmpty = (m_outputBuffer.getSize() == 0);
 		m_outputBuffer.write(buffer, n);
+		s_outputBuffered.record(m_outputBuffer.getSize());
+
+		// there's data to write
+		m_flushed = false;
+	}
+
+	// make sure we're waiting to write
+	if (wasEmpty) {
+		setJob(newJob());
+	}
+}
+
+void
+CTCPSocket::writeBuffers(const CSharedBufferList& buffers)
+{
+	bool wasEmpty;
+	{
+		CLock lock(&m_mutex);
+
+		// must not have shutdown output
+		if (!m_writable) {
+			sendEvent(m_events->forIStream().outputError());
+			return;
+		}
+
+		// queue data on the output buffer.  large buffers are queued
+		// by reference, not copied.
+		wasEmpty = (m_outputBuffer.getSize() == 0);
+		for (CSharedBufferList::const_iterator i = buffers.begin();
+								i != buffers.end(); ++i) {
+			m_outputBuffer.write(*i);
+		}
+
+		// ignore empty writes
+		if (m_outputBuffer.getSize() == 0) {
+			return;
+		}
+		s_outputBuffered.record(m_outputBuffer.getSize());
 
 		// there's data to write
 		m_flushed = false;
@@ -290,12 +348,18 @@ CTCPSocket::connect(const CNetworkAddress& addr)
 }
 
 void
-CTCPSocket::init()
+CTCPSocket::init(IArchNetwork::EAddressFamily family)
 {
 	// default state
 	m_connected = false;
 	m_readable  = false;
 	m_writable  = false;
+	m_bytes     = 0;
+
+	// local sockets have no Nagle algorithm
+	if (family != IArchNetwork::kINET) {
+		return;
+	}
 
 	try {
 		// turn off Nagle algorithm.  we send lots of very short messages
@@ -464,13 +528,16 @@ CTCPSocket::serviceConnected(ISocketMultiplexerJob* job,
 
 	if (write) {
 		try {
-			// write data
-			UInt32 n = m_outputBuffer.getSize();
+			// write data, up to the next shared buffer so it needn't
+			// be copied
+			UInt32 n = m_outputBuffer.getRunSize();
 			const void* buffer = m_outputBuffer.peek(n);
 			n = (UInt32)ARCH->writeSocket(m_socket, buffer, n);
 
 			// discard written data
 			if (n > 0) {
+				s_bytesWritten.add(n);
+				m_bytes += n;
 				m_outputBuffer.pop(n);
 				if (m_outputBuffer.getSize() == 0) {
 					sendEvent(m_events->forIStream().outputFlushed());
@@ -516,6 +583,8 @@ CTCPSocket::serviceConnected(ISocketMultiplexerJob* job,
 
 				// slurp up as much as possible
 				do {
+					s_bytesRead.add(n);
+					m_bytes += n;
 					m_inputBuffer.write(buffer, (UInt32)n);
 					n = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
 				} while (n > 0);
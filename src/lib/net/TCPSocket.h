@@ -32,12 +32,15 @@ class CSocketMultiplexer;
 
 //! TCP data socket
 /*!
-A data socket using TCP.
+A data socket using TCP.  A socket in the IArchNetwork::kUNIX family
+is a local stream socket that works the same way.
 */
 class CTCPSocket : public IDataSocket {
 public:
-	CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer);
-	CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer, CArchSocket socket);
+	CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer,
+				IArchNetwork::EAddressFamily family = IArchNetwork::kINET);
+	CTCPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer, CArchSocket socket,
+				IArchNetwork::EAddressFamily family = IArchNetwork::kINET);
 	~CTCPSocket();
 
 	// ISocket overrides
@@ -48,6 +51,7 @@ public:
 	// IStream overrides
 	virtual UInt32		read(void* buffer, UInt32 n);
 	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		writeBuffers(const CSharedBufferList& buffers);
 	virtual void		flush();
 	virtual void		shutdownInput();
 	virtual void		shutdownOutput();
@@ -58,7 +62,7 @@ public:
 	virtual void		connect(const CNetworkAddress&);
 
 private:
-	void				init();
+	void				init(IArchNetwork::EAddressFamily family);
 
 	void				setJob(ISocketMultiplexerJob*);
 	ISocketMultiplexerJob*	newJob();
@@ -86,6 +90,7 @@ private:
 	bool				m_connected;
 	bool				m_readable;
 	bool				m_writable;
+	UInt64				m_bytes;
 	IEventQueue*		m_events;
 	CSocketMultiplexer* m_socketMultiplexer;
 };
@@ -20,6 +20,7 @@
 
 #include "net/TCPSocket.h"
 #include "net/TCPListenSocket.h"
+#include "net/UDPSocket.h"
 
 //
 // CTCPSocketFactory
@@ -48,3 +49,9 @@ CTCPSocketFactory::createListen() const
 {
 	return new CTCPListenSocket(m_events, m_socketMultiplexer);
 }
+
+IDatagramSocket*
+CTCPSocketFactory::createDatagram() const
+{
+	return new CUDPSocket(m_events, m_socketMultiplexer);
+}
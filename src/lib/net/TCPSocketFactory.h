@@ -24,6 +24,9 @@ class IEventQueue;
 class CSocketMultiplexer;
 
 //! Socket factory for TCP sockets
+/*!
+Datagram sockets use UDP.
+*/
 class CTCPSocketFactory : public ISocketFactory {
 public:
 	CTCPSocketFactory(IEventQueue* events, CSocketMultiplexer* socketMultiplexer);
@@ -32,6 +35,7 @@ public:
 	// ISocketFactory overrides
 	virtual IDataSocket*	create() const;
 	virtual IListenSocket*	createListen() const;
+	virtual IDatagramSocket*	createDatagram() const;
 
 private:
 	IEventQueue*		m_events;
@@ -0,0 +1,196 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "net/UDPSocket.h"
+
+#include "net/SocketMultiplexer.h"
+#include "net/TSocketMultiplexerMethodJob.h"
+#include "net/XSocket.h"
+#include "io/XIO.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "arch/Arch.h"
+#include "arch/XArch.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+
+// the largest datagram we read
+static const size_t		s_maxDatagramSize = 2048;
+
+// datagrams waiting beyond this many are dropped, oldest first
+static const size_t		s_maxQueued = 1024;
+
+//
+// CUDPSocket
+//
+
+CUDPSocket::CUDPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer) :
+	m_events(events),
+	m_socketMultiplexer(socketMultiplexer)
+{
+	m_mutex = new CMutex;
+	try {
+		m_socket = ARCH->newSocket(IArchNetwork::kINET, IArchNetwork::kDGRAM);
+	}
+	catch (XArchNetwork& e) {
+		delete m_mutex;
+		throw XSocketCreate(e.what());
+	}
+
+	// an unbound socket is bound to any port by the first send, after
+	// which replies can arrive
+	m_socketMultiplexer->addSocket(this,
+							new TSocketMultiplexerMethodJob<CUDPSocket>(
+								this, &CUDPSocket::serviceReadable,
+								m_socket, true, false));
+}
+
+CUDPSocket::~CUDPSocket()
+{
+	try {
+		if (m_socket != NULL) {
+			m_socketMultiplexer->removeSocket(this);
+			ARCH->closeSocket(m_socket);
+		}
+	}
+	catch (...) {
+		// ignore
+	}
+	delete m_mutex;
+}
+
+void
+CUDPSocket::bind(const CNetworkAddress& addr)
+{
+	try {
+		CLock lock(m_mutex);
+		ARCH->setReuseAddrOnSocket(m_socket, true);
+		ARCH->bindSocket(m_socket, addr.getAddress());
+	}
+	catch (XArchNetworkAddressInUse& e) {
+		throw XSocketAddressInUse(e.what());
+	}
+	catch (XArchNetwork& e) {
+		throw XSocketBind(e.what());
+	}
+}
+
+void
+CUDPSocket::close()
+{
+	// stop servicing first.  the service thread takes the lock.
+	m_socketMultiplexer->removeSocket(this);
+
+	CLock lock(m_mutex);
+	if (m_socket == NULL) {
+		throw XIOClosed();
+	}
+	try {
+		ARCH->closeSocket(m_socket);
+		m_socket = NULL;
+	}
+	catch (XArchNetwork& e) {
+		throw XSocketIOClose(e.what());
+	}
+}
+
+void*
+CUDPSocket::getEventTarget() const
+{
+	return const_cast<void*>(reinterpret_cast<const void*>(this));
+}
+
+void
+CUDPSocket::sendTo(const void* data, UInt32 n, const CNetworkAddress& address)
+{
+	CLock lock(m_mutex);
+	if (m_socket == NULL) {
+		return;
+	}
+	try {
+		if (ARCH->writeToSocket(m_socket, data, n, address.getAddress()) == 0) {
+			LOG((CLOG_DEBUG2 "dropped datagram of %d bytes", n));
+		}
+	}
+	catch (XArchNetwork& e) {
+		// datagrams are allowed to go missing
+		LOG((CLOG_DEBUG "cannot send datagram: %s", e.what()));
+	}
+}
+
+bool
+CUDPSocket::receive(CString& data, CNetworkAddress& from)
+{
+	CLock lock(m_mutex);
+	if (m_received.empty()) {
+		return false;
+	}
+	data.swap(m_received.front().m_data);
+	from = m_received.front().m_from;
+	m_received.pop_front();
+	return true;
+}
+
+ISocketMultiplexerJob*
+CUDPSocket::serviceReadable(ISocketMultiplexerJob* job, bool read, bool, bool)
+{
+	if (!read) {
+		return job;
+	}
+
+	bool ready;
+	{
+		CLock lock(m_mutex);
+		bool wasEmpty = m_received.empty();
+		char buffer[s_maxDatagramSize];
+		try {
+			for (;;) {
+				CArchNetAddress from = NULL;
+				size_t n = ARCH->readFromSocket(m_socket,
+							buffer, sizeof(buffer), &from);
+				if (n == 0) {
+					if (from != NULL) {
+						ARCH->closeAddr(from);
+					}
+					break;
+				}
+				if (n > sizeof(buffer)) {
+					n = sizeof(buffer);
+				}
+				m_received.push_back(CDatagram());
+				m_received.back().m_data.assign(buffer, n);
+				m_received.back().m_from = CNetworkAddress(from);
+				ARCH->closeAddr(from);
+				if (m_received.size() > s_maxQueued) {
+					m_received.pop_front();
+				}
+			}
+		}
+		catch (XArchNetwork& e) {
+			// e.g. an earlier datagram was refused.  keep listening.
+			LOG((CLOG_DEBUG2 "datagram read error: %s", e.what()));
+		}
+		ready = (wasEmpty && !m_received.empty());
+	}
+
+	if (ready) {
+		m_events->addEvent(CEvent(m_events->forIStream().inputReady(),
+							getEventTarget(), NULL));
+	}
+	return job;
+}
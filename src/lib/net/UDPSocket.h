@@ -0,0 +1,69 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "net/IDatagramSocket.h"
+#include "net/NetworkAddress.h"
+#include "arch/IArchNetwork.h"
+#include "common/stddeque.h"
+
+class CMutex;
+class CSocketMultiplexer;
+class IEventQueue;
+class ISocketMultiplexerJob;
+
+//! UDP socket
+/*!
+A datagram socket using UDP.  Datagrams are read on the socket
+multiplexer's thread and queued until received.
+*/
+class CUDPSocket : public IDatagramSocket {
+public:
+	CUDPSocket(IEventQueue* events, CSocketMultiplexer* socketMultiplexer);
+	~CUDPSocket();
+
+	// ISocket overrides
+	virtual void		bind(const CNetworkAddress&);
+	virtual void		close();
+	virtual void*		getEventTarget() const;
+
+	// IDatagramSocket overrides
+	virtual void		sendTo(const void* data, UInt32 n,
+							const CNetworkAddress& address);
+	virtual bool		receive(CString& data, CNetworkAddress& from);
+
+private:
+	class CDatagram {
+	public:
+		CString			m_data;
+		CNetworkAddress	m_from;
+	};
+	typedef std::deque<CDatagram> CDatagramQueue;
+
+	ISocketMultiplexerJob*
+						serviceReadable(ISocketMultiplexerJob*,
+							bool, bool, bool);
+
+private:
+	CArchSocket			m_socket;
+	CMutex*				m_mutex;
+	IEventQueue*		m_events;
+	CSocketMultiplexer* m_socketMultiplexer;
+	CDatagramQueue		m_received;
+};
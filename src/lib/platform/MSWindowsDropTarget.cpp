@@ -91,9 +91,9 @@ CMSWindowsDropTarget::queryDataObject(IDataObject* dataObject)
 }
 
 void
-CMSWindowsDropTarget::setDraggingFilename(char* const filename)
+CMSWindowsDropTarget::setDraggingFilename(const std::string& filenames)
 {
-	m_dragFilename = filename;
+	m_dragFilename = filenames;
 }
 
 std::string
@@ -122,23 +122,28 @@ getDropData(IDataObject* dataObject)
 			PVOID data = GlobalLock(stgMed.hGlobal);
 
 			// data object global handler contains:
-			// DROPFILESfilename1 filename2 two spaces as the end
-			// TODO: get multiple filenames
+			// DROPFILES filename1\0filename2\0\0
+			std::string filenames;
 			wchar_t* wcData = (wchar_t*)((LPBYTE)data + sizeof(DROPFILES));
-
-			// convert wchar to char
-			char* filename = new char[wcslen(wcData) + 1];
-			filename[wcslen(wcData)] = '\0';
-			wcstombs(filename, wcData, wcslen(wcData));
-
-			CMSWindowsDropTarget::instance().setDraggingFilename(filename);
+			while (*wcData != L'\0') {
+				// convert wchar to char
+				size_t length = wcslen(wcData);
+				char* filename = new char[length + 1];
+				filename[length] = '\0';
+				wcstombs(filename, wcData, length);
+				filenames.append(filename);
+				filenames.append("\n");
+				delete[] filename;
+
+				wcData += length + 1;
+			}
+
+			CMSWindowsDropTarget::instance().setDraggingFilename(filenames);
 			
 			GlobalUnlock(stgMed.hGlobal);
 
 			// release the data using the COM API
 			ReleaseStgMedium(&stgMed);
-
-			delete[] filename;
 		}
 	}
 }
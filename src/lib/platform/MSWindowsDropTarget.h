@@ -40,7 +40,7 @@ public:
 	HRESULT __stdcall	DragLeave(void);
 	HRESULT __stdcall	Drop(IDataObject* dataObject, DWORD keyState, POINTL point, DWORD* effect);
 
-	void				setDraggingFilename(char* const);
+	void				setDraggingFilename(const std::string& filenames);
 	std::string			getDraggingFilename();
 	void				clearDraggingFilename();
 
@@ -383,14 +383,18 @@ void
 CMSWindowsScreen::sendDragThread(void*)
 {
 	CString& draggingFilename = getDraggingFilename();
-	size_t size = draggingFilename.size();
 
 	if (draggingFilename.empty() == false) {
 		CClientApp& app = CClientApp::instance();
 		CClient* client = app.getClientPtr();
-		UInt32 fileCount = 1;
-		LOG((CLOG_DEBUG "send dragging info to server: %s", draggingFilename.c_str()));
-		client->sendDragInfo(fileCount, draggingFilename, size);
+
+		CDragFileList dragFileList;
+		CDragInformation::splitFilenames(dragFileList, draggingFilename);
+		CString info;
+		UInt32 fileCount = CDragInformation::setupDragInfo(
+			dragFileList, info);
+		LOG((CLOG_DEBUG "send dragging info to server: %s", info.c_str()));
+		client->sendDragInfo(fileCount, info, info.size());
 		LOG((CLOG_DEBUG "send dragging file to server"));
 		client->sendFileToServer(draggingFilename.c_str());
 	}
@@ -1910,11 +1914,18 @@ CMSWindowsScreen::getDraggingFilename()
 		ShowWindow(m_dropWindow, SW_HIDE);
 
 		if (!filename.empty()) {
-			if (CDragInformation::isFileValid(filename)) {
-				m_draggingFilename = filename;
-			}
-			else {
-				LOG((CLOG_DEBUG "drag file name is invalid: %s", filename.c_str()));
+			// send the files that can be read, one per line
+			CDragFileList dragFileList;
+			CDragInformation::splitFilenames(dragFileList, filename);
+			for (size_t i = 0; i < dragFileList.size(); ++i) {
+				CString& name = dragFileList[i].getFilename();
+				if (CDragInformation::isFileValid(name)) {
+					m_draggingFilename.append(name);
+					m_draggingFilename.append("\n");
+				}
+				else {
+					LOG((CLOG_DEBUG "drag file name is invalid: %s", name.c_str()));
+				}
 			}
 		}
 
@@ -915,18 +915,13 @@ COSXScreen::leave()
 				CClientApp& app = CClientApp::instance();
 				CClient* client = app.getClientPtr();
 				
-				CDragInformation di;
-				di.setFilename(fileList);
 				CDragFileList dragFileList;
-				dragFileList.push_back(di);
+				CDragInformation::splitFilenames(dragFileList, fileList);
 				CString info;
 				UInt32 fileCount = CDragInformation::setupDragInfo(
 					dragFileList, info);
 				client->sendDragInfo(fileCount, info, info.size());
 				LOG((CLOG_DEBUG "send dragging file to server"));
-				
-				// TODO: what to do with multiple file or even
-				// a folder
 				client->sendFileToServer(fileList.c_str());
 			}
 		}
@@ -0,0 +1,228 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/VirtualInput.h"
+#include "base/Log.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+//
+// CVirtualInput
+//
+
+CVirtualInput::CVirtualInput()
+{
+	// do nothing
+}
+
+CVirtualInput::~CVirtualInput()
+{
+	// do nothing
+}
+
+bool
+CVirtualInput::load(const CString& path)
+{
+	std::ifstream file(path.c_str());
+	if (!file.is_open()) {
+		LOG((CLOG_ERR "cannot open virtual input \"%s\"", path.c_str()));
+		m_actions.clear();
+		return false;
+	}
+	return parse(file);
+}
+
+bool
+CVirtualInput::parse(std::istream& stream)
+{
+	m_actions.clear();
+	m_repeats.clear();
+
+	bool result = true;
+	UInt32 lineNumber = 0;
+	std::string line;
+	while (std::getline(stream, line)) {
+		++lineNumber;
+		if (!parseLine(line)) {
+			LOG((CLOG_WARN "virtual input line %d ignored: %s",
+				lineNumber, line.c_str()));
+			result = false;
+		}
+	}
+
+	// close unterminated repeats
+	if (!m_repeats.empty()) {
+		LOG((CLOG_WARN "virtual input has %d repeats without end",
+			m_repeats.size()));
+		result = false;
+		while (!m_repeats.empty()) {
+			CAction action(kEnd);
+			action.m_index = m_repeats.back();
+			action.m_count = m_actions[action.m_index].m_count;
+			m_actions.push_back(action);
+			m_repeats.pop_back();
+		}
+	}
+
+	return result;
+}
+
+UInt32
+CVirtualInput::getSize() const
+{
+	return (UInt32)m_actions.size();
+}
+
+const CVirtualInput::CAction&
+CVirtualInput::get(UInt32 index) const
+{
+	assert(index < m_actions.size());
+	return m_actions[index];
+}
+
+bool
+CVirtualInput::parseLine(const CString& line)
+{
+	std::istringstream tokens(line);
+	CString command;
+	if (!(tokens >> command) || command[0] == '#') {
+		// blank or comment
+		return true;
+	}
+
+	if (command == "move" || command == "rmove" || command == "wheel") {
+		CAction action(command == "move" ? kMove :
+					(command == "rmove" ? kRelativeMove : kWheel));
+		if (!(tokens >> action.m_x >> action.m_y)) {
+			return false;
+		}
+		m_actions.push_back(action);
+	}
+
+	else if (command == "down" || command == "up") {
+		CAction action(command == "down" ? kButtonDown : kButtonUp);
+		int button;
+		if (!(tokens >> button) || button <= 0 || button >= 256) {
+			return false;
+		}
+		action.m_button = static_cast<ButtonID>(button);
+		m_actions.push_back(action);
+	}
+
+	else if (command == "keydown" || command == "keyup" || command == "key") {
+		CAction action(command == "keyup" ? kKeyUp : kKeyDown);
+		CString key, mask;
+		if (!(tokens >> key) || !parseKey(key, action.m_key)) {
+			return false;
+		}
+		if (tokens >> mask) {
+			action.m_mask = static_cast<KeyModifierMask>(
+								strtoul(mask.c_str(), NULL, 0));
+		}
+		m_actions.push_back(action);
+		if (command == "key") {
+			action.m_type = kKeyUp;
+			m_actions.push_back(action);
+		}
+	}
+
+	else if (command == "clipboard") {
+		CAction action(kClipboard);
+		std::getline(tokens >> std::ws, action.m_text);
+		m_actions.push_back(action);
+	}
+
+	else if (command == "wait") {
+		CAction action(kWait);
+		double ms;
+		if (!(tokens >> ms) || ms < 0.0) {
+			return false;
+		}
+		action.m_wait = 1.0e-3 * ms;
+		m_actions.push_back(action);
+	}
+
+	else if (command == "repeat") {
+		CAction action(kRepeat);
+		if (!(tokens >> action.m_count)) {
+			return false;
+		}
+		m_repeats.push_back((UInt32)m_actions.size());
+		m_actions.push_back(action);
+	}
+
+	else if (command == "end") {
+		if (m_repeats.empty()) {
+			return false;
+		}
+		CAction action(kEnd);
+		action.m_index = m_repeats.back();
+		action.m_count = m_actions[action.m_index].m_count;
+		m_repeats.pop_back();
+		m_actions.push_back(action);
+	}
+
+	else if (command == "quit") {
+		m_actions.push_back(CAction(kQuit));
+	}
+
+	else {
+		return false;
+	}
+
+	return true;
+}
+
+bool
+CVirtualInput::parseKey(const CString& token, KeyID& key)
+{
+	// a single character is itself
+	if (token.size() == 1) {
+		key = static_cast<unsigned char>(token[0]);
+		return true;
+	}
+
+	// otherwise a number
+	char* end;
+	unsigned long value = strtoul(token.c_str(), &end, 0);
+	if (*end != '\0' || value == 0) {
+		return false;
+	}
+	key = static_cast<KeyID>(value);
+	return true;
+}
+
+
+//
+// CVirtualInput::CAction
+//
+
+CVirtualInput::CAction::CAction(EType type) :
+	m_type(type),
+	m_x(0),
+	m_y(0),
+	m_button(kButtonNone),
+	m_wait(0.0),
+	m_key(kKeyNone),
+	m_mask(0),
+	m_index(0),
+	m_count(0)
+{
+	// do nothing
+}
@@ -0,0 +1,134 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/key_types.h"
+#include "synergy/mouse_types.h"
+#include "base/String.h"
+#include "common/stdvector.h"
+
+#include <iosfwd>
+
+//! Scripted user input
+/*!
+A list of input actions for a CVirtualScreen to play back as if a user
+had made them.  Scripts are text, one action per line;  blank lines and
+lines starting with \c # are ignored:
+
+\code
+move <x> <y>              move the cursor to x,y
+rmove <dx> <dy>           move the cursor by dx,dy
+down <button>             press a mouse button (1 = left)
+up <button>               release a mouse button
+wheel <dx> <dy>           turn the mouse wheel
+keydown <key> [<mask>]    press a key
+keyup <key> [<mask>]      release a key
+key <key> [<mask>]        press and release a key
+clipboard <text>          take the clipboard with text to end of line
+wait <ms>                 wait before the next action
+repeat <n>                play the actions up to the matching end n times
+end
+quit                      stop synergy
+\endcode
+
+A key is a single character or a KeyID number (e.g. 0xef0d for
+Return), and a mask is a KeyModifierMask number.
+*/
+class CVirtualInput {
+public:
+	enum EType {
+		kMove,
+		kRelativeMove,
+		kButtonDown,
+		kButtonUp,
+		kWheel,
+		kKeyDown,
+		kKeyUp,
+		kClipboard,
+		kWait,
+		kRepeat,
+		kEnd,
+		kQuit
+	};
+
+	//! One scripted action
+	class CAction {
+	public:
+		CAction(EType type);
+
+	public:
+		EType			m_type;
+
+		// position or delta for the mouse, the button, or the time to
+		// wait in seconds
+		SInt32			m_x, m_y;
+		ButtonID		m_button;
+		double			m_wait;
+
+		// the key, or for kEnd the index of the kRepeat and the count
+		KeyID			m_key;
+		KeyModifierMask	m_mask;
+		UInt32			m_index;
+		UInt32			m_count;
+
+		// clipboard text
+		CString			m_text;
+	};
+
+	CVirtualInput();
+	~CVirtualInput();
+
+	//! @name manipulators
+	//@{
+
+	//! Load a script file
+	/*!
+	Replaces the actions with those in the file at \c path.  Returns
+	false if the file can't be read or has errors, which are logged.
+	*/
+	bool				load(const CString& path);
+
+	//! Parse a script
+	/*!
+	Replaces the actions with those read from \c stream.  Lines with
+	errors are logged and skipped;  returns false if there were any.
+	*/
+	bool				parse(std::istream& stream);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get number of actions
+	UInt32				getSize() const;
+
+	//! Get an action
+	const CAction&		get(UInt32 index) const;
+
+	//@}
+
+private:
+	bool				parseLine(const CString& line);
+	static bool			parseKey(const CString& token, KeyID& key);
+
+private:
+	typedef std::vector<CAction> CActionList;
+
+	CActionList			m_actions;
+	std::vector<UInt32>	m_repeats;
+};
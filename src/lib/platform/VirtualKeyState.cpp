@@ -0,0 +1,114 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/VirtualKeyState.h"
+
+// editing keys, mapped to the buttons after the Latin-1 characters
+static const KeyID		s_editingKeys[] = {
+	kKeyBackSpace, kKeyTab, kKeyReturn, kKeyEscape, kKeyDelete,
+	kKeyHome, kKeyLeft, kKeyUp, kKeyRight, kKeyDown, kKeyEnd
+};
+static const UInt32		s_numEditingKeys =
+							sizeof(s_editingKeys) / sizeof(s_editingKeys[0]);
+
+//
+// CVirtualKeyState
+//
+
+CVirtualKeyState::CVirtualKeyState(IEventQueue* events) :
+	CKeyState(events)
+{
+	// do nothing
+}
+
+CVirtualKeyState::~CVirtualKeyState()
+{
+	// do nothing
+}
+
+KeyButton
+CVirtualKeyState::mapKeyToButton(KeyID id)
+{
+	if (id >= 0x20 && id <= 0xff) {
+		return static_cast<KeyButton>(id);
+	}
+	for (UInt32 i = 0; i < s_numEditingKeys; ++i) {
+		if (s_editingKeys[i] == id) {
+			return static_cast<KeyButton>(0x100 + i);
+		}
+	}
+	return 0;
+}
+
+bool
+CVirtualKeyState::fakeCtrlAltDel()
+{
+	// nothing to interrupt
+	return true;
+}
+
+KeyModifierMask
+CVirtualKeyState::pollActiveModifiers() const
+{
+	return getActiveModifiers();
+}
+
+SInt32
+CVirtualKeyState::pollActiveGroup() const
+{
+	return 0;
+}
+
+void
+CVirtualKeyState::pollPressedKeys(KeyButtonSet& pressedKeys) const
+{
+	for (KeyButton button = 1; button < kNumButtons; ++button) {
+		if (isKeyDown(button)) {
+			pressedKeys.insert(button);
+		}
+	}
+}
+
+void
+CVirtualKeyState::getKeyMap(CKeyMap& keyMap)
+{
+	CKeyMap::KeyItem item;
+	item.m_group     = 0;
+	item.m_required  = 0;
+	item.m_sensitive = 0;
+	item.m_generates = 0;
+	item.m_dead      = false;
+	item.m_lock      = false;
+	item.m_client    = 0;
+
+	for (KeyID id = 0x20; id <= 0xff; ++id) {
+		item.m_id     = id;
+		item.m_button = mapKeyToButton(id);
+		keyMap.addKeyEntry(item);
+	}
+	for (UInt32 i = 0; i < s_numEditingKeys; ++i) {
+		item.m_id     = s_editingKeys[i];
+		item.m_button = mapKeyToButton(item.m_id);
+		keyMap.addKeyEntry(item);
+	}
+}
+
+void
+CVirtualKeyState::fakeKey(const Keystroke&)
+{
+	// nothing to synthesize.  CVirtualScreen records the keys.
+}
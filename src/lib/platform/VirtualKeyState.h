@@ -0,0 +1,58 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/KeyState.h"
+
+class IEventQueue;
+
+//! Virtual screen key state
+/*!
+A key state for CVirtualScreen.  The keyboard map has a button for each
+Latin-1 character and for a few editing keys, none of which need
+modifiers, and the pressed keys are whatever was last faked or
+reported.
+*/
+class CVirtualKeyState : public CKeyState {
+public:
+	CVirtualKeyState(IEventQueue* events);
+	~CVirtualKeyState();
+
+	//! @name accessors
+	//@{
+
+	//! Get button for a key
+	/*!
+	Returns the button that \p id is mapped to, or 0 if none.
+	*/
+	static KeyButton	mapKeyToButton(KeyID id);
+
+	//@}
+
+	// IKeyState overrides
+	virtual bool		fakeCtrlAltDel();
+	virtual KeyModifierMask
+						pollActiveModifiers() const;
+	virtual SInt32		pollActiveGroup() const;
+	virtual void		pollPressedKeys(KeyButtonSet& pressedKeys) const;
+
+protected:
+	// CKeyState overrides
+	virtual void		getKeyMap(CKeyMap& keyMap);
+	virtual void		fakeKey(const Keystroke& keystroke);
+};
@@ -0,0 +1,609 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/VirtualScreen.h"
+
+#include "platform/VirtualKeyState.h"
+#include "synergy/Clipboard.h"
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// most input actions to post before letting the event queue catch up
+static const UInt32		s_inputBurst = 64;
+
+// shortest wait between input actions
+static const double		s_minInputDelay = 1.0e-6;
+
+//
+// CVirtualScreen
+//
+
+CVirtualScreen::CVirtualScreen(IEventQueue* events, bool isPrimary,
+				SInt32 width, SInt32 height,
+				const CString& inputPath, const CString& recordPath) :
+	CPlatformScreen(events),
+	m_isPrimary(isPrimary),
+	m_isOnScreen(isPrimary),
+	m_enabled(false),
+	m_w(width),
+	m_h(height),
+	m_xCursor(width / 2),
+	m_yCursor(height / 2),
+	m_nextHotKey(0),
+	m_sequenceNumber(0),
+	m_keyState(NULL),
+	m_inputIndex(0),
+	m_inputTimer(NULL),
+	m_record(NULL),
+	m_recordFile(NULL),
+	m_numInjected(0),
+	m_events(events)
+{
+	assert(m_w > 0 && m_h > 0);
+
+	memset(m_buttons, 0, sizeof(m_buttons));
+	m_keyState = new CVirtualKeyState(m_events);
+	updateKeyMap();
+
+	if (!inputPath.empty()) {
+		m_input.load(inputPath);
+		m_repeated.assign(m_input.getSize(), 0);
+	}
+	if (!recordPath.empty()) {
+		m_recordFile = new std::ofstream(recordPath.c_str());
+		if (!m_recordFile->is_open()) {
+			LOG((CLOG_ERR "cannot write virtual record \"%s\"", recordPath.c_str()));
+		}
+		else {
+			m_record = m_recordFile;
+		}
+	}
+
+	LOG((CLOG_NOTE "virtual %s screen %dx%d",
+		m_isPrimary ? "primary" : "secondary", m_w, m_h));
+}
+
+CVirtualScreen::~CVirtualScreen()
+{
+	stopInput();
+	delete m_keyState;
+	delete m_recordFile;
+}
+
+void
+CVirtualScreen::setInput(const CVirtualInput& input)
+{
+	stopInput();
+	m_input      = input;
+	m_inputIndex = 0;
+	m_repeated.assign(m_input.getSize(), 0);
+	if (m_enabled) {
+		startInput();
+	}
+}
+
+void
+CVirtualScreen::setRecord(std::ostream* stream)
+{
+	m_record = stream;
+}
+
+UInt32
+CVirtualScreen::getNumInjected() const
+{
+	return m_numInjected;
+}
+
+bool
+CVirtualScreen::isInputFinished() const
+{
+	return (m_inputIndex >= m_input.getSize());
+}
+
+void*
+CVirtualScreen::getEventTarget() const
+{
+	return const_cast<CVirtualScreen*>(this);
+}
+
+bool
+CVirtualScreen::getClipboard(ClipboardID id, IClipboard* clipboard) const
+{
+	assert(clipboard != NULL);
+	assert(id < kClipboardEnd);
+
+	return CClipboard::copy(clipboard, &m_clipboard[id]);
+}
+
+void
+CVirtualScreen::getShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h) const
+{
+	x = 0;
+	y = 0;
+	w = m_w;
+	h = m_h;
+}
+
+void
+CVirtualScreen::getCursorPos(SInt32& x, SInt32& y) const
+{
+	x = m_xCursor;
+	y = m_yCursor;
+}
+
+void
+CVirtualScreen::reconfigure(UInt32)
+{
+	// do nothing
+}
+
+void
+CVirtualScreen::warpCursor(SInt32 x, SInt32 y)
+{
+	m_xCursor = x;
+	m_yCursor = y;
+}
+
+UInt32
+CVirtualScreen::registerHotKey(KeyID, KeyModifierMask)
+{
+	// hot keys are never pressed but must have an id
+	return ++m_nextHotKey;
+}
+
+void
+CVirtualScreen::unregisterHotKey(UInt32)
+{
+	// do nothing
+}
+
+void
+CVirtualScreen::fakeInputBegin()
+{
+	// do nothing
+}
+
+void
+CVirtualScreen::fakeInputEnd()
+{
+	// do nothing
+}
+
+SInt32
+CVirtualScreen::getJumpZoneSize() const
+{
+	return 1;
+}
+
+bool
+CVirtualScreen::isAnyMouseButtonDown(UInt32& buttonID) const
+{
+	for (UInt32 i = 1; i < sizeof(m_buttons) / sizeof(m_buttons[0]); ++i) {
+		if (m_buttons[i]) {
+			buttonID = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+CVirtualScreen::getCursorCenter(SInt32& x, SInt32& y) const
+{
+	x = m_w / 2;
+	y = m_h / 2;
+}
+
+void
+CVirtualScreen::fakeMouseButton(ButtonID id, bool press)
+{
+	m_buttons[id] = press;
+	record("%s %d", press ? "down" : "up", id);
+}
+
+void
+CVirtualScreen::fakeMouseMove(SInt32 x, SInt32 y)
+{
+	m_xCursor = x;
+	m_yCursor = y;
+	record("move %d %d", x, y);
+}
+
+void
+CVirtualScreen::fakeMouseRelativeMove(SInt32 dx, SInt32 dy) const
+{
+	m_xCursor += dx;
+	m_yCursor += dy;
+	record("rmove %d %d", dx, dy);
+}
+
+void
+CVirtualScreen::fakeMouseWheel(SInt32 xDelta, SInt32 yDelta) const
+{
+	record("wheel %d %d", xDelta, yDelta);
+}
+
+void
+CVirtualScreen::fakeKeyDown(KeyID id, KeyModifierMask mask, KeyButton button)
+{
+	record("keydown 0x%04x 0x%04x %d", id, mask, button);
+	CPlatformScreen::fakeKeyDown(id, mask, button);
+}
+
+bool
+CVirtualScreen::fakeKeyRepeat(KeyID id, KeyModifierMask mask,
+				SInt32 count, KeyButton button)
+{
+	record("keyrepeat 0x%04x 0x%04x %d %d", id, mask, count, button);
+	return CPlatformScreen::fakeKeyRepeat(id, mask, count, button);
+}
+
+bool
+CVirtualScreen::fakeKeyUp(KeyButton button)
+{
+	record("keyup %d", button);
+	return CPlatformScreen::fakeKeyUp(button);
+}
+
+void
+CVirtualScreen::enable()
+{
+	m_enabled = true;
+	startInput();
+}
+
+void
+CVirtualScreen::disable()
+{
+	stopInput();
+	m_enabled = false;
+	LOG((CLOG_INFO "virtual screen had %d changes injected", m_numInjected));
+}
+
+void
+CVirtualScreen::enter()
+{
+	m_isOnScreen = true;
+	record("enter");
+}
+
+bool
+CVirtualScreen::leave()
+{
+	m_isOnScreen = false;
+	record("leave");
+	return true;
+}
+
+bool
+CVirtualScreen::setClipboard(ClipboardID id, const IClipboard* clipboard)
+{
+	assert(id < kClipboardEnd);
+
+	if (clipboard == NULL) {
+		// take ownership with no data
+		m_clipboard[id].open(0);
+		m_clipboard[id].empty();
+		m_clipboard[id].close();
+	}
+	else if (!CClipboard::copy(&m_clipboard[id], clipboard)) {
+		return false;
+	}
+
+	UInt32 size = 0;
+	if (m_clipboard[id].open(0)) {
+		if (m_clipboard[id].has(IClipboard::kText)) {
+			size = (UInt32)m_clipboard[id].get(IClipboard::kText).size();
+		}
+		m_clipboard[id].close();
+	}
+	record("clipboard %d %d", id, size);
+	return true;
+}
+
+void
+CVirtualScreen::checkClipboards()
+{
+	// do nothing.  we always know when our clipboard changes.
+}
+
+void
+CVirtualScreen::openScreensaver(bool)
+{
+	// do nothing
+}
+
+void
+CVirtualScreen::closeScreensaver()
+{
+	// do nothing
+}
+
+void
+CVirtualScreen::screensaver(bool activate)
+{
+	record("screensaver %d", activate ? 1 : 0);
+}
+
+void
+CVirtualScreen::resetOptions()
+{
+	// no options
+}
+
+void
+CVirtualScreen::setOptions(const COptionsList&)
+{
+	// no options
+}
+
+void
+CVirtualScreen::setSequenceNumber(UInt32 seqNum)
+{
+	m_sequenceNumber = seqNum;
+}
+
+bool
+CVirtualScreen::isPrimary() const
+{
+	return m_isPrimary;
+}
+
+void
+CVirtualScreen::handleSystemEvent(const CEvent&, void*)
+{
+	// there are no system events
+}
+
+void
+CVirtualScreen::updateButtons()
+{
+	// do nothing
+}
+
+IKeyState*
+CVirtualScreen::getKeyState() const
+{
+	return m_keyState;
+}
+
+void
+CVirtualScreen::sendEvent(CEvent::Type type, void* data)
+{
+	m_events->addEvent(CEvent(type, getEventTarget(), data));
+}
+
+void
+CVirtualScreen::sendClipboardEvent(CEvent::Type type, ClipboardID id)
+{
+	CClipboardInfo* info   = (CClipboardInfo*)malloc(sizeof(CClipboardInfo));
+	info->m_id             = id;
+	info->m_sequenceNumber = m_sequenceNumber;
+	sendEvent(type, info);
+}
+
+void
+CVirtualScreen::startInput()
+{
+	if (m_inputTimer == NULL && !isInputFinished()) {
+		LOG((CLOG_DEBUG "virtual input started"));
+		scheduleInput(0.0);
+	}
+}
+
+void
+CVirtualScreen::stopInput()
+{
+	if (m_inputTimer != NULL) {
+		m_events->removeHandler(CEvent::kTimer, m_inputTimer);
+		m_events->deleteTimer(m_inputTimer);
+		m_inputTimer = NULL;
+	}
+}
+
+void
+CVirtualScreen::scheduleInput(double delay)
+{
+	assert(m_inputTimer == NULL);
+
+	// timers must have a duration.  the shortest still lets the event
+	// queue handle everything already posted first.
+	if (delay < s_minInputDelay) {
+		delay = s_minInputDelay;
+	}
+	m_inputTimer = m_events->newOneShotTimer(delay, NULL);
+	m_events->adoptHandler(CEvent::kTimer, m_inputTimer,
+							new TMethodEventJob<CVirtualScreen>(this,
+								&CVirtualScreen::handleInputTimer));
+}
+
+void
+CVirtualScreen::handleInputTimer(const CEvent&, void*)
+{
+	stopInput();
+	playInput();
+}
+
+void
+CVirtualScreen::playInput()
+{
+	for (UInt32 burst = 0; !isInputFinished(); ) {
+		const UInt32 index = m_inputIndex++;
+		const CVirtualInput::CAction& action = m_input.get(index);
+		switch (action.m_type) {
+		case CVirtualInput::kWait:
+			scheduleInput(action.m_wait);
+			return;
+
+		case CVirtualInput::kRepeat:
+			break;
+
+		case CVirtualInput::kEnd:
+			// go round again unless done.  a count of 0 repeats forever.
+			if (action.m_count == 0 || ++m_repeated[index] < action.m_count) {
+				m_inputIndex = action.m_index + 1;
+			}
+			else {
+				m_repeated[index] = 0;
+			}
+			break;
+
+		case CVirtualInput::kQuit:
+			LOG((CLOG_NOTE "virtual input quit"));
+			m_inputIndex = m_input.getSize();
+			m_events->addEvent(CEvent(CEvent::kQuit));
+			return;
+
+		default:
+			postInput(action);
+			break;
+		}
+
+		// let the events we've posted be handled.  this also keeps an
+		// empty repeat from spinning forever.
+		if (++burst == s_inputBurst) {
+			scheduleInput(0.0);
+			return;
+		}
+	}
+	LOG((CLOG_DEBUG "virtual input finished"));
+}
+
+void
+CVirtualScreen::postInput(const CVirtualInput::CAction& action)
+{
+	// a secondary screen can only change its clipboard
+	if (!m_isPrimary && action.m_type != CVirtualInput::kClipboard) {
+		return;
+	}
+
+	switch (action.m_type) {
+	case CVirtualInput::kMove:
+	case CVirtualInput::kRelativeMove: {
+		SInt32 x = action.m_x;
+		SInt32 y = action.m_y;
+		if (action.m_type == CVirtualInput::kRelativeMove) {
+			x += m_xCursor;
+			y += m_yCursor;
+		}
+		if (m_isOnScreen) {
+			sendEvent(m_events->forIPrimaryScreen().motionOnPrimary(),
+							CMotionInfo::alloc(x, y));
+		}
+		else {
+			sendEvent(m_events->forIPrimaryScreen().motionOnSecondary(),
+							CMotionInfo::alloc(x - m_xCursor, y - m_yCursor));
+		}
+		m_xCursor = x;
+		m_yCursor = y;
+		recordInput("move %d %d", x, y);
+		break;
+	}
+
+	case CVirtualInput::kButtonDown:
+	case CVirtualInput::kButtonUp: {
+		const bool press = (action.m_type == CVirtualInput::kButtonDown);
+		m_buttons[action.m_button] = press;
+		sendEvent(press ? m_events->forIPrimaryScreen().buttonDown() :
+							m_events->forIPrimaryScreen().buttonUp(),
+							CButtonInfo::alloc(action.m_button,
+								m_keyState->getActiveModifiers()));
+		recordInput("%s %d", press ? "down" : "up", action.m_button);
+		break;
+	}
+
+	case CVirtualInput::kWheel:
+		sendEvent(m_events->forIPrimaryScreen().wheel(),
+							CWheelInfo::alloc(action.m_x, action.m_y));
+		recordInput("wheel %d %d", action.m_x, action.m_y);
+		break;
+
+	case CVirtualInput::kKeyDown:
+	case CVirtualInput::kKeyUp: {
+		const bool press = (action.m_type == CVirtualInput::kKeyDown);
+		KeyButton button = CVirtualKeyState::mapKeyToButton(action.m_key);
+		m_keyState->onKey(button, press, action.m_mask);
+		m_keyState->sendKeyEvent(getEventTarget(), press, false,
+							action.m_key, action.m_mask, 1, button);
+		recordInput("%s 0x%04x 0x%04x", press ? "keydown" : "keyup",
+							action.m_key, action.m_mask);
+		break;
+	}
+
+	case CVirtualInput::kClipboard: {
+		CClipboard& clipboard = m_clipboard[kClipboardClipboard];
+		clipboard.open(0);
+		clipboard.empty();
+		clipboard.add(IClipboard::kText, action.m_text);
+		clipboard.close();
+		sendClipboardEvent(m_events->forIScreen().clipboardGrabbed(),
+							kClipboardClipboard);
+		recordInput("clipboard %d %d", kClipboardClipboard,
+							(int)action.m_text.size());
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+void
+CVirtualScreen::record(const char* fmt, ...) const
+{
+	++m_numInjected;
+	if (m_record == NULL) {
+		return;
+	}
+
+	va_list args;
+	va_start(args, fmt);
+	writeRecord("", fmt, args);
+	va_end(args);
+}
+
+void
+CVirtualScreen::recordInput(const char* fmt, ...) const
+{
+	if (m_record == NULL) {
+		return;
+	}
+
+	va_list args;
+	va_start(args, fmt);
+	writeRecord("play ", fmt, args);
+	va_end(args);
+}
+
+void
+CVirtualScreen::writeRecord(const char* prefix,
+				const char* fmt, va_list args) const
+{
+	char buffer[256];
+	ARCH->vsnprintf(buffer, sizeof(buffer), fmt, args);
+
+	char time[32];
+	sprintf(time, "%.6f ", ARCH->time());
+	*m_record << time << prefix << buffer << '\n';
+}
@@ -0,0 +1,199 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "platform/VirtualInput.h"
+#include "synergy/PlatformScreen.h"
+#include "synergy/Clipboard.h"
+
+#include <cstdarg>
+#include <iosfwd>
+
+class CEventQueueTimer;
+class CVirtualKeyState;
+
+//! Headless screen
+/*!
+A screen without a display, for running synergy where there's no window
+system, e.g. to load test the server and client on a build machine.  It
+has a fixed size, takes its user input from a CVirtualInput script and
+records the mouse, keyboard, clipboard and screen saver changes synergy
+makes to it, one line each with the time they happened:
+
+\code
+<seconds> enter
+<seconds> move <x> <y>
+<seconds> keydown <key> <mask> <button>
+<seconds> clipboard <id> <text size>
+\endcode
+
+A primary screen also records the input it plays back, prefixed with
+\c play, so the time input took to reach a client can be measured:
+
+\code
+<seconds> play keydown <key> <mask>
+\endcode
+*/
+class CVirtualScreen : public CPlatformScreen {
+public:
+	/*!
+	The screen is \p width by \p height.  If \p inputPath isn't empty
+	the script in that file is played back once the screen is enabled.
+	If \p recordPath isn't empty changes are recorded to that file.
+	*/
+	CVirtualScreen(IEventQueue* events, bool isPrimary,
+							SInt32 width, SInt32 height,
+							const CString& inputPath,
+							const CString& recordPath);
+	virtual ~CVirtualScreen();
+
+	//! @name manipulators
+	//@{
+
+	//! Set input
+	/*!
+	Replaces the script with \p input, which is played back once the
+	screen is enabled (or immediately if it already is).
+	*/
+	void				setInput(const CVirtualInput& input);
+
+	//! Set record
+	/*!
+	Records changes to \p stream, or stops recording if it's NULL.  The
+	caller keeps ownership of \p stream.
+	*/
+	void				setRecord(std::ostream* stream);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get number of injected events
+	/*!
+	Returns the number of mouse, keyboard, clipboard and screen saver
+	changes synergy has made to the screen.
+	*/
+	UInt32				getNumInjected() const;
+
+	//! Test if input is finished
+	/*!
+	Returns true if the whole script has been played back.
+	*/
+	bool				isInputFinished() const;
+
+	//@}
+
+	// IScreen overrides
+	virtual void*		getEventTarget() const;
+	virtual bool		getClipboard(ClipboardID id, IClipboard*) const;
+	virtual void		getShape(SInt32& x, SInt32& y,
+							SInt32& width, SInt32& height) const;
+	virtual void		getCursorPos(SInt32& x, SInt32& y) const;
+
+	// IPrimaryScreen overrides
+	virtual void		reconfigure(UInt32 activeSides);
+	virtual void		warpCursor(SInt32 x, SInt32 y);
+	virtual UInt32		registerHotKey(KeyID key, KeyModifierMask mask);
+	virtual void		unregisterHotKey(UInt32 id);
+	virtual void		fakeInputBegin();
+	virtual void		fakeInputEnd();
+	virtual SInt32		getJumpZoneSize() const;
+	virtual bool		isAnyMouseButtonDown(UInt32& buttonID) const;
+	virtual void		getCursorCenter(SInt32& x, SInt32& y) const;
+
+	// ISecondaryScreen overrides
+	virtual void		fakeMouseButton(ButtonID id, bool press);
+	virtual void		fakeMouseMove(SInt32 x, SInt32 y);
+	virtual void		fakeMouseRelativeMove(SInt32 dx, SInt32 dy) const;
+	virtual void		fakeMouseWheel(SInt32 xDelta, SInt32 yDelta) const;
+
+	// IKeyState overrides
+	virtual void		fakeKeyDown(KeyID id, KeyModifierMask mask,
+							KeyButton button);
+	virtual bool		fakeKeyRepeat(KeyID id, KeyModifierMask mask,
+							SInt32 count, KeyButton button);
+	virtual bool		fakeKeyUp(KeyButton button);
+
+	// IPlatformScreen overrides
+	virtual void		enable();
+	virtual void		disable();
+	virtual void		enter();
+	virtual bool		leave();
+	virtual bool		setClipboard(ClipboardID, const IClipboard*);
+	virtual void		checkClipboards();
+	virtual void		openScreensaver(bool notify);
+	virtual void		closeScreensaver();
+	virtual void		screensaver(bool activate);
+	virtual void		resetOptions();
+	virtual void		setOptions(const COptionsList& options);
+	virtual void		setSequenceNumber(UInt32);
+	virtual bool		isPrimary() const;
+
+protected:
+	// IPlatformScreen overrides
+	virtual void		handleSystemEvent(const CEvent&, void*);
+	virtual void		updateButtons();
+	virtual IKeyState*	getKeyState() const;
+
+private:
+	void				sendEvent(CEvent::Type, void* = NULL);
+	void				sendClipboardEvent(CEvent::Type, ClipboardID);
+
+	// input playback
+	void				startInput();
+	void				stopInput();
+	void				scheduleInput(double delay);
+	void				handleInputTimer(const CEvent&, void*);
+	void				playInput();
+	void				postInput(const CVirtualInput::CAction&);
+
+	// record a change or played input.  fmt is printf style.
+	void				record(const char* fmt, ...) const;
+	void				recordInput(const char* fmt, ...) const;
+	void				writeRecord(const char* prefix,
+							const char* fmt, va_list args) const;
+
+private:
+	bool				m_isPrimary;
+	bool				m_isOnScreen;
+	bool				m_enabled;
+	SInt32				m_w, m_h;
+
+	// the cursor.  mutable for fakeMouseRelativeMove().
+	mutable SInt32		m_xCursor, m_yCursor;
+
+	// pressed mouse buttons, indexed by ButtonID
+	bool				m_buttons[256];
+	UInt32				m_nextHotKey;
+	UInt32				m_sequenceNumber;
+	CClipboard			m_clipboard[kClipboardEnd];
+	CVirtualKeyState*	m_keyState;
+
+	// input script and playback position
+	CVirtualInput		m_input;
+	UInt32				m_inputIndex;
+	std::vector<UInt32>	m_repeated;
+	CEventQueueTimer*	m_inputTimer;
+
+	// change record
+	std::ostream*		m_record;
+	std::ofstream*		m_recordFile;
+	mutable UInt32		m_numInjected;
+
+	IEventQueue*		m_events;
+};
@@ -25,7 +25,8 @@
 CBaseClientProxy::CBaseClientProxy(const CString& name) :
 	m_name(name),
 	m_x(0),
-	m_y(0)
+	m_y(0),
+	m_broadcast(NULL)
 {
 	// do nothing
 }
@@ -42,6 +43,12 @@ CBaseClientProxy::setJumpCursorPos(SInt32 x, SInt32 y)
 	m_y = y;
 }
 
+void
+CBaseClientProxy::setBroadcast(CMessageBroadcast* broadcast)
+{
+	m_broadcast = broadcast;
+}
+
 void
 CBaseClientProxy::getJumpCursorPos(SInt32& x, SInt32& y) const
 {
@@ -49,6 +56,12 @@ CBaseClientProxy::getJumpCursorPos(SInt32& x, SInt32& y) const
 	y = m_y;
 }
 
+CMessageBroadcast*
+CBaseClientProxy::getBroadcast() const
+{
+	return m_broadcast;
+}
+
 CString
 CBaseClientProxy::getName() const
 {
@@ -21,6 +21,8 @@
 #include "synergy/IClient.h"
 #include "base/String.h"
 
+class CMessageBroadcast;
+
 //! Generic proxy for client or primary
 class CBaseClientProxy : public IClient {
 public:
@@ -39,6 +41,17 @@ public:
 	*/
 	void				setJumpCursorPos(SInt32 x, SInt32 y);
 
+	//! Share messages with other clients
+	/*!
+	While \c broadcast is not NULL, messages sent to the client are
+	taken from or formatted into \c broadcast (see
+	CProtocolUtil::writefBroadcast()), so the server can send the same
+	message to many clients while formatting it once.  Only messages
+	that are the same for every client are shared, e.g. not the crypto
+	IV.  The server must reset this to NULL after the broadcast.
+	*/
+	void				setBroadcast(CMessageBroadcast* broadcast);
+
 	//@}
 	//! @name accessors
 	//@{
@@ -49,6 +62,13 @@ public:
 	*/
 	void				getJumpCursorPos(SInt32& x, SInt32& y) const;
 
+	//! Get broadcast
+	/*!
+	Returns the broadcast set by setBroadcast(), or NULL if not
+	broadcasting.
+	*/
+	CMessageBroadcast*	getBroadcast() const;
+
 	//@}
 
 	// IScreen
@@ -86,4 +106,5 @@ public:
 private:
 	CString				m_name;
 	SInt32				m_x, m_y;
+	CMessageBroadcast*	m_broadcast;
 };
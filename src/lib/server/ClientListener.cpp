@@ -21,6 +21,8 @@
 #include "server/ClientProxy.h"
 #include "server/ClientProxyUnknown.h"
 #include "synergy/PacketStreamFilter.h"
+#include "synergy/PriorityStreamFilter.h"
+#include "synergy/CaptureStreamFilter.h"
 #include "net/IDataSocket.h"
 #include "net/IListenSocket.h"
 #include "net/ISocketFactory.h"
@@ -28,10 +30,23 @@
 #include "io/CryptoStream.h"
 #include "io/CryptoOptions.h"
 #include "io/IStreamFilterFactory.h"
+#include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
 
+// most handshakes that may be in progress at once.  connections beyond
+// this are dropped straight away;  clients back off and try again.
+static const UInt32		s_maxPendingClients = 64;
+
+// seconds a new client has to complete the handshake
+static const double		s_handshakeTimeout = 10.0;
+
+// connections allowed from one address:  a burst of this many (unless
+// set otherwise) then one per s_sourceRefillTime seconds.
+static const double		s_sourceBurst = 8.0;
+static const double		s_sourceRefillTime = 1.0;
+
 //
 // CClientListener
 //
@@ -45,7 +60,10 @@ CClientListener::CClientListener(const CNetworkAddress& address,
 	m_streamFilterFactory(streamFilterFactory),
 	m_server(NULL),
 	m_crypto(crypto),
-	m_events(events)
+	m_events(events),
+	m_connectCount(0),
+	m_connectRate(0.0),
+	m_sourceBurst(s_sourceBurst)
 {
 	assert(m_socketFactory != NULL);
 
@@ -71,6 +89,14 @@ CClientListener::CClientListener(const CNetworkAddress& address,
 	}
 	LOG((CLOG_DEBUG1 "listening for clients"));
 
+	// the key only depends on the password so derive it once rather
+	// than for every connection
+	if (m_crypto.m_mode != kDisabled && !m_crypto.m_pass.empty()) {
+		m_cryptoKey.resize(synergy::crypto::kKeyLength);
+		m_cryptoIv.resize(CRYPTO_IV_SIZE);
+		CCryptoStream::createKeys(m_crypto, &m_cryptoKey[0], &m_cryptoIv[0]);
+	}
+
 	// setup event handler
 	m_events->adoptHandler(m_events->forIListenSocket().connecting(), m_listen,
 							new TMethodEventJob<CClientListener>(this,
@@ -114,6 +140,19 @@ CClientListener::setServer(CServer* server)
 	m_server = server;
 }
 
+void
+CClientListener::setSourceBurst(UInt32 n)
+{
+	assert(n > 0);
+	m_sourceBurst = n;
+}
+
+void
+CClientListener::setCapturePath(const CString& path)
+{
+	m_capturePath = path;
+}
+
 CClientProxy*
 CClientListener::getNextClient()
 {
@@ -126,32 +165,78 @@ CClientListener::getNextClient()
 	return client;
 }
 
+UInt32
+CClientListener::getNumPendingClients() const
+{
+	return static_cast<UInt32>(m_newClients.size());
+}
+
 void
 CClientListener::handleClientConnecting(const CEvent&, void*)
 {
 	// accept client connection
-	synergy::IStream* stream = m_listen->accept();
+	CString peer;
+	synergy::IStream* stream = m_listen->accept(peer);
 	if (stream == NULL) {
 		return;
 	}
-	LOG((CLOG_NOTE "accepted client connection"));
+	LOG((CLOG_NOTE "accepted client connection from %s", peer.c_str()));
+
+	// measure connection attempts per second so reconnect storms show
+	// up in the log
+	++m_connectCount;
+	double elapsed = m_connectWindow.getTime();
+	if (elapsed >= 1.0) {
+		m_connectRate  = m_connectCount / elapsed;
+		m_connectCount = 0;
+		m_connectWindow.reset();
+		LOG((CLOG_DEBUG "client connect rate %.1f/s", m_connectRate));
+		pruneSources(ARCH->coarseTime());
+	}
+
+	// drop the connection before doing any work for it if we're
+	// already busy or this source is connecting too often
+	if (!admit(peer)) {
+		delete stream;
+		return;
+	}
 
 	// filter socket messages, including a packetizing filter
 	if (m_streamFilterFactory != NULL) {
 		stream = m_streamFilterFactory->create(stream, true);
 	}
-	stream = new CPacketStreamFilter(m_events, stream, true);
+	CPacketStreamFilter* packetStream =
+		new CPacketStreamFilter(m_events, stream, true);
+	stream = packetStream;
 	
+	CCryptoStream* cryptoStream = NULL;
 	if (m_crypto.m_mode != kDisabled) {
-		CCryptoStream* cryptoStream = new CCryptoStream(
-			m_events, stream, m_crypto, true);
+		if (!m_cryptoKey.empty()) {
+			cryptoStream = new CCryptoStream(m_events, stream, m_crypto,
+								&m_cryptoKey[0], &m_cryptoIv[0], true);
+		}
+		else {
+			cryptoStream = new CCryptoStream(m_events, stream, m_crypto, true);
+		}
 		stream = cryptoStream;
 	}
 
+	// capture the plain messages
+	if (!m_capturePath.empty()) {
+		stream = new CCaptureStreamFilter(m_events, stream,
+							CProtocolCapture::getNextPath(m_capturePath),
+							CProtocolCapture::kServer, true);
+	}
+
+	// keep file transfers from delaying input
+	stream = new CPriorityStreamFilter(m_events, stream, true);
+
 	assert(m_server != NULL);
 
 	// create proxy for unknown client
-	CClientProxyUnknown* client = new CClientProxyUnknown(stream, 30.0, m_server, m_events);
+	CClientProxyUnknown* client = new CClientProxyUnknown(stream,
+								packetStream, cryptoStream,
+								s_handshakeTimeout, m_server, m_events);
 	m_newClients.insert(client);
 
 	// watch for events from unknown client
@@ -193,6 +278,58 @@ CClientListener::handleUnknownClient(const CEvent&, void* vclient)
 	delete unknownClient;
 }
 
+bool
+CClientListener::admit(const CString& peer)
+{
+	if (m_newClients.size() >= s_maxPendingClients) {
+		LOG((CLOG_WARN "too many clients connecting, dropped connection from %s", peer.c_str()));
+		return false;
+	}
+
+	// refill the source's bucket for the time since it last connected.
+	// a source we haven't seen starts with a full bucket.
+	double now = ARCH->coarseTime();
+	CSourceRates::iterator index = m_sourceRates.find(peer);
+	if (index == m_sourceRates.end()) {
+		index = m_sourceRates.insert(std::make_pair(peer, CSourceRate())).first;
+		index->second.m_tokens = m_sourceBurst;
+	}
+	else {
+		CSourceRate& rate = index->second;
+		rate.m_tokens += (now - rate.m_time) / s_sourceRefillTime;
+		if (rate.m_tokens > m_sourceBurst) {
+			rate.m_tokens = m_sourceBurst;
+		}
+	}
+	CSourceRate& rate = index->second;
+	rate.m_time = now;
+
+	if (rate.m_tokens < 1.0) {
+		LOG((CLOG_WARN "%s is connecting too often, dropped connection", peer.c_str()));
+		return false;
+	}
+	rate.m_tokens -= 1.0;
+	return true;
+}
+
+void
+CClientListener::pruneSources(double now)
+{
+	// a source whose bucket has refilled is the same as one we've never
+	// seen so there's no need to remember it
+	double full = m_sourceBurst * s_sourceRefillTime;
+	for (CSourceRates::iterator index = m_sourceRates.begin();
+								index != m_sourceRates.end(); ) {
+		const CSourceRate& rate = index->second;
+		if (now - rate.m_time >= full - rate.m_tokens * s_sourceRefillTime) {
+			m_sourceRates.erase(index++);
+		}
+		else {
+			++index;
+		}
+	}
+}
+
 void
 CClientListener::handleClientDisconnected(const CEvent&, void* vclient)
 {
@@ -22,8 +22,11 @@
 #include "io/CryptoOptions.h"
 #include "base/EventTypes.h"
 #include "base/Event.h"
+#include "base/Stopwatch.h"
 #include "common/stddeque.h"
+#include "common/stdmap.h"
 #include "common/stdset.h"
+#include "common/stdvector.h"
 
 class CClientProxy;
 class CClientProxyUnknown;
@@ -49,6 +52,22 @@ public:
 
 	void				setServer(CServer* server);
 
+	//! Set connection burst
+	/*!
+	Sets how many connections one address may make at once before it's
+	held to one a second.  The default is 8;  a host running many clients,
+	e.g. for a load test, needs more.
+	*/
+	void				setSourceBurst(UInt32 n);
+
+	//! Set capture path
+	/*!
+	Captures the messages of each new connection to a new file named
+	after \p path (see CProtocolCapture::getNextPath()), or stops
+	capturing if \p path is empty.
+	*/
+	void				setCapturePath(const CString& path);
+
 	//@}
 
 	//! @name accessors
@@ -65,6 +84,16 @@ public:
 	//! Get server which owns this listener
 	CServer*			getServer() { return m_server; }
 
+	//! Get connect rate
+	/*!
+	Returns the number of connection attempts per second accepted over
+	the last complete measuring window (about a second).
+	*/
+	double				getConnectRate() const { return m_connectRate; }
+
+	//! Get number of handshakes in progress
+	UInt32				getNumPendingClients() const;
+
 	//@}
 
 private:
@@ -73,9 +102,26 @@ private:
 	void				handleUnknownClient(const CEvent&, void*);
 	void				handleClientDisconnected(const CEvent&, void*);
 
+	// returns true iff a connection from \p peer may start a handshake
+	bool				admit(const CString& peer);
+
+	// forget sources that haven't connected in a while
+	void				pruneSources(double now);
+
 private:
+	// connection allowance for one source address (a token bucket)
+	class CSourceRate {
+	public:
+		CSourceRate() : m_tokens(0.0), m_time(0.0) { }
+
+	public:
+		double			m_tokens;
+		double			m_time;
+	};
+
 	typedef std::set<CClientProxyUnknown*> CNewClients;
 	typedef std::deque<CClientProxy*> CWaitingClients;
+	typedef std::map<CString, CSourceRate> CSourceRates;
 
 	IListenSocket*		m_listen;
 	ISocketFactory*		m_socketFactory;
@@ -85,4 +131,12 @@ private:
 	CServer*			m_server;
 	CCryptoOptions		m_crypto;
 	IEventQueue*		m_events;
+	CStopwatch			m_connectWindow;
+	UInt32				m_connectCount;
+	double				m_connectRate;
+	double				m_sourceBurst;
+	CString				m_capturePath;
+	CSourceRates		m_sourceRates;
+	std::vector<UInt8>	m_cryptoKey;
+	std::vector<UInt8>	m_cryptoIv;
 };
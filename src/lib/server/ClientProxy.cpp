@@ -39,10 +39,16 @@ CClientProxy::~CClientProxy()
 }
 
 void
-CClientProxy::close(const char* msg)
+CClientProxy::close(const char* msg, UInt32 retryHint)
 {
-	LOG((CLOG_DEBUG1 "send close \"%s\" to \"%s\"", msg, getName().c_str()));
-	CProtocolUtil::writef(getStream(), msg);
+	LOG((CLOG_DEBUG1 "send close \"%.4s\" to \"%s\"", msg, getName().c_str()));
+	if (hasRetryHint()) {
+		CProtocolUtil::writef(getStream(), msg, retryHint);
+	}
+	else {
+		CString code(msg, 4);
+		CProtocolUtil::writef(getStream(), code.c_str());
+	}
 
 	// force the close to be sent before we return
 	getStream()->flush();
@@ -54,6 +60,18 @@ CClientProxy::getStream() const
 	return m_stream;
 }
 
+bool
+CClientProxy::hasRetryHint() const
+{
+	return false;
+}
+
+bool
+CClientProxy::hasMultiFileTransfer() const
+{
+	return false;
+}
+
 void*
 CClientProxy::getEventTarget() const
 {
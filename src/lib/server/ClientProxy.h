@@ -39,9 +39,12 @@ public:
 
 	//! Disconnect
 	/*!
-	Ask the client to disconnect, using \p msg as the reason.
+	Ask the client to disconnect, using \p msg as the reason.  If
+	\p msg takes an argument (e.g. kMsgEBusyRetry) then \p retryHint
+	is sent as that argument, or only the message code is sent if the
+	client doesn't take retry hints.
 	*/
-	void				close(const char* msg);
+	void				close(const char* msg, UInt32 retryHint = 0);
 
 	//@}
 	//! @name accessors
@@ -54,6 +57,21 @@ public:
 	*/
 	synergy::IStream*			getStream() const;
 
+	//! Test for retry hints
+	/*!
+	Returns true if the client's protocol version reads a retry hint
+	after kMsgCClose and kMsgEBusy.
+	*/
+	virtual bool		hasRetryHint() const;
+
+	//! Test for multiple file transfers
+	/*!
+	Returns true if the client's protocol version receives several
+	files in one transfer.  Older clients write every file of a
+	transfer to the first file's name.
+	*/
+	virtual bool		hasMultiFileTransfer() const;
+
 	//@}
 
 	// IScreen
@@ -20,20 +20,27 @@
 
 #include "synergy/ProtocolUtil.h"
 #include "synergy/XSynergy.h"
+#include "synergy/LivenessMonitor.h"
 #include "io/IStream.h"
 #include "base/Log.h"
+#include "base/Metrics.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
 
 #include <cstring>
 
+// messages from every client, by code
+static CCodeCounter		s_received("server.received");
+
 //
 // CClientProxy1_0
 //
 
 CClientProxy1_0::CClientProxy1_0(const CString& name, synergy::IStream* stream, IEventQueue* events) :
 	CClientProxy(name, stream),
-	m_heartbeatTimer(NULL),
+	m_heartbeatAlarm(0.0),
+	m_lastActivity(0.0),
+	m_liveness(CLivenessMonitor::acquire(events)),
 	m_parser(&CClientProxy1_0::parseHandshakeMessage),
 	m_events(events)
 {
@@ -54,7 +61,7 @@ CClientProxy1_0::CClientProxy1_0(const CString& name, synergy::IStream* stream,
 							stream->getEventTarget(),
 							new TMethodEventJob<CClientProxy1_0>(this,
 								&CClientProxy1_0::handleWriteError, NULL));
-	m_events->adoptHandler(CEvent::kTimer, this,
+	m_events->adoptHandler(m_events->forCLivenessMonitor().dead(), this,
 							new TMethodEventJob<CClientProxy1_0>(this,
 								&CClientProxy1_0::handleFlatline, NULL));
 
@@ -67,6 +74,7 @@ CClientProxy1_0::CClientProxy1_0(const CString& name, synergy::IStream* stream,
 CClientProxy1_0::~CClientProxy1_0()
 {
 	removeHandlers();
+	CLivenessMonitor::release(m_liveness);
 }
 
 void
@@ -89,9 +97,9 @@ CClientProxy1_0::removeHandlers()
 							getStream()->getEventTarget());
 	m_events->removeHandler(m_events->forIStream().outputShutdown(),
 							getStream()->getEventTarget());
-	m_events->removeHandler(CEvent::kTimer, this);
+	m_events->removeHandler(m_events->forCLivenessMonitor().dead(), this);
 
-	// remove timer
+	// stop watching for flatline
 	removeHeartbeatTimer();
 }
 
@@ -99,25 +107,22 @@ void
 CClientProxy1_0::addHeartbeatTimer()
 {
 	if (m_heartbeatAlarm > 0.0) {
-		m_heartbeatTimer = m_events->newOneShotTimer(m_heartbeatAlarm, this);
+		m_liveness->watch(this, &m_lastActivity, m_heartbeatAlarm);
 	}
 }
 
 void
 CClientProxy1_0::removeHeartbeatTimer()
 {
-	if (m_heartbeatTimer != NULL) {
-		m_events->deleteTimer(m_heartbeatTimer);
-		m_heartbeatTimer = NULL;
-	}
+	m_liveness->unwatch(this);
 }
 
 void
 CClientProxy1_0::resetHeartbeatTimer()
 {
-	// reset the alarm
-	removeHeartbeatTimer();
-	addHeartbeatTimer();
+	// reset the alarm.  this happens for every batch of messages so
+	// it only notes the time;  the liveness monitor checks it later.
+	CLivenessMonitor::touch(m_lastActivity);
 }
 
 void
@@ -153,6 +158,7 @@ CClientProxy1_0::handleData(const CEvent&, void*)
 			disconnect();
 			return;
 		}
+		s_received.add(code);
 
 		// next message
 		n = getStream()->read(code, 4);
@@ -281,9 +287,10 @@ CClientProxy1_0::setClipboard(ClipboardID id, const IClipboard* clipboard)
 		m_clipboard[id].m_dirty = false;
 		CClipboard::copy(&m_clipboard[id].m_clipboard, clipboard);
 
-		CString data = m_clipboard[id].m_clipboard.marshall();
-		LOG((CLOG_DEBUG "send clipboard %d to \"%s\" size=%d", id, getName().c_str(), data.size()));
-		CProtocolUtil::writef(getStream(), kMsgDClipboard, id, 0, &data);
+		CSharedBufferList data;
+		UInt32 size = m_clipboard[id].m_clipboard.marshall(data);
+		LOG((CLOG_DEBUG "send clipboard %d to \"%s\" size=%d", id, getName().c_str(), size));
+		CProtocolUtil::writefBuffers(getStream(), data, kMsgDClipboard, id, 0);
 	}
 }
 
@@ -291,7 +298,8 @@ void
 CClientProxy1_0::grabClipboard(ClipboardID id)
 {
 	LOG((CLOG_DEBUG "send grab clipboard %d to \"%s\"", id, getName().c_str()));
-	CProtocolUtil::writef(getStream(), kMsgCClipboard, id, 0);
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							kMsgCClipboard, id, 0);
 
 	// this clipboard is now dirty
 	m_clipboard[id].m_dirty = true;
@@ -307,7 +315,8 @@ void
 CClientProxy1_0::keyDown(KeyID key, KeyModifierMask mask, KeyButton)
 {
 	LOG((CLOG_DEBUG1 "send key down to \"%s\" id=%d, mask=0x%04x", getName().c_str(), key, mask));
-	CProtocolUtil::writef(getStream(), kMsgDKeyDown1_0, key, mask);
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							kMsgDKeyDown1_0, key, mask);
 }
 
 void
@@ -315,14 +324,16 @@ CClientProxy1_0::keyRepeat(KeyID key, KeyModifierMask mask,
 				SInt32 count, KeyButton)
 {
 	LOG((CLOG_DEBUG1 "send key repeat to \"%s\" id=%d, mask=0x%04x, count=%d", getName().c_str(), key, mask, count));
-	CProtocolUtil::writef(getStream(), kMsgDKeyRepeat1_0, key, mask, count);
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							kMsgDKeyRepeat1_0, key, mask, count);
 }
 
 void
 CClientProxy1_0::keyUp(KeyID key, KeyModifierMask mask, KeyButton)
 {
 	LOG((CLOG_DEBUG1 "send key up to \"%s\" id=%d, mask=0x%04x", getName().c_str(), key, mask));
-	CProtocolUtil::writef(getStream(), kMsgDKeyUp1_0, key, mask);
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							kMsgDKeyUp1_0, key, mask);
 }
 
 void
@@ -378,14 +389,16 @@ void
 CClientProxy1_0::screensaver(bool on)
 {
 	LOG((CLOG_DEBUG1 "send screen saver to \"%s\" on=%d", getName().c_str(), on ? 1 : 0));
-	CProtocolUtil::writef(getStream(), kMsgCScreenSaver, on ? 1 : 0);
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							kMsgCScreenSaver, on ? 1 : 0);
 }
 
 void
 CClientProxy1_0::resetOptions()
 {
 	LOG((CLOG_DEBUG1 "send reset options to \"%s\"", getName().c_str()));
-	CProtocolUtil::writef(getStream(), kMsgCResetOptions);
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							kMsgCResetOptions);
 
 	// reset heart rate and death
 	resetHeartbeatRate();
@@ -397,7 +410,8 @@ void
 CClientProxy1_0::setOptions(const COptionsList& options)
 {
 	LOG((CLOG_DEBUG1 "send set options to \"%s\" size=%d", getName().c_str(), options.size()));
-	CProtocolUtil::writef(getStream(), kMsgDSetOptions, &options);
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							kMsgDSetOptions, &options);
 
 	// check options
 	for (UInt32 i = 0, n = (UInt32)options.size(); i < n; i += 2) {
@@ -466,7 +480,7 @@ CClientProxy1_0::recvClipboard()
 	}
 
 	// save clipboard
-	m_clipboard[id].m_clipboard.unmarshall(data, 0);
+	m_clipboard[id].m_clipboard.unmarshall(CSharedBuffer::adopt(data), 0);
 	m_clipboard[id].m_sequenceNumber = seqNum;
 
 	// notify
@@ -24,6 +24,7 @@
 
 class CEvent;
 class CEventQueueTimer;
+class CLivenessMonitor;
 class IEventQueue;
 
 //! Proxy for client implementing protocol version 1.0
@@ -99,7 +100,8 @@ private:
 	CClientInfo			m_info;
 	CClientClipboard	m_clipboard[kClipboardEnd];
 	double				m_heartbeatAlarm;
-	CEventQueueTimer*	m_heartbeatTimer;
+	double				m_lastActivity;
+	CLivenessMonitor*	m_liveness;
 	MessageParser		m_parser;
 	IEventQueue*		m_events;
 };
@@ -83,8 +83,7 @@ void
 CClientProxy1_3::resetHeartbeatTimer()
 {
 	// reset the alarm but not the keep alive timer
-	CClientProxy1_2::removeHeartbeatTimer();
-	CClientProxy1_2::addHeartbeatTimer();
+	CClientProxy1_2::resetHeartbeatTimer();
 }
 
 void
@@ -32,8 +32,12 @@
 // CClientProxy1_4
 //
 
-CClientProxy1_4::CClientProxy1_4(const CString& name, synergy::IStream* stream, CServer* server, IEventQueue* events) :
-	CClientProxy1_3(name, stream, events), m_server(server)
+CClientProxy1_4::CClientProxy1_4(const CString& name, synergy::IStream* stream,
+				CCryptoStream* cryptoStream,
+				CServer* server, IEventQueue* events) :
+	CClientProxy1_3(name, stream, events),
+	m_cryptoStream(cryptoStream),
+	m_server(server)
 {
 	assert(m_server != NULL);
 }
@@ -45,22 +49,31 @@ CClientProxy1_4::~CClientProxy1_4()
 void
 CClientProxy1_4::keyDown(KeyID key, KeyModifierMask mask, KeyButton button)
 {
+	syncInput();
 	cryptoIv();
-	CClientProxy1_3::keyDown(key, mask, button);
+	LOG((CLOG_DEBUG1 "send key down to \"%s\" id=%d, mask=0x%04x, button=0x%04x", getName().c_str(), key, mask, button));
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							getKeyDownFormat(), key, mask, button);
 }
 
 void
 CClientProxy1_4::keyRepeat(KeyID key, KeyModifierMask mask, SInt32 count, KeyButton button)
 {
+	syncInput();
 	cryptoIv();
-	CClientProxy1_3::keyRepeat(key, mask, count, button);
+	LOG((CLOG_DEBUG1 "send key repeat to \"%s\" id=%d, mask=0x%04x, count=%d, button=0x%04x", getName().c_str(), key, mask, count, button));
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							getKeyRepeatFormat(), key, mask, count, button);
 }
 
 void
 CClientProxy1_4::keyUp(KeyID key, KeyModifierMask mask, KeyButton button)
 {
+	syncInput();
 	cryptoIv();
-	CClientProxy1_3::keyUp(key, mask, button);
+	LOG((CLOG_DEBUG1 "send key up to \"%s\" id=%d, mask=0x%04x, button=0x%04x", getName().c_str(), key, mask, button));
+	CProtocolUtil::writefBroadcast(getStream(), getBroadcast(),
+							getKeyUpFormat(), key, mask, button);
 }
 
 void
@@ -73,7 +86,7 @@ CClientProxy1_4::keepAlive()
 void
 CClientProxy1_4::cryptoIv()
 {
-	CCryptoStream* cryptoStream = dynamic_cast<CCryptoStream*>(getStream());
+	CCryptoStream* cryptoStream = getCryptoStream();
 	if (cryptoStream == NULL) {
 		return;
 	}
@@ -89,3 +102,33 @@ CClientProxy1_4::cryptoIv()
 	// the client won't be able to decrypt the new IV.
 	cryptoStream->setEncryptIv(iv);
 }
+
+CCryptoStream*
+CClientProxy1_4::getCryptoStream() const
+{
+	return m_cryptoStream;
+}
+
+void
+CClientProxy1_4::syncInput()
+{
+	// do nothing
+}
+
+const char*
+CClientProxy1_4::getKeyDownFormat() const
+{
+	return kMsgDKeyDown;
+}
+
+const char*
+CClientProxy1_4::getKeyRepeatFormat() const
+{
+	return kMsgDKeyRepeat;
+}
+
+const char*
+CClientProxy1_4::getKeyUpFormat() const
+{
+	return kMsgDKeyUp;
+}
@@ -20,12 +20,20 @@
 
 #include "server/ClientProxy1_3.h"
 
+class CCryptoStream;
 class CServer;
 
 //! Proxy for client implementing protocol version 1.4
+/*!
+Sends a new crypto IV before each key message.  \p cryptoStream is the
+crypto stream in \p adoptedStream's filter stack, or NULL if the
+connection isn't encrypted.
+*/
 class CClientProxy1_4 : public CClientProxy1_3 {
 public:
-	CClientProxy1_4(const CString& name, synergy::IStream* adoptedStream, CServer* server, IEventQueue* events);
+	CClientProxy1_4(const CString& name, synergy::IStream* adoptedStream,
+							CCryptoStream* cryptoStream,
+							CServer* server, IEventQueue* events);
 	~CClientProxy1_4();
 
 	//! @name accessors
@@ -45,5 +53,46 @@ public:
 	//! Send IV to make 
 	void				cryptoIv();
 
+protected:
+	//! Get the crypto stream
+	/*!
+	Returns the crypto stream beneath the proxy's stream, or NULL if
+	the connection isn't encrypted.
+	*/
+	CCryptoStream*		getCryptoStream() const;
+
+	//! Send input that must precede a key message
+	/*!
+	Called before the IV is changed for each key press, repeat and
+	release.  Does nothing by default.
+	*/
+	virtual void		syncInput();
+
+	//! Get the key press format
+	/*!
+	Returns the format for key press messages;  it takes the key,
+	modifier mask and button.
+	*/
+	virtual const char*	getKeyDownFormat() const;
+
+	//! Get the key repeat format
+	/*!
+	Returns the format for key repeat messages;  it takes the key,
+	modifier mask, count and button.
+	*/
+	virtual const char*	getKeyRepeatFormat() const;
+
+	//! Get the key release format
+	/*!
+	Returns the format for key release messages;  it takes the key,
+	modifier mask and button.
+	*/
+	virtual const char*	getKeyUpFormat() const;
+
+private:
+	CCryptoStream*		m_cryptoStream;
+
+public:
+
 	CServer*			m_server;
 };
@@ -28,8 +28,10 @@
 
 const UInt16 CClientProxy1_5::m_intervalThreshold = 1;
 
-CClientProxy1_5::CClientProxy1_5(const CString& name, synergy::IStream* stream, CServer* server, IEventQueue* events) :
-	CClientProxy1_4(name, stream, server, events),
+CClientProxy1_5::CClientProxy1_5(const CString& name, synergy::IStream* stream,
+				CCryptoStream* cryptoStream,
+				CServer* server, IEventQueue* events) :
+	CClientProxy1_4(name, stream, cryptoStream, server, events),
 	m_events(events),
 	m_stopwatch(true),
 	m_elapsedTime(0),
@@ -98,10 +100,9 @@ CClientProxy1_5::fileChunkReceived()
 	CServer* server = getServer();
 	switch (mark) {
 	case kFileStart:
-		server->clearReceivedFileData();
-		server->setExpectedFileSize(content);
+		server->fileStartReceived(content);
 		if (CLOG->getFilter() >= kDEBUG2) {
-			LOG((CLOG_DEBUG2 "recv file data from client: file size=%s", content.c_str()));
+			LOG((CLOG_DEBUG2 "recv file data from client: header=%s", content.c_str()));
 			m_stopwatch.start();
 		}
 		break;
@@ -124,14 +125,25 @@ CClientProxy1_5::fileChunkReceived()
 			}
 		break;
 
+	case kFileCheck:
+		server->fileCheckReceived(content);
+		break;
+
+	case kFileResume:
+		LOG((CLOG_DEBUG "recv file resume request: %s", content.c_str()));
+		server->fileResumeRequested(this, content);
+		break;
+
 	case kFileEnd:
-		m_events->addEvent(CEvent(m_events->forIScreen().fileRecieveCompleted(), server));
+		if (server->fileEndReceived()) {
+			m_events->addEvent(CEvent(m_events->forIScreen().fileRecieveCompleted(), server));
+		}
 		if (CLOG->getFilter() >= kDEBUG2) {
 			LOG((CLOG_DEBUG2 "file data transfer finished"));
 			m_elapsedTime += m_stopwatch.getTime();
-			double averageSpeed = getServer()->getExpectedFileSize() / m_elapsedTime / 1000;
+			double averageSpeed = (double)getServer()->getExpectedFileSize() / m_elapsedTime / 1000;
 			LOG((CLOG_DEBUG2 "file data transfer finished: total time consumed=%f s", m_elapsedTime));
-			LOG((CLOG_DEBUG2 "file data transfer finished: total data received=%i kb", getServer()->getExpectedFileSize() / 1000));
+			LOG((CLOG_DEBUG2 "file data transfer finished: total data received=%.0f kb", (double)getServer()->getExpectedFileSize() / 1000));
 			LOG((CLOG_DEBUG2 "file data transfer finished: total average speed=%f kb/s", averageSpeed));
 		}
 		break;
@@ -20,13 +20,16 @@
 #include "server/ClientProxy1_4.h"
 #include "base/Stopwatch.h"
 
+class CCryptoStream;
 class CServer;
 class IEventQueue;
 
 //! Proxy for client implementing protocol version 1.5
 class CClientProxy1_5 : public CClientProxy1_4 {
 public:
-	CClientProxy1_5(const CString& name, synergy::IStream* adoptedStream, CServer* server, IEventQueue* events);
+	CClientProxy1_5(const CString& name, synergy::IStream* adoptedStream,
+							CCryptoStream* cryptoStream,
+							CServer* server, IEventQueue* events);
 	~CClientProxy1_5();
 
 	virtual void		sendDragInfo(UInt32 fileCount, const char* info, size_t size);
@@ -0,0 +1,283 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ClientProxy1_6.h"
+
+#include "server/MotionListener.h"
+#include "server/Server.h"
+#include "synergy/ProtocolUtil.h"
+#include "io/CryptoStream.h"
+#include "base/Log.h"
+
+// seconds without a report, or with motion unacknowledged, before the
+// motion channel is considered down
+static const double		s_motionTimeout = 2.0;
+
+// seconds to use the stream after the motion channel goes down before
+// trying the channel again
+static const double		s_motionRetry = 10.0;
+
+// seconds motion may go unacknowledged before it's sent again on the
+// stream.  clients report about four times a second.
+static const double		s_motionSyncDelay = 0.1;
+
+//
+// CClientProxy1_6
+//
+
+CClientProxy1_6::CClientProxy1_6(const CString& name, synergy::IStream* stream,
+				CCryptoStream* cryptoStream,
+				CServer* server, IEventQueue* events) :
+	CClientProxy1_5(name, stream, cryptoStream, server, events),
+	m_motionListener(server->getMotionListener()),
+	m_motion(NULL),
+	m_motionSeq(0),
+	m_motionAck(0),
+	m_datagramAck(0),
+	m_reportSeq(0),
+	m_xRelative(0),
+	m_yRelative(0),
+	m_motionReported(false),
+	m_motionDown(false),
+	m_datagramPending(false)
+{
+	if (m_motionListener == NULL) {
+		return;
+	}
+
+	// encrypt datagrams with the stream's key, if it has one
+	UInt32 token = m_motionListener->addClient(this);
+	m_motion = new CMotionChannel(token,
+		cryptoStream != NULL ? cryptoStream->getKey() : NULL);
+	m_motion->setLoss(m_motionListener->getLoss());
+
+	LOG((CLOG_DEBUG1 "send motion channel to \"%s\"", getName().c_str()));
+	CProtocolUtil::writef(getStream(), kMsgCMotionChannel, token);
+}
+
+CClientProxy1_6::~CClientProxy1_6()
+{
+	if (m_motion != NULL) {
+		m_motionListener->removeClient(m_motion->getToken());
+		delete m_motion;
+	}
+}
+
+void
+CClientProxy1_6::handleMotionDatagram(const CString& data,
+				const CNetworkAddress& from)
+{
+	CMotionChannel::CPacket packet;
+	if (m_motion == NULL ||
+		!m_motion->decode(CMotionChannel::kToServer, data, packet) ||
+		packet.m_type != CMotionChannel::kReport) {
+		LOG((CLOG_DEBUG1 "ignored bad datagram for \"%s\" from %s", getName().c_str(), from.getHostname().c_str()));
+		return;
+	}
+
+	// only a newer report may move the channel, so a replayed one can't
+	// redirect motion
+	if (packet.m_seq <= m_reportSeq) {
+		LOG((CLOG_DEBUG1 "ignored old report %d for \"%s\" from %s", packet.m_seq, getName().c_str(), from.getHostname().c_str()));
+		return;
+	}
+	m_reportSeq = packet.m_seq;
+
+	// reply to wherever the reports come from
+	if (!m_motionReported) {
+		LOG((CLOG_INFO "motion channel to \"%s\" is up", getName().c_str()));
+		m_motionReported = true;
+	}
+	m_motionAddress = from;
+	m_reportTime.reset();
+
+	UInt32 ack = static_cast<UInt32>(packet.m_a);
+	if (ack > m_motionAck && ack <= m_motionSeq) {
+		m_motionAck = ack;
+	}
+	UInt32 received = static_cast<UInt32>(packet.m_b);
+	if (received > m_datagramAck && received <= m_motionSeq) {
+		m_datagramAck     = received;
+		m_datagramPending = false;
+	}
+
+	// the last motion was probably lost
+	if (m_sendTime.getTime() > s_motionSyncDelay) {
+		syncMotion();
+	}
+}
+
+bool
+CClientProxy1_6::hasMotionChannel() const
+{
+	return (m_motion != NULL);
+}
+
+bool
+CClientProxy1_6::hasRetryHint() const
+{
+	return true;
+}
+
+bool
+CClientProxy1_6::hasMultiFileTransfer() const
+{
+	return true;
+}
+
+bool
+CClientProxy1_6::leave()
+{
+	syncMotion();
+	return CClientProxy1_5::leave();
+}
+
+void
+CClientProxy1_6::mouseDown(ButtonID button)
+{
+	syncMotion();
+	CClientProxy1_5::mouseDown(button);
+}
+
+void
+CClientProxy1_6::mouseUp(ButtonID button)
+{
+	syncMotion();
+	CClientProxy1_5::mouseUp(button);
+}
+
+void
+CClientProxy1_6::mouseMove(SInt32 xAbs, SInt32 yAbs)
+{
+	if (m_motion == NULL) {
+		CClientProxy1_5::mouseMove(xAbs, yAbs);
+		return;
+	}
+	sendMotion(CMotionChannel::kMove, xAbs, yAbs);
+}
+
+void
+CClientProxy1_6::mouseRelativeMove(SInt32 xRel, SInt32 yRel)
+{
+	if (m_motion == NULL) {
+		CClientProxy1_5::mouseRelativeMove(xRel, yRel);
+		return;
+	}
+
+	// send running totals so a lost datagram is made up by the next
+	m_xRelative += static_cast<UInt32>(xRel);
+	m_yRelative += static_cast<UInt32>(yRel);
+	sendMotion(CMotionChannel::kRelative,
+		static_cast<SInt32>(m_xRelative), static_cast<SInt32>(m_yRelative));
+}
+
+void
+CClientProxy1_6::mouseWheel(SInt32 xDelta, SInt32 yDelta)
+{
+	syncMotion();
+	CClientProxy1_5::mouseWheel(xDelta, yDelta);
+}
+
+void
+CClientProxy1_6::keepAlive()
+{
+	syncMotion();
+	CClientProxy1_5::keepAlive();
+}
+
+void
+CClientProxy1_6::syncInput()
+{
+	syncMotion();
+}
+
+bool
+CClientProxy1_6::checkMotionChannel()
+{
+	if (m_motion == NULL || !m_motionReported) {
+		return false;
+	}
+	if (m_motionDown && m_downTime.getTime() < s_motionRetry) {
+		return false;
+	}
+
+	// down if the reports stop or none of the datagrams sent for a
+	// while got through
+	if (m_reportTime.getTime() > s_motionTimeout ||
+		(m_datagramPending && m_pendingTime.getTime() > s_motionTimeout)) {
+		if (!m_motionDown) {
+			LOG((CLOG_WARN "motion channel to \"%s\" is down, using the connection", getName().c_str()));
+			m_motionDown = true;
+		}
+		m_downTime.reset();
+		return false;
+	}
+
+	if (m_motionDown) {
+		LOG((CLOG_INFO "motion channel to \"%s\" is up again", getName().c_str()));
+		m_motionDown      = false;
+		m_datagramPending = false;
+	}
+	return true;
+}
+
+void
+CClientProxy1_6::sendMotion(CMotionChannel::EType type, SInt32 a, SInt32 b)
+{
+	m_lastMotion = CMotionChannel::CPacket(++m_motionSeq, type, a, b);
+	m_sendTime.reset();
+
+	if (!checkMotionChannel()) {
+		writeMotion(m_lastMotion);
+		return;
+	}
+
+	// time how long the client takes to receive from the first
+	// datagram since the last one it did
+	if (!m_datagramPending) {
+		m_datagramPending = true;
+		m_pendingTime.reset();
+	}
+
+	LOG((CLOG_DEBUG2 "send motion datagram %d to \"%s\" %c %d,%d", m_motionSeq, getName().c_str(), type, a, b));
+	if (m_motion->isLost()) {
+		return;
+	}
+	m_motionListener->send(
+		m_motion->encode(CMotionChannel::kToClient, m_lastMotion),
+		m_motionAddress);
+}
+
+void
+CClientProxy1_6::syncMotion()
+{
+	if (m_motionAck != m_motionSeq) {
+		writeMotion(m_lastMotion);
+	}
+}
+
+void
+CClientProxy1_6::writeMotion(const CMotionChannel::CPacket& packet)
+{
+	LOG((CLOG_DEBUG2 "send motion %d to \"%s\" %c %d,%d", packet.m_seq, getName().c_str(), packet.m_type, packet.m_a, packet.m_b));
+	CProtocolUtil::writef(getStream(), kMsgDMouseMoveSeq,
+		packet.m_seq, static_cast<UInt32>(packet.m_type),
+		packet.m_a, packet.m_b);
+
+	// the stream doesn't lose messages
+	m_motionAck = packet.m_seq;
+}
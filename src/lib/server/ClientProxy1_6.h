@@ -0,0 +1,126 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "server/ClientProxy1_5.h"
+#include "synergy/MotionChannel.h"
+#include "net/NetworkAddress.h"
+#include "base/Stopwatch.h"
+
+class CMotionListener;
+class CCryptoStream;
+class CServer;
+class IEventQueue;
+
+//! Proxy for client implementing protocol version 1.6
+/*!
+Sends mouse motion on the motion channel (see kMsgCMotionChannel) when
+the server has a CMotionListener and the client reports on it, and
+as kMsgDMouseMoveSeq on the stream when the channel is down.  Without
+a CMotionListener motion is sent as in protocol 1.5.
+*/
+class CClientProxy1_6 : public CClientProxy1_5 {
+public:
+	CClientProxy1_6(const CString& name, synergy::IStream* adoptedStream,
+							CCryptoStream* cryptoStream,
+							CServer* server, IEventQueue* events);
+	~CClientProxy1_6();
+
+	//! @name manipulators
+	//@{
+
+	//! Handle a motion channel datagram
+	/*!
+	Called by the CMotionListener with a datagram carrying this
+	client's token.
+	*/
+	void				handleMotionDatagram(const CString& data,
+							const CNetworkAddress& from);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test for a motion channel
+	/*!
+	Returns true if the motion channel was offered to the client, in
+	which case all mouse motion must go through this class.
+	*/
+	bool				hasMotionChannel() const;
+
+	//@}
+
+	// CClientProxy overrides
+	virtual bool		hasRetryHint() const;
+	virtual bool		hasMultiFileTransfer() const;
+
+	// IClient overrides
+	virtual bool		leave();
+	virtual void		mouseDown(ButtonID);
+	virtual void		mouseUp(ButtonID);
+	virtual void		mouseMove(SInt32 xAbs, SInt32 yAbs);
+	virtual void		mouseRelativeMove(SInt32 xRel, SInt32 yRel);
+	virtual void		mouseWheel(SInt32 xDelta, SInt32 yDelta);
+
+protected:
+	virtual void		keepAlive();
+
+	// CClientProxy1_4 overrides
+	virtual void		syncInput();
+
+	// send the last motion on the stream if the client hasn't
+	// acknowledged it, so it arrives before what's sent next
+	void				syncMotion();
+
+private:
+	// returns true if motion should go on the motion channel
+	bool				checkMotionChannel();
+
+	// send motion on the channel if it's up, otherwise on the stream
+	void				sendMotion(CMotionChannel::EType, SInt32 a, SInt32 b);
+
+	void				writeMotion(const CMotionChannel::CPacket&);
+
+private:
+	CMotionListener*	m_motionListener;
+	CMotionChannel*		m_motion;
+	CNetworkAddress		m_motionAddress;
+
+	// sequence number of the last motion sent, the highest one the
+	// client reported it has and the highest it reported receiving as
+	// a datagram
+	UInt32				m_motionSeq;
+	UInt32				m_motionAck;
+	UInt32				m_datagramAck;
+	CMotionChannel::CPacket	m_lastMotion;
+
+	// sequence number of the last report accepted
+	UInt32				m_reportSeq;
+
+	// running totals of relative motion
+	UInt32				m_xRelative;
+	UInt32				m_yRelative;
+
+	bool				m_motionReported;
+	bool				m_motionDown;
+	bool				m_datagramPending;
+	CStopwatch			m_reportTime;
+	CStopwatch			m_pendingTime;
+	CStopwatch			m_sendTime;
+	CStopwatch			m_downTime;
+};
@@ -0,0 +1,202 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "server/ClientProxy1_7.h"
+
+#include "synergy/ProtocolUtil.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+//
+// CClientProxy1_7
+//
+
+CClientProxy1_7::CClientProxy1_7(const CString& name, synergy::IStream* stream,
+				CCryptoStream* cryptoStream,
+				CServer* server, IEventQueue* events) :
+	CClientProxy1_6(name, stream, cryptoStream, server, events),
+	m_events(events),
+	m_xCompact(0),
+	m_yCompact(0),
+	m_moveHeld(false),
+	m_xHeld(0),
+	m_yHeld(0)
+{
+	// do nothing
+}
+
+CClientProxy1_7::~CClientProxy1_7()
+{
+	if (m_moveHeld) {
+		m_events->removeEndDispatchHandler(this);
+	}
+}
+
+void
+CClientProxy1_7::enter(SInt32 xAbs, SInt32 yAbs,
+				UInt32 seqNum, KeyModifierMask mask, bool forScreensaver)
+{
+	flushMouseMove();
+	CClientProxy1_6::enter(xAbs, yAbs, seqNum, mask, forScreensaver);
+	m_xCompact = xAbs;
+	m_yCompact = yAbs;
+}
+
+bool
+CClientProxy1_7::leave()
+{
+	flushMouseMove();
+	return CClientProxy1_6::leave();
+}
+
+void
+CClientProxy1_7::mouseDown(ButtonID button)
+{
+	LOG((CLOG_DEBUG1 "send mouse down to \"%s\" id=%d", getName().c_str(), button));
+	writeMouseButton(kMsgDCompactMouseDown, kMsgDCompactMoveMouseDown, button);
+}
+
+void
+CClientProxy1_7::mouseUp(ButtonID button)
+{
+	LOG((CLOG_DEBUG1 "send mouse up to \"%s\" id=%d", getName().c_str(), button));
+	writeMouseButton(kMsgDCompactMouseUp, kMsgDCompactMoveMouseUp, button);
+}
+
+void
+CClientProxy1_7::mouseMove(SInt32 xAbs, SInt32 yAbs)
+{
+	if (hasMotionChannel()) {
+		CClientProxy1_6::mouseMove(xAbs, yAbs);
+		return;
+	}
+
+	// send the move before this one and hold this one.  a timer could
+	// be held off by a busy queue so send it when the event is handled.
+	flushMouseMove();
+	m_moveHeld = true;
+	m_xHeld    = xAbs;
+	m_yHeld    = yAbs;
+	m_events->adoptEndDispatchHandler(this,
+							new TMethodEventJob<CClientProxy1_7>(this,
+								&CClientProxy1_7::handleEndDispatch));
+}
+
+void
+CClientProxy1_7::mouseRelativeMove(SInt32 xRel, SInt32 yRel)
+{
+	if (hasMotionChannel()) {
+		CClientProxy1_6::mouseRelativeMove(xRel, yRel);
+		return;
+	}
+
+	flushMouseMove();
+	LOG((CLOG_DEBUG2 "send mouse relative move to \"%s\" %d,%d", getName().c_str(), xRel, yRel));
+	CProtocolUtil::writef(getStream(), kMsgDCompactMouseRelMove, xRel, yRel);
+}
+
+void
+CClientProxy1_7::mouseWheel(SInt32 xDelta, SInt32 yDelta)
+{
+	flushMouseMove();
+	syncMotion();
+	LOG((CLOG_DEBUG2 "send mouse wheel to \"%s\" %+d,%+d", getName().c_str(), xDelta, yDelta));
+	CProtocolUtil::writef(getStream(), kMsgDCompactMouseWheel, xDelta, yDelta);
+}
+
+void
+CClientProxy1_7::sendDragInfo(UInt32 fileCount, const char* info, size_t size)
+{
+	// the client drops where the cursor is
+	flushMouseMove();
+	CClientProxy1_6::sendDragInfo(fileCount, info, size);
+}
+
+void
+CClientProxy1_7::keepAlive()
+{
+	flushMouseMove();
+	CClientProxy1_6::keepAlive();
+}
+
+void
+CClientProxy1_7::syncInput()
+{
+	flushMouseMove();
+	CClientProxy1_6::syncInput();
+}
+
+const char*
+CClientProxy1_7::getKeyDownFormat() const
+{
+	return kMsgDCompactKeyDown;
+}
+
+const char*
+CClientProxy1_7::getKeyRepeatFormat() const
+{
+	return kMsgDCompactKeyRepeat;
+}
+
+const char*
+CClientProxy1_7::getKeyUpFormat() const
+{
+	return kMsgDCompactKeyUp;
+}
+
+void
+CClientProxy1_7::flushMouseMove()
+{
+	if (!m_moveHeld) {
+		return;
+	}
+	m_moveHeld = false;
+	m_events->removeEndDispatchHandler(this);
+
+	LOG((CLOG_DEBUG2 "send mouse move to \"%s\" %d,%d", getName().c_str(), m_xHeld, m_yHeld));
+	CProtocolUtil::writef(getStream(), kMsgDCompactMouseMove,
+							m_xHeld - m_xCompact, m_yHeld - m_yCompact);
+	m_xCompact = m_xHeld;
+	m_yCompact = m_yHeld;
+}
+
+void
+CClientProxy1_7::writeMouseButton(const char* fmt,
+				const char* moveFmt, ButtonID button)
+{
+	if (!m_moveHeld) {
+		syncMotion();
+		CProtocolUtil::writef(getStream(), fmt, button);
+		return;
+	}
+	m_moveHeld = false;
+	m_events->removeEndDispatchHandler(this);
+
+	LOG((CLOG_DEBUG2 "with mouse move %d,%d", m_xHeld, m_yHeld));
+	CProtocolUtil::writef(getStream(), moveFmt,
+							m_xHeld - m_xCompact, m_yHeld - m_yCompact, button);
+	m_xCompact = m_xHeld;
+	m_yCompact = m_yHeld;
+}
+
+void
+CClientProxy1_7::handleEndDispatch(const CEvent&, void*)
+{
+	flushMouseMove();
+}
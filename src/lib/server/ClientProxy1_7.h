@@ -0,0 +1,83 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "server/ClientProxy1_6.h"
+
+class CCryptoStream;
+class CServer;
+class IEventQueue;
+
+//! Proxy for client implementing protocol version 1.7
+/*!
+Sends input as compact messages (see kMsgCompactLimit).  A mouse move
+is held until the event being dispatched has been handled, so a button
+press or release right after it can go in the same message.  Mouse motion still
+goes through CClientProxy1_6 when there's a motion channel.
+*/
+class CClientProxy1_7 : public CClientProxy1_6 {
+public:
+	CClientProxy1_7(const CString& name, synergy::IStream* adoptedStream,
+							CCryptoStream* cryptoStream,
+							CServer* server, IEventQueue* events);
+	~CClientProxy1_7();
+
+	// IClient overrides
+	virtual void		enter(SInt32 xAbs, SInt32 yAbs,
+							UInt32 seqNum, KeyModifierMask mask,
+							bool forScreensaver);
+	virtual bool		leave();
+	virtual void		mouseDown(ButtonID);
+	virtual void		mouseUp(ButtonID);
+	virtual void		mouseMove(SInt32 xAbs, SInt32 yAbs);
+	virtual void		mouseRelativeMove(SInt32 xRel, SInt32 yRel);
+	virtual void		mouseWheel(SInt32 xDelta, SInt32 yDelta);
+	virtual void		sendDragInfo(UInt32 fileCount, const char* info, size_t size);
+
+protected:
+	virtual void		keepAlive();
+
+	// CClientProxy1_4 overrides
+	virtual void		syncInput();
+	virtual const char*	getKeyDownFormat() const;
+	virtual const char*	getKeyRepeatFormat() const;
+	virtual const char*	getKeyUpFormat() const;
+
+private:
+	// send the held mouse move, if any
+	void				flushMouseMove();
+
+	// send a button press or release with the held mouse move, if any
+	void				writeMouseButton(const char* fmt,
+							const char* moveFmt, ButtonID);
+
+	void				handleEndDispatch(const CEvent&, void*);
+
+private:
+	IEventQueue*		m_events;
+
+	// the position compact moves are relative to
+	SInt32				m_xCompact;
+	SInt32				m_yCompact;
+
+	// mouse move waiting to be sent
+	bool				m_moveHeld;
+	SInt32				m_xHeld;
+	SInt32				m_yHeld;
+};
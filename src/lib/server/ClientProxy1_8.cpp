@@ -0,0 +1,53 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "server/ClientProxy1_8.h"
+
+#include "server/Server.h"
+#include "synergy/PacketStreamFilter.h"
+#include "base/Log.h"
+
+//
+// CClientProxy1_8
+//
+
+CClientProxy1_8::CClientProxy1_8(const CString& name, synergy::IStream* stream,
+				CPacketStreamFilter* packetStream,
+				CCryptoStream* cryptoStream,
+				CServer* server, IEventQueue* events) :
+	CClientProxy1_7(name, stream, cryptoStream, server, events),
+	m_packetStream(packetStream)
+{
+	if (m_packetStream != NULL) {
+		m_packetStream->setBatchDelay(server->getBatchDelay());
+	}
+}
+
+CClientProxy1_8::~CClientProxy1_8()
+{
+	// the base class destructor deletes the stream so the packet
+	// filter is still here
+	if (m_packetStream != NULL && m_packetStream->getNumFrames() != 0) {
+		LOG((CLOG_INFO "sent \"%s\" %d messages in %d frames, %.1f per frame, %d at most",
+			getName().c_str(), m_packetStream->getNumFramedWrites(),
+			m_packetStream->getNumFrames(),
+			(double)m_packetStream->getNumFramedWrites() /
+				m_packetStream->getNumFrames(),
+			m_packetStream->getMaxFramedWrites()));
+	}
+}
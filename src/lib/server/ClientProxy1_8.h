@@ -0,0 +1,47 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "server/ClientProxy1_7.h"
+
+class CCryptoStream;
+class CPacketStreamFilter;
+class CServer;
+class IEventQueue;
+
+//! Proxy for client implementing protocol version 1.8
+/*!
+Batches the messages to the client into frames, so the input made while
+handling one round of events goes out in one packet and one write to the
+socket.  Frames are held for at most the server's batch delay.
+\p packetStream is the packet filter in \p adoptedStream's filter stack,
+or NULL if there isn't one.
+*/
+class CClientProxy1_8 : public CClientProxy1_7 {
+public:
+	CClientProxy1_8(const CString& name, synergy::IStream* adoptedStream,
+							CPacketStreamFilter* packetStream,
+							CCryptoStream* cryptoStream,
+							CServer* server, IEventQueue* events);
+	~CClientProxy1_8();
+
+private:
+	// the packet filter in the stream's filter stack, if any
+	CPacketStreamFilter*	m_packetStream;
+};
@@ -25,6 +25,9 @@
 #include "server/ClientProxy1_3.h"
 #include "server/ClientProxy1_4.h"
 #include "server/ClientProxy1_5.h"
+#include "server/ClientProxy1_6.h"
+#include "server/ClientProxy1_7.h"
+#include "server/ClientProxy1_8.h"
 #include "synergy/protocol_types.h"
 #include "synergy/ProtocolUtil.h"
 #include "synergy/XSynergy.h"
@@ -39,8 +42,13 @@
 // CClientProxyUnknown
 //
 
-CClientProxyUnknown::CClientProxyUnknown(synergy::IStream* stream, double timeout, CServer* server, IEventQueue* events) :
+CClientProxyUnknown::CClientProxyUnknown(synergy::IStream* stream,
+				CPacketStreamFilter* packetStream,
+				CCryptoStream* cryptoStream,
+				double timeout, CServer* server, IEventQueue* events) :
 	m_stream(stream),
+	m_packetStream(packetStream),
+	m_cryptoStream(cryptoStream),
 	m_proxy(NULL),
 	m_ready(false),
 	m_server(server),
@@ -221,11 +229,28 @@ CClientProxyUnknown::handleData(const CEvent&, void*)
 				break;
 
 			case 4:
-				m_proxy = new CClientProxy1_4(name, m_stream, m_server, m_events);
+				m_proxy = new CClientProxy1_4(name, m_stream, m_cryptoStream,
+								m_server, m_events);
 				break;
 
 			case 5:
-				m_proxy = new CClientProxy1_5(name, m_stream, m_server, m_events);
+				m_proxy = new CClientProxy1_5(name, m_stream, m_cryptoStream,
+								m_server, m_events);
+				break;
+
+			case 6:
+				m_proxy = new CClientProxy1_6(name, m_stream, m_cryptoStream,
+								m_server, m_events);
+				break;
+
+			case 7:
+				m_proxy = new CClientProxy1_7(name, m_stream, m_cryptoStream,
+								m_server, m_events);
+				break;
+
+			case 8:
+				m_proxy = new CClientProxy1_8(name, m_stream, m_packetStream,
+								m_cryptoStream, m_server, m_events);
 				break;
 			}
 		}
@@ -22,14 +22,25 @@
 #include "base/EventTypes.h"
 
 class CClientProxy;
+class CCryptoStream;
 class CEventQueueTimer;
+class CPacketStreamFilter;
 namespace synergy { class IStream; }
 class CServer;
 class IEventQueue;
 
+//! Proxy for a client that hasn't finished the handshake
+/*!
+\p packetStream and \p cryptoStream are the packet filter and crypto
+stream in \p stream's filter stack, or NULL if it doesn't have them.
+*/
 class CClientProxyUnknown {
 public:
-	CClientProxyUnknown(synergy::IStream* stream, double timeout, CServer* server, IEventQueue* events);
+	CClientProxyUnknown(synergy::IStream* stream,
+							CPacketStreamFilter* packetStream,
+							CCryptoStream* cryptoStream,
+							double timeout, CServer* server,
+							IEventQueue* events);
 	~CClientProxyUnknown();
 
 	//! @name manipulators
@@ -60,6 +71,8 @@ private:
 
 private:
 	synergy::IStream*	m_stream;
+	CPacketStreamFilter*	m_packetStream;
+	CCryptoStream*		m_cryptoStream;
 	CEventQueueTimer*	m_timer;
 	CClientProxy*		m_proxy;
 	bool				m_ready;
@@ -553,6 +553,16 @@ CConfig::getOptions(const CString& name) const
 	return options;
 }
 
+bool
+CConfig::hasScreenOptions(const CString& name) const
+{
+	if (name.empty()) {
+		return false;
+	}
+	const CScreenOptions* options = getOptions(name);
+	return (options != NULL && !options->empty());
+}
+
 bool
 CConfig::hasLockToScreenAction() const
 {
@@ -641,6 +651,22 @@ CConfig::getInputFilter()
 	return &m_inputFilter;
 }
 
+void
+CConfig::assignExceptInputFilter(const CConfig& x)
+{
+	m_map                   = x.m_map;
+	m_nameToCanonicalName   = x.m_nameToCanonicalName;
+	m_synergyAddress        = x.m_synergyAddress;
+	m_globalOptions         = x.m_globalOptions;
+	m_hasLockToScreenAction = x.m_hasLockToScreenAction;
+}
+
+const CInputFilter*
+CConfig::getInputFilter() const
+{
+	return &m_inputFilter;
+}
+
 CString
 CConfig::formatInterval(const CInterval& x)
 {
@@ -320,10 +320,21 @@ public:
 	virtual CInputFilter*
 						getInputFilter();
 
+	//! Copy all but the input filter
+	/*!
+	Sets this configuration to \c x except for the input filter, which
+	is left as it is.  Assigning an input filter unregisters and
+	reregisters its hotkeys, which is wasted when the rules are the same.
+	*/
+	void				assignExceptInputFilter(const CConfig& x);
+
 	//@}
 	//! @name accessors
 	//@{
 
+	//! Get the hot key input filter
+	const CInputFilter*	getInputFilter() const;
+
 	//! Test screen name validity
 	/*!
 	Returns true iff \c name is a valid screen name.
@@ -401,6 +412,13 @@ public:
 	*/
 	const CScreenOptions* getOptions(const CString& name) const;
 
+	//! Test for screen options
+	/*!
+	Returns true iff the named screen has options of its own, as opposed
+	to only the global options.
+	*/
+	bool				hasScreenOptions(const CString& name) const;
+
 	//! Check for lock to screen action
 	/*!
 	Returns \c true if this configuration has a lock to screen action.
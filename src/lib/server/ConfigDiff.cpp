@@ -0,0 +1,194 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2013 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ConfigDiff.h"
+
+#include "server/Config.h"
+
+using namespace synergy::string;
+
+//
+// CConfigDiff
+//
+
+CConfigDiff::CConfigDiff(const CConfig& oldConfig, const CConfig& newConfig) :
+	m_globalOptionsChanged(false),
+	m_aliasesChanged(false),
+	m_inputFilterChanged(false),
+	m_addressChanged(false)
+{
+	diffScreens(oldConfig, newConfig);
+	diffAliases(oldConfig, newConfig);
+
+	m_globalOptionsChanged =
+		(*oldConfig.getOptions("") != *newConfig.getOptions(""));
+	m_inputFilterChanged =
+		(*oldConfig.getInputFilter() != *newConfig.getInputFilter());
+	m_addressChanged =
+		(oldConfig.getSynergyAddress() != newConfig.getSynergyAddress());
+}
+
+CConfigDiff::~CConfigDiff()
+{
+	// do nothing
+}
+
+bool
+CConfigDiff::isEmpty() const
+{
+	return (m_added.empty() &&
+			m_removed.empty() &&
+			m_linksChanged.empty() &&
+			m_optionsChanged.empty() &&
+			!m_globalOptionsChanged &&
+			!m_aliasesChanged &&
+			!m_inputFilterChanged &&
+			!m_addressChanged);
+}
+
+const CConfigDiff::CScreenSet&
+CConfigDiff::getAddedScreens() const
+{
+	return m_added;
+}
+
+const CConfigDiff::CScreenSet&
+CConfigDiff::getRemovedScreens() const
+{
+	return m_removed;
+}
+
+const CConfigDiff::CScreenSet&
+CConfigDiff::getLinksChanged() const
+{
+	return m_linksChanged;
+}
+
+const CConfigDiff::CScreenSet&
+CConfigDiff::getOptionsChanged() const
+{
+	return m_optionsChanged;
+}
+
+bool
+CConfigDiff::haveGlobalOptionsChanged() const
+{
+	return m_globalOptionsChanged;
+}
+
+bool
+CConfigDiff::haveAliasesChanged() const
+{
+	return m_aliasesChanged;
+}
+
+bool
+CConfigDiff::hasInputFilterChanged() const
+{
+	return m_inputFilterChanged;
+}
+
+bool
+CConfigDiff::hasAddressChanged() const
+{
+	return m_addressChanged;
+}
+
+bool
+CConfigDiff::needsOptions(const CString& name) const
+{
+	return (m_globalOptionsChanged || m_optionsChanged.count(name) != 0);
+}
+
+void
+CConfigDiff::diffScreens(const CConfig& oldConfig, const CConfig& newConfig)
+{
+	for (CConfig::const_iterator screen = oldConfig.begin();
+								screen != oldConfig.end(); ++screen) {
+		if (!newConfig.isCanonicalName(*screen)) {
+			m_removed.insert(*screen);
+		}
+		else {
+			if (*oldConfig.getOptions(*screen) !=
+				*newConfig.getOptions(*screen)) {
+				m_optionsChanged.insert(*screen);
+			}
+			if (!equalLinks(oldConfig, newConfig, *screen)) {
+				m_linksChanged.insert(*screen);
+			}
+		}
+	}
+
+	for (CConfig::const_iterator screen = newConfig.begin();
+								screen != newConfig.end(); ++screen) {
+		if (!oldConfig.isCanonicalName(*screen)) {
+			m_added.insert(*screen);
+		}
+	}
+}
+
+void
+CConfigDiff::diffAliases(const CConfig& oldConfig, const CConfig& newConfig)
+{
+	// the name maps include canonical names so screen changes show up
+	// here too;  only report changes to actual aliases.
+	CConfig::all_const_iterator index1 = oldConfig.beginAll();
+	CConfig::all_const_iterator index2 = newConfig.beginAll();
+	for (;;) {
+		while (index1 != oldConfig.endAll() &&
+				CaselessCmp::equal(index1->first, index1->second)) {
+			++index1;
+		}
+		while (index2 != newConfig.endAll() &&
+				CaselessCmp::equal(index2->first, index2->second)) {
+			++index2;
+		}
+		if (index1 == oldConfig.endAll() || index2 == newConfig.endAll()) {
+			break;
+		}
+		if (!CaselessCmp::equal(index1->first,  index2->first) ||
+			!CaselessCmp::equal(index1->second, index2->second)) {
+			m_aliasesChanged = true;
+			return;
+		}
+		++index1;
+		++index2;
+	}
+	m_aliasesChanged = (index1 != oldConfig.endAll() ||
+						index2 != newConfig.endAll());
+}
+
+bool
+CConfigDiff::equalLinks(const CConfig& oldConfig, const CConfig& newConfig,
+				const CString& name)
+{
+	CConfig::link_const_iterator index1 = oldConfig.beginNeighbor(name);
+	CConfig::link_const_iterator index2 = newConfig.beginNeighbor(name);
+	for (; index1 != oldConfig.endNeighbor(name) &&
+			index2 != newConfig.endNeighbor(name); ++index1, ++index2) {
+		// CCellEdge::operator== doesn't compare names.  only compare
+		// destination names.
+		if (index1->first != index2->first ||
+			index1->second != index2->second ||
+			!CaselessCmp::equal(index1->second.getName(),
+								index2->second.getName())) {
+			return false;
+		}
+	}
+	return (index1 == oldConfig.endNeighbor(name) &&
+			index2 == newConfig.endNeighbor(name));
+}
@@ -0,0 +1,111 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2013 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/stdset.h"
+
+class CConfig;
+
+//! Server configuration difference
+/*!
+Describes what changed between two server configurations:  screens
+added or removed, screens whose links or options changed, global
+options, aliases, the input filter and the listen address.  The server
+uses this to apply a reloaded configuration without disturbing
+clients that aren't affected by the change.
+*/
+class CConfigDiff {
+public:
+	typedef std::set<CString, synergy::string::CaselessCmp> CScreenSet;
+
+	CConfigDiff(const CConfig& oldConfig, const CConfig& newConfig);
+	~CConfigDiff();
+
+	//! @name accessors
+	//@{
+
+	//! Test for no change
+	/*!
+	Returns true iff the configurations are equivalent.
+	*/
+	bool				isEmpty() const;
+
+	//! Get added screens
+	/*!
+	Returns the canonical names of screens only in the new configuration.
+	*/
+	const CScreenSet&	getAddedScreens() const;
+
+	//! Get removed screens
+	/*!
+	Returns the canonical names of screens only in the old configuration.
+	*/
+	const CScreenSet&	getRemovedScreens() const;
+
+	//! Get screens with changed links
+	/*!
+	Returns the canonical names of screens in both configurations whose
+	links to neighbors changed.
+	*/
+	const CScreenSet&	getLinksChanged() const;
+
+	//! Get screens with changed options
+	/*!
+	Returns the canonical names of screens in both configurations whose
+	screen specific options changed.
+	*/
+	const CScreenSet&	getOptionsChanged() const;
+
+	//! Test for changed global options
+	bool				haveGlobalOptionsChanged() const;
+
+	//! Test for changed aliases
+	bool				haveAliasesChanged() const;
+
+	//! Test for changed input filter
+	bool				hasInputFilterChanged() const;
+
+	//! Test for changed listen address
+	bool				hasAddressChanged() const;
+
+	//! Test if a screen needs its options resent
+	/*!
+	Returns true iff the options sent to screen \p name changed, either
+	because its own options or the global options changed.
+	*/
+	bool				needsOptions(const CString& name) const;
+
+	//@}
+
+private:
+	void				diffScreens(const CConfig&, const CConfig&);
+	void				diffAliases(const CConfig&, const CConfig&);
+	static bool			equalLinks(const CConfig&, const CConfig&,
+							const CString& name);
+
+private:
+	CScreenSet			m_added;
+	CScreenSet			m_removed;
+	CScreenSet			m_linksChanged;
+	CScreenSet			m_optionsChanged;
+	bool				m_globalOptionsChanged;
+	bool				m_aliasesChanged;
+	bool				m_inputFilterChanged;
+	bool				m_addressChanged;
+};
@@ -26,10 +26,38 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
+#include <iterator>
+
+// modifiers that cannot be combined with a mouse button
+static const KeyModifierMask s_buttonIgnoreMask =
+	KeyModifierAltGr | KeyModifierCapsLock |
+	KeyModifierNumLock | KeyModifierScrollLock;
 
 // -----------------------------------------------------------------------------
 // Input Filter Condition Classes
 // -----------------------------------------------------------------------------
+CInputFilter::CIndexKey::CIndexKey(
+		CEvent::Type type, UInt32 id, KeyModifierMask mask) :
+	m_type(type),
+	m_id(id),
+	m_mask(mask)
+{
+	// do nothing
+}
+
+bool
+CInputFilter::CIndexKey::operator<(const CIndexKey& x) const
+{
+	if (m_type != x.m_type) {
+		return (m_type < x.m_type);
+	}
+	if (m_id != x.m_id) {
+		return (m_id < x.m_id);
+	}
+	return (m_mask < x.m_mask);
+}
+
 CInputFilter::CCondition::CCondition()
 {
 	// do nothing
@@ -40,6 +68,12 @@ CInputFilter::CCondition::~CCondition()
 	// do nothing
 }
 
+bool
+CInputFilter::CCondition::getIndexKeys(CIndexKeyList&) const
+{
+	return false;
+}
+
 void
 CInputFilter::CCondition::enablePrimary(CPrimaryClient*)
 {
@@ -129,6 +163,14 @@ CInputFilter::CKeystrokeCondition::match(const CEvent& event)
 	return status;
 }
 
+bool
+CInputFilter::CKeystrokeCondition::getIndexKeys(CIndexKeyList& keys) const
+{
+	keys.push_back(CIndexKey(m_events->forIPrimaryScreen().hotKeyDown(), m_id));
+	keys.push_back(CIndexKey(m_events->forIPrimaryScreen().hotKeyUp(), m_id));
+	return true;
+}
+
 void
 CInputFilter::CKeystrokeCondition::enablePrimary(CPrimaryClient* primary)
 {
@@ -196,10 +238,6 @@ CInputFilter::CMouseButtonCondition::format() const
 CInputFilter::EFilterStatus		
 CInputFilter::CMouseButtonCondition::match(const CEvent& event)
 {
-	static const KeyModifierMask s_ignoreMask =
-		KeyModifierAltGr | KeyModifierCapsLock |
-		KeyModifierNumLock | KeyModifierScrollLock;
-
 	EFilterStatus status;
 
 	// check for hotkey events
@@ -219,13 +257,23 @@ CInputFilter::CMouseButtonCondition::match(const CEvent& event)
 	IPlatformScreen::CButtonInfo* minfo =
 		reinterpret_cast<IPlatformScreen::CButtonInfo*>(event.getData());
 	if (minfo->m_button != m_button ||
-		(minfo->m_mask & ~s_ignoreMask) != m_mask) {
+		(minfo->m_mask & ~s_buttonIgnoreMask) != m_mask) {
 		return kNoMatch;
 	}
 
 	return status;
 }
 
+bool
+CInputFilter::CMouseButtonCondition::getIndexKeys(CIndexKeyList& keys) const
+{
+	keys.push_back(CIndexKey(m_events->forIPrimaryScreen().buttonDown(),
+							m_button, m_mask));
+	keys.push_back(CIndexKey(m_events->forIPrimaryScreen().buttonUp(),
+							m_button, m_mask));
+	return true;
+}
+
 CInputFilter::CScreenConnectedCondition::CScreenConnectedCondition(
 		IEventQueue* events, const CString& screen) :
 	m_screen(screen),
@@ -265,6 +313,13 @@ CInputFilter::CScreenConnectedCondition::match(const CEvent& event)
 	return kNoMatch;
 }
 
+bool
+CInputFilter::CScreenConnectedCondition::getIndexKeys(CIndexKeyList& keys) const
+{
+	keys.push_back(CIndexKey(m_events->forCServer().connected()));
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Input Filter Action Classes
 // -----------------------------------------------------------------------------
@@ -861,6 +916,16 @@ CInputFilter::CRule::getCondition() const
 	return m_condition;
 }
 
+bool
+CInputFilter::CRule::getIndexKeys(CIndexKeyList& keys) const
+{
+	// NULL condition never matches so it needs no keys
+	if (m_condition == NULL) {
+		return true;
+	}
+	return m_condition->getIndexKeys(keys);
+}
+
 UInt32
 CInputFilter::CRule::getNumActions(bool onActivation) const
 {
@@ -889,7 +954,8 @@ CInputFilter::CRule::getAction(bool onActivation, UInt32 index) const
 // -----------------------------------------------------------------------------
 CInputFilter::CInputFilter(IEventQueue* events) :
 	m_primaryClient(NULL),
-	m_events(events)
+	m_events(events),
+	m_rulesCompiled(false)
 {
 	// do nothing
 }
@@ -897,7 +963,8 @@ CInputFilter::CInputFilter(IEventQueue* events) :
 CInputFilter::CInputFilter(const CInputFilter& x) :
 	m_ruleList(x.m_ruleList),
 	m_primaryClient(NULL),
-	m_events(x.m_events)
+	m_events(x.m_events),
+	m_rulesCompiled(false)
 {
 	setPrimaryClient(x.m_primaryClient);
 }
@@ -914,7 +981,8 @@ CInputFilter::operator=(const CInputFilter& x)
 		CPrimaryClient* oldClient = m_primaryClient;
 		setPrimaryClient(NULL);
 
-		m_ruleList = x.m_ruleList;
+		m_ruleList      = x.m_ruleList;
+		m_rulesCompiled = false;
 
 		setPrimaryClient(oldClient);
 	}
@@ -928,6 +996,7 @@ CInputFilter::addFilterRule(const CRule& rule)
 	if (m_primaryClient != NULL) {
 		m_ruleList.back().enable(m_primaryClient);
 	}
+	m_rulesCompiled = false;
 }
 
 void
@@ -937,11 +1006,13 @@ CInputFilter::removeFilterRule(UInt32 index)
 		m_ruleList[index].disable(m_primaryClient);
 	}
 	m_ruleList.erase(m_ruleList.begin() + index);
+	m_rulesCompiled = false;
 }
 
 CInputFilter::CRule&
 CInputFilter::getRule(UInt32 index)
 {
+	m_rulesCompiled = false;
 	return m_ruleList[index];
 }
 
@@ -1017,6 +1088,51 @@ CInputFilter::setPrimaryClient(CPrimaryClient* client)
 			rule->enable(m_primaryClient);
 		}
 	}
+
+	// hotkey ids change when rules are enabled or disabled
+	m_rulesCompiled = false;
+}
+
+void
+CInputFilter::compileRules()
+{
+	m_ruleIndex.clear();
+	m_unindexedRules.clear();
+
+	// collect the rules that can match each key
+	CIndexKeyList keys;
+	for (UInt32 i = 0; i < m_ruleList.size(); ++i) {
+		keys.clear();
+		if (!m_ruleList[i].getIndexKeys(keys)) {
+			m_unindexedRules.push_back(i);
+			continue;
+		}
+		for (CIndexKeyList::const_iterator key = keys.begin();
+								key != keys.end(); ++key) {
+			CRuleIndexList& rules = m_ruleIndex[*key];
+			if (rules.empty() || rules.back() != i) {
+				rules.push_back(i);
+			}
+		}
+	}
+
+	// unindexed rules may match anything so merge them into each list,
+	// keeping rule order so the first matching rule still wins.
+	if (!m_unindexedRules.empty()) {
+		for (CRuleIndex::iterator index = m_ruleIndex.begin();
+								index != m_ruleIndex.end(); ++index) {
+			CRuleIndexList merged;
+			merged.reserve(index->second.size() + m_unindexedRules.size());
+			std::merge(index->second.begin(), index->second.end(),
+						m_unindexedRules.begin(), m_unindexedRules.end(),
+						std::back_inserter(merged));
+			index->second.swap(merged);
+		}
+	}
+
+	m_rulesCompiled = true;
+	LOG((CLOG_DEBUG1 "compiled %d filter rules into %d keys, %d unindexed",
+		m_ruleList.size(), m_ruleIndex.size(), m_unindexedRules.size()));
 }
 
 CString
@@ -1068,6 +1184,20 @@ CInputFilter::operator!=(const CInputFilter& x) const
 	return !operator==(x);
 }
 
+bool
+CInputFilter::hasSameRules(const CInputFilter& x) const
+{
+	if (m_ruleList.size() != x.m_ruleList.size()) {
+		return false;
+	}
+	for (UInt32 i = 0; i < m_ruleList.size(); ++i) {
+		if (m_ruleList[i].format() != x.m_ruleList[i].format()) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void
 CInputFilter::handleEvent(const CEvent& event, void*)
 {
@@ -1076,10 +1206,21 @@ CInputFilter::handleEvent(const CEvent& event, void*)
 								event.getFlags() | CEvent::kDontFreeData |
 								CEvent::kDeliverImmediately);
 
-	// let each rule try to match the event until one does
-	for (CRuleList::iterator rule  = m_ruleList.begin();
-							 rule != m_ruleList.end(); ++rule) {
-		if (rule->handleEvent(myEvent)) {
+	if (!m_rulesCompiled) {
+		compileRules();
+	}
+
+	// find the rules that could match the event
+	const CRuleIndexList* rules = &m_unindexedRules;
+	CRuleIndex::const_iterator index = m_ruleIndex.find(getIndexKey(event));
+	if (index != m_ruleIndex.end()) {
+		rules = &index->second;
+	}
+
+	// let each candidate rule try to match the event until one does
+	for (CRuleIndexList::const_iterator i = rules->begin();
+								i != rules->end(); ++i) {
+		if (m_ruleList[*i].handleEvent(myEvent)) {
 			// handled
 			return;
 		}
@@ -1088,3 +1229,25 @@ CInputFilter::handleEvent(const CEvent& event, void*)
 	// not handled so pass through
 	m_events->addEvent(myEvent);
 }
+
+CInputFilter::CIndexKey
+CInputFilter::getIndexKey(const CEvent& event) const
+{
+	CEvent::Type type = event.getType();
+	if (type == m_events->forIPrimaryScreen().hotKeyDown() ||
+		type == m_events->forIPrimaryScreen().hotKeyUp()) {
+		IPlatformScreen::CHotKeyInfo* kinfo =
+			reinterpret_cast<IPlatformScreen::CHotKeyInfo*>(event.getData());
+		return CIndexKey(type, kinfo->m_id);
+	}
+	else if (type == m_events->forIPrimaryScreen().buttonDown() ||
+			 type == m_events->forIPrimaryScreen().buttonUp()) {
+		IPlatformScreen::CButtonInfo* minfo =
+			reinterpret_cast<IPlatformScreen::CButtonInfo*>(event.getData());
+		return CIndexKey(type, minfo->m_button,
+							minfo->m_mask & ~s_buttonIgnoreMask);
+	}
+	else {
+		return CIndexKey(type);
+	}
+}
@@ -22,12 +22,13 @@
 #include "synergy/mouse_types.h"
 #include "synergy/protocol_types.h"
 #include "synergy/IPlatformScreen.h"
+#include "base/Event.h"
 #include "base/String.h"
 #include "common/stdmap.h"
 #include "common/stdset.h"
+#include "common/stdvector.h"
 
 class CPrimaryClient;
-class CEvent;
 class IEventQueue;
 
 class CInputFilter {
@@ -41,6 +42,24 @@ public:
 		kDeactivate
 	};
 
+	//! Rule index key
+	/*!
+	Identifies the events a condition can match:  the event type plus
+	an event specific id (hotkey id or mouse button) and modifier mask.
+	*/
+	class CIndexKey {
+	public:
+		CIndexKey(CEvent::Type type, UInt32 id = 0, KeyModifierMask mask = 0);
+
+		bool					operator<(const CIndexKey&) const;
+
+	public:
+		CEvent::Type			m_type;
+		UInt32					m_id;
+		KeyModifierMask			m_mask;
+	};
+	typedef std::vector<CIndexKey> CIndexKeyList;
+
 	class CCondition {
 	public:
 		CCondition();
@@ -51,6 +70,15 @@ public:
 
 		virtual EFilterStatus	match(const CEvent&) = 0;
 
+		//! Get index keys
+		/*!
+		Append the keys of every event this condition can match to
+		\p keys and return true.  Return false if the condition must
+		be tried against every event (the default).  Keys may depend
+		on state set by enablePrimary().
+		*/
+		virtual bool			getIndexKeys(CIndexKeyList& keys) const;
+
 		virtual void			enablePrimary(CPrimaryClient*);
 		virtual void			disablePrimary(CPrimaryClient*);
 	};
@@ -69,6 +97,7 @@ public:
 		virtual CCondition*		clone() const;
 		virtual CString			format() const;
 		virtual EFilterStatus	match(const CEvent&);
+		virtual bool			getIndexKeys(CIndexKeyList&) const;
 		virtual void			enablePrimary(CPrimaryClient*);
 		virtual void			disablePrimary(CPrimaryClient*);
 
@@ -93,6 +122,7 @@ public:
 		virtual CCondition*		clone() const;
 		virtual CString			format() const;
 		virtual EFilterStatus	match(const CEvent&);
+		virtual bool			getIndexKeys(CIndexKeyList&) const;
 
 	private:
 		ButtonID				m_button;
@@ -110,6 +140,7 @@ public:
 		virtual CCondition*		clone() const;
 		virtual CString			format() const;
 		virtual EFilterStatus	match(const CEvent&);
+		virtual bool			getIndexKeys(CIndexKeyList&) const;
 
 	private:
 		CString					m_screen;
@@ -293,6 +324,10 @@ public:
 		const CCondition*
 						getCondition() const;
 
+		// get the index keys of the rule's condition.  returns false
+		// if the rule must be tried against every event.
+		bool			getIndexKeys(CIndexKeyList& keys) const;
+
 		// get number of actions
 		UInt32			getNumActions(bool onActivation) const;
 
@@ -321,7 +356,7 @@ public:
 	virtual ~CInputFilter();
 
 #ifdef TEST_ENV
-	CInputFilter() : m_primaryClient(NULL) { }
+	CInputFilter() : m_primaryClient(NULL), m_rulesCompiled(false) { }
 #endif
 
 	CInputFilter&		operator=(const CInputFilter&);
@@ -332,13 +367,20 @@ public:
 	// remove a rule
 	void				removeFilterRule(UInt32 index);
 
-	// get rule by index
+	// get rule by index.  the rule index is recompiled before the next
+	// event since the caller may modify the rule.
 	CRule&				getRule(UInt32 index);
 
 	// enable event filtering using the given primary client.  disable
 	// if client is NULL.
 	virtual void		setPrimaryClient(CPrimaryClient* client);
 
+	// compile the rules into an index of candidate rules by event
+	// type, id and modifier mask.  this happens automatically before
+	// the first event after the rules or the primary client change;
+	// call it to avoid paying that cost on the input path.
+	void				compileRules();
+
 	// convert rules to a string
 	CString				format(const CString& linePrefix) const;
 
@@ -350,12 +392,32 @@ public:
 	//! Compare filters
 	bool				operator!=(const CInputFilter&) const;
 
+	//! Compare rules in order
+	/*!
+	Returns true iff both filters have the same rules in the same order,
+	so assigning one to the other would change nothing.
+	*/
+	bool				hasSameRules(const CInputFilter&) const;
+
 private:
 	// event handling
 	void				handleEvent(const CEvent&, void*);
 
+	// get the index key matching an event
+	CIndexKey			getIndexKey(const CEvent&) const;
+
 private:
+	typedef std::vector<UInt32> CRuleIndexList;
+	typedef std::map<CIndexKey, CRuleIndexList> CRuleIndex;
+
 	CRuleList			m_ruleList;
 	CPrimaryClient*		m_primaryClient;
 	IEventQueue*		m_events;
+
+	// indices into m_ruleList, in rule order, of the rules that can
+	// match each key.  unindexed rules are merged into every list and
+	// are the only candidates for keys not in the index.
+	CRuleIndex			m_ruleIndex;
+	CRuleIndexList		m_unindexedRules;
+	bool				m_rulesCompiled;
 };
@@ -0,0 +1,125 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/MotionListener.h"
+
+#include "server/ClientProxy1_6.h"
+#include "synergy/MotionChannel.h"
+#include "net/IDatagramSocket.h"
+#include "net/ISocketFactory.h"
+#include "net/NetworkAddress.h"
+#include "net/XSocket.h"
+#include "base/Log.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+
+//
+// CMotionListener
+//
+
+CMotionListener::CMotionListener(const CNetworkAddress& address,
+				ISocketFactory* socketFactory,
+				IEventQueue* events) :
+	m_socketFactory(socketFactory),
+	m_socket(NULL),
+	m_events(events),
+	m_loss(0.0)
+{
+	assert(m_socketFactory != NULL);
+
+	try {
+		m_socket = m_socketFactory->createDatagram();
+		LOG((CLOG_DEBUG1 "binding motion socket"));
+		m_socket->bind(address);
+	}
+	catch (XBase&) {
+		delete m_socket;
+		delete m_socketFactory;
+		throw;
+	}
+
+	m_events->adoptHandler(m_events->forIStream().inputReady(),
+							m_socket->getEventTarget(),
+							new TMethodEventJob<CMotionListener>(this,
+								&CMotionListener::handleData));
+}
+
+CMotionListener::~CMotionListener()
+{
+	m_events->removeHandler(m_events->forIStream().inputReady(),
+							m_socket->getEventTarget());
+	delete m_socket;
+	delete m_socketFactory;
+}
+
+void
+CMotionListener::setLoss(double fraction)
+{
+	m_loss = fraction;
+}
+
+UInt32
+CMotionListener::addClient(CClientProxy1_6* client)
+{
+	// tokens must be hard to guess since an unencrypted client's
+	// datagrams are trusted by their token alone
+	UInt32 token;
+	do {
+		m_random.GenerateBlock(reinterpret_cast<byte*>(&token), sizeof(token));
+	} while (token == 0 || m_clients.count(token) != 0);
+
+	m_clients.insert(std::make_pair(token, client));
+	return token;
+}
+
+void
+CMotionListener::removeClient(UInt32 token)
+{
+	m_clients.erase(token);
+}
+
+void
+CMotionListener::send(const CString& data, const CNetworkAddress& address)
+{
+	m_socket->sendTo(data.data(), (UInt32)data.size(), address);
+}
+
+double
+CMotionListener::getLoss() const
+{
+	return m_loss;
+}
+
+void
+CMotionListener::handleData(const CEvent&, void*)
+{
+	CString data;
+	CNetworkAddress from;
+	while (m_socket->receive(data, from)) {
+		UInt32 token;
+		if (!CMotionChannel::getToken(data, token)) {
+			LOG((CLOG_DEBUG1 "ignored datagram from %s", from.getHostname().c_str()));
+			continue;
+		}
+		CClientMap::const_iterator i = m_clients.find(token);
+		if (i == m_clients.end()) {
+			LOG((CLOG_DEBUG1 "ignored datagram for unknown token from %s", from.getHostname().c_str()));
+			continue;
+		}
+		i->second->handleMotionDatagram(data, from);
+	}
+}
@@ -0,0 +1,89 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "io/CryptoStream_cryptopp.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+
+class CClientProxy1_6;
+class CEvent;
+class CNetworkAddress;
+class IDatagramSocket;
+class IEventQueue;
+class ISocketFactory;
+
+//! Mouse motion channel listener
+/*!
+Owns the datagram socket of the mouse motion side-channel, bound to the
+same address as the client listener, and hands each datagram to the
+client proxy whose token it carries (see CMotionChannel).
+*/
+class CMotionListener {
+public:
+	// The factory is adopted.
+	CMotionListener(const CNetworkAddress&,
+							ISocketFactory*,
+							IEventQueue* events);
+	~CMotionListener();
+
+	//! @name manipulators
+	//@{
+
+	//! Set simulated loss
+	/*!
+	Drops the given fraction (0 to 1) of motion datagrams sent to
+	clients that join after this call, for testing.
+	*/
+	void				setLoss(double fraction);
+
+	//! Add a client
+	/*!
+	Returns a new random token for \p client's datagrams.
+	*/
+	UInt32				addClient(CClientProxy1_6* client);
+
+	//! Remove a client
+	void				removeClient(UInt32 token);
+
+	//! Send a datagram
+	void				send(const CString& data, const CNetworkAddress&);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get simulated loss
+	double				getLoss() const;
+
+	//@}
+
+private:
+	void				handleData(const CEvent&, void*);
+
+private:
+	typedef std::map<UInt32, CClientProxy1_6*> CClientMap;
+
+	ISocketFactory*		m_socketFactory;
+	IDatagramSocket*	m_socket;
+	IEventQueue*		m_events;
+	CClientMap			m_clients;
+	double				m_loss;
+	CryptoPP::AutoSeededRandomPool	m_random;
+};
@@ -20,15 +20,16 @@
 
 #include "server/ClientProxy.h"
 #include "server/ClientProxyUnknown.h"
+#include "server/ConfigDiff.h"
 #include "server/PrimaryClient.h"
 #include "synergy/IPlatformScreen.h"
-#include "synergy/DropHelper.h"
 #include "synergy/option_types.h"
 #include "synergy/protocol_types.h"
 #include "synergy/XScreen.h"
 #include "synergy/XSynergy.h"
 #include "synergy/FileChunker.h"
 #include "synergy/KeyState.h"
+#include "synergy/MessageBroadcast.h"
 #include "synergy/Screen.h"
 #include "net/IDataSocket.h"
 #include "net/IListenSocket.h"
@@ -38,6 +39,7 @@
 #include "base/TMethodJob.h"
 #include "base/IEventQueue.h"
 #include "base/Log.h"
+#include "base/Metrics.h"
 #include "base/TMethodEventJob.h"
 #include "common/stdexcept.h"
 
@@ -46,6 +48,18 @@
 #include <sstream>
 #include <fstream>
 
+// retry hints (in milliseconds) sent to clients we disconnect.  a busy
+// name is retried after a stale connection would have timed out.  a
+// clean close is retried right away, spread over a window that grows
+// with the number of clients.
+static const UInt32		s_busyRetryHint =
+	static_cast<UInt32>(1000.0 * kKeepAliveRate * kKeepAlivesUntilDeath);
+static const UInt32		s_closeRetryHintPerClient = 20;
+
+static CGauge			s_clients("server.clients");
+static CCounter			s_switches("server.switches");
+static CHistogram		s_clipboardSize("server.clipboardSize");
+
 //
 // CServer
 //
@@ -83,12 +97,16 @@ CServer::CServer(
 	m_lockedToScreen(false),
 	m_screen(screen),
 	m_events(events),
-	m_sendFileThread(NULL),
+	m_fileReceiver("server"),
+	m_fileSender(events, this),
+	m_fileSendClient(NULL),
 	m_writeToDropDirThread(NULL),
 	m_ignoreFileTransfer(false),
 	m_enableDragDrop(enableDragDrop),
 	m_getDragInfoThread(NULL),
-	m_waitDragInfoThread(true)
+	m_waitDragInfoThread(true),
+	m_motionListener(NULL),
+	m_batchDelay(0.0)
 {
 	// must have a primary client and it must have a canonical name
 	assert(m_primaryClient != NULL);
@@ -187,6 +205,9 @@ CServer::CServer(
 								this,
 								new TMethodEventJob<CServer>(this,
 									&CServer::handleFileRecieveCompletedEvent));
+
+		// pick up a transfer interrupted by a restart
+		m_fileReceiver.recover();
 	}
 
 	// add connection
@@ -283,23 +304,93 @@ CServer::setConfig(const CConfig& config)
 	// configured a CLockCursorToScreenAction then we don't add
 	// ScrollLock as a hotkey.
 	if (!m_config->hasLockToScreenAction()) {
-		IPlatformScreen::CKeyInfo* key =
-			IPlatformScreen::CKeyInfo::alloc(kKeyScrollLock, 0, 0, 0);
-		CInputFilter::CRule rule(new CInputFilter::CKeystrokeCondition(m_events, key));
-		rule.adoptAction(new CInputFilter::CLockCursorToScreenAction(m_events), true);
-		m_inputFilter->addFilterRule(rule);
+		addLockToScreenRule(m_inputFilter);
 	}
 
+	// build the hotkey lookup now rather than on the next keystroke
+	m_inputFilter->compileRules();
+
 	// tell primary screen about reconfiguration
 	m_primaryClient->reconfigure(getActivePrimarySides());
 
 	// tell all (connected) clients about current options
+	CMessageBroadcast broadcast;
 	for (CClientList::const_iterator index = m_clients.begin();
 								index != m_clients.end(); ++index) {
 		CBaseClientProxy* client = index->second;
-		sendOptions(client);
+		sendOptions(client, &broadcast);
+	}
+
+	return true;
+}
+
+bool
+CServer::updateConfig(const CConfig& newConfig)
+{
+	// refuse configuration if it doesn't include the primary screen
+	if (!newConfig.isScreen(m_primaryClient->getName())) {
+		return false;
+	}
+
+	// our configuration has the ScrollLock rule that setConfig() added
+	// (if any) so add the same rule before comparing.
+	CConfig config(newConfig);
+	if (!config.hasLockToScreenAction()) {
+		addLockToScreenRule(config.getInputFilter());
+	}
+
+	CConfigDiff diff(*m_config, config);
+	if (diff.isEmpty()) {
+		LOG((CLOG_DEBUG "configuration unchanged"));
+		return true;
+	}
+	if (diff.hasAddressChanged()) {
+		LOG((CLOG_WARN "new listen address takes effect after a restart"));
+	}
+
+	// cut over.  keep the input filter if its rules are the same so its
+	// hotkeys stay registered with the primary screen.
+	if (m_config->getInputFilter()->hasSameRules(*config.getInputFilter())) {
+		m_config->assignExceptInputFilter(config);
+	}
+	else {
+		*m_config = config;
 	}
 
+	// close clients that are connected but being dropped from the
+	// configuration.  a changed alias can change a canonical name too.
+	if (!diff.getRemovedScreens().empty() || diff.haveAliasesChanged()) {
+		closeClients(*m_config);
+	}
+
+	if (diff.haveGlobalOptionsChanged()) {
+		processOptions();
+	}
+
+	if (diff.hasInputFilterChanged()) {
+		m_inputFilter->compileRules();
+	}
+
+	// tell primary screen about reconfiguration if its edges changed.
+	// a screen being added or removed can change which edges are active.
+	if (diff.getLinksChanged().count(m_primaryClient->getName()) != 0 ||
+		!diff.getAddedScreens().empty() ||
+		!diff.getRemovedScreens().empty()) {
+		m_primaryClient->reconfigure(getActivePrimarySides());
+	}
+
+	// tell only the affected clients about their new options
+	CMessageBroadcast broadcast;
+	for (CClientList::const_iterator index = m_clients.begin();
+								index != m_clients.end(); ++index) {
+		if (diff.needsOptions(index->first)) {
+			sendOptions(index->second, &broadcast);
+		}
+	}
+
+	LOG((CLOG_DEBUG "configuration updated: %d screens added, %d removed, %d relinked, %d with new options",
+		diff.getAddedScreens().size(), diff.getRemovedScreens().size(),
+		diff.getLinksChanged().size(), diff.getOptionsChanged().size()));
 	return true;
 }
 
@@ -323,14 +414,26 @@ CServer::adoptClient(CBaseClientProxy* client)
 	// add client to client list
 	if (!addClient(client)) {
 		// can only have one screen with a given name at any given time
+		// ask it to come back once the existing connection would have
+		// timed out if it's stale.
 		LOG((CLOG_WARN "a client with name \"%s\" is already connected", getName(client).c_str()));
-		closeClient(client, kMsgEBusy);
+		closeClient(client, kMsgEBusyRetry, s_busyRetryHint);
 		return;
 	}
 	LOG((CLOG_NOTE "client \"%s\" has connected", getName(client).c_str()));
 
 	// send configuration options to client
-	sendOptions(client);
+	sendOptions(client, NULL);
+
+	// ask for the rest of a transfer a lost connection interrupted.
+	// we don't know which client sent it but only that one will
+	// recognise the request.
+	CString request;
+	if (m_enableDragDrop && m_fileReceiver.getResumeRequest(request)) {
+		LOG((CLOG_DEBUG "requesting file transfer resume from \"%s\": %s",
+			getName(client).c_str(), request.c_str()));
+		client->fileChunkSending(kFileResume, &request[0], request.size());
+	}
 
 	// activate screen saver on new client if active on the primary screen
 	if (m_activeSaver != NULL) {
@@ -458,6 +561,7 @@ CServer::switchScreen(CBaseClientProxy* dst,
 
 	// stop waiting to switch
 	stopSwitch();
+	s_switches.add();
 
 	// record new position
 	m_x       = x;
@@ -1084,13 +1188,16 @@ CServer::stopRelativeMoves()
 }
 
 void
-CServer::sendOptions(CBaseClientProxy* client) const
+CServer::sendOptions(CBaseClientProxy* client,
+				CMessageBroadcast* broadcast) const
 {
 	COptionsList optionsList;
 
-	// look up options for client
+	// look up options for client.  every configured screen has a
+	// collection of options but most of them are empty.
 	const CConfig::CScreenOptions* options =
 						m_config->getOptions(getName(client));
+	const bool hasScreenOptions = m_config->hasScreenOptions(getName(client));
 	if (options != NULL) {
 		// convert options to a more convenient form for sending
 		optionsList.reserve(2 * options->size());
@@ -1113,9 +1220,15 @@ CServer::sendOptions(CBaseClientProxy* client) const
 		}
 	}
 
-	// send the options
+	// send the options.  the reset is the same for every client but
+	// the options are only the same for clients without their own.
+	client->setBroadcast(broadcast);
 	client->resetOptions();
+	if (hasScreenOptions) {
+		client->setBroadcast(NULL);
+	}
 	client->setOptions(optionsList);
+	client->setBroadcast(NULL);
 }
 
 void
@@ -1235,6 +1348,7 @@ CServer::handleClipboardGrabbed(const CEvent& event, void* vclient)
 
 	// tell all other screens to take ownership of clipboard.  tell the
 	// grabber that it's clipboard isn't dirty.
+	CMessageBroadcast broadcast;
 	for (CClientList::iterator index = m_clients.begin();
 								index != m_clients.end(); ++index) {
 		CBaseClientProxy* client = index->second;
@@ -1242,7 +1356,9 @@ CServer::handleClipboardGrabbed(const CEvent& event, void* vclient)
 			client->setClipboardDirty(info->m_id, false);
 		}
 		else {
+			client->setBroadcast(&broadcast);
 			client->grabClipboard(info->m_id);
+			client->setBroadcast(NULL);
 		}
 	}
 }
@@ -1484,7 +1600,7 @@ CServer::handleFakeInputEndEvent(const CEvent&, void*)
 void
 CServer::handleFileChunkSendingEvent(const CEvent& event, void*)
 {
-	onFileChunkSending(event.getData());
+	onFileChunkSending(event.getDataObject());
 }
 
 void
@@ -1521,6 +1637,7 @@ CServer::onClipboardChanged(CBaseClientProxy* sender,
 	// got new data
 	LOG((CLOG_INFO "screen \"%s\" updated clipboard %d", clipboard.m_clipboardOwner.c_str(), id));
 	clipboard.m_clipboardData = data;
+	s_clipboardSize.record(data.size());
 
 	// tell all clients except the sender that the clipboard is dirty
 	for (CClientList::const_iterator index = m_clients.begin();
@@ -1580,11 +1697,14 @@ CServer::onScreensaver(bool activated)
 		m_activeSaver = NULL;
 	}
 
-	// send message to all clients
+	// send message to all clients, formatting it once
+	CMessageBroadcast broadcast;
 	for (CClientList::const_iterator index = m_clients.begin();
 								index != m_clients.end(); ++index) {
 		CBaseClientProxy* client = index->second;
+		client->setBroadcast(&broadcast);
 		client->screensaver(activated);
+		client->setBroadcast(NULL);
 	}
 }
 
@@ -1606,10 +1726,14 @@ CServer::onKeyDown(KeyID id, KeyModifierMask mask, KeyButton button,
 				screens = "*";
 			}
 		}
+		CMessageBroadcast broadcast;
 		for (CClientList::const_iterator index = m_clients.begin();
 								index != m_clients.end(); ++index) {
 			if (IKeyState::CKeyInfo::contains(screens, index->first)) {
-				index->second->keyDown(id, mask, button);
+				CBaseClientProxy* client = index->second;
+				client->setBroadcast(&broadcast);
+				client->keyDown(id, mask, button);
+				client->setBroadcast(NULL);
 			}
 		}
 	}
@@ -1633,10 +1757,14 @@ CServer::onKeyUp(KeyID id, KeyModifierMask mask, KeyButton button,
 				screens = "*";
 			}
 		}
+		CMessageBroadcast broadcast;
 		for (CClientList::const_iterator index = m_clients.begin();
 								index != m_clients.end(); ++index) {
 			if (IKeyState::CKeyInfo::contains(screens, index->first)) {
-				index->second->keyUp(id, mask, button);
+				CBaseClientProxy* client = index->second;
+				client->setBroadcast(&broadcast);
+				client->keyUp(id, mask, button);
+				client->setBroadcast(NULL);
 			}
 		}
 	}
@@ -1802,11 +1930,7 @@ CServer::getDragInfoThread(void*)
 {
 	m_dragFileList.clear();
 	CString& dragFileList = m_screen->getDraggingFilename();
-	if (!dragFileList.empty()) {
-		CDragInformation di;
-		di.setFilename(dragFileList);
-		m_dragFileList.push_back(di);
-	}
+	CDragInformation::splitFilenames(m_dragFileList, dragFileList);
 			
 #if defined(__APPLE__)
 	// on mac it seems that after faking a LMB up, system would signal back
@@ -2013,23 +2137,35 @@ CServer::onMouseWheel(SInt32 xDelta, SInt32 yDelta)
 void
 CServer::onFileChunkSending(const void* data)
 {
-	CFileChunker::CFileChunk* fileChunk = reinterpret_cast<CFileChunker::CFileChunk*>(const_cast<void*>(data));
+	const CFileChunker::CFileChunk* fileChunk = reinterpret_cast<const CFileChunker::CFileChunk*>(data);
 
 	LOG((CLOG_DEBUG1 "onFileChunkSending"));
-	assert(m_active != NULL);
+
+	// a transfer whose chunks are raised without sendFileToClient()
+	// goes to the active client
+	if (m_fileSendClient == NULL && fileChunk->m_chunk[0] == kFileStart) {
+		m_fileSendClient = m_active;
+	}
+	if (m_fileSendClient == NULL) {
+		// disconnected.  the client asks for the rest when it's back.
+		LOG((CLOG_DEBUG "dropped file chunk while disconnected"));
+		return;
+	}
 
 	// relay
- 	m_active->fileChunkSending(fileChunk->m_chunk[0], &(fileChunk->m_chunk[1]), fileChunk->m_dataSize);
+	m_fileSendClient->fileChunkSending(fileChunk->m_chunk[0], &(fileChunk->m_chunk[1]), fileChunk->m_dataSize);
 }
 
 void
 CServer::onFileRecieveCompleted()
 {
-	if (isReceivedFileSizeValid()) {
-		m_writeToDropDirThread = new CThread(
+	// drop what arrived intact.  the rest is discarded.
+	if (!isReceivedFileSizeValid()) {
+		LOG((CLOG_WARN "some dropped files were not received intact"));
+	}
+	m_writeToDropDirThread = new CThread(
 									   new TMethodJob<CServer>(
 															   this, &CServer::writeToDropDirThread));
-	}
 }
 
 void
@@ -2041,8 +2177,8 @@ CServer::writeToDropDirThread(void*)
 		ARCH->sleep(.1f);
 	}
 
-	CDropHelper::writeToDir(m_screen->getDropTarget(), m_dragFileList,
-					m_receivedFileData);
+	m_fileReceiver.moveTo(m_screen->getDropTarget());
+	m_dragFileList.clear();
 }
 
 bool
@@ -2070,6 +2206,7 @@ CServer::addClient(CBaseClientProxy* client)
 	// add to list
 	m_clientSet.insert(client);
 	m_clients.insert(std::make_pair(name, client));
+	s_clients.set(m_clients.size());
 
 	// initialize client data
 	SInt32 x, y;
@@ -2102,12 +2239,20 @@ CServer::removeClient(CBaseClientProxy* client)
 	// remove from list
 	m_clients.erase(getName(client));
 	m_clientSet.erase(i);
+	s_clients.set(m_clients.size());
+
+	// nowhere to send files until the client asks to resume
+	if (client == m_fileSendClient) {
+		m_fileSender.suspend();
+		m_fileSendClient = NULL;
+	}
 
 	return true;
 }
 
 void
-CServer::closeClient(CBaseClientProxy* client, const char* msg)
+CServer::closeClient(CBaseClientProxy* client, const char* msg,
+				UInt32 retryHint)
 {
 	assert(client != m_primaryClient);
 	assert(msg != NULL);
@@ -2124,7 +2269,7 @@ CServer::closeClient(CBaseClientProxy* client, const char* msg)
 
 	// send message
 	// FIXME -- avoid type cast (kinda hard, though)
-	((CClientProxy*)client)->close(msg);
+	((CClientProxy*)client)->close(msg, retryHint);
 
 	// install timer.  wait timeout seconds for client to close.
 	double timeout = 5.0;
@@ -2159,14 +2304,30 @@ CServer::closeClients(const CConfig& config)
 	// don't close the primary client
 	removed.erase(m_primaryClient);
 
+	// clients retry a clean close right away.  the more of them there
+	// are the longer the window they spread their reconnects over so
+	// we're not flooded with handshakes if we're just restarting.
+	UInt32 retryHint = static_cast<UInt32>(removed.size()) *
+						s_closeRetryHintPerClient;
+
 	// now close them.  we collect the list then close in two steps
 	// because closeClient() modifies the collection we iterate over.
 	for (CRemovedClients::iterator index = removed.begin();
 								index != removed.end(); ++index) {
-		closeClient(*index, kMsgCClose);
+		closeClient(*index, kMsgCCloseRetry, retryHint);
 	}
 }
 
+void
+CServer::addLockToScreenRule(CInputFilter* filter)
+{
+	IPlatformScreen::CKeyInfo* key =
+		IPlatformScreen::CKeyInfo::alloc(kKeyScrollLock, 0, 0, 0);
+	CInputFilter::CRule rule(new CInputFilter::CKeystrokeCondition(m_events, key));
+	rule.adoptAction(new CInputFilter::CLockCursorToScreenAction(m_events), true);
+	filter->addFilterRule(rule);
+}
+
 void
 CServer::removeActiveClient(CBaseClientProxy* client)
 {
@@ -2317,52 +2478,70 @@ CServer::CKeyboardBroadcastInfo::alloc(State state, const CString& screens)
 }
 
 void
-CServer::clearReceivedFileData()
+CServer::fileStartReceived(CString header)
 {
-	m_receivedFileData.clear();
-}
+	// older clients don't name their files
+	CString defaultName;
+	UInt32 index = static_cast<UInt32>(m_fileReceiver.getFiles().size());
+	if (m_fileReceiver.isComplete()) {
+		index = 0;
+	}
+	if (index < m_dragFileList.size()) {
+		defaultName = m_dragFileList.at(index).getFilename();
+	}
 
-void
-CServer::setExpectedFileSize(CString data)
-{
-	std::istringstream iss(data);
-	iss >> m_expectedFileSize;
+	m_fileReceiver.start(header, defaultName);
 }
 
 void
 CServer::fileChunkReceived(CString data)
 {
-	m_receivedFileData += data;
+	m_fileReceiver.write(data);
 }
 
 bool
-CServer::isReceivedFileSizeValid()
+CServer::fileEndReceived()
 {
-	return m_expectedFileSize == m_receivedFileData.size();
+	return m_fileReceiver.end();
 }
 
 void
-CServer::sendFileToClient(const char* filename)
+CServer::fileCheckReceived(CString checksum)
 {
-	m_sendFileThread = new CThread(
-		new TMethodJob<CServer>(
-			this, &CServer::sendFileThread,
-			reinterpret_cast<void*>(const_cast<char*>(filename))));
+	m_fileReceiver.check(checksum);
 }
 
 void
-CServer::sendFileThread(void* data)
+CServer::fileResumeRequested(CBaseClientProxy* client, CString request)
 {
-	try {
-		char* filename = reinterpret_cast<char*>(data);
-		LOG((CLOG_DEBUG "sending file to client, filename=%s", filename));
-		CFileChunker::sendFileChunks(filename, m_events, this);
-	}
-	catch (std::runtime_error error) {
-		LOG((CLOG_ERR "failed sending file chunks, error: %s", error.what()));
+	// FIXME -- avoid type cast (kinda hard, though)
+	m_fileSender.setStream(((CClientProxy*)client)->getStream());
+	if (m_fileSender.resume(request)) {
+		m_fileSendClient = client;
 	}
+}
 
-	m_sendFileThread = NULL;
+bool
+CServer::isReceivedFileSizeValid()
+{
+	return m_fileReceiver.isValid();
+}
+
+void
+CServer::sendFileToClient(const char* filenames)
+{
+	LOG((CLOG_DEBUG "sending files to client, filenames=%s", filenames));
+	m_fileSendClient = m_active;
+
+	// receivers before 1.6 only take one file per drop
+	// FIXME -- avoid type cast (kinda hard, though)
+	bool multiFile = false;
+	if (m_active != m_primaryClient) {
+		CClientProxy* client = (CClientProxy*)m_active;
+		multiFile = client->hasMultiFileTransfer();
+		m_fileSender.setStream(client->getStream());
+	}
+	m_fileSender.send(filenames, !multiFile);
 }
 
 void
@@ -2377,3 +2556,27 @@ CServer::dragInfoReceived(UInt32 fileNum, CString content)
 
 	m_screen->startDraggingFiles(m_dragFileList);
 }
+
+void
+CServer::setMotionListener(CMotionListener* listener)
+{
+	m_motionListener = listener;
+}
+
+CMotionListener*
+CServer::getMotionListener() const
+{
+	return m_motionListener;
+}
+
+void
+CServer::setBatchDelay(double maxDelay)
+{
+	m_batchDelay = maxDelay;
+}
+
+double
+CServer::getBatchDelay() const
+{
+	return m_batchDelay;
+}
@@ -25,6 +25,8 @@
 #include "synergy/mouse_types.h"
 #include "synergy/INode.h"
 #include "synergy/DragInformation.h"
+#include "synergy/FileReceiver.h"
+#include "synergy/FileSender.h"
 #include "base/Event.h"
 #include "base/Stopwatch.h"
 #include "base/EventTypes.h"
@@ -36,6 +38,8 @@ class CBaseClientProxy;
 class CEventQueueTimer;
 class CPrimaryClient;
 class CInputFilter;
+class CMessageBroadcast;
+class CMotionListener;
 class CScreen;
 class IEventQueue;
 class CThread;
@@ -108,7 +112,8 @@ public:
 	~CServer();
 
 #ifdef TEST_ENV
-	CServer() : m_mock(true), m_config(NULL) { }
+	CServer() : m_mock(true), m_config(NULL), m_fileSender(NULL, NULL),
+				m_motionListener(NULL) { }
 	void setActive(CBaseClientProxy* active) {	m_active = active; }
 #endif
 
@@ -123,6 +128,17 @@ public:
 	*/
 	bool				setConfig(const CConfig&);
 
+	//! Update configuration
+	/*!
+	Replace the server's configuration with \p config, applying only
+	what changed:  clients dropped from the configuration are closed,
+	options are resent only to clients whose options changed and the
+	primary screen is reconfigured only if its edges changed.  Returns
+	true iff the new configuration was accepted (it must include the
+	server's name).
+	*/
+	bool				updateConfig(const CConfig& config);
+
 	//! Add a client
 	/*!
 	Adds \p client to the server.  The client is adopted and will be
@@ -139,20 +155,54 @@ public:
 	*/
 	void				disconnect();
 
-	//! Clears the file buffer
-	void				clearReceivedFileData();
+	//! Received the start of a file
+	void				fileStartReceived(CString header);
 
-	//! Set the expected size of receiving file
-	void				setExpectedFileSize(CString data);
-	
 	//! Received a chunk of file data
 	void				fileChunkReceived(CString data);
 
-	//! Create a new thread and use it to send file to client
-	void				sendFileToClient(const char* filename);
+	//! Received the end of a file
+	/*!
+	Returns true if that was the last file of the transfer.
+	*/
+	bool				fileEndReceived();
+
+	//! Received a file chunk checksum
+	void				fileCheckReceived(CString checksum);
+
+	//! Received a request to resume sending files
+	/*!
+	\c client asked for the rest of a transfer the last connection
+	interrupted.
+	*/
+	void				fileResumeRequested(CBaseClientProxy* client, CString request);
+
+	//! Create a new thread and use it to send files to client
+	/*!
+	\c filenames is a newline separated list of files and directories.
+	They're sent to the active client.  If it disconnects it can resume
+	the transfer after reconnecting.
+	*/
+	void				sendFileToClient(const char* filenames);
 
 	//! Received dragging information from client
 	void				dragInfoReceived(UInt32 fileNum, CString content);
+
+	//! Set the motion listener
+	/*!
+	Clients that connect after this call are offered a mouse motion
+	channel on \p listener, or none if it's NULL.  The listener isn't
+	adopted and must outlive the clients.
+	*/
+	void				setMotionListener(CMotionListener* listener);
+
+	//! Set the batch delay
+	/*!
+	Clients that connect after this call get their input in frames
+	held for at most \p maxDelay seconds, or in a packet per message if
+	it's negative.  See CPacketStreamFilter::setBatchDelay().
+	*/
+	void				setBatchDelay(double maxDelay);
 	
 	//@}
 	//! @name accessors
@@ -170,11 +220,23 @@ public:
 	*/
 	void				getClients(std::vector<CString>& list) const;
 	
-	//! Return true if recieved file size is valid
+	//! Return true if every received file has the expected size and checksum
 	bool				isReceivedFileSizeValid();
 
 	//! Return expected file size
-	size_t				getExpectedFileSize() { return m_expectedFileSize; }
+	UInt64				getExpectedFileSize() { return m_fileReceiver.getExpectedSize(); }
+
+	//! Get the motion listener
+	/*!
+	Returns the listener set by setMotionListener(), or NULL.
+	*/
+	CMotionListener*	getMotionListener() const;
+
+	//! Get the batch delay
+	/*!
+	Returns the delay set by setBatchDelay().
+	*/
+	double				getBatchDelay() const;
 
 	//@}
 
@@ -281,8 +343,10 @@ private:
 	// stop relative mouse moves
 	void				stopRelativeMoves();
 
-	// send screen options to \c client
-	void				sendOptions(CBaseClientProxy* client) const;
+	// send screen options to \c client.  messages the same for every
+	// client are shared through \c broadcast, which may be NULL.
+	void				sendOptions(CBaseClientProxy* client,
+							CMessageBroadcast* broadcast) const;
 
 	// process options from configuration
 	void				processOptions();
@@ -336,12 +400,16 @@ private:
 	// remove client from list and detach event handlers for client
 	bool				removeClient(CBaseClientProxy*);
 
-	// close a client
-	void				closeClient(CBaseClientProxy*, const char* msg);
+	// close a client.  \p retryHint is sent with messages that take one.
+	void				closeClient(CBaseClientProxy*, const char* msg,
+							UInt32 retryHint = 0);
 
 	// close clients not in \p config
 	void				closeClients(const CConfig& config);
 
+	// add the ScrollLock rule that locks the cursor to the screen
+	void				addLockToScreenRule(CInputFilter* filter);
+
 	// close all clients whether they've completed the handshake or not,
 	// except the primary client
 	void				closeAllClients();
@@ -353,9 +421,6 @@ private:
 	// force the cursor off of \p client
 	void				forceLeaveClient(CBaseClientProxy* client);
 	
-	// thread funciton for sending file
-	void				sendFileThread(void*);
-	
 	// thread function for writing file to drop directory
 	void				writeToDropDirThread(void*);
 
@@ -462,10 +527,10 @@ private:
 	IEventQueue*		m_events;
 
 	// file transfer
-	size_t				m_expectedFileSize;
-	CString				m_receivedFileData;
+	CFileReceiver		m_fileReceiver;
 	CDragFileList		m_dragFileList;
-	CThread*			m_sendFileThread;
+	CFileSender			m_fileSender;
+	CBaseClientProxy*	m_fileSendClient;
 	CThread*			m_writeToDropDirThread;
 	CString				m_dragFileExt;
 	bool				m_ignoreFileTransfer;
@@ -473,4 +538,7 @@ private:
 
 	CThread*			m_getDragInfoThread;
 	bool				m_waitDragInfoThread;
+
+	CMotionListener*	m_motionListener;
+	double				m_batchDelay;
 };
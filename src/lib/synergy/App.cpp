@@ -18,6 +18,7 @@
 
 #include "synergy/App.h"
 #include "base/Log.h"
+#include "base/Metrics.h"
 #include "common/Version.h"
 #include "synergy/protocol_types.h"
 #include "arch/Arch.h"
@@ -31,6 +32,10 @@
 #include "ipc/IpcMessage.h"
 #include "ipc/Ipc.h"
 #include "base/EventQueue.h"
+#include "net/SocketMultiplexer.h"
+#include "net/LocalSocketFactory.h"
+#include "net/NetworkAddress.h"
+#include "mt/Thread.h"
 
 #if SYSAPI_WIN32
 #include "arch/win32/ArchMiscWindows.h"
@@ -40,6 +45,7 @@
 
 #include <iostream>
 #include <stdio.h>
+#include <stdlib.h>
 
 #if WINAPI_CARBON
 #include <ApplicationServices/ApplicationServices.h>
@@ -51,6 +57,9 @@
 
 CApp* CApp::s_instance = nullptr;
 
+// seconds between metrics snapshots sent to the daemon
+static const double		s_metricsInterval = 5.0;
+
 CApp::CApp(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBarReceiver, CArgsBase* args) :
 	m_bye(&exit),
 	m_taskBarReceiver(NULL),
@@ -59,7 +68,8 @@ CApp::CApp(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBarReceiver,
 	m_args(args),
 	m_createTaskBarReceiver(createTaskBarReceiver),
 	m_appUtil(events),
-	m_ipcClient(nullptr)
+	m_ipcClient(nullptr),
+	m_metricsTimer(nullptr)
 {
 	assert(s_instance == nullptr);
 	s_instance = this;
@@ -172,6 +182,54 @@ CApp::parseArg(const int& argc, const char* const* argv, int& i)
 		argsBase().m_crypto.setMode("cfb");
 	}
 
+	else if (isArg(i, argc, argv, NULL, "--sched-policy", 1)) {
+		if (!argsBase().m_scheduling.setPolicy(argv[++i])) {
+			LOG((CLOG_PRINT "%s: unknown scheduling policy `%s'" BYE,
+				argsBase().m_pname, argv[i], argsBase().m_pname));
+			m_bye(kExitArgs);
+		}
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--sched-priority", 1)) {
+		argsBase().m_scheduling.setPriority(atoi(argv[++i]));
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--sched-cpu", 1)) {
+		argsBase().m_scheduling.setCPU(atoi(argv[++i]));
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--sched-lock-memory")) {
+		argsBase().m_scheduling.setLockMemory(true);
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--virtual-screen", 1)) {
+		int w, h;
+		if (sscanf(argv[++i], "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+			LOG((CLOG_PRINT "%s: invalid virtual screen size `%s'" BYE,
+				argsBase().m_pname, argv[i], argsBase().m_pname));
+			m_bye(kExitArgs);
+		}
+		argsBase().m_virtualScreen = true;
+		argsBase().m_virtualWidth  = w;
+		argsBase().m_virtualHeight = h;
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--virtual-input", 1)) {
+		argsBase().m_virtualInput = argv[++i];
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--virtual-record", 1)) {
+		argsBase().m_virtualRecord = argv[++i];
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--capture", 1)) {
+		argsBase().m_capturePath = argv[++i];
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--udp-motion")) {
+		argsBase().m_udpMotion = true;
+	}
+
 	else if (isArg(i, argc, argv, NULL, "--enable-drag-drop")) {
         bool useDragDrop = true;
 
@@ -385,7 +443,25 @@ CApp::initApp(int argc, const char** argv)
 void
 CApp::initIpcClient()
 {
-	m_ipcClient = new CIpcClient(m_events, m_socketMultiplexer);
+#if SYSAPI_UNIX
+	CString localPath = getIpcLocalPath();
+	if (!localPath.empty()) {
+		m_ipcClient = new CIpcClient(m_events,
+							new CLocalSocketFactory(m_events, m_socketMultiplexer),
+							CNetworkAddress::local(localPath));
+
+		// an older daemon, or one with another user or runtime
+		// directory, is only on the port
+		m_ipcClient->setFallbackPort(m_socketMultiplexer, IPC_PORT);
+	}
+	else
+#endif
+	{
+		m_ipcClient = new CIpcClient(m_events, m_socketMultiplexer);
+	}
+	m_events->adoptHandler(
+		m_events->forCIpcClient().connected(), m_ipcClient,
+		new TMethodEventJob<CApp>(this, &CApp::handleIpcConnected));
 	m_ipcClient->connect();
 
 	m_events->adoptHandler(
@@ -393,10 +469,38 @@ CApp::initIpcClient()
 		new TMethodEventJob<CApp>(this, &CApp::handleIpcMessage));
 }
 
+void
+CApp::applySchedulingProfile()
+{
+	// the main thread runs the event loop and the multiplexer threads
+	// read and write sockets.  all are on the input path.
+	const CSchedulingProfile& profile = argsBase().m_scheduling;
+	if (profile.isDefault()) {
+		return;
+	}
+
+	profile.applyToProcess();
+	CThread mainThread = CThread::getCurrentThread();
+	profile.apply(mainThread, "main");
+	if (m_socketMultiplexer != NULL) {
+		UInt32 n = m_socketMultiplexer->getNumServiceThreads();
+		for (UInt32 i = 0; i < n; ++i) {
+			profile.apply(*m_socketMultiplexer->getServiceThread(i), "socket");
+		}
+	}
+}
+
 void
 CApp::cleanupIpcClient()
 {
+	if (m_metricsTimer != nullptr) {
+		m_events->removeHandler(CEvent::kTimer, m_metricsTimer);
+		m_events->deleteTimer(m_metricsTimer);
+		m_metricsTimer = nullptr;
+	}
+
 	m_ipcClient->disconnect();
+	m_events->removeHandler(m_events->forCIpcClient().connected(), m_ipcClient);
 	m_events->removeHandler(m_events->forCIpcClient().messageReceived(), m_ipcClient);
 	delete m_ipcClient;
 }
@@ -411,6 +515,23 @@ CApp::handleIpcMessage(const CEvent& e, void*)
     }
 }
 
+void
+CApp::handleIpcConnected(const CEvent&, void*)
+{
+	// send the daemon our metrics for monitors from now on
+	if (m_metricsTimer == nullptr) {
+		m_metricsTimer = m_events->newTimer(s_metricsInterval, NULL);
+		m_events->adoptHandler(CEvent::kTimer, m_metricsTimer,
+			new TMethodEventJob<CApp>(this, &CApp::handleMetricsTimer));
+	}
+}
+
+void
+CApp::handleMetricsTimer(const CEvent&, void*)
+{
+	m_ipcClient->send(CIpcMetricsMessage(CMetric::snapshot()));
+}
+
 void
 CApp::runEventsLoop(void*)
 {
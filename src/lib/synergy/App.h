@@ -36,6 +36,7 @@ class CFileLogOutputter;
 class CScreen;
 class IEventQueue;
 class CSocketMultiplexer;
+class CEventQueueTimer;
 
 typedef IArchTaskBarReceiver* (*CreateTaskBarReceiverFunc)(const CBufferedLogOutputter*, IEventQueue* events);
 
@@ -103,11 +104,14 @@ public:
 
 private:
 	void				handleIpcMessage(const CEvent&, void*);
+	void				handleIpcConnected(const CEvent&, void*);
+	void				handleMetricsTimer(const CEvent&, void*);
 
 protected:
 	virtual void parseArgs(int argc, const char* const* argv, int &i);
 	virtual bool parseArg(const int& argc, const char* const* argv, int& i);
 	void				initIpcClient();
+	void				applySchedulingProfile();
 	void				cleanupIpcClient();
 	void				runEventsLoop(void*);
 
@@ -122,6 +126,7 @@ private:
 	CreateTaskBarReceiverFunc m_createTaskBarReceiver;
 	ARCH_APP_UTIL m_appUtil;
 	CIpcClient*			m_ipcClient;
+	CEventQueueTimer*	m_metricsTimer;
 	CSocketMultiplexer*	m_socketMultiplexer;
 };
 
@@ -142,7 +147,23 @@ private:
 	"  -1, --no-restart         do not try to restart on failure.\n" \
 	"*     --restart            restart the server automatically if it fails.\n" \
 	"  -l  --log <file>         write log messages to file.\n" \
-	"      --no-tray            disable the system tray icon.\n"
+	"      --no-tray            disable the system tray icon.\n" \
+	"      --sched-policy <policy>\n" \
+	"                           schedule input threads with policy, which may\n" \
+	"                             be: normal, nice, rr, fifo.\n" \
+	"      --sched-priority <n> niceness or real-time priority for the policy.\n" \
+	"      --sched-cpu <n>      pin input threads to cpu n.\n" \
+	"      --sched-lock-memory  lock the process into memory.\n" \
+	"      --virtual-screen <w>x<h>\n" \
+	"                           use a headless screen instead of the display.\n" \
+	"      --virtual-input <file>\n" \
+	"                           play back input from a script file.\n" \
+	"      --virtual-record <file>\n" \
+	"                           record injected input to a file.\n" \
+	"      --capture <file>     capture each connection's messages to a\n" \
+	"                             numbered file, for syntool --replay.\n" \
+	"      --udp-motion         send mouse motion over UDP when the other\n" \
+	"                             end does too.\n"
 
 #define HELP_COMMON_INFO_2 \
 	"  -h, --help               display this help and exit.\n" \
@@ -151,7 +172,9 @@ private:
 #define HELP_COMMON_ARGS \
 	" [--name <screen-name>]" \
 	" [--restart|--no-restart]" \
-	" [--debug <level>]"
+	" [--debug <level>]" \
+	" [--sched-policy <policy>]" \
+	" [--virtual-screen <w>x<h>]"
 
 // system args (windows/unix)
 #if SYSAPI_UNIX
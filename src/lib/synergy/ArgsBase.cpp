@@ -39,7 +39,11 @@ m_logFile(NULL),
 m_display(NULL),
 m_disableTray(false),
 m_enableIpc(false),
-m_enableDragDrop(false)
+m_enableDragDrop(false),
+m_virtualScreen(false),
+m_virtualWidth(0),
+m_virtualHeight(0),
+m_udpMotion(false)
 {
 }
 
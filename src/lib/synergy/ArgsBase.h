@@ -20,6 +20,8 @@
 
 #include "base/String.h"
 #include "io/CryptoOptions.h"
+#include "synergy/SchedulingProfile.h"
+#include "common/basic_types.h"
 
 class CArgsBase {
 public:
@@ -38,6 +40,14 @@ public:
 	bool m_enableIpc;
 	CCryptoOptions m_crypto;
 	bool m_enableDragDrop;
+	CSchedulingProfile m_scheduling;
+	bool m_virtualScreen;
+	SInt32 m_virtualWidth;
+	SInt32 m_virtualHeight;
+	CString m_virtualInput;
+	CString m_virtualRecord;
+	CString m_capturePath;
+	bool m_udpMotion;
 #if SYSAPI_WIN32
 	bool m_debugServiceWait;
 	bool m_pauseOnExit;
@@ -0,0 +1,97 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/CaptureStreamFilter.h"
+
+#include <cstring>
+
+//
+// CCaptureStreamFilter
+//
+
+CCaptureStreamFilter::CCaptureStreamFilter(IEventQueue* events,
+				synergy::IStream* stream, const CString& path,
+				CProtocolCapture::ESide side, bool adoptStream) :
+	CStreamFilter(events, stream, adoptStream),
+	m_messageSize(0)
+{
+	m_capture.open(path, side);
+}
+
+CCaptureStreamFilter::~CCaptureStreamFilter()
+{
+	// do nothing
+}
+
+synergy::IStream*
+CCaptureStreamFilter::getFilteredStream() const
+{
+	return getStream();
+}
+
+UInt32
+CCaptureStreamFilter::read(void* buffer, UInt32 n)
+{
+	if (n == 0) {
+		return 0;
+	}
+
+	// a message is usually read in pieces.  the wrapped stream tells us
+	// how big it is when we start.
+	if (m_messageSize == 0) {
+		m_messageSize = getStream()->getSize();
+		m_message.clear();
+	}
+
+	// read into the message and copy out, so a caller skipping data
+	// (with a NULL buffer) doesn't leave a hole in the capture
+	size_t offset = m_message.size();
+	m_message.resize(offset + n);
+	n = getStream()->read(&m_message[offset], n);
+	m_message.resize(offset + n);
+	if (buffer != NULL && n != 0) {
+		memcpy(buffer, m_message.data() + offset, n);
+	}
+
+	if (m_messageSize != 0 && m_message.size() >= m_messageSize) {
+		m_capture.write(false, m_message.data(),
+							static_cast<UInt32>(m_message.size()));
+		m_messageSize = 0;
+	}
+	return n;
+}
+
+void
+CCaptureStreamFilter::write(const void* buffer, UInt32 n)
+{
+	m_capture.write(true, buffer, n);
+	getStream()->write(buffer, n);
+}
+
+void
+CCaptureStreamFilter::writeBuffers(const CSharedBufferList& buffers)
+{
+	CString message;
+	for (CSharedBufferList::const_iterator i = buffers.begin();
+							i != buffers.end(); ++i) {
+		message.append(reinterpret_cast<const char*>(i->getData()),
+							i->getSize());
+	}
+	m_capture.write(true, message.data(), static_cast<UInt32>(message.size()));
+	getStream()->writeBuffers(buffers);
+}
@@ -0,0 +1,66 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "synergy/ProtocolCapture.h"
+#include "io/StreamFilter.h"
+
+//! Message capturing stream filter
+/*!
+Records every message written to and read from a stream to a
+CProtocolCapture.  The wrapped stream must read and write whole
+messages, as a CPacketStreamFilter does;  put this above any encryption
+so the capture holds the plain messages.
+*/
+class CCaptureStreamFilter : public CStreamFilter {
+public:
+	/*!
+	Captures to a new file at \p path for \p side.  If the file can't be
+	written the filter just passes messages through.
+	*/
+	CCaptureStreamFilter(IEventQueue* events, synergy::IStream* stream,
+							const CString& path,
+							CProtocolCapture::ESide side,
+							bool adoptStream = true);
+	~CCaptureStreamFilter();
+
+	//! @name accessors
+	//@{
+
+	//! Get the filtered stream
+	/*!
+	Returns the stream this filter captures, e.g. to reach a crypto
+	stream beneath it.
+	*/
+	synergy::IStream*	getFilteredStream() const;
+
+	//@}
+
+	// IStream overrides
+	virtual UInt32		read(void* buffer, UInt32 n);
+	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		writeBuffers(const CSharedBufferList& buffers);
+
+private:
+	CProtocolCapture	m_capture;
+
+	// the message being read and how big it is
+	CString				m_message;
+	UInt32				m_messageSize;
+};
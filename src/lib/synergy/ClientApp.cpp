@@ -50,6 +50,7 @@
 #elif WINAPI_CARBON
 #include "platform/OSXScreen.h"
 #endif
+#include "platform/VirtualScreen.h"
 
 #if defined(__APPLE__)
 #include "platform/OSXDragSimulator.h"
@@ -59,11 +60,13 @@
 #include <stdio.h>
 
 #define RETRY_TIME 1.0
+#define RETRY_TIME_MAX 16.0
 
 CClientApp::CClientApp(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBarReceiver) :
 	CApp(events, createTaskBarReceiver, new CArgs()),
 	m_client(NULL),
-	m_clientScreen(NULL)
+	m_clientScreen(NULL),
+	m_retryScheduler(RETRY_TIME, RETRY_TIME_MAX)
 {
 }
 
@@ -178,7 +181,7 @@ CClientApp::help()
 #  define WINAPI_INFO
 #endif
 
-	char buffer[2000];
+	char buffer[3000];
 	sprintf(
 		buffer,
 		"Usage: %s"
@@ -231,6 +234,12 @@ CClientApp::daemonInfo() const
 CScreen*
 CClientApp::createScreen()
 {
+	if (args().m_virtualScreen) {
+		return new CScreen(new CVirtualScreen(m_events, false,
+			args().m_virtualWidth, args().m_virtualHeight,
+			args().m_virtualInput, args().m_virtualRecord), m_events);
+	}
+
 #if WINAPI_MSWINDOWS
 	return new CScreen(new CMSWindowsScreen(
 		false, args().m_noHooks, args().m_stopOnDeskSwitch, m_events), m_events);
@@ -263,31 +272,23 @@ CClientApp::updateStatus(const CString& msg)
 void
 CClientApp::resetRestartTimeout()
 {
-	// retry time can nolonger be changed
-	//s_retryTime = 0.0;
+	m_retryScheduler.reset();
 }
 
 
 double
 CClientApp::nextRestartTimeout()
 {
-	// retry at a constant rate (Issue 52)
-	return RETRY_TIME;
-
-	/*
-	// choose next restart timeout.  we start with rapid retries
-	// then slow down.
-	if (s_retryTime < 1.0) {
-	s_retryTime = 1.0;
-	}
-	else if (s_retryTime < 3.0) {
-	s_retryTime = 3.0;
-	}
-	else {
-	s_retryTime = 5.0;
+	// back off exponentially with jitter so that many clients that
+	// lost the same server don't all reconnect at once.  the server
+	// may have told us how long to wait.
+	if (m_client != NULL) {
+		if (m_client->isClosedByServer()) {
+			m_retryScheduler.setCleanClose();
+		}
+		m_retryScheduler.setHint(m_client->getRetryHint());
 	}
-	return s_retryTime;
-	*/
+	return m_retryScheduler.next();
 }
 
 
@@ -340,7 +341,7 @@ void
 CClientApp::scheduleClientRestart(double retryTime)
 {
 	// install a timer and handler to retry later
-	LOG((CLOG_DEBUG "retry in %.0f seconds", retryTime));
+	LOG((CLOG_DEBUG "retry in %.1f seconds", retryTime));
 	CEventQueueTimer* timer = m_events->newOneShotTimer(retryTime, NULL);
 	m_events->adoptHandler(CEvent::kTimer, timer,
 		new TMethodEventJob<CClientApp>(this, &CClientApp::handleClientRestart, timer));
@@ -385,7 +386,7 @@ CClientApp::handleClientDisconnected(const CEvent&, void*)
 		m_events->addEvent(CEvent(CEvent::kQuit));
 	}
 	else if (!m_suspended) {
-		m_client->connect();
+		scheduleClientRestart(nextRestartTimeout());
 	}
 	updateStatus();
 }
@@ -403,6 +404,8 @@ CClientApp::openClient(const CString& name, const CNetworkAddress& address, CScr
 		screen,
 		crypto,
 		args().m_enableDragDrop);
+	client->setCapturePath(args().m_capturePath);
+	client->setMotionChannel(args().m_udpMotion);
 
 	try {
 		m_events->adoptHandler(
@@ -515,6 +518,7 @@ CClientApp::mainLoop()
 	// on unix because threads evaporate across a fork().
 	CSocketMultiplexer multiplexer;
 	setSocketMultiplexer(&multiplexer);
+	applySchedulingProfile();
 
 	// start client, etc
 	appUtil().startNode();
@@ -20,6 +20,7 @@
 
 #include "synergy/App.h"
 #include "synergy/ArgsBase.h"
+#include "synergy/RetryScheduler.h"
 
 class CScreen;
 class CEvent;
@@ -91,4 +92,5 @@ private:
 private:
 	CClient*			m_client;
 	CScreen*			m_clientScreen;
+	CRetryScheduler		m_retryScheduler;
 };
@@ -43,7 +43,7 @@ CClipboard::empty()
 
 	// clear all data
 	for (SInt32 index = 0; index < kNumFormats; ++index) {
-		m_data[index]  = "";
+		m_data[index]  = CSharedBuffer();
 		m_added[index] = false;
 	}
 
@@ -62,7 +62,7 @@ CClipboard::add(EFormat format, const CString& data)
 	assert(m_open);
 	assert(m_owner);
 
-	m_data[format]  = data;
+	m_data[format]  = CSharedBuffer(data.data(), (UInt32)data.size());
 	m_added[format] = true;
 }
 
@@ -102,17 +102,87 @@ CString
 CClipboard::get(EFormat format) const
 {
 	assert(m_open);
-	return m_data[format];
+	return m_data[format].toString();
 }
 
 void
 CClipboard::unmarshall(const CString& data, Time time)
 {
-	IClipboard::unmarshall(this, data, time);
+	unmarshall(CSharedBuffer(data.data(), (UInt32)data.size()), time);
+}
+
+void
+CClipboard::unmarshall(const CSharedBuffer& data, Time time)
+{
+	const char* index = reinterpret_cast<const char*>(data.getData());
+	const UInt32 size = data.getSize();
+
+	// clear existing data
+	open(time);
+	empty();
+
+	// read each format, stopping at the end of the data
+	if (size >= 4) {
+		const UInt32 numFormats = readUInt32(index);
+		UInt32 offset = 4;
+		for (UInt32 i = 0; i < numFormats && size - offset >= 8; ++i) {
+			UInt32 format = readUInt32(index + offset);
+			UInt32 n      = readUInt32(index + offset + 4);
+			offset += 8;
+			if (n > size - offset) {
+				break;
+			}
+
+			// keep the data if it's a known format, sharing it.  see
+			// IClipboard::unmarshall().
+			if (format < kNumFormats) {
+				m_data[format]  = data.slice(offset, n);
+				m_added[format] = true;
+			}
+			offset += n;
+		}
+	}
+
+	// done
+	close();
 }
 
 CString
 CClipboard::marshall() const
 {
-	return IClipboard::marshall(this);
+	CSharedBufferList buffers;
+	CString data;
+	data.reserve(marshall(buffers));
+	for (CSharedBufferList::const_iterator i = buffers.begin();
+							i != buffers.end(); ++i) {
+		data.append(reinterpret_cast<const char*>(i->getData()),
+							i->getSize());
+	}
+	return data;
+}
+
+UInt32
+CClipboard::marshall(CSharedBufferList& buffers) const
+{
+	UInt32 size = 4;
+	UInt32 numFormats = 0;
+	for (SInt32 format = 0; format != kNumFormats; ++format) {
+		if (m_added[format]) {
+			++numFormats;
+		}
+	}
+
+	CString header;
+	writeUInt32(&header, numFormats);
+	buffers.push_back(CSharedBuffer::adopt(header));
+	for (SInt32 format = 0; format != kNumFormats; ++format) {
+		if (m_added[format]) {
+			writeUInt32(&header, format);
+			writeUInt32(&header, m_data[format].getSize());
+			buffers.push_back(CSharedBuffer::adopt(header));
+			buffers.push_back(m_data[format]);
+			size += 4 + 4 + m_data[format].getSize();
+		}
+	}
+	return size;
 }
@@ -39,6 +39,13 @@ public:
 	*/
 	void				unmarshall(const CString& data, Time time);
 
+	//! Unmarshall clipboard data without copying
+	/*!
+	Like unmarshall() but the formats share \c data's memory.  Use
+	CSharedBuffer::adopt() to unmarshall a received string this way.
+	*/
+	void				unmarshall(const CSharedBuffer& data, Time time);
+
 	//@}
 	//! @name accessors
 	//@{
@@ -50,6 +57,13 @@ public:
 	*/
 	CString				marshall() const;
 
+	//! Marshall clipboard data without copying
+	/*!
+	Like IClipboard::marshall(const IClipboard*, CSharedBufferList&)
+	but the parts share this clipboard's memory instead of being copied.
+	*/
+	UInt32				marshall(CSharedBufferList& buffers) const;
+
 	//@}
 
 	// IClipboard overrides
@@ -67,5 +81,5 @@ private:
 	bool				m_owner;
 	Time				m_timeOwned;
 	bool				m_added[kNumFormats];
-	CString				m_data[kNumFormats];
+	CSharedBuffer		m_data[kNumFormats];
 };
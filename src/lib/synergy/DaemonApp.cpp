@@ -26,6 +26,8 @@
 #include "ipc/IpcMessage.h"
 #include "ipc/IpcLogOutputter.h"
 #include "net/SocketMultiplexer.h"
+#include "net/LocalSocketFactory.h"
+#include "net/NetworkAddress.h"
 #include "arch/XArch.h"
 #include "base/Log.h"
 #include "base/TMethodJob.h"
@@ -217,6 +219,16 @@ CDaemonApp::mainLoop(bool logToFile)
 			new TMethodEventJob<CDaemonApp>(this, &CDaemonApp::handleIpcMessage));
 
 		m_ipcServer->listen();
+#if SYSAPI_UNIX
+		CString localPath = getIpcLocalPath();
+		if (localPath.empty()) {
+			LOG((CLOG_WARN "no private directory for the ipc socket, using tcp only"));
+		}
+		else {
+			m_ipcServer->listen(new CLocalSocketFactory(m_events, &multiplexer),
+							localPath);
+		}
+#endif
 		
 #if SYSAPI_WIN32
 
@@ -344,12 +356,18 @@ CDaemonApp::handleIpcMessage(const CEvent& e, void*)
 			break;
 		}
 
+		case kIpcMetrics:
+			// only monitors want them;  the gui takes only log lines.
+			m_ipcServer->send(*m, kIpcClientMonitor);
+			break;
+
 		case kIpcHello:
 			CIpcHelloMessage* hm = static_cast<CIpcHelloMessage*>(m);
 			CString type;
 			switch (hm->clientType()) {
 				case kIpcClientGui: type = "gui"; break;
 				case kIpcClientNode: type = "node"; break;
+				case kIpcClientMonitor: type = "monitor"; break;
 				default: type = "unknown"; break;
 			}
 
@@ -16,7 +16,9 @@
  */
 
 #include "synergy/DragInformation.h"
+#include "synergy/FileChunker.h"
 #include "base/Log.h"
+#include "arch/Arch.h"
 
 #include <fstream>
 #include <sstream>
@@ -70,7 +72,7 @@ CDragInformation::parseDragInfo(CDragFileList& dragFileList, UInt32 fileNum, CSt
 			size_t size = stringToNum(filesize);
 			dragFileList.at(index).setFilesize(size);
 		}
-		startPos = findResult1 + 1;
+		startPos = findResult2 + 1;
 		
 		++index;
 	}
@@ -112,9 +114,25 @@ CDragInformation::setupDragInfo(CDragFileList& fileList, CString& output)
 	return size;
 }
 
+void
+CDragInformation::splitFilenames(CDragFileList& fileList, const CString& filenames)
+{
+	std::vector<CString> paths;
+	CFileChunker::splitPaths(filenames, paths);
+	for (size_t i = 0; i < paths.size(); ++i) {
+		CDragInformation di;
+		di.setFilename(paths[i]);
+		fileList.push_back(di);
+	}
+}
+
 bool
 CDragInformation::isFileValid(CString filename)
 {
+	if (ARCH->isDirectory(filename)) {
+		return true;
+	}
+
 	bool result = false;
 	std::fstream file(filename.c_str(), ios::in|ios::binary);
 
@@ -139,6 +157,11 @@ CDragInformation::stringToNum(CString& str)
 CString
 CDragInformation::getFileSize(CString& filename)
 {
+	// the files in a directory are sent separately
+	if (ARCH->isDirectory(filename)) {
+		return "0";
+	}
+
 	std::fstream file(filename.c_str(), ios::in|ios::binary);
 
 	if (!file.is_open()) {
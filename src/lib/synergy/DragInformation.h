@@ -40,6 +40,9 @@ public:
 	// example: filename1,filesize1,filename2,filesize2,
 	// return file count
 	static int			setupDragInfo(CDragFileList& fileList, CString& output);
+	// helper function to fill a drag file list from newline separated
+	// paths, as returned by getDraggingFilename()
+	static void			splitFilenames(CDragFileList& fileList, const CString& filenames);
 
 	static bool			isFileValid(CString filename);
 
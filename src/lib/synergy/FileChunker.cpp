@@ -17,96 +17,366 @@
 
 #include "synergy/FileChunker.h"
 
+#include "synergy/PriorityStreamFilter.h"
 #include "synergy/protocol_types.h"
+#include "mt/CondVar.h"
+#include "mt/Lock.h"
+#include "mt/Thread.h"
 #include "base/EventTypes.h"
 #include "base/Event.h"
 #include "base/IEventQueue.h"
-#include "base/EventTypes.h"
 #include "base/Log.h"
-#include "base/Stopwatch.h"
+#include "arch/Arch.h"
 #include "common/stdexcept.h"
 
 #include <fstream>
 #include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+// how many bytes of file data may be read but not yet written to the
+// peer.  a few chunks keeps the connection busy while the next chunk
+// is read.
+static const size_t		s_windowSize = 4 * 1024 * 1024;
+
+// how often a sender waiting for the connection to drain checks again.
+// chunks leaving the event queue wake it up sooner.
+static const double		s_drainPollRate = 0.01;
+
+// CRC-32 lookup table (IEEE polynomial, reflected)
+class CChecksumTable {
+public:
+	CChecksumTable()
+	{
+		for (UInt32 i = 0; i < 256; ++i) {
+			UInt32 c = i;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+			}
+			m_table[i] = c;
+		}
+	}
 
-#define PAUSE_TIME_HACK 0.1
+public:
+	UInt32				m_table[256];
+};
+
+static const CChecksumTable	s_checksumTable;
 
 using namespace std;
 
+//
+// CFileChunker
+//
+
 const size_t CFileChunker::m_chunkSize = 512 * 1024; // 512kb
 
 void
-CFileChunker::sendFileChunks(char* filename, IEventQueue* events, void* eventTarget)
+CFileChunker::sendFileChunks(const char* paths, IEventQueue* events, void* eventTarget)
 {
-	std::fstream file(reinterpret_cast<char*>(filename), std::ios::in | std::ios::binary);
+	std::vector<CString> pathList;
+	splitPaths(paths, pathList);
 
-	if (!file.is_open()) {
+	CFileList files;
+	expandFiles(pathList, files);
+	if (files.empty()) {
 		throw runtime_error("failed to open file");
 	}
 
-	// check file size
-	file.seekg (0, std::ios::end);
-	size_t size = (size_t)file.tellg();
-
-	// send first message (file size)
-	CString fileSize = intToString(size);
-	size_t sizeLength = fileSize.size();
-	CFileChunk* sizeMessage = new CFileChunk(sizeLength + 2);
-	char* chunkData = sizeMessage->m_chunk;
-
-	chunkData[0] = kFileStart;
-	memcpy(&chunkData[1], fileSize.c_str(), sizeLength);
-	chunkData[sizeLength + 1] = '\0';
-	events->addEvent(CEvent(events->forIScreen().fileChunkSending(), eventTarget, sizeMessage));
-
-	// send chunk messages with a fixed chunk size
-	size_t sentLength = 0;
-	size_t chunkSize = m_chunkSize;
-	CStopwatch stopwatch;
-	stopwatch.start();
-	file.seekg (0, std::ios::beg);
-	while (true) {
-		if (stopwatch.getTime() > PAUSE_TIME_HACK) {
-			// make sure we don't read too much from the mock data.
-			if (sentLength + chunkSize > size) {
-				chunkSize = size - sentLength;
-			}
+	sendFiles(files, newTransferId(), 0, 0, events, eventTarget);
+}
 
-			// for fileChunk->m_chunk, the first byte is the chunk mark, last is \0
-			CFileChunk* fileChunk = new CFileChunk(chunkSize + 2);
-			char* chunkData = fileChunk->m_chunk;
+void
+CFileChunker::sendFiles(const CFileList& files, UInt32 id,
+				UInt32 first, UInt64 offset,
+				IEventQueue* events, void* eventTarget,
+				const synergy::IStream* stream)
+{
+	CWindow* window = new CWindow(s_windowSize, stream);
+	try {
+		UInt32 count = static_cast<UInt32>(files.size());
+		for (UInt32 index = first; index < count; ++index) {
+			sendFile(files[index], count, id,
+							(index == first) ? offset : 0,
+							window, events, eventTarget);
+		}
+	}
+	catch (...) {
+		window->unref();
+		throw;
+	}
+	window->unref();
+}
 
-			chunkData[0] = kFileChunk;
-			file.read(&chunkData[1], chunkSize);
-			chunkData[chunkSize + 1] = '\0';
-			events->addEvent(CEvent(events->forIScreen().fileChunkSending(), eventTarget, fileChunk));
+UInt32
+CFileChunker::newTransferId()
+{
+	UInt64 now = ARCH->nanoTime();
+	UInt32 id  = static_cast<UInt32>(now ^ (now >> 32));
+	return (id == 0) ? 1 : id;
+}
 
-			sentLength += chunkSize;
-			file.seekg (sentLength, std::ios::beg);
+void
+CFileChunker::sendFile(const CFile& info, UInt32 count, UInt32 id,
+				UInt64 offset, CWindow* window,
+				IEventQueue* events, void* eventTarget)
+{
+	std::fstream file(info.m_path.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
+		// the receiver still expects the file.  send it empty and let
+		// it fail the size check.
+		LOG((CLOG_ERR "failed to open file: %s", info.m_path.c_str()));
+	}
+	if (offset > info.m_size) {
+		offset = info.m_size;
+	}
+	if (offset > 0) {
+		file.seekg(static_cast<std::streamoff>(offset));
+		LOG((CLOG_DEBUG "resuming file %s at %.0f bytes",
+			info.m_name.c_str(), (double)offset));
+	}
 
-			if (sentLength == size) {
-				break;
-			}
+	// send first message (file size, file count, transfer and name)
+	CString header = intToString(info.m_size);
+	header += ",";
+	header += intToString(count);
+	header += ",";
+	header += intToString(id);
+	header += ",";
+	header += intToString(offset);
+	header += ",";
+	header += info.m_name;
+	sendChunk(kFileStart, header, events, eventTarget);
+
+	// send chunk messages with a fixed chunk size, each followed by
+	// its checksum
+	UInt64 sentLength = offset;
+	char check[9];
+	while (file.is_open() && sentLength < info.m_size) {
+		size_t chunkSize = m_chunkSize;
+		if (sentLength + chunkSize > info.m_size) {
+			chunkSize = static_cast<size_t>(info.m_size - sentLength);
+		}
+
+		// wait until the connection has room, then read the chunk
+		CThread::testCancel();
+		window->acquire(chunkSize);
+		CFileChunk* fileChunk = new CFileChunk(chunkSize + 2, window);
+		char* chunkData = fileChunk->m_chunk;
 
-			stopwatch.reset();
+		chunkData[0] = kFileChunk;
+		file.read(&chunkData[1], chunkSize);
+		if (file.gcount() != static_cast<std::streamsize>(chunkSize)) {
+			// file shrank or can't be read.  the receiver will notice
+			// the short file.
+			LOG((CLOG_ERR "failed to read file: %s", info.m_path.c_str()));
+			delete fileChunk;
+			break;
 		}
+		chunkData[chunkSize + 1] = '\0';
+		UInt32 chunkCrc = checksum(0, &chunkData[1], chunkSize);
+
+		CEvent event(events->forIScreen().fileChunkSending(), eventTarget);
+		event.setDataObject(fileChunk);
+		events->addEvent(event);
+
+		sprintf(check, "%08x", chunkCrc);
+		sendChunk(kFileCheck, check, events, eventTarget);
+
+		sentLength += chunkSize;
 	}
 
 	// send last message
-	CFileChunk* transferFinished = new CFileChunk(2);
-	chunkData = transferFinished->m_chunk;
+	sendChunk(kFileEnd, "", events, eventTarget);
+
+	LOG((CLOG_DEBUG1 "queued file %s, %.0f bytes",
+		info.m_name.c_str(), (double)sentLength));
+}
+
+void
+CFileChunker::sendChunk(UInt8 mark, const CString& content,
+				IEventQueue* events, void* eventTarget)
+{
+	size_t length = content.size();
+	CFileChunk* chunk = new CFileChunk(length + 2);
+	char* chunkData = chunk->m_chunk;
+
+	chunkData[0] = mark;
+	memcpy(&chunkData[1], content.c_str(), length);
+	chunkData[length + 1] = '\0';
+	CEvent event(events->forIScreen().fileChunkSending(), eventTarget);
+	event.setDataObject(chunk);
+	events->addEvent(event);
+}
+
+void
+CFileChunker::expandFiles(const std::vector<CString>& paths, CFileList& files)
+{
+	// each entry is a path to send and the name to send it as
+	std::vector<std::pair<CString, CString> > pending;
+	for (std::vector<CString>::const_reverse_iterator index = paths.rbegin();
+							index != paths.rend(); ++index) {
+		pending.push_back(std::make_pair(*index,
+							CString(ARCH->getBasename(index->c_str()))));
+	}
+
+	while (!pending.empty()) {
+		CString path = pending.back().first;
+		CString name = pending.back().second;
+		pending.pop_back();
+
+		if (ARCH->isDirectory(path)) {
+			// sorted so transfers are repeatable
+			std::vector<std::string> entries;
+			if (!ARCH->listDirectory(path, entries)) {
+				LOG((CLOG_WARN "can't read directory: %s", path.c_str()));
+				continue;
+			}
+			std::sort(entries.begin(), entries.end());
+			for (std::vector<std::string>::reverse_iterator entry =
+							entries.rbegin(); entry != entries.rend(); ++entry) {
+				pending.push_back(std::make_pair(
+							CString(ARCH->concatPath(path, *entry)),
+							name + "/" + *entry));
+			}
+			continue;
+		}
 
-	chunkData[0] = kFileEnd;
-	chunkData[1] = '\0';
-	events->addEvent(CEvent(events->forIScreen().fileChunkSending(), eventTarget, transferFinished));
+		std::fstream file(path.c_str(), std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			LOG((CLOG_WARN "can't open file: %s", path.c_str()));
+			continue;
+		}
+		file.seekg(0, std::ios::end);
+
+		CFile info;
+		info.m_path = path;
+		info.m_name = name;
+		info.m_size = static_cast<UInt64>(file.tellg());
+		files.push_back(info);
+	}
+}
 
-	file.close();
+void
+CFileChunker::splitPaths(const CString& paths, std::vector<CString>& output)
+{
+	CString::size_type start = 0;
+	while (start < paths.size()) {
+		CString::size_type end = paths.find('\n', start);
+		if (end == CString::npos) {
+			end = paths.size();
+		}
+		if (end > start) {
+			output.push_back(paths.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+}
+
+UInt32
+CFileChunker::checksum(UInt32 crc, const void* data, size_t n)
+{
+	const UInt8* bytes = static_cast<const UInt8*>(data);
+	crc = ~crc;
+	for (size_t i = 0; i < n; ++i) {
+		crc = s_checksumTable.m_table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
 }
 
 CString
-CFileChunker::intToString(size_t i)
+CFileChunker::intToString(UInt64 i)
 {
 	stringstream ss;
 	ss << i;
 	return ss.str();
 }
+
+//
+// CFileChunker::CFileChunk
+//
+
+CFileChunker::CFileChunk::CFileChunk(size_t chunkSize, CWindow* window) :
+	m_dataSize(chunkSize - 2),
+	m_chunk(new char[chunkSize]),
+	m_window(window)
+{
+	if (m_window != NULL) {
+		m_window->ref();
+	}
+}
+
+CFileChunker::CFileChunk::~CFileChunk()
+{
+	delete[] m_chunk;
+	if (m_window != NULL) {
+		m_window->release(m_dataSize);
+		m_window->unref();
+	}
+}
+
+//
+// CFileChunker::CWindow
+//
+
+CFileChunker::CWindow::CWindow(size_t size, const synergy::IStream* stream) :
+	m_mutex(new CMutex),
+	m_inFlight(new CCondVar<size_t>(m_mutex, 0)),
+	m_size(size),
+	m_stream(stream),
+	m_refCount(1)
+{
+	// do nothing
+}
+
+CFileChunker::CWindow::~CWindow()
+{
+	delete m_inFlight;
+	delete m_mutex;
+}
+
+void
+CFileChunker::CWindow::acquire(size_t n)
+{
+	// chunks in the event queue plus file data our connection hasn't
+	// sent yet.  always allow a chunk once everything has been sent so
+	// a chunk larger than the window can't stall.
+	CLock lock(m_mutex);
+	for (;;) {
+		size_t pending = *m_inFlight + CPriorityStreamFilter::getBulkSize(m_stream);
+		if (pending == 0 || pending + n <= m_size) {
+			break;
+		}
+		m_inFlight->wait(s_drainPollRate);
+	}
+	*m_inFlight = *m_inFlight + n;
+}
+
+void
+CFileChunker::CWindow::release(size_t n)
+{
+	CLock lock(m_mutex);
+	*m_inFlight = *m_inFlight - n;
+	m_inFlight->broadcast();
+}
+
+void
+CFileChunker::CWindow::ref()
+{
+	CLock lock(m_mutex);
+	++m_refCount;
+}
+
+void
+CFileChunker::CWindow::unref()
+{
+	bool last;
+	{
+		CLock lock(m_mutex);
+		last = (--m_refCount == 0);
+	}
+	if (last) {
+		delete this;
+	}
+}
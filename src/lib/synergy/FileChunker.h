@@ -18,29 +18,163 @@
 #pragma once
 
 #include "base/String.h"
+#include "base/Event.h"
+#include "common/stdvector.h"
 
 class IEventQueue;
+class CMutex;
+namespace synergy { class IStream; }
+template <class T> class CCondVar;
 
+//! File transfer sender
+/*!
+Sends files to the peer as \c forIScreen().fileChunkSending() events
+carrying CFileChunk data, which the event target writes to the peer.
+Each file is sent as a start chunk, data chunks and an end chunk:
+
+  - the start chunk holds "size,count,id,offset,name" where count is
+    the number of files in the transfer, id identifies the transfer,
+    offset is where in the file the data starts (non-zero only when
+    resuming) and name is the file's path relative to the dropped item,
+    using '/' as the separator.  older peers only read the size.
+  - each data chunk is followed by a check chunk holding the CRC-32 of
+    the data chunk in hex.  the connection may split a data chunk into
+    several messages but check chunks aren't split.
+  - the end chunk is empty.
+
+The receiver may ask to resume an interrupted transfer with a resume
+chunk holding "id,index,offset";  see sendFiles().
+
+The sending thread reads ahead of the connection by at most a small
+window, so the next file's data is read while the current one is on
+the wire but no more than the window is ever held in memory.
+*/
 class CFileChunker {
 public:
-	//! FileChunk data
-	class CFileChunk {
-	public:
-		CFileChunk(size_t chunkSize) : m_dataSize(chunkSize - 2)
-		{
-			m_chunk = new char[chunkSize]; 
-		}
+	class CWindow;
 
-		~CFileChunk() { delete[] m_chunk; }
+	//! File data chunk
+	/*!
+	The first byte is the chunk mark, the last is a NUL.  Use as event
+	data with CEvent::setDataObject().
+	*/
+	class CFileChunk : public CEventData {
+	public:
+		CFileChunk(size_t chunkSize, CWindow* window = NULL);
+		virtual ~CFileChunk();
 
 	public:
 		const size_t	m_dataSize;
 		char*			m_chunk;
+
+	private:
+		CWindow*		m_window;
+	};
+
+	//! A file to send
+	class CFile {
+	public:
+		CString			m_path;
+		CString			m_name;
+		UInt64			m_size;
 	};
+	typedef std::vector<CFile> CFileList;
+
+	//! Send files
+	/*!
+	Sends the files and directories in \c paths, which are separated
+	by newlines, including everything in the directories.  Returns when
+	the last chunk has been queued.  Throws std::runtime_error if there
+	is nothing to send.
+	*/
+	static void			sendFileChunks(const char* paths, IEventQueue* events, void* eventTarget);
+
+	//! Send part of a transfer
+	/*!
+	Sends files \c first onwards of transfer \c id, starting \c offset
+	bytes into the first of them.  Returns when the last chunk has been
+	queued.  If the chunks are written to a CPriorityStreamFilter then
+	pass it as \c stream so reading doesn't get far ahead of it.  This
+	is a cancellation point.
+	*/
+	static void			sendFiles(const CFileList& files, UInt32 id,
+							UInt32 first, UInt64 offset,
+							IEventQueue* events, void* eventTarget,
+							const synergy::IStream* stream = NULL);
+
+	//! Make a transfer id
+	/*!
+	Returns a non-zero id that's unlikely to match an earlier transfer.
+	*/
+	static UInt32		newTransferId();
+
+	//! Expand directories
+	/*!
+	Replaces each directory in \c paths by the files in it,
+	recursively, and fills in \c files.  Paths that don't exist are
+	skipped.
+	*/
+	static void			expandFiles(const std::vector<CString>& paths, CFileList& files);
+
+	//! Split a path list
+	/*!
+	Splits newline separated \c paths, as used for dragged files.
+	*/
+	static void			splitPaths(const CString& paths, std::vector<CString>& output);
 
-	static void			sendFileChunks(char* filename, IEventQueue* events, void* eventTarget);
-	static CString		intToString(size_t i);
+	//! Update a CRC-32
+	/*!
+	Returns \c crc updated with \c n bytes of \c data.  Start with 0.
+	*/
+	static UInt32		checksum(UInt32 crc, const void* data, size_t n);
+
+	static CString		intToString(UInt64 i);
+
+private:
+	static void			sendFile(const CFile&, UInt32 count, UInt32 id,
+							UInt64 offset, CWindow*,
+							IEventQueue*, void* eventTarget);
+	static void			sendChunk(UInt8 mark, const CString& content,
+							IEventQueue*, void* eventTarget);
 
 private:
 	static const size_t m_chunkSize;
 };
+
+//! File transfer window
+/*!
+Limits how far the sending thread reads ahead of the connection.
+Chunks are charged to the window until they've been written to the
+peer.  Shared by the sending thread and its chunks, it's destroyed when
+the last of them releases it.
+*/
+class CFileChunker::CWindow {
+public:
+	/*!
+	Data still queued in \c stream, a CPriorityStreamFilter or NULL,
+	counts against the window too.
+	*/
+	CWindow(size_t size, const synergy::IStream* stream);
+
+	//! Wait for room for a chunk of \c n bytes and charge it
+	void				acquire(size_t n);
+
+	//! Return the charge for a chunk of \c n bytes
+	void				release(size_t n);
+
+	//! Add a reference
+	void				ref();
+
+	//! Drop a reference, deleting the window with the last one
+	void				unref();
+
+private:
+	~CWindow();
+
+private:
+	CMutex*				m_mutex;
+	CCondVar<size_t>*	m_inFlight;
+	size_t				m_size;
+	const synergy::IStream*	m_stream;
+	UInt32				m_refCount;
+};
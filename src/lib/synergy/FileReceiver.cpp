@@ -0,0 +1,643 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/FileReceiver.h"
+
+#include "synergy/FileChunker.h"
+#include "base/Log.h"
+#include "arch/Arch.h"
+
+#include <sstream>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if SYSAPI_WIN32
+#	include <io.h>
+#else
+#	include <unistd.h>
+#endif
+
+// size of the buffer used to copy a spool file to another file system
+static const size_t		s_copyBufferSize = 64 * 1024;
+
+//
+// CFileReceiver
+//
+
+CFileReceiver::CFileReceiver(const CString& name, const CString& spoolDirectory) :
+	m_name(name),
+	m_spoolDirectory(spoolDirectory),
+	m_transferId(0),
+	m_expectedCount(0),
+	m_expectedSize(0),
+	m_receivedSize(0),
+	m_verifiedSize(0),
+	m_receiving(false),
+	m_checked(false),
+	m_failed(false)
+{
+	// the shared temp directory would let other users guess the spool
+	// file names and put links there first
+	if (m_spoolDirectory.empty()) {
+		m_spoolDirectory = ARCH->getPrivateDirectory();
+		if (m_spoolDirectory.empty()) {
+			LOG((CLOG_ERR "no private directory to receive files in"));
+		}
+	}
+	setTransfer(0, 0);
+}
+
+CFileReceiver::~CFileReceiver()
+{
+	// keep a partial transfer that can be resumed for recover()
+	CString request;
+	if (getResumeRequest(request)) {
+		m_file.close();
+		m_journal.close();
+	}
+	else {
+		clear();
+	}
+}
+
+void
+CFileReceiver::start(const CString& header, const CString& defaultName)
+{
+	// parse "size" or "size,count,id,offset,name"
+	std::istringstream iss(header);
+	UInt64 size = 0, offset = 0;
+	UInt32 count = 1, id = 0;
+	char comma;
+	iss >> size;
+	if (iss.get(comma) && comma == ',') {
+		iss >> count >> comma >> id >> comma >> offset;
+		iss.get(comma);
+	}
+	CString name;
+	std::getline(iss, name, '\0');
+
+	if (!name.empty() && !isSafeName(name)) {
+		LOG((CLOG_WARN "ignoring unsafe file name: %s", name.c_str()));
+		name.clear();
+	}
+	if (name.empty()) {
+		name = isSafeName(defaultName) ? defaultName : CString("untitled");
+	}
+
+	// the sender restarted the current file after a reconnect
+	if (m_receiving && id != 0 && id == m_transferId &&
+		name == m_files.back().m_name) {
+		resumeFile(offset);
+		return;
+	}
+
+	if (m_receiving) {
+		LOG((CLOG_WARN "file %s ended early", m_files.back().m_name.c_str()));
+		m_file.close();
+		m_receiving = false;
+		journal("E " + CFileChunker::intToString(m_files.size() - 1) + " 0");
+	}
+	if (m_files.empty() || id != m_transferId ||
+		m_files.size() >= m_expectedCount) {
+		newTransfer(id, count);
+	}
+
+	UInt32 index = static_cast<UInt32>(m_files.size());
+	CFile file;
+	file.m_spoolPath = getSpoolPath(index);
+	file.m_name      = name;
+	file.m_size      = size;
+	file.m_valid     = false;
+	m_files.push_back(file);
+	journal("F " + CFileChunker::intToString(index) + " " +
+			CFileChunker::intToString(size) + " " + name);
+
+	m_file.clear();
+	if (createFile(file.m_spoolPath)) {
+		m_file.open(file.m_spoolPath.c_str(),
+					std::ios::out | std::ios::binary | std::ios::trunc);
+	}
+	if (!m_file.is_open()) {
+		LOG((CLOG_ERR "can't create spool file %s", file.m_spoolPath.c_str()));
+	}
+
+	m_expectedSize = size;
+	m_receivedSize = 0;
+	m_verifiedSize = 0;
+	m_unverified.clear();
+	m_receiving    = true;
+	m_checked      = (id != 0);
+	m_failed       = false;
+	if (offset != 0) {
+		LOG((CLOG_ERR "can't resume %s, it wasn't started", name.c_str()));
+		m_failed = true;
+	}
+	LOG((CLOG_DEBUG1 "receiving file %d of %d: %s, %.0f bytes",
+		m_files.size(), m_expectedCount, name.c_str(), (double)size));
+}
+
+void
+CFileReceiver::write(const CString& data)
+{
+	if (!m_receiving) {
+		LOG((CLOG_DEBUG "ignoring file data outside of a file"));
+		return;
+	}
+
+	// data is only written once it's been checked
+	if (m_checked) {
+		m_unverified += data;
+	}
+	else if (m_file.is_open()) {
+		m_file.write(data.data(), data.size());
+	}
+	m_receivedSize += data.size();
+}
+
+void
+CFileReceiver::check(const CString& checksum)
+{
+	if (!m_receiving || !m_checked) {
+		return;
+	}
+
+	char expected[9];
+	sprintf(expected, "%08x", CFileChunker::checksum(0,
+							m_unverified.data(), m_unverified.size()));
+
+	if (m_failed) {
+		// nothing more is written to a failed file
+	}
+	else if (checksum != expected) {
+		LOG((CLOG_ERR "checksum mismatch in %s after %.0f bytes",
+			m_files.back().m_name.c_str(), (double)m_verifiedSize));
+		m_failed = true;
+	}
+	else {
+		if (m_file.is_open()) {
+			m_file.write(m_unverified.data(), m_unverified.size());
+			m_file.flush();
+		}
+		m_verifiedSize += m_unverified.size();
+		journal("V " + CFileChunker::intToString(m_files.size() - 1) + " " +
+				CFileChunker::intToString(m_verifiedSize));
+	}
+	m_unverified.clear();
+}
+
+bool
+CFileReceiver::end()
+{
+	if (!m_receiving) {
+		return false;
+	}
+
+	bool written = false;
+	if (m_file.is_open()) {
+		m_file.close();
+		written = !m_file.fail();
+	}
+	m_receiving = false;
+
+	CFile& file = m_files.back();
+	if (!written) {
+		LOG((CLOG_ERR "failed to write %s", file.m_name.c_str()));
+	}
+	else if (m_failed || !m_unverified.empty()) {
+		LOG((CLOG_ERR "%s failed its checks", file.m_name.c_str()));
+	}
+	else if (m_receivedSize != m_expectedSize) {
+		LOG((CLOG_ERR "size mismatch for %s: expected %.0f bytes, received %.0f",
+			file.m_name.c_str(), (double)m_expectedSize, (double)m_receivedSize));
+	}
+	else {
+		file.m_valid = true;
+	}
+	m_unverified.clear();
+	journal("E " + CFileChunker::intToString(m_files.size() - 1) +
+			(file.m_valid ? " 1" : " 0"));
+
+	return isComplete();
+}
+
+bool
+CFileReceiver::moveTo(const CString& destination)
+{
+	LOG((CLOG_DEBUG "dropping files, files=%i target=%s", m_files.size(), destination.c_str()));
+
+	bool result = true;
+	for (CFileList::const_iterator index = m_files.begin();
+							index != m_files.end(); ++index) {
+		if (!index->m_valid) {
+			remove(index->m_spoolPath.c_str());
+			continue;
+		}
+
+		CString path;
+		if (destination.empty() ||
+			!makeParents(destination, index->m_name, path) ||
+			!moveFile(index->m_spoolPath, path)) {
+			LOG((CLOG_ERR "drop file failed: can not write %s to %s",
+				index->m_name.c_str(), destination.c_str()));
+			remove(index->m_spoolPath.c_str());
+			result = false;
+		}
+	}
+
+	m_files.clear();
+	clear();
+	return result;
+}
+
+void
+CFileReceiver::clear()
+{
+	if (m_receiving) {
+		m_file.close();
+		m_receiving = false;
+	}
+	for (CFileList::const_iterator index = m_files.begin();
+							index != m_files.end(); ++index) {
+		remove(index->m_spoolPath.c_str());
+	}
+	if (m_journal.is_open()) {
+		m_journal.close();
+	}
+	if (m_transferId != 0) {
+		remove(getJournalPath().c_str());
+	}
+	m_files.clear();
+	m_unverified.clear();
+	setTransfer(0, 0);
+}
+
+bool
+CFileReceiver::recover()
+{
+	clear();
+
+	std::vector<std::string> names;
+	if (!ARCH->listDirectory(m_spoolDirectory, names)) {
+		return false;
+	}
+
+	const CString prefix = "synergy-" + m_name + "-";
+	const CString suffix = ".journal";
+	bool found = false;
+	for (size_t i = 0; i < names.size(); ++i) {
+		const CString& name = names[i];
+		if (name.size() <= prefix.size() + suffix.size() ||
+			name.compare(0, prefix.size(), prefix) != 0 ||
+			name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+			continue;
+		}
+
+		// a receiver only has one transfer so the rest are stale
+		CString path = ARCH->concatPath(m_spoolDirectory, name);
+		if (found) {
+			CFileReceiver stale(m_name, m_spoolDirectory);
+			stale.replay(path);
+			stale.clear();
+			remove(path.c_str());
+		}
+		else if (replay(path)) {
+			found = true;
+		}
+		else {
+			clear();
+			remove(path.c_str());
+		}
+	}
+
+	if (found) {
+		LOG((CLOG_INFO "recovered partial file transfer, %d of %d files",
+			m_files.size(), m_expectedCount));
+	}
+	return found;
+}
+
+bool
+CFileReceiver::isComplete() const
+{
+	return (!m_receiving && !m_files.empty() &&
+			m_files.size() >= m_expectedCount);
+}
+
+bool
+CFileReceiver::isValid() const
+{
+	if (!isComplete()) {
+		return false;
+	}
+	for (CFileList::const_iterator index = m_files.begin();
+							index != m_files.end(); ++index) {
+		if (!index->m_valid) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool
+CFileReceiver::getResumeRequest(CString& request) const
+{
+	if (m_transferId == 0 || m_files.empty() || isComplete()) {
+		return false;
+	}
+
+	// the rest of the current file or the start of the next one
+	UInt32 index  = static_cast<UInt32>(m_files.size());
+	UInt64 offset = 0;
+	if (m_receiving) {
+		index  -= 1;
+		offset  = m_verifiedSize;
+	}
+	request  = CFileChunker::intToString(m_transferId);
+	request += ",";
+	request += CFileChunker::intToString(index);
+	request += ",";
+	request += CFileChunker::intToString(offset);
+	return true;
+}
+
+UInt64
+CFileReceiver::getExpectedSize() const
+{
+	return m_expectedSize;
+}
+
+const CFileReceiver::CFileList&
+CFileReceiver::getFiles() const
+{
+	return m_files;
+}
+
+bool
+CFileReceiver::isSafeName(const CString& name)
+{
+	if (name.empty() || name[0] == '/' ||
+		name.find_first_of("\\:\n") != CString::npos) {
+		return false;
+	}
+
+	CString::size_type start = 0;
+	for (;;) {
+		CString::size_type end = name.find('/', start);
+		CString part = name.substr(start,
+							(end == CString::npos) ? CString::npos : end - start);
+		if (part.empty() || part == "." || part == "..") {
+			return false;
+		}
+		if (end == CString::npos) {
+			return true;
+		}
+		start = end + 1;
+	}
+}
+
+void
+CFileReceiver::newTransfer(UInt32 id, UInt32 count)
+{
+	clear();
+	setTransfer(id, count);
+
+	// older senders can't resume so there's no point in a journal
+	if (id != 0 && createFile(getJournalPath())) {
+		m_journal.open(getJournalPath().c_str(),
+							std::ios::out | std::ios::trunc);
+		journal("T " + CFileChunker::intToString(id) + " " +
+				CFileChunker::intToString(m_expectedCount));
+	}
+}
+
+void
+CFileReceiver::setTransfer(UInt32 id, UInt32 count)
+{
+	m_transferId    = id;
+	m_expectedCount = (count == 0 && id != 0) ? 1 : count;
+
+	// spool files of a resumable transfer must be found again by id.
+	// otherwise keep spool files of different receivers apart.
+	char prefix[40];
+	if (id != 0) {
+		sprintf(prefix, "%08x-", id);
+	}
+	else {
+		sprintf(prefix, "%08x%08x-",
+			static_cast<UInt32>(ARCH->nanoTime()),
+			static_cast<UInt32>(reinterpret_cast<size_t>(this)));
+	}
+	m_spoolPrefix = "synergy-" + m_name + "-" + prefix;
+}
+
+void
+CFileReceiver::resumeFile(UInt64 offset)
+{
+	CFile& file = m_files.back();
+	m_file.close();
+	m_file.clear();
+	m_unverified.clear();
+
+	// only verified data was written so carry on from there
+	m_file.open(file.m_spoolPath.c_str(),
+				std::ios::in | std::ios::out | std::ios::binary);
+	if (!m_file.is_open()) {
+		LOG((CLOG_ERR "can't reopen spool file %s", file.m_spoolPath.c_str()));
+		m_failed = true;
+	}
+	else if (offset != m_verifiedSize) {
+		LOG((CLOG_ERR "can't resume %s at %.0f bytes, have %.0f",
+			file.m_name.c_str(), (double)offset, (double)m_verifiedSize));
+		m_failed = true;
+	}
+	else {
+		m_file.seekp(static_cast<std::streamoff>(offset));
+		m_failed = false;
+		LOG((CLOG_INFO "resuming %s at %.0f bytes",
+			file.m_name.c_str(), (double)offset));
+	}
+
+	m_receivedSize = offset;
+}
+
+void
+CFileReceiver::journal(const CString& line)
+{
+	if (m_journal.is_open()) {
+		m_journal << line << "\n";
+		m_journal.flush();
+	}
+}
+
+bool
+CFileReceiver::replay(const CString& path)
+{
+	std::ifstream in(path.c_str());
+	CString line;
+	while (std::getline(in, line)) {
+		std::istringstream iss(line);
+		char type = 0;
+		UInt32 index = 0;
+		UInt64 value = 0;
+		iss >> type;
+		if (type == 'T') {
+			UInt32 id = 0, count = 0;
+			iss >> id >> count;
+			if (!m_files.empty() || id == 0) {
+				return false;
+			}
+			setTransfer(id, count);
+			continue;
+		}
+
+		iss >> index >> value;
+		if (iss.fail() || m_transferId == 0 ||
+			index + (type == 'F' ? 0 : 1) != m_files.size()) {
+			return false;
+		}
+		if (type == 'F') {
+			CFile file;
+			iss.get();
+			std::getline(iss, file.m_name);
+			if (!isSafeName(file.m_name)) {
+				LOG((CLOG_WARN "unsafe file name in journal: %s",
+					file.m_name.c_str()));
+				return false;
+			}
+			file.m_spoolPath = getSpoolPath(index);
+			file.m_size      = value;
+			file.m_valid     = false;
+			m_files.push_back(file);
+			m_expectedSize   = value;
+			m_verifiedSize   = 0;
+			m_receiving      = true;
+		}
+		else if (type == 'V') {
+			m_verifiedSize   = value;
+		}
+		else if (type == 'E') {
+			m_files.back().m_valid = (value != 0);
+			m_receiving      = false;
+		}
+		else {
+			return false;
+		}
+	}
+
+	// a finished transfer wasn't dropped in time so it's of no use
+	if (m_transferId == 0 || m_files.empty() || isComplete()) {
+		return false;
+	}
+
+	m_checked = true;
+	m_failed  = false;
+	m_journal.open(path.c_str(), std::ios::out | std::ios::app);
+	return true;
+}
+
+CString
+CFileReceiver::getSpoolPath(UInt32 index) const
+{
+	return ARCH->concatPath(m_spoolDirectory,
+							m_spoolPrefix + CFileChunker::intToString(index));
+}
+
+CString
+CFileReceiver::getJournalPath() const
+{
+	char name[20];
+	sprintf(name, "%08x.journal", m_transferId);
+	return ARCH->concatPath(m_spoolDirectory, "synergy-" + m_name + "-" + name);
+}
+
+bool
+CFileReceiver::createFile(const CString& path) const
+{
+	if (m_spoolDirectory.empty()) {
+		return false;
+	}
+
+	// a file left by an earlier receiver is replaced.  create the new
+	// one exclusively so nothing put there in the meantime is followed.
+	remove(path.c_str());
+#if SYSAPI_WIN32
+	int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY,
+							_S_IREAD | _S_IWRITE);
+	if (fd == -1) {
+		return false;
+	}
+	_close(fd);
+#else
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+	if (fd == -1) {
+		return false;
+	}
+	close(fd);
+#endif
+	return true;
+}
+
+bool
+CFileReceiver::makeParents(const CString& destination,
+				const CString& name, CString& path)
+{
+	path = destination;
+	CString::size_type start = 0;
+	for (;;) {
+		CString::size_type end = name.find('/', start);
+		if (end == CString::npos) {
+			path = ARCH->concatPath(path, name.substr(start));
+			return true;
+		}
+		path = ARCH->concatPath(path, name.substr(start, end - start));
+		if (!ARCH->makeDirectory(path)) {
+			return false;
+		}
+		start = end + 1;
+	}
+}
+
+bool
+CFileReceiver::moveFile(const CString& from, const CString& to)
+{
+	// replace any existing file
+	remove(to.c_str());
+	if (rename(from.c_str(), to.c_str()) == 0) {
+		return true;
+	}
+
+	// probably on another file system
+	std::ifstream in(from.c_str(), std::ios::in | std::ios::binary);
+	std::ofstream out(to.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!in.is_open() || !out.is_open()) {
+		return false;
+	}
+
+	std::vector<char> buffer(s_copyBufferSize);
+	while (in) {
+		in.read(&buffer[0], buffer.size());
+		out.write(&buffer[0], in.gcount());
+	}
+	out.close();
+	in.close();
+	if (out.fail()) {
+		remove(to.c_str());
+		return false;
+	}
+	remove(from.c_str());
+	return true;
+}
@@ -0,0 +1,191 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+#include <fstream>
+
+//! File transfer receiver
+/*!
+Receives the files sent by CFileChunker.  The drop target isn't known
+until the drop has happened, which is usually after the data arrives,
+so each file is written to a spool file as its chunks arrive and the
+finished files are moved to the drop target by moveTo().  Memory use
+doesn't depend on the file sizes.
+
+Data is only written to the spool file once its check chunk has
+verified it, and the verified part of each file is recorded in a
+journal next to the spool files.  If the connection is lost the
+receiver can ask the sender to resume from there (see
+getResumeRequest()), and a new receiver can pick up the partial
+transfer from the journal (see recover()).
+
+Each file is checked against the size in its start chunk.  Names sent
+by the peer are only used if they stay inside the drop target.
+*/
+class CFileReceiver {
+public:
+	//! A received file
+	class CFile {
+	public:
+		CString			m_spoolPath;
+		CString			m_name;
+		UInt64			m_size;
+		bool			m_valid;
+	};
+	typedef std::vector<CFile> CFileList;
+
+	/*!
+	Spool files are written to \c spoolDirectory, or the user's private
+	directory if it's empty, with names starting with \c name.  Use a
+	different name for each receiver sharing a spool directory.  Files
+	can't be received if there's no private directory.
+	*/
+	CFileReceiver(const CString& name = "drop",
+							const CString& spoolDirectory = "");
+	~CFileReceiver();
+
+	//! @name manipulators
+	//@{
+
+	//! Start a file
+	/*!
+	Handles a start chunk.  \c defaultName is used if the sender didn't
+	name the file, which older senders don't.  Starts a new transfer if
+	the previous one is complete or this is a different transfer, and
+	resumes the current file if the sender restarted it.
+	*/
+	void				start(const CString& header, const CString& defaultName);
+
+	//! Write file data
+	/*!
+	Handles a data chunk for the current file.
+	*/
+	void				write(const CString& data);
+
+	//! Check file data
+	/*!
+	Handles a check chunk, verifying the data since the last one.
+	*/
+	void				check(const CString& checksum);
+
+	//! End a file
+	/*!
+	Handles an end chunk.  Returns true if that was the last file of
+	the transfer.
+	*/
+	bool				end();
+
+	//! Move files to destination
+	/*!
+	Moves the files of a complete transfer into directory
+	\c destination, creating any subdirectories, and forgets them.
+	Files that failed their checks are deleted instead.  Returns false
+	if any file couldn't be moved.
+	*/
+	bool				moveTo(const CString& destination);
+
+	//! Discard all files
+	/*!
+	Deletes all spool files, including a partly received one, and the
+	journal.
+	*/
+	void				clear();
+
+	//! Recover a partial transfer
+	/*!
+	Replaces the current state with the partial transfer in the
+	journal left in the spool directory by an earlier receiver with
+	the same name, if there is one.  Returns true if it found one.
+	Other journals of that name are discarded.
+	*/
+	bool				recover();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test for a complete transfer
+	bool				isComplete() const;
+
+	//! Test for a valid transfer
+	/*!
+	Returns true iff the transfer is complete and every file passed
+	its checks.
+	*/
+	bool				isValid() const;
+
+	//! Get resume request
+	/*!
+	If a resumable transfer is partly received, sets \c request to the
+	content of a resume chunk asking for the rest and returns true.
+	*/
+	bool				getResumeRequest(CString& request) const;
+
+	//! Get size of current file
+	/*!
+	Returns the size announced for the file being received, or the
+	last one received.
+	*/
+	UInt64				getExpectedSize() const;
+
+	//! Get received files
+	const CFileList&	getFiles() const;
+
+	//! Test a file name
+	/*!
+	Returns true iff relative path \c name (using '/' separators) stays
+	inside the directory it's relative to.
+	*/
+	static bool			isSafeName(const CString& name);
+
+	//@}
+
+private:
+	void				newTransfer(UInt32 id, UInt32 count);
+	void				setTransfer(UInt32 id, UInt32 count);
+	void				resumeFile(UInt64 offset);
+	void				journal(const CString& line);
+	bool				replay(const CString& path);
+	CString				getSpoolPath(UInt32 index) const;
+	CString				getJournalPath() const;
+	bool				createFile(const CString& path) const;
+	static bool			makeParents(const CString& destination,
+							const CString& name, CString& path);
+	static bool			moveFile(const CString& from, const CString& to);
+
+private:
+	CString				m_name;
+	CString				m_spoolDirectory;
+	CString				m_spoolPrefix;
+	CFileList			m_files;
+	UInt32				m_transferId;
+	UInt32				m_expectedCount;
+	UInt64				m_expectedSize;
+	UInt64				m_receivedSize;
+	UInt64				m_verifiedSize;
+	CString				m_unverified;
+	std::fstream		m_file;
+	std::ofstream		m_journal;
+	bool				m_receiving;
+	bool				m_checked;
+	bool				m_failed;
+};
@@ -0,0 +1,148 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/FileSender.h"
+
+#include "mt/Lock.h"
+#include "mt/Thread.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+#include "common/stdexcept.h"
+
+#include <sstream>
+
+//
+// CFileSender
+//
+
+CFileSender::CFileSender(IEventQueue* events, void* eventTarget) :
+	m_events(events),
+	m_eventTarget(eventTarget),
+	m_thread(NULL),
+	m_id(0),
+	m_first(0),
+	m_offset(0),
+	m_stream(NULL)
+{
+	// do nothing
+}
+
+CFileSender::~CFileSender()
+{
+	CLock lock(&m_mutex);
+	stop();
+}
+
+void
+CFileSender::send(const CString& paths, bool firstFileOnly)
+{
+	CLock lock(&m_mutex);
+	stop();
+
+	std::vector<CString> pathList;
+	CFileChunker::splitPaths(paths, pathList);
+	m_files.clear();
+	CFileChunker::expandFiles(pathList, m_files);
+	if (m_files.empty()) {
+		LOG((CLOG_ERR "failed sending file chunks: nothing to send"));
+		m_id = 0;
+		return;
+	}
+	if (firstFileOnly && m_files.size() > 1) {
+		LOG((CLOG_NOTE "peer can't receive several files, sending %s only",
+			m_files[0].m_name.c_str()));
+		m_files.resize(1);
+	}
+
+	m_id = CFileChunker::newTransferId();
+	start(0, 0);
+}
+
+void
+CFileSender::setStream(const synergy::IStream* stream)
+{
+	CLock lock(&m_mutex);
+	m_stream = stream;
+}
+
+void
+CFileSender::suspend()
+{
+	CLock lock(&m_mutex);
+	stop();
+}
+
+bool
+CFileSender::resume(const CString& request)
+{
+	std::istringstream iss(request);
+	UInt32 id = 0, index = 0;
+	UInt64 offset = 0;
+	char comma1 = 0, comma2 = 0;
+	iss >> id >> comma1 >> index >> comma2 >> offset;
+	if (iss.fail() || comma1 != ',' || comma2 != ',') {
+		LOG((CLOG_WARN "bad file resume request: %s", request.c_str()));
+		return false;
+	}
+
+	CLock lock(&m_mutex);
+	if (id == 0 || id != m_id || index >= m_files.size()) {
+		LOG((CLOG_DEBUG "ignoring resume of unknown file transfer %u", id));
+		return false;
+	}
+
+	LOG((CLOG_INFO "resuming file transfer at file %u of %u, %.0f bytes",
+		index + 1, m_files.size(), (double)offset));
+	stop();
+	start(index, offset);
+	return true;
+}
+
+void
+CFileSender::stop()
+{
+	if (m_thread != NULL) {
+		m_thread->cancel();
+		m_thread->wait();
+		delete m_thread;
+		m_thread = NULL;
+	}
+}
+
+void
+CFileSender::start(UInt32 first, UInt64 offset)
+{
+	assert(m_thread == NULL);
+
+	m_first  = first;
+	m_offset = offset;
+	m_thread = new CThread(new TMethodJob<CFileSender>(
+								this, &CFileSender::sendThread));
+}
+
+void
+CFileSender::sendThread(void*)
+{
+	// m_files and the rest don't change until this thread has stopped
+	try {
+		CFileChunker::sendFiles(m_files, m_id, m_first, m_offset,
+							m_events, m_eventTarget, m_stream);
+	}
+	catch (std::runtime_error& error) {
+		LOG((CLOG_ERR "failed sending file chunks: %s", error.what()));
+	}
+}
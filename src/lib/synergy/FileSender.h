@@ -0,0 +1,98 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/FileChunker.h"
+#include "mt/Mutex.h"
+
+class CThread;
+class IEventQueue;
+namespace synergy { class IStream; }
+
+//! File transfer sender
+/*!
+Sends files with CFileChunker on a thread of its own.  The transfer is
+remembered after the thread stops so that, if the connection was lost,
+it can be resumed from wherever the receiver asks once the peer has
+reconnected.
+*/
+class CFileSender {
+public:
+	/*!
+	Chunk events are sent to \c eventTarget.
+	*/
+	CFileSender(IEventQueue* events, void* eventTarget);
+	~CFileSender();
+
+	//! @name manipulators
+	//@{
+
+	//! Send files
+	/*!
+	Starts a new transfer of the newline separated files and
+	directories in \c paths, abandoning any earlier transfer.  If
+	\c firstFileOnly is true then only the first file is sent, for
+	peers that keep one file per drop.
+	*/
+	void				send(const CString& paths, bool firstFileOnly = false);
+
+	//! Set the connection
+	/*!
+	Chunks are written to \c stream, which may be a
+	CPriorityStreamFilter, until the next call.  Reading ahead is
+	limited by the data it hasn't sent yet.  Takes effect when sending
+	next starts or resumes.
+	*/
+	void				setStream(const synergy::IStream* stream);
+
+	//! Stop sending
+	/*!
+	Stops the sending thread, e.g. because the connection was lost.
+	Chunks already queued are still sent to the event target.  The
+	transfer can be resumed.
+	*/
+	void				suspend();
+
+	//! Resume the transfer
+	/*!
+	Handles a resume chunk from the receiver, \c request being
+	"id,index,offset".  Restarts the transfer at that point and returns
+	true if it's the current transfer, otherwise returns false.
+	*/
+	bool				resume(const CString& request);
+
+	//@}
+
+private:
+	// note -- m_mutex must be locked on entry
+	void				stop();
+	void				start(UInt32 first, UInt64 offset);
+
+	void				sendThread(void*);
+
+private:
+	IEventQueue*		m_events;
+	void*				m_eventTarget;
+	CMutex				m_mutex;
+	CThread*			m_thread;
+	CFileChunker::CFileList m_files;
+	UInt32				m_id;
+	UInt32				m_first;
+	UInt64				m_offset;
+	const synergy::IStream*	m_stream;
+};
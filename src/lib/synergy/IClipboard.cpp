@@ -103,6 +103,38 @@ IClipboard::marshall(const IClipboard* clipboard)
 	return data;
 }
 
+UInt32
+IClipboard::marshall(const IClipboard* clipboard, CSharedBufferList& buffers)
+{
+	assert(clipboard != NULL);
+
+	// each format's data is copied once, by get(), and used as it is
+	CSharedBufferList formatData;
+	UInt32 size = 4;
+	UInt32 numFormats = 0;
+	clipboard->open(0);
+	for (UInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		if (clipboard->has(static_cast<IClipboard::EFormat>(format))) {
+			CString data =
+				clipboard->get(static_cast<IClipboard::EFormat>(format));
+			CString header;
+			writeUInt32(&header, format);
+			writeUInt32(&header, (UInt32)data.size());
+			size += 4 + 4 + (UInt32)data.size();
+			++numFormats;
+			formatData.push_back(CSharedBuffer::adopt(header));
+			formatData.push_back(CSharedBuffer::adopt(data));
+		}
+	}
+	clipboard->close();
+
+	CString header;
+	writeUInt32(&header, numFormats);
+	buffers.push_back(CSharedBuffer::adopt(header));
+	buffers.insert(buffers.end(), formatData.begin(), formatData.end());
+	return size;
+}
+
 bool
 IClipboard::copy(IClipboard* dst, const IClipboard* src)
 {
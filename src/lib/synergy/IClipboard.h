@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "io/SharedBuffer.h"
 #include "base/String.h"
 #include "base/EventTypes.h"
 #include "common/IInterface.h"
@@ -134,6 +135,16 @@ public:
 	*/
 	static CString		marshall(const IClipboard* clipboard);
 
+	//! Marshall clipboard data in parts
+	/*!
+	Like marshall() but appends the marshalled data to \p buffers in
+	parts, each format's data in a part of its own, and returns its
+	size.  Send it with CProtocolUtil::writefBuffers() so the data isn't
+	copied together.
+	*/
+	static UInt32		marshall(const IClipboard* clipboard,
+							CSharedBufferList& buffers);
+
 	//! Unmarshall clipboard data
 	/*!
 	Extract marshalled clipboard data and store it in \p clipboard.
@@ -163,7 +174,7 @@ public:
 
 	//@}
 
-private:
+protected:
 	static UInt32		readUInt32(const char*);
 	static void			writeUInt32(CString*, UInt32);
 };
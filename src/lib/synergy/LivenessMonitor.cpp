@@ -0,0 +1,190 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/LivenessMonitor.h"
+
+#include "base/IEventQueue.h"
+#include "base/EventTypes.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+#include "arch/Arch.h"
+
+// how often the shared monitor looks for silent connections.  this
+// adds at most this much to the time it takes to notice a dead peer.
+static const double		s_sweepRate = 0.5;
+
+//
+// CLivenessMonitor
+//
+
+CLivenessMonitor::CMonitors	CLivenessMonitor::s_monitors;
+
+CLivenessMonitor::CLivenessMonitor(IEventQueue* events, double sweepRate) :
+	m_events(events),
+	m_sweepRate(sweepRate),
+	m_timer(NULL),
+	m_numTimers(0),
+	m_refCount(0)
+{
+	assert(m_events != NULL);
+	assert(m_sweepRate > 0.0);
+
+	// silent targets are reported through the monitor so the report
+	// can be dropped if the target goes away first
+	m_events->adoptHandler(m_events->forCLivenessMonitor().dead(), this,
+							new TMethodEventJob<CLivenessMonitor>(this,
+								&CLivenessMonitor::handleDead));
+}
+
+CLivenessMonitor::~CLivenessMonitor()
+{
+	m_events->removeHandler(m_events->forCLivenessMonitor().dead(), this);
+	stopSweeping();
+}
+
+CLivenessMonitor*
+CLivenessMonitor::acquire(IEventQueue* events)
+{
+	CMonitors::iterator index = s_monitors.find(events);
+	if (index == s_monitors.end()) {
+		index = s_monitors.insert(std::make_pair(events,
+							new CLivenessMonitor(events, s_sweepRate))).first;
+	}
+	++index->second->m_refCount;
+	return index->second;
+}
+
+void
+CLivenessMonitor::release(CLivenessMonitor* monitor)
+{
+	assert(monitor != NULL);
+	assert(monitor->m_refCount > 0);
+
+	if (--monitor->m_refCount == 0) {
+		s_monitors.erase(monitor->m_events);
+		delete monitor;
+	}
+}
+
+void
+CLivenessMonitor::watch(void* target, double* lastActivity, double timeout)
+{
+	assert(lastActivity != NULL);
+
+	touch(*lastActivity);
+	m_dead.erase(target);
+	CWatch& watch         = m_watches[target];
+	watch.m_lastActivity  = lastActivity;
+	watch.m_timeout       = timeout;
+
+	// start sweeping
+	if (m_timer == NULL) {
+		m_timer = m_events->newTimer(m_sweepRate, NULL);
+		m_events->adoptHandler(CEvent::kTimer, m_timer,
+							new TMethodEventJob<CLivenessMonitor>(this,
+								&CLivenessMonitor::handleSweep));
+		++m_numTimers;
+	}
+}
+
+void
+CLivenessMonitor::unwatch(void* target)
+{
+	m_watches.erase(target);
+	m_dead.erase(target);
+
+	// nothing to sweep
+	if (m_watches.empty()) {
+		stopSweeping();
+	}
+}
+
+void
+CLivenessMonitor::touch(double& lastActivity)
+{
+	lastActivity = ARCH->coarseTime();
+}
+
+UInt32
+CLivenessMonitor::getNumWatched() const
+{
+	return static_cast<UInt32>(m_watches.size());
+}
+
+UInt32
+CLivenessMonitor::getNumTimers() const
+{
+	return m_numTimers;
+}
+
+void
+CLivenessMonitor::handleSweep(const CEvent&, void*)
+{
+	// find silent connections and stop watching them
+	double now = ARCH->coarseTime();
+	bool queue = m_dead.empty();
+	for (CWatches::iterator index = m_watches.begin();
+							index != m_watches.end(); ) {
+		if (now - *index->second.m_lastActivity > index->second.m_timeout) {
+			LOG((CLOG_DEBUG1 "liveness timeout for %p", index->first));
+			m_dead.insert(index->first);
+			m_watches.erase(index++);
+		}
+		else {
+			++index;
+		}
+	}
+
+	// report them later, unless they're unwatched by then
+	if (queue && !m_dead.empty()) {
+		m_events->addEvent(CEvent(m_events->forCLivenessMonitor().dead(),
+							this));
+	}
+
+	if (m_watches.empty()) {
+		stopSweeping();
+	}
+}
+
+void
+CLivenessMonitor::handleDead(const CEvent&, void*)
+{
+	if (m_dead.empty()) {
+		return;
+	}
+
+	// report one target per event.  the handler may release the monitor
+	// so don't touch it after dispatching.
+	void* target = *m_dead.begin();
+	m_dead.erase(m_dead.begin());
+	if (!m_dead.empty()) {
+		m_events->addEvent(CEvent(m_events->forCLivenessMonitor().dead(),
+							this));
+	}
+	IEventQueue* events = m_events;
+	events->dispatchEvent(CEvent(events->forCLivenessMonitor().dead(), target));
+}
+
+void
+CLivenessMonitor::stopSweeping()
+{
+	if (m_timer != NULL) {
+		m_events->removeHandler(CEvent::kTimer, m_timer);
+		m_events->deleteTimer(m_timer);
+		m_timer = NULL;
+	}
+}
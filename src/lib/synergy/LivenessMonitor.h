@@ -0,0 +1,128 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+#include "common/stdset.h"
+
+class CEvent;
+class CEventQueueTimer;
+class IEventQueue;
+
+//! Peer liveness monitor
+/*!
+Detects peers that have gone silent.  Each watched connection keeps
+its own last activity timestamp, which it updates with touch() whenever
+it hears from its peer;  that's just a clock read so it's cheap enough
+to do for every batch of messages.  A single periodic timer sweeps all
+watched connections and sends a \c forCLivenessMonitor().dead() event
+to the target of each one that's been silent for longer than its
+timeout.  A target is only reported once;  watch it again to rearm.
+A target that's unwatched or watched again before its event is
+dispatched isn't reported, so a target's address may be reused once
+it's unwatched.
+
+Connections should share one monitor per event queue through
+acquire() and release().
+*/
+class CLivenessMonitor {
+public:
+	CLivenessMonitor(IEventQueue* events, double sweepRate);
+	~CLivenessMonitor();
+
+	//! @name manipulators
+	//@{
+
+	//! Get the shared monitor
+	/*!
+	Returns the monitor for \p events, creating it if necessary.  Each
+	call must be balanced by a call to release().
+	*/
+	static CLivenessMonitor*
+						acquire(IEventQueue* events);
+
+	//! Release the shared monitor
+	/*!
+	Releases a monitor returned by acquire(), destroying it when it's
+	no longer used.
+	*/
+	static void			release(CLivenessMonitor*);
+
+	//! Watch a connection
+	/*!
+	Starts watching \p target, which must stay silent for no longer
+	than \p timeout seconds.  \p lastActivity points to the connection's
+	timestamp, which must outlive the watch;  it's set to the current
+	time.  Watching a target again replaces its timeout.
+	*/
+	void				watch(void* target, double* lastActivity,
+							double timeout);
+
+	//! Stop watching a connection
+	void				unwatch(void* target);
+
+	//! Note activity
+	/*!
+	Sets \p lastActivity to the current time.
+	*/
+	static void			touch(double& lastActivity);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get number of watched connections
+	UInt32				getNumWatched() const;
+
+	//! Get number of sweep timers created
+	/*!
+	Returns the number of timers the monitor has created, for measuring
+	timer churn.
+	*/
+	UInt32				getNumTimers() const;
+
+	//@}
+
+private:
+	void				stopSweeping();
+	void				handleSweep(const CEvent&, void*);
+	void				handleDead(const CEvent&, void*);
+
+private:
+	class CWatch {
+	public:
+		const double*	m_lastActivity;
+		double			m_timeout;
+	};
+	typedef std::map<void*, CWatch> CWatches;
+	typedef std::set<void*> CTargets;
+	typedef std::map<IEventQueue*, CLivenessMonitor*> CMonitors;
+
+	IEventQueue*		m_events;
+	double				m_sweepRate;
+	CEventQueueTimer*	m_timer;
+	CWatches			m_watches;
+
+	// silent targets not yet reported
+	CTargets			m_dead;
+	UInt32				m_numTimers;
+	UInt32				m_refCount;
+
+	static CMonitors	s_monitors;
+};
@@ -0,0 +1,794 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/LoadGenerator.h"
+#include "client/Client.h"
+#include "synergy/Screen.h"
+#include "platform/VirtualScreen.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+#include "arch/Arch.h"
+#include "base/EventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#if SYSAPI_UNIX
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+// the script advances in ticks of this many milliseconds
+static const UInt32		s_tickTime = 10;
+
+// probe keys are characters from this range, which the protocol can
+// carry (key ids are 16 bits) and the server passes on untouched.  they
+// wrap around after a few minutes.
+static const KeyID		s_firstProbe = 0x4e00;
+static const KeyID		s_lastProbe  = 0x9fff;
+
+// the cursor steps down a line each tick and back up after this many,
+// so each height is played once every this many ticks
+static const SInt32		s_motionProbes = 400;
+
+// seconds to wait for a failed connection to be retried
+static const double		s_retryTime = 0.5;
+
+// seconds to wait after the script for the server to quit, and then
+// for it to exit
+static const double		s_quitTime = 15.0;
+static const double		s_exitTime = 5.0;
+
+// screen 0 is the server, the rest are clients
+static CString
+screenName(UInt32 index)
+{
+	if (index == 0) {
+		return "server";
+	}
+	return synergy::string::sprintf("load%d", index);
+}
+
+static double
+percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty()) {
+		return 0.0;
+	}
+	size_t i = static_cast<size_t>(p * sorted.size());
+	return sorted[std::min(i, sorted.size() - 1)];
+}
+
+// the times the cursor reached each height
+typedef std::vector<std::pair<double, SInt32> > CMotionList;
+
+// a client's cursor height is the server's plus an offset that depends
+// on where the cursor first left the server.  take the offset that most
+// often matches what a client saw to what was played just before, then
+// time each height from when it was played to when a client had it.
+static void
+matchMotion(const CMotionList& played, const CMotionList& seen,
+				std::vector<double>& latencies)
+{
+	std::map<SInt32, std::vector<double> > times;
+	for (CMotionList::const_iterator i = played.begin();
+							i != played.end(); ++i) {
+		times[i->second].push_back(i->first);
+	}
+
+	std::map<SInt32, UInt32> offsets;
+	SInt32 offset = 0;
+	UInt32 votes  = 0;
+	for (CMotionList::const_iterator i = seen.begin(); i != seen.end(); ++i) {
+		CMotionList::const_iterator j = std::upper_bound(played.begin(),
+							played.end(), std::make_pair(i->first, 0x7fffffff));
+		if (j != played.begin()) {
+			SInt32 d = i->second - (j - 1)->second;
+			if (++offsets[d] > votes) {
+				votes  = offsets[d];
+				offset = d;
+			}
+		}
+	}
+
+	for (CMotionList::const_iterator i = seen.begin(); i != seen.end(); ++i) {
+		std::map<SInt32, std::vector<double> >::const_iterator j =
+							times.find(i->second - offset);
+		if (j != times.end()) {
+			std::vector<double>::const_iterator k = std::upper_bound(
+							j->second.begin(), j->second.end(), i->first);
+			if (k != j->second.begin()) {
+				latencies.push_back(i->first - *(k - 1));
+			}
+		}
+	}
+}
+
+//
+// CLoadGenerator
+//
+
+CLoadGenerator::CLoadGenerator(const CString& toolPath) :
+	m_directory("."),
+	m_numClients(50),
+	m_warmup(3.0),
+	m_duration(10.0),
+	m_moveRate(500),
+	m_keyRate(50),
+	m_clipboardRate(1),
+	m_switchRate(10),
+	m_width(1920),
+	m_height(1080),
+	m_port(24850),
+	m_ioThreads(1),
+	m_udpMotion(false),
+	m_motionLoss(0.0),
+	m_logLevel("WARNING"),
+	m_serverPid(0),
+	m_serverTime(0.0),
+	m_serverCPU(0.0),
+	m_events(NULL),
+	m_numConnected(0),
+	m_numEverConnected(0),
+	m_retryTimer(NULL)
+{
+	// look for the server next to this program
+	size_t separator = toolPath.find_last_of('/');
+	if (separator == CString::npos) {
+		m_serverPath = "synergys";
+	}
+	else {
+		m_serverPath = toolPath.substr(0, separator + 1) + "synergys";
+	}
+}
+
+CLoadGenerator::~CLoadGenerator()
+{
+	stopServer();
+}
+
+bool
+CLoadGenerator::parseArgs(int argc, char** argv)
+{
+	for (int i = 0; i < argc; ++i) {
+		const char* arg   = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (value == NULL) {
+			std::cerr << "missing value for " << arg << std::endl;
+			usage();
+			return false;
+		}
+		++i;
+
+		if (strcmp(arg, "--clients") == 0) {
+			m_numClients = static_cast<UInt32>(atoi(value));
+		}
+		else if (strcmp(arg, "--duration") == 0) {
+			m_duration = atof(value);
+		}
+		else if (strcmp(arg, "--warmup") == 0) {
+			m_warmup = atof(value);
+		}
+		else if (strcmp(arg, "--move-rate") == 0) {
+			m_moveRate = static_cast<UInt32>(atoi(value));
+		}
+		else if (strcmp(arg, "--key-rate") == 0) {
+			m_keyRate = static_cast<UInt32>(atoi(value));
+		}
+		else if (strcmp(arg, "--clipboard-rate") == 0) {
+			m_clipboardRate = static_cast<UInt32>(atoi(value));
+		}
+		else if (strcmp(arg, "--switch-rate") == 0) {
+			m_switchRate = static_cast<UInt32>(atoi(value));
+		}
+		else if (strcmp(arg, "--port") == 0) {
+			m_port = atoi(value);
+		}
+		else if (strcmp(arg, "--io-threads") == 0) {
+			m_ioThreads = static_cast<UInt32>(atoi(value));
+		}
+		else if (strcmp(arg, "--udp-motion") == 0) {
+			m_udpMotion  = true;
+			m_motionLoss = atof(value);
+		}
+		else if (strcmp(arg, "--batch-delay") == 0) {
+			m_batchDelay = value;
+		}
+		else if (strcmp(arg, "--crypto-pass") == 0) {
+			m_crypto = CCryptoOptions("cfb", value);
+		}
+		else if (strcmp(arg, "--server") == 0) {
+			m_serverPath = value;
+		}
+		else if (strcmp(arg, "--dir") == 0) {
+			m_directory = value;
+		}
+		else if (strcmp(arg, "-d") == 0 || strcmp(arg, "--debug") == 0) {
+			m_logLevel = value;
+		}
+		else {
+			std::cerr << "unknown load test arg: " << arg << std::endl;
+			usage();
+			return false;
+		}
+	}
+
+	if (m_numClients == 0 || m_duration <= 0.0 || m_warmup < 0.0 ||
+		m_port <= 0 || m_port > 65535 || m_ioThreads == 0 ||
+		m_motionLoss < 0.0 || m_motionLoss > 100.0) {
+		std::cerr << "invalid load test args" << std::endl;
+		usage();
+		return false;
+	}
+	return true;
+}
+
+bool
+CLoadGenerator::run()
+{
+#if SYSAPI_UNIX
+	if (!CLOG->setFilter(m_logLevel.c_str())) {
+		std::cerr << "invalid log level: " << m_logLevel << std::endl;
+		return false;
+	}
+
+	m_configPath       = m_directory + "/synergy-load.conf";
+	m_scriptPath       = m_directory + "/synergy-load.txt";
+	m_serverRecordPath = m_directory + "/synergy-load.rec";
+	m_clientRecordPath = m_directory + "/synergy-load-clients.rec";
+	m_record.open(m_clientRecordPath.c_str());
+	if (!m_record.is_open() ||
+		!writeConfig(m_configPath) || !writeScript(m_scriptPath)) {
+		std::cerr << "cannot write load test files in "
+			<< m_directory << std::endl;
+		return false;
+	}
+
+	if (!startServer()) {
+		return false;
+	}
+	runClients();
+	stopServer();
+	m_record.close();
+	report();
+	return true;
+#else
+	std::cerr << "the load test needs a unix system" << std::endl;
+	return false;
+#endif
+}
+
+bool
+CLoadGenerator::writeConfig(const CString& path) const
+{
+	std::ofstream file(path.c_str());
+	if (!file.is_open()) {
+		return false;
+	}
+
+	// the server leads into a ring of the clients, so the cursor keeps
+	// moving right through them and never comes back to the server
+	file << "section: screens\n";
+	for (UInt32 i = 0; i <= m_numClients; ++i) {
+		file << "\t" << screenName(i) << ":\n";
+	}
+	file << "end\n\nsection: links\n";
+	for (UInt32 i = 0; i <= m_numClients; ++i) {
+		UInt32 right = (i == m_numClients) ? 1 : i + 1;
+		file << "\t" << screenName(i) << ":\n";
+		if (right != i) {
+			file << "\t\tright = " << screenName(right) << "\n";
+		}
+	}
+	file << "end\n";
+	return file.good();
+}
+
+bool
+CLoadGenerator::writeScript(const CString& path) const
+{
+	std::ofstream file(path.c_str());
+	if (!file.is_open()) {
+		return false;
+	}
+
+	// give the clients time to connect
+	file << "# generated by syntool --load-test\n";
+	file << "wait " << static_cast<UInt32>(1000.0 * m_warmup) << "\n";
+
+	// each tick hops to the next screen now and then, then jiggles the
+	// mouse, presses probe keys and takes the clipboard for the tick's
+	// share of the rates
+	const UInt32 numTicks  = static_cast<UInt32>(1000.0 * m_duration) / s_tickTime;
+	const UInt32 hopTicks  = (m_switchRate == 0) ? 0 :
+							std::max(1000 / s_tickTime / m_switchRate, 1u);
+	double moves = 0.0, keys = 0.0, clipboards = 0.0;
+	SInt32 drift = 0;
+	KeyID probe  = s_firstProbe;
+	for (UInt32 tick = 0; tick < numTicks; ++tick) {
+		if (tick == 0 || (hopTicks != 0 && tick % hopTicks == 0)) {
+			file << "rmove " << m_width << " 0\n";
+		}
+
+		// motion probe
+		if (tick % s_motionProbes == s_motionProbes - 1) {
+			file << "rmove 0 " << 1 - s_motionProbes << "\n";
+		}
+		else {
+			file << "rmove 0 1\n";
+		}
+
+		moves += 1.0e-3 * s_tickTime * m_moveRate;
+		UInt32 n = static_cast<UInt32>(moves);
+		moves   -= n;
+		if (n >= 2) {
+			file << "repeat " << n / 2 << "\nrmove 1 0\nrmove -1 0\nend\n";
+		}
+		if (n % 2 != 0) {
+			// step back towards where we started
+			SInt32 dx = (drift > 0) ? -1 : 1;
+			drift    += dx;
+			file << "rmove " << dx << " 0\n";
+		}
+
+		keys += 1.0e-3 * s_tickTime * m_keyRate;
+		for (n = static_cast<UInt32>(keys); n > 0; --n) {
+			file << synergy::string::sprintf("key 0x%x\n", probe);
+			probe = (probe == s_lastProbe) ? s_firstProbe : probe + 1;
+		}
+		keys -= static_cast<UInt32>(keys);
+
+		clipboards += 1.0e-3 * s_tickTime * m_clipboardRate;
+		for (n = static_cast<UInt32>(clipboards); n > 0; --n) {
+			file << "clipboard load test " << tick << "\n";
+		}
+		clipboards -= static_cast<UInt32>(clipboards);
+
+		file << "wait " << s_tickTime << "\n";
+	}
+
+	// let the last input arrive
+	file << "wait 1000\nquit\n";
+	return file.good();
+}
+
+bool
+CLoadGenerator::startServer()
+{
+#if SYSAPI_UNIX
+	CString screen  = synergy::string::sprintf("%dx%d", m_width, m_height);
+	CString address = synergy::string::sprintf("127.0.0.1:%d", m_port);
+	CString burst   = synergy::string::sprintf("%d", m_numClients);
+	CString threads = synergy::string::sprintf("%d", m_ioThreads);
+	CString loss    = synergy::string::sprintf("%g", m_motionLoss);
+
+	std::vector<const char*> argv;
+	argv.push_back(m_serverPath.c_str());
+	argv.push_back("-f");
+	argv.push_back("--no-tray");
+	argv.push_back("-d");
+	argv.push_back(m_logLevel.c_str());
+	argv.push_back("--name");
+	argv.push_back("server");
+	argv.push_back("-c");
+	argv.push_back(m_configPath.c_str());
+	argv.push_back("--connect-burst");
+	argv.push_back(burst.c_str());
+	argv.push_back("--io-threads");
+	argv.push_back(threads.c_str());
+	argv.push_back("--address");
+	argv.push_back(address.c_str());
+	argv.push_back("--virtual-screen");
+	argv.push_back(screen.c_str());
+	argv.push_back("--virtual-input");
+	argv.push_back(m_scriptPath.c_str());
+	argv.push_back("--virtual-record");
+	argv.push_back(m_serverRecordPath.c_str());
+	if (m_crypto.m_mode != kDisabled) {
+		argv.push_back("--crypto-pass");
+		argv.push_back(m_crypto.m_pass.c_str());
+	}
+	if (m_udpMotion) {
+		argv.push_back("--udp-motion");
+		argv.push_back("--udp-motion-loss");
+		argv.push_back(loss.c_str());
+	}
+	if (!m_batchDelay.empty()) {
+		argv.push_back("--batch-delay");
+		argv.push_back(m_batchDelay.c_str());
+	}
+	argv.push_back(NULL);
+
+	// the child may only make async-signal-safe calls, so the error
+	// message is made before forking
+	CString execError = CString("cannot run ") + argv[0] + "\n";
+
+	m_serverTime = ARCH->time();
+	m_serverPid  = fork();
+	if (m_serverPid == 0) {
+		execvp(argv[0], const_cast<char* const*>(&argv[0]));
+		ssize_t ignored = write(2, execError.data(), execError.size());
+		(void)ignored;
+		_exit(1);
+	}
+	if (m_serverPid < 0) {
+		std::cerr << "cannot start server: " << strerror(errno) << std::endl;
+		m_serverPid = 0;
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void
+CLoadGenerator::stopServer()
+{
+#if SYSAPI_UNIX
+	// the server quits at the end of the script.  if it hasn't, the
+	// test was cut short.
+	double start = ARCH->time();
+	while (isServerRunning() && ARCH->time() - start < s_exitTime) {
+		ARCH->sleep(0.05);
+	}
+	if (isServerRunning()) {
+		LOG((CLOG_WARN "stopping server before the end of the test"));
+		kill(m_serverPid, SIGTERM);
+		waitpid(m_serverPid, NULL, 0);
+		onServerExited();
+	}
+#endif
+}
+
+bool
+CLoadGenerator::isServerRunning()
+{
+#if SYSAPI_UNIX
+	if (m_serverPid == 0) {
+		return false;
+	}
+	if (waitpid(m_serverPid, NULL, WNOHANG) == 0) {
+		return true;
+	}
+	onServerExited();
+#endif
+	return false;
+}
+
+void
+CLoadGenerator::onServerExited()
+{
+#if SYSAPI_UNIX
+	m_serverPid  = 0;
+	m_serverTime = ARCH->time() - m_serverTime;
+
+	// the server is our only child
+	struct rusage usage;
+	getrusage(RUSAGE_CHILDREN, &usage);
+	m_serverCPU = usage.ru_utime.tv_sec + 1.0e-6 * usage.ru_utime.tv_usec +
+				  usage.ru_stime.tv_sec + 1.0e-6 * usage.ru_stime.tv_usec;
+#endif
+}
+
+void
+CLoadGenerator::runClients()
+{
+	CEventQueue events;
+	CSocketMultiplexer multiplexer;
+	m_events = &events;
+
+	// all the clients record to one file.  we only need to know what
+	// they got and when, not which of them got it.
+	CNetworkAddress address("127.0.0.1", m_port);
+	m_clients.resize(m_numClients);
+	for (UInt32 i = 0; i < m_numClients; ++i) {
+		CLoadClient& client = m_clients[i];
+		CVirtualScreen* screen = new CVirtualScreen(m_events, false,
+							m_width, m_height, "", "");
+		screen->setRecord(&m_record);
+		client.m_name   = screenName(i + 1);
+		client.m_screen = new CScreen(screen, m_events);
+		client.m_client = new CClient(m_events, client.m_name, address,
+							new CTCPSocketFactory(m_events, &multiplexer),
+							NULL, client.m_screen, m_crypto, false);
+		client.m_client->setMotionChannel(m_udpMotion);
+
+		void* target = client.m_client->getEventTarget();
+		m_events->adoptHandler(m_events->forCClient().connected(), target,
+							new TMethodEventJob<CLoadGenerator>(this,
+								&CLoadGenerator::handleConnected, &client));
+		m_events->adoptHandler(m_events->forCClient().connectionFailed(),
+							target,
+							new TMethodEventJob<CLoadGenerator>(this,
+								&CLoadGenerator::handleConnectionFailed));
+		m_events->adoptHandler(m_events->forCClient().disconnected(), target,
+							new TMethodEventJob<CLoadGenerator>(this,
+								&CLoadGenerator::handleDisconnected, &client));
+		client.m_client->connect();
+	}
+
+	// give up if the server doesn't quit when it should
+	CEventQueueTimer* timer = m_events->newOneShotTimer(
+							m_warmup + m_duration + s_quitTime, NULL);
+	m_events->adoptHandler(CEvent::kTimer, timer,
+							new TMethodEventJob<CLoadGenerator>(this,
+								&CLoadGenerator::handleTimeout));
+
+	m_events->loop();
+
+	m_events->removeHandler(CEvent::kTimer, timer);
+	m_events->deleteTimer(timer);
+	if (m_retryTimer != NULL) {
+		m_events->removeHandler(CEvent::kTimer, m_retryTimer);
+		m_events->deleteTimer(m_retryTimer);
+		m_retryTimer = NULL;
+	}
+	for (CLoadClientList::iterator i = m_clients.begin();
+							i != m_clients.end(); ++i) {
+		void* target = i->m_client->getEventTarget();
+		m_events->removeHandler(m_events->forCClient().connected(), target);
+		m_events->removeHandler(m_events->forCClient().connectionFailed(),
+							target);
+		m_events->removeHandler(m_events->forCClient().disconnected(), target);
+		delete i->m_client;
+		delete i->m_screen;
+	}
+	m_clients.clear();
+	m_events = NULL;
+}
+
+void
+CLoadGenerator::scheduleRetry()
+{
+	if (m_retryTimer == NULL) {
+		m_retryTimer = m_events->newOneShotTimer(s_retryTime, NULL);
+		m_events->adoptHandler(CEvent::kTimer, m_retryTimer,
+							new TMethodEventJob<CLoadGenerator>(this,
+								&CLoadGenerator::handleRetry));
+	}
+}
+
+void
+CLoadGenerator::handleConnected(const CEvent&, void* vclient)
+{
+	CLoadClient* client = reinterpret_cast<CLoadClient*>(vclient);
+	client->m_connected = true;
+	++m_numConnected;
+	if (++m_numEverConnected == m_numClients) {
+		LOG((CLOG_NOTE "all %d clients connected", m_numClients));
+	}
+}
+
+void
+CLoadGenerator::handleConnectionFailed(const CEvent& event, void*)
+{
+	CClient::CFailInfo* info =
+		reinterpret_cast<CClient::CFailInfo*>(event.getData());
+	LOG((CLOG_DEBUG "failed to connect to server: %s", info->m_what.c_str()));
+	delete info;
+
+	// the server may not be listening yet
+	if (isServerRunning()) {
+		scheduleRetry();
+	}
+	else {
+		LOG((CLOG_ERR "server isn't running"));
+		m_events->addEvent(CEvent(CEvent::kQuit));
+	}
+}
+
+void
+CLoadGenerator::handleDisconnected(const CEvent&, void* vclient)
+{
+	CLoadClient* client = reinterpret_cast<CLoadClient*>(vclient);
+	LOG((CLOG_DEBUG "\"%s\" disconnected", client->m_name.c_str()));
+	if (!client->m_connected) {
+		// dropped before the handshake
+		scheduleRetry();
+		return;
+	}
+	client->m_connected = false;
+
+	// the server quits at the end of the test
+	if (--m_numConnected == 0) {
+		m_events->addEvent(CEvent(CEvent::kQuit));
+	}
+}
+
+void
+CLoadGenerator::handleRetry(const CEvent&, void*)
+{
+	m_events->removeHandler(CEvent::kTimer, m_retryTimer);
+	m_events->deleteTimer(m_retryTimer);
+	m_retryTimer = NULL;
+
+	for (CLoadClientList::iterator i = m_clients.begin();
+							i != m_clients.end(); ++i) {
+		if (!i->m_connected) {
+			i->m_client->connect();
+		}
+	}
+}
+
+void
+CLoadGenerator::handleTimeout(const CEvent&, void*)
+{
+	LOG((CLOG_WARN "load test timed out"));
+	m_events->addEvent(CEvent(CEvent::kQuit));
+}
+
+void
+CLoadGenerator::report() const
+{
+	// when the server played each probe.  probes wrap around so each
+	// may have been played more than once.
+	typedef std::map<KeyID, std::vector<double> > CProbeTimes;
+	CProbeTimes played;
+	UInt32 numPlayed = 0;
+
+	// when the cursor reached each height
+	CMotionList moved;
+	SInt32 lastY = -1;
+
+	double first = 0.0;
+	std::ifstream serverRecord(m_serverRecordPath.c_str());
+	CString line;
+	while (std::getline(serverRecord, line)) {
+		double time;
+		if (sscanf(line.c_str(), "%lf", &time) != 1 ||
+			line.find(" play ") == CString::npos) {
+			continue;
+		}
+		if (first == 0.0) {
+			first = time;
+		}
+		unsigned int id;
+		SInt32 x, y;
+		if (sscanf(line.c_str(), "%*f play keydown %x", &id) == 1 &&
+			id >= s_firstProbe && id <= s_lastProbe) {
+			played[id].push_back(time);
+			++numPlayed;
+		}
+		else if (sscanf(line.c_str(), "%*f play move %d %d", &x, &y) == 2 &&
+			y != lastY) {
+			moved.push_back(std::make_pair(time, y));
+			lastY = y;
+		}
+	}
+
+	// when the clients got each probe, and how much they got once the
+	// input started.  a probe is matched to the last time it was played
+	// before it arrived.
+	std::vector<double> latencies;
+	CMotionList seen;
+	UInt32 numChanges = 0;
+	double last = first;
+	lastY = -1;
+	std::ifstream clientRecord(m_clientRecordPath.c_str());
+	while (std::getline(clientRecord, line)) {
+		double time;
+		unsigned int id;
+		if (sscanf(line.c_str(), "%lf", &time) != 1 || time < first) {
+			continue;
+		}
+		++numChanges;
+		last = time;
+		SInt32 x, y;
+		if (sscanf(line.c_str(), "%*f move %d %d", &x, &y) == 2) {
+			if (y != lastY) {
+				seen.push_back(std::make_pair(time, y));
+				lastY = y;
+			}
+			continue;
+		}
+		if (sscanf(line.c_str(), "%*f keydown %x", &id) != 1) {
+			continue;
+		}
+		CProbeTimes::const_iterator i = played.find(id);
+		if (i != played.end()) {
+			const std::vector<double>& times = i->second;
+			std::vector<double>::const_iterator j =
+				std::upper_bound(times.begin(), times.end(), time);
+			if (j != times.begin()) {
+				latencies.push_back(time - *(j - 1));
+			}
+		}
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	std::vector<double> motionLatencies;
+	matchMotion(moved, seen, motionLatencies);
+	std::sort(motionLatencies.begin(), motionLatencies.end());
+
+	double selfCPU = 0.0;
+#if SYSAPI_UNIX
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	selfCPU = usage.ru_utime.tv_sec + 1.0e-6 * usage.ru_utime.tv_usec +
+			  usage.ru_stime.tv_sec + 1.0e-6 * usage.ru_stime.tv_usec;
+#endif
+
+	double span = (last > first) ? last - first : 1.0;
+	printf("clients:    %d of %d connected\n",
+		m_numEverConnected, m_numClients);
+	printf("throughput: %d changes in %.1fs, %.0f/s\n",
+		numChanges, last - first, numChanges / span);
+	printf("probes:     %d of %d received\n",
+		(int)latencies.size(), numPlayed);
+	printf("latency:    p50 %.2fms, p99 %.2fms, max %.2fms\n",
+		1000.0 * percentile(latencies, 0.50),
+		1000.0 * percentile(latencies, 0.99),
+		1000.0 * percentile(latencies, 1.0));
+	printf("motion:     %d of %d received\n",
+		(int)motionLatencies.size(), (int)moved.size());
+	printf("latency:    p50 %.2fms, p99 %.2fms, max %.2fms\n",
+		1000.0 * percentile(motionLatencies, 0.50),
+		1000.0 * percentile(motionLatencies, 0.99),
+		1000.0 * percentile(motionLatencies, 1.0));
+	printf("server cpu: %.2fs in %.1fs, %.0f%%\n",
+		m_serverCPU, m_serverTime,
+		(m_serverTime > 0.0) ? 100.0 * m_serverCPU / m_serverTime : 0.0);
+	printf("load cpu:   %.2fs\n", selfCPU);
+}
+
+void
+CLoadGenerator::usage()
+{
+	std::cerr <<
+		"usage: syntool --load-test [options]\n"
+		"  --clients <n>         clients to connect (50)\n"
+		"  --duration <s>        seconds of input (10)\n"
+		"  --warmup <s>          seconds for the clients to connect (3)\n"
+		"  --move-rate <n>       mouse moves per second (500)\n"
+		"  --key-rate <n>        probe key presses per second (50)\n"
+		"  --clipboard-rate <n>  clipboard changes per second (1)\n"
+		"  --switch-rate <n>     switches to the next client per second (10)\n"
+		"  --crypto-pass <pass>  encrypt with this password\n"
+		"  --port <port>         server port (24850)\n"
+		"  --io-threads <n>      server socket threads (1)\n"
+		"  --udp-motion <loss>   send motion over UDP, dropping <loss>%\n"
+		"  --batch-delay <ms>    server batch delay, or off (0)\n"
+		"  --server <path>       server program (synergys next to syntool)\n"
+		"  --dir <path>          where to write the test's files (.)\n"
+		"  -d, --debug <level>   log level (WARNING)\n";
+}
+
+
+//
+// CLoadGenerator::CLoadClient
+//
+
+CLoadGenerator::CLoadClient::CLoadClient() :
+	m_screen(NULL),
+	m_client(NULL),
+	m_connected(false)
+{
+	// do nothing
+}
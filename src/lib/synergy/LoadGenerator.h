@@ -0,0 +1,148 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "io/CryptoOptions.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+#include <fstream>
+
+class CClient;
+class CEvent;
+class CEventQueueTimer;
+class CScreen;
+class IEventQueue;
+
+//! Multi-client load generator
+/*!
+Measures how one server copes with many clients.  Starts a server on a
+virtual primary screen and connects many clients to it from this
+process, each a full CClient with a virtual secondary screen.  The server
+plays back a generated script that moves the mouse, presses keys and
+takes the clipboard at fixed rates while hopping the cursor from client
+to client.
+
+Every key press is a probe:  the server records when it played it and
+the client when it received it, which gives the latency of the input
+path.  The cursor also steps down a line each tick, so the height at
+which a client first sees it tells when the server played that motion.
+Prints the changes the clients received per second, key and motion
+latency percentiles and the CPU time the server used.
+*/
+class CLoadGenerator {
+public:
+	/*!
+	\p toolPath is the path of this program, used to find the server
+	next to it.
+	*/
+	CLoadGenerator(const CString& toolPath);
+	~CLoadGenerator();
+
+	//! @name manipulators
+	//@{
+
+	//! Parse arguments
+	/*!
+	Parses the load test options.  Returns false and prints the usage if
+	they're invalid.
+	*/
+	bool				parseArgs(int argc, char** argv);
+
+	//! Run the load test
+	/*!
+	Runs the server and clients to the end of the test and prints the
+	results.  Returns false if the test couldn't be run.
+	*/
+	bool				run();
+
+	//@}
+
+private:
+	class CLoadClient {
+	public:
+		CLoadClient();
+
+	public:
+		CString			m_name;
+		CScreen*		m_screen;
+		CClient*		m_client;
+		bool			m_connected;
+	};
+	typedef std::vector<CLoadClient> CLoadClientList;
+
+	bool				writeConfig(const CString& path) const;
+	bool				writeScript(const CString& path) const;
+	bool				startServer();
+	void				stopServer();
+	bool				isServerRunning();
+	void				onServerExited();
+	void				runClients();
+	void				report() const;
+
+	void				scheduleRetry();
+	void				handleConnected(const CEvent&, void*);
+	void				handleConnectionFailed(const CEvent&, void*);
+	void				handleDisconnected(const CEvent&, void*);
+	void				handleRetry(const CEvent&, void*);
+	void				handleTimeout(const CEvent&, void*);
+
+	static void			usage();
+
+private:
+	// options
+	CString				m_serverPath;
+	CString				m_directory;
+	UInt32				m_numClients;
+	double				m_warmup;
+	double				m_duration;
+	UInt32				m_moveRate;
+	UInt32				m_keyRate;
+	UInt32				m_clipboardRate;
+	UInt32				m_switchRate;
+	SInt32				m_width;
+	SInt32				m_height;
+	int					m_port;
+	UInt32				m_ioThreads;
+	bool				m_udpMotion;
+	double				m_motionLoss;
+	CString				m_batchDelay;
+	CString				m_logLevel;
+	CCryptoOptions		m_crypto;
+
+	// files shared with the server
+	CString				m_configPath;
+	CString				m_scriptPath;
+	CString				m_serverRecordPath;
+	CString				m_clientRecordPath;
+
+	// server process
+	int					m_serverPid;
+	double				m_serverTime;
+	double				m_serverCPU;
+
+	// clients
+	IEventQueue*		m_events;
+	CLoadClientList		m_clients;
+	UInt32				m_numConnected;
+	UInt32				m_numEverConnected;
+	CEventQueueTimer*	m_retryTimer;
+	std::ofstream		m_record;
+};
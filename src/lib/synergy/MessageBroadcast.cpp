@@ -0,0 +1,56 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/MessageBroadcast.h"
+
+//
+// CMessageBroadcast
+//
+
+CMessageBroadcast::CMessageBroadcast()
+{
+	// do nothing
+}
+
+CMessageBroadcast::~CMessageBroadcast()
+{
+	// do nothing
+}
+
+const CSharedBuffer&
+CMessageBroadcast::add(const char* fmt, const CSharedBuffer& message)
+{
+	CSharedBuffer& entry = m_messages[fmt];
+	entry = message;
+	return entry;
+}
+
+const CSharedBuffer*
+CMessageBroadcast::find(const char* fmt) const
+{
+	CMessageMap::const_iterator index = m_messages.find(fmt);
+	if (index == m_messages.end()) {
+		return NULL;
+	}
+	return &index->second;
+}
+
+UInt32
+CMessageBroadcast::getSize() const
+{
+	return (UInt32)m_messages.size();
+}
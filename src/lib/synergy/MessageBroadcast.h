@@ -0,0 +1,70 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "io/SharedBuffer.h"
+#include "base/String.h"
+#include "common/stdmap.h"
+
+//! Messages formatted once for many streams
+/*!
+Holds the messages written by CProtocolUtil::writefBroadcast(), one per
+format string, so a message sent to many clients is formatted once and
+every stream queues the same bytes.  Only share a broadcast between
+writes whose arguments are the same for every stream;  writes with
+different formats (e.g. for different protocol versions) get their own
+message.
+*/
+class CMessageBroadcast {
+public:
+	CMessageBroadcast();
+	~CMessageBroadcast();
+
+	//! @name manipulators
+	//@{
+
+	//! Add message
+	/*!
+	Saves \c message as the bytes formatted for \c fmt and returns it.
+	*/
+	const CSharedBuffer&	add(const char* fmt, const CSharedBuffer& message);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Find message
+	/*!
+	Returns the message formatted for \c fmt, or NULL if there isn't one
+	yet.
+	*/
+	const CSharedBuffer*	find(const char* fmt) const;
+
+	//! Get number of messages
+	/*!
+	Returns the number of messages formatted so far.
+	*/
+	UInt32				getSize() const;
+
+	//@}
+
+private:
+	typedef std::map<CString, CSharedBuffer> CMessageMap;
+
+	CMessageMap			m_messages;
+};
@@ -0,0 +1,174 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/MetricsMonitor.h"
+#include "ipc/IpcClient.h"
+#include "ipc/IpcMessage.h"
+#include "ipc/Ipc.h"
+#include "net/SocketMultiplexer.h"
+#include "net/LocalSocketFactory.h"
+#include "net/NetworkAddress.h"
+#include "base/EventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+//
+// CMetricsMonitor
+//
+
+CMetricsMonitor::CMetricsMonitor() :
+	m_count(1),
+	m_timeout(30.0),
+	m_port(0),
+	m_events(NULL),
+	m_received(0)
+{
+	// do nothing
+}
+
+CMetricsMonitor::~CMetricsMonitor()
+{
+	// do nothing
+}
+
+bool
+CMetricsMonitor::parseArgs(int argc, char** argv)
+{
+	for (int i = 0; i < argc; ++i) {
+		const char* arg   = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (value == NULL) {
+			std::cerr << "missing value for " << arg << std::endl;
+			usage();
+			return false;
+		}
+		++i;
+
+		if (strcmp(arg, "--count") == 0) {
+			m_count = static_cast<UInt32>(atoi(value));
+		}
+		else if (strcmp(arg, "--timeout") == 0) {
+			m_timeout = atof(value);
+		}
+		else if (strcmp(arg, "--port") == 0) {
+			m_port = atoi(value);
+		}
+		else {
+			std::cerr << "unknown metrics arg: " << arg << std::endl;
+			usage();
+			return false;
+		}
+	}
+
+	if (m_count == 0 || m_timeout <= 0.0 || m_port < 0) {
+		std::cerr << "invalid metrics args" << std::endl;
+		usage();
+		return false;
+	}
+	return true;
+}
+
+bool
+CMetricsMonitor::run()
+{
+	CLOG->setFilter(kWARNING);
+
+	CEventQueue events;
+	CSocketMultiplexer multiplexer;
+	m_events = &events;
+
+	// the daemon also listens locally where it can, as the core uses
+	// that in preference to tcp
+	CIpcClient* client;
+#if SYSAPI_UNIX
+	CString localPath = getIpcLocalPath();
+	if (m_port == 0 && !localPath.empty()) {
+		client = new CIpcClient(m_events,
+							new CLocalSocketFactory(m_events, &multiplexer),
+							CNetworkAddress::local(localPath));
+	}
+	else
+#endif
+	{
+		client = new CIpcClient(m_events, &multiplexer,
+							m_port == 0 ? IPC_PORT : m_port);
+	}
+	client->setClientType(kIpcClientMonitor);
+	m_events->adoptHandler(m_events->forCIpcClient().messageReceived(),
+							client,
+							new TMethodEventJob<CMetricsMonitor>(this,
+								&CMetricsMonitor::handleMessage));
+	client->connect();
+
+	CEventQueueTimer* timer = m_events->newOneShotTimer(m_timeout, NULL);
+	m_events->adoptHandler(CEvent::kTimer, timer,
+							new TMethodEventJob<CMetricsMonitor>(this,
+								&CMetricsMonitor::handleTimeout));
+
+	m_events->loop();
+
+	m_events->removeHandler(CEvent::kTimer, timer);
+	m_events->deleteTimer(timer);
+	m_events->removeHandler(m_events->forCIpcClient().messageReceived(),
+							client);
+	client->disconnect();
+	delete client;
+	m_events = NULL;
+
+	return m_received != 0;
+}
+
+void
+CMetricsMonitor::handleMessage(const CEvent& event, void*)
+{
+	CIpcMessage* message = static_cast<CIpcMessage*>(event.getDataObject());
+	if (message->type() != kIpcMetrics) {
+		return;
+	}
+
+	CIpcMetricsMessage* metrics = static_cast<CIpcMetricsMessage*>(message);
+	std::cout << metrics->snapshot() << std::endl;
+	if (++m_received == m_count) {
+		m_events->addEvent(CEvent(CEvent::kQuit));
+	}
+}
+
+void
+CMetricsMonitor::handleTimeout(const CEvent&, void*)
+{
+	if (m_received == 0) {
+		std::cerr << "no metrics in " << m_timeout << "s;  is synergys or "
+			"synergyc running from the daemon?" << std::endl;
+	}
+	m_events->addEvent(CEvent(CEvent::kQuit));
+}
+
+void
+CMetricsMonitor::usage()
+{
+	std::cerr <<
+		"usage: syntool --metrics [options]\n"
+		"  --count <n>           snapshots to print (1)\n"
+		"  --timeout <seconds>   give up waiting after (30)\n"
+		"  --port <port>         connect to the daemon over tcp on this port\n"
+		"                        (the local socket, or 24801 on windows)\n";
+}
@@ -0,0 +1,73 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "common/basic_types.h"
+
+class CEvent;
+class CIpcClient;
+class IEventQueue;
+
+//! Metrics dump
+/*!
+Connects to the daemon as an IPC monitor and prints the metrics
+snapshots the running synergys or synergyc sends it (see CMetric),
+one line per value followed by a blank line, until it has printed the
+number asked for.  The core sends a snapshot every few seconds when
+it's started by the daemon.
+*/
+class CMetricsMonitor {
+public:
+	CMetricsMonitor();
+	~CMetricsMonitor();
+
+	//! @name manipulators
+	//@{
+
+	//! Parse arguments
+	/*!
+	Parses the monitor options.  Returns false and prints the usage if
+	they're invalid.
+	*/
+	bool				parseArgs(int argc, char** argv);
+
+	//! Print snapshots
+	/*!
+	Prints snapshots as they arrive.  Returns false if none arrived
+	before the timeout.
+	*/
+	bool				run();
+
+	//@}
+
+private:
+	void				handleMessage(const CEvent&, void*);
+	void				handleTimeout(const CEvent&, void*);
+
+	static void			usage();
+
+private:
+	// options
+	UInt32				m_count;
+	double				m_timeout;
+	int					m_port;
+
+	IEventQueue*		m_events;
+	UInt32				m_received;
+};
@@ -0,0 +1,221 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/MotionChannel.h"
+
+#include <cryptopp562/hmac.h>
+#include <cryptopp562/sha.h>
+#include <cstring>
+
+static const char		s_magic[] = "SYNM";
+
+static void
+putInt(UInt8* out, UInt32 v)
+{
+	out[0] = static_cast<UInt8>(v >> 24);
+	out[1] = static_cast<UInt8>(v >> 16);
+	out[2] = static_cast<UInt8>(v >> 8);
+	out[3] = static_cast<UInt8>(v);
+}
+
+static UInt32
+getInt(const UInt8* in)
+{
+	return (static_cast<UInt32>(in[0]) << 24) |
+			(static_cast<UInt32>(in[1]) << 16) |
+			(static_cast<UInt32>(in[2]) << 8) |
+			static_cast<UInt32>(in[3]);
+}
+
+//
+// CMotionChannel
+//
+
+const UInt32			CMotionChannel::kSize;
+const UInt32			CMotionChannel::kMacSize;
+
+CMotionChannel::CMotionChannel(UInt32 token, const UInt8* key) :
+	m_token(token),
+	m_encrypted(key != NULL),
+	m_encryption(kCfb, true),
+	m_decryption(kCfb, false),
+	m_loss(0),
+	m_random(token | 1)
+{
+	if (m_encrypted) {
+		// use a different key for the mac than for encryption
+		memcpy(m_key, key, sizeof(m_key));
+		CryptoPP::SHA256 hash;
+		hash.Update(reinterpret_cast<const byte*>(s_magic), 4);
+		hash.Update(m_key, sizeof(m_key));
+		hash.Final(m_macKey);
+	}
+	else {
+		memset(m_key, 0, sizeof(m_key));
+		memset(m_macKey, 0, sizeof(m_macKey));
+	}
+}
+
+CMotionChannel::~CMotionChannel()
+{
+	// do nothing
+}
+
+CString
+CMotionChannel::encode(EDirection dir, const CPacket& packet)
+{
+	UInt8 data[kSize + kMacSize];
+	memcpy(data, s_magic, 4);
+	putInt(data + 4, m_token);
+	putInt(data + 8, packet.m_seq);
+	data[12] = static_cast<UInt8>(packet.m_type);
+	putInt(data + 13, static_cast<UInt32>(packet.m_a));
+	putInt(data + 17, static_cast<UInt32>(packet.m_b));
+	data[21] = static_cast<UInt8>(m_token >> 8);
+	data[22] = static_cast<UInt8>(m_token);
+	crypt(dir, packet.m_seq, data + 12, kSize - 12, true);
+	if (!m_encrypted) {
+		return CString(reinterpret_cast<const char*>(data), kSize);
+	}
+	mac(dir, data + kSize, data, kSize);
+	return CString(reinterpret_cast<const char*>(data), kSize + kMacSize);
+}
+
+bool
+CMotionChannel::decode(EDirection dir, const CString& datagram, CPacket& packet)
+{
+	UInt32 token;
+	UInt32 size = m_encrypted ? kSize + kMacSize : kSize;
+	if (datagram.size() != size ||
+		!getToken(datagram, token) || token != m_token) {
+		return false;
+	}
+
+	UInt8 data[kSize + kMacSize];
+	memcpy(data, datagram.data(), size);
+	if (m_encrypted) {
+		UInt8 expected[kMacSize];
+		mac(dir, expected, data, kSize);
+		if (memcmp(expected, data + kSize, kMacSize) != 0) {
+			return false;
+		}
+	}
+
+	UInt32 seq = getInt(data + 8);
+	crypt(dir, seq, data + 12, kSize - 12, false);
+
+	// reject datagrams that don't decrypt to a known type and the check
+	if (data[21] != static_cast<UInt8>(m_token >> 8) ||
+		data[22] != static_cast<UInt8>(m_token)) {
+		return false;
+	}
+	switch (data[12]) {
+	case kReport:
+	case kMove:
+	case kRelative:
+		break;
+
+	default:
+		return false;
+	}
+
+	packet.m_seq  = seq;
+	packet.m_type = static_cast<EType>(data[12]);
+	packet.m_a    = static_cast<SInt32>(getInt(data + 13));
+	packet.m_b    = static_cast<SInt32>(getInt(data + 17));
+	return true;
+}
+
+void
+CMotionChannel::setLoss(double fraction)
+{
+	if (fraction <= 0.0) {
+		m_loss = 0;
+	}
+	else if (fraction >= 1.0) {
+		m_loss = 0xffffffffu;
+	}
+	else {
+		m_loss = static_cast<UInt32>(fraction * 4294967296.0);
+	}
+}
+
+bool
+CMotionChannel::isLost()
+{
+	if (m_loss == 0) {
+		return false;
+	}
+
+	// xorshift
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return (m_random < m_loss);
+}
+
+UInt32
+CMotionChannel::getToken() const
+{
+	return m_token;
+}
+
+bool
+CMotionChannel::getToken(const CString& data, UInt32& token)
+{
+	if (data.size() < 8 || memcmp(data.data(), s_magic, 4) != 0) {
+		return false;
+	}
+	token = getInt(reinterpret_cast<const UInt8*>(data.data()) + 4);
+	return true;
+}
+
+void
+CMotionChannel::crypt(EDirection dir, UInt32 seq,
+				UInt8* data, UInt32 n, bool encrypt)
+{
+	if (!m_encrypted) {
+		return;
+	}
+
+	// every datagram gets its own iv.  the token differs between
+	// connections and the direction between the two ends.
+	byte iv[CRYPTO_IV_SIZE];
+	memset(iv, 0, sizeof(iv));
+	memcpy(iv, s_magic, 4);
+	putInt(iv + 4, m_token);
+	putInt(iv + 8, seq);
+	iv[12] = static_cast<byte>(dir);
+
+	CCryptoMode& mode = encrypt ? m_encryption : m_decryption;
+	mode.setKeyWithIv(m_key, sizeof(m_key), iv);
+	mode.processData(data, data, n);
+}
+
+void
+CMotionChannel::mac(EDirection dir,
+				UInt8* out, const UInt8* data, UInt32 n) const
+{
+	// include the direction so datagrams can't be reflected
+	byte digest[CryptoPP::SHA256::DIGESTSIZE];
+	byte direction = static_cast<byte>(dir);
+	CryptoPP::HMAC<CryptoPP::SHA256> hmac(m_macKey, sizeof(m_macKey));
+	hmac.Update(&direction, 1);
+	hmac.Update(data, n);
+	hmac.Final(digest);
+	memcpy(out, digest, kMacSize);
+}
@@ -0,0 +1,149 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "io/CryptoStream.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+
+//! Mouse motion datagram codec
+/*!
+Encodes and decodes the datagrams of the mouse motion side-channel
+(see kMsgCMotionChannel).  Each datagram is:
+
+\code
+"SYNM"    4 bytes
+token     4 bytes, identifies the connection
+seq       4 bytes, sequence number
+type      1 byte
+a         4 bytes
+b         4 bytes
+check     2 bytes, the low 16 bits of the token
+mac       8 bytes, only with a key
+\endcode
+
+All integers are big-endian.  When a key is given everything after seq
+is encrypted with it, using an IV made from the token, seq and
+direction, and the datagram ends with a truncated HMAC-SHA256 of the
+rest, so a datagram can't be read, forged or moved to another
+connection without the key.  Datagrams with the wrong token, check or
+mac are rejected.
+
+Motion datagrams carry either an absolute position or the running total
+of relative motion since the channel was opened, so losing one is
+repaired by the next.  A receiver drops any datagram with a sequence
+number not greater than the last one it applied.
+*/
+class CMotionChannel {
+public:
+	enum EType {
+		kReport   = 'R',	//!< client to server, a = highest seq applied,
+						//!< b = highest seq received as a datagram
+		kMove     = 'A',	//!< absolute position a,b
+		kRelative = 'M'		//!< relative motion totals a,b
+	};
+
+	enum EDirection {
+		kToClient = 0,
+		kToServer = 1
+	};
+
+	//! A decoded datagram
+	class CPacket {
+	public:
+		CPacket() : m_seq(0), m_type(kMove), m_a(0), m_b(0) { }
+		CPacket(UInt32 seq, EType type, SInt32 a, SInt32 b) :
+			m_seq(seq), m_type(type), m_a(a), m_b(b) { }
+
+	public:
+		UInt32			m_seq;
+		EType			m_type;
+		SInt32			m_a;
+		SInt32			m_b;
+	};
+
+	/*!
+	Use \p token for the connection.  \p key is the kKeyLength byte key
+	of the connection's crypto stream, or NULL to send in the clear.
+	*/
+	CMotionChannel(UInt32 token, const UInt8* key);
+	~CMotionChannel();
+
+	//! @name manipulators
+	//@{
+
+	//! Encode a datagram
+	CString				encode(EDirection, const CPacket&);
+
+	//! Decode a datagram
+	/*!
+	Returns false if \p data isn't a valid datagram for this channel.
+	*/
+	bool				decode(EDirection, const CString& data, CPacket&);
+
+	//! Set simulated loss
+	/*!
+	Sets the fraction (0 to 1) of datagrams isLost() reports as lost,
+	for testing.  The losses are pseudo-random but repeatable.
+	*/
+	void				setLoss(double fraction);
+
+	//! Test for simulated loss
+	/*!
+	Returns true if the next datagram should be dropped to simulate
+	loss.  Always false unless setLoss() was called.
+	*/
+	bool				isLost();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the token
+	UInt32				getToken() const;
+
+	//! Get the token of a datagram
+	/*!
+	Returns false if \p data isn't a motion datagram.
+	*/
+	static bool			getToken(const CString& data, UInt32& token);
+
+	//@}
+
+	//! Size of a datagram in bytes, without the mac
+	static const UInt32	kSize = 23;
+
+	//! Size of the mac in bytes
+	static const UInt32	kMacSize = 8;
+
+private:
+	void				crypt(EDirection, UInt32 seq,
+							UInt8* data, UInt32 n, bool encrypt);
+	void				mac(EDirection, UInt8* out,
+							const UInt8* data, UInt32 n) const;
+
+private:
+	UInt32				m_token;
+	bool				m_encrypted;
+	UInt8				m_key[synergy::crypto::kKeyLength];
+	UInt8				m_macKey[synergy::crypto::kKeyLength];
+	CCryptoMode			m_encryption;
+	CCryptoMode			m_decryption;
+	UInt32				m_loss;
+	UInt32				m_random;
+};
@@ -21,9 +21,17 @@
 #include "mt/Lock.h"
 #include "base/TMethodEventJob.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
+// largest frame.  a frame this size fits in one TCP segment on ethernet.
+static const UInt32		s_maxFrameSize = 1400;
+
+// shortest timer.  the timer only sends a frame when the queue is idle,
+// otherwise the end of a dispatch or the next write does.
+static const double		s_minFrameDelay = 1.0e-6;
+
 //
 // CPacketStreamFilter
 //
@@ -32,19 +40,59 @@ CPacketStreamFilter::CPacketStreamFilter(IEventQueue* events, synergy::IStream*
 	CStreamFilter(events, stream, adoptStream),
 	m_size(0),
 	m_inputShutdown(false),
-	m_events(events)
+	m_events(events),
+	m_batchDelay(-1.0),
+	m_frameSize(0),
+	m_frameWrites(0),
+	m_frameTimer(NULL),
+	m_numFrames(0),
+	m_numFramedWrites(0),
+	m_maxFramedWrites(0)
 {
 	// do nothing
 }
 
 CPacketStreamFilter::~CPacketStreamFilter()
 {
-	// do nothing
+	if (m_frameTimer != NULL) {
+		m_events->removeHandler(CEvent::kTimer, m_frameTimer);
+		m_events->deleteTimer(m_frameTimer);
+		m_events->removeEndDispatchHandler(this);
+	}
+}
+
+void
+CPacketStreamFilter::setBatchDelay(double maxDelay)
+{
+	if (maxDelay < 0.0) {
+		writeFrame();
+	}
+	m_batchDelay = maxDelay;
+}
+
+UInt32
+CPacketStreamFilter::getNumFrames() const
+{
+	return m_numFrames;
+}
+
+UInt32
+CPacketStreamFilter::getNumFramedWrites() const
+{
+	return m_numFramedWrites;
+}
+
+UInt32
+CPacketStreamFilter::getMaxFramedWrites() const
+{
+	return m_maxFramedWrites;
 }
 
 void
 CPacketStreamFilter::close()
 {
+	writeFrame();
+
 	CLock lock(&m_mutex);
 	m_size = 0;
 	m_buffer.pop(m_buffer.getSize());
@@ -72,9 +120,11 @@ CPacketStreamFilter::read(void* buffer, UInt32 n)
 
 	// read it
 	if (buffer != NULL) {
-		memcpy(buffer, m_buffer.peek(n), n);
+		m_buffer.read(buffer, n);
+	}
+	else {
+		m_buffer.pop(n);
 	}
-	m_buffer.pop(n);
 	m_size -= n;
 
 	// get next packet's size if we've finished with this packet and
@@ -92,6 +142,14 @@ CPacketStreamFilter::read(void* buffer, UInt32 n)
 void
 CPacketStreamFilter::write(const void* buffer, UInt32 count)
 {
+	if (m_batchDelay >= 0.0 && count < s_maxFrameSize) {
+		CSharedBufferList buffers(1, CSharedBuffer(buffer, count));
+		if (addToFrame(buffers, count)) {
+			return;
+		}
+	}
+	writeFrame();
+
 	// write the length of the payload
 	UInt8 length[4];
 	length[0] = (UInt8)((count >> 24) & 0xff);
@@ -104,6 +162,28 @@ CPacketStreamFilter::write(const void* buffer, UInt32 count)
 	getStream()->write(buffer, count);
 }
 
+void
+CPacketStreamFilter::writeBuffers(const CSharedBufferList& buffers)
+{
+	UInt32 count = 0;
+	for (CSharedBufferList::const_iterator i = buffers.begin();
+							i != buffers.end(); ++i) {
+		count += i->getSize();
+	}
+
+	if (m_batchDelay < 0.0 || !addToFrame(buffers, count)) {
+		writeFrame();
+		writePacket(buffers, count);
+	}
+}
+
+void
+CPacketStreamFilter::flush()
+{
+	writeFrame();
+	CStreamFilter::flush();
+}
+
 void
 CPacketStreamFilter::shutdownInput()
 {
@@ -113,6 +193,13 @@ CPacketStreamFilter::shutdownInput()
 	CStreamFilter::shutdownInput();
 }
 
+void
+CPacketStreamFilter::shutdownOutput()
+{
+	writeFrame();
+	CStreamFilter::shutdownOutput();
+}
+
 bool
 CPacketStreamFilter::isReady() const
 {
@@ -175,6 +262,103 @@ CPacketStreamFilter::readMore()
 	return (wasReady != isReady);
 }
 
+void
+CPacketStreamFilter::writePacket(const CSharedBufferList& buffers,
+				UInt32 count)
+{
+	// write the length of the payload and the payload together
+	UInt8 length[4];
+	length[0] = (UInt8)((count >> 24) & 0xff);
+	length[1] = (UInt8)((count >> 16) & 0xff);
+	length[2] = (UInt8)((count >>  8) & 0xff);
+	length[3] = (UInt8)( count        & 0xff);
+
+	CSharedBufferList packet;
+	packet.reserve(buffers.size() + 1);
+	packet.push_back(CSharedBuffer(length, sizeof(length)));
+	packet.insert(packet.end(), buffers.begin(), buffers.end());
+	getStream()->writeBuffers(packet);
+}
+
+bool
+CPacketStreamFilter::addToFrame(const CSharedBufferList& buffers,
+				UInt32 count)
+{
+	if (count >= s_maxFrameSize) {
+		return false;
+	}
+	if (m_frameSize + count > s_maxFrameSize) {
+		writeFrame();
+	}
+
+	// send the frame when the delay is up.  timers only fire when no
+	// events are waiting so also check at the end of each dispatch.
+	if (m_frameTimer == NULL) {
+		m_frameTime.reset();
+		m_frameTimer = m_events->newOneShotTimer(
+							std::max(m_batchDelay, s_minFrameDelay), NULL);
+		m_events->adoptHandler(CEvent::kTimer, m_frameTimer,
+							new TMethodEventJob<CPacketStreamFilter>(this,
+								&CPacketStreamFilter::handleFrameTimer));
+		m_events->adoptEndDispatchHandler(this,
+							new TMethodEventJob<CPacketStreamFilter>(this,
+								&CPacketStreamFilter::handleEndDispatch));
+	}
+
+	m_frame.insert(m_frame.end(), buffers.begin(), buffers.end());
+	m_frameSize += count;
+	++m_frameWrites;
+
+	// a delay of 0 holds writes until the dispatch ends
+	if (m_batchDelay > 0.0) {
+		writeFrameIfDue();
+	}
+	return true;
+}
+
+void
+CPacketStreamFilter::writeFrame()
+{
+	if (m_frameTimer != NULL) {
+		m_events->removeHandler(CEvent::kTimer, m_frameTimer);
+		m_events->deleteTimer(m_frameTimer);
+		m_events->removeEndDispatchHandler(this);
+		m_frameTimer = NULL;
+	}
+	if (m_frameWrites == 0) {
+		return;
+	}
+
+	writePacket(m_frame, m_frameSize);
+
+	++m_numFrames;
+	m_numFramedWrites += m_frameWrites;
+	m_maxFramedWrites  = std::max(m_maxFramedWrites, m_frameWrites);
+	m_frame.clear();
+	m_frameSize   = 0;
+	m_frameWrites = 0;
+}
+
+void
+CPacketStreamFilter::writeFrameIfDue()
+{
+	if (m_frameWrites != 0 && m_frameTime.getTime() >= m_batchDelay) {
+		writeFrame();
+	}
+}
+
+void
+CPacketStreamFilter::handleFrameTimer(const CEvent&, void*)
+{
+	writeFrame();
+}
+
+void
+CPacketStreamFilter::handleEndDispatch(const CEvent&, void*)
+{
+	writeFrameIfDue();
+}
+
 void
 CPacketStreamFilter::filterEvent(const CEvent& event)
 {
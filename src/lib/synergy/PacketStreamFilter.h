@@ -20,24 +20,66 @@
 
 #include "io/StreamFilter.h"
 #include "io/StreamBuffer.h"
+#include "io/SharedBuffer.h"
 #include "mt/Mutex.h"
+#include "base/Stopwatch.h"
 
+class CEventQueueTimer;
 class IEventQueue;
 
 //! Packetizing stream filter 
 /*!
-Filters a stream to read and write packets.
+Filters a stream to read and write packets.  Each write is normally one
+packet;  with batching on, the writes made close together go out as one
+packet, a frame, in a single write to the wrapped stream.
 */
 class CPacketStreamFilter : public CStreamFilter {
 public:
 	CPacketStreamFilter(IEventQueue* events, synergy::IStream* stream, bool adoptStream = true);
 	~CPacketStreamFilter();
 
+	//! @name manipulators
+	//@{
+
+	//! Batch writes into frames
+	/*!
+	Holds writes and sends them as one packet once \p maxDelay seconds
+	have passed since the first.  The frame goes out on the first
+	write or the end of the first event dispatch after that, or from a
+	timer if the queue is idle, so a delay of 0 holds just what's
+	written while handling the current event.  Large writes, flush()
+	and close() send the frame at once.  A negative delay turns
+	batching off.  The reader must accept several messages in one
+	packet, and writes must all be made on the event thread.
+	*/
+	void				setBatchDelay(double maxDelay);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get number of frames
+	/*!
+	Returns the number of frames written since batching was turned on.
+	*/
+	UInt32				getNumFrames() const;
+
+	//! Get number of writes sent in frames
+	UInt32				getNumFramedWrites() const;
+
+	//! Get most writes sent in one frame
+	UInt32				getMaxFramedWrites() const;
+
+	//@}
+
 	// IStream overrides
 	virtual void		close();
 	virtual UInt32		read(void* buffer, UInt32 n);
 	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		writeBuffers(const CSharedBufferList& buffers);
+	virtual void		flush();
 	virtual void		shutdownInput();
+	virtual void		shutdownOutput();
 	virtual bool		isReady() const;
 	virtual UInt32		getSize() const;
 
@@ -50,10 +92,41 @@ private:
 	void				readPacketSize();
 	bool				readMore();
 
+	// write a packet holding \p buffers, \p count bytes in all
+	void				writePacket(const CSharedBufferList& buffers,
+							UInt32 count);
+
+	// add a write to the frame.  returns false if it's too big and
+	// must go on its own.
+	bool				addToFrame(const CSharedBufferList& buffers,
+							UInt32 count);
+
+	// write the frame, if any
+	void				writeFrame();
+
+	// write the frame if it's been held for the batch delay
+	void				writeFrameIfDue();
+
+	void				handleFrameTimer(const CEvent&, void*);
+	void				handleEndDispatch(const CEvent&, void*);
+
 private:
 	CMutex				m_mutex;
 	UInt32				m_size;
 	CStreamBuffer		m_buffer;
 	bool				m_inputShutdown;
 	IEventQueue*		m_events;
+
+	// writes waiting to go out in one packet
+	double				m_batchDelay;
+	CSharedBufferList	m_frame;
+	UInt32				m_frameSize;
+	UInt32				m_frameWrites;
+	CStopwatch			m_frameTime;
+	CEventQueueTimer*	m_frameTimer;
+
+	// frames written
+	UInt32				m_numFrames;
+	UInt32				m_numFramedWrites;
+	UInt32				m_maxFramedWrites;
 };
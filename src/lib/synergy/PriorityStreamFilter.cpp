@@ -0,0 +1,218 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/PriorityStreamFilter.h"
+
+#include "synergy/protocol_types.h"
+#include "mt/Lock.h"
+#include "base/IEventQueue.h"
+
+#include <cstring>
+
+// size of a file transfer message before the data:  code, mark and
+// data length
+static const UInt32		s_fileTransferHeaderSize = 4 + 1 + 4;
+
+//
+// CPriorityStreamFilter
+//
+
+const UInt32			CPriorityStreamFilter::kFrameSize = 32 * 1024;
+CPriorityStreamFilter::CFilterMap	CPriorityStreamFilter::s_filters;
+
+CPriorityStreamFilter::CPriorityStreamFilter(IEventQueue* events, synergy::IStream* stream, bool adoptStream) :
+	CStreamFilter(events, stream, adoptStream),
+	m_bulkOffset(0),
+	m_bulkSize(0),
+	m_writing(false),
+	m_events(events)
+{
+	CLock lock(getFiltersMutex());
+	s_filters[this] = this;
+}
+
+CPriorityStreamFilter::~CPriorityStreamFilter()
+{
+	CLock lock(getFiltersMutex());
+	s_filters.erase(this);
+}
+
+UInt32
+CPriorityStreamFilter::getBulkSize() const
+{
+	CLock lock(&m_mutex);
+	return m_bulkSize;
+}
+
+UInt32
+CPriorityStreamFilter::getBulkSize(const synergy::IStream* stream)
+{
+	// the filter can't be destroyed while we hold the mutex
+	CLock lock(getFiltersMutex());
+	CFilterMap::const_iterator index = s_filters.find(stream);
+	if (index == s_filters.end()) {
+		return 0;
+	}
+	return index->second->getBulkSize();
+}
+
+CMutex*
+CPriorityStreamFilter::getFiltersMutex()
+{
+	static CMutex* s_mutex = new CMutex;
+	return s_mutex;
+}
+
+synergy::IStream*
+CPriorityStreamFilter::getFilteredStream() const
+{
+	return getStream();
+}
+
+void
+CPriorityStreamFilter::close()
+{
+	{
+		CLock lock(&m_mutex);
+		m_bulk.clear();
+		m_bulkOffset = 0;
+		m_bulkSize   = 0;
+		m_writing    = false;
+	}
+	CStreamFilter::close();
+}
+
+void
+CPriorityStreamFilter::write(const void* buffer, UInt32 n)
+{
+	CLock lock(&m_mutex);
+
+	if (!isBulk(buffer, n)) {
+		getStream()->write(buffer, n);
+		return;
+	}
+
+	m_bulk.push_back(CString(static_cast<const char*>(buffer), n));
+	m_bulkSize += n;
+
+	// start sending if nothing is in flight
+	if (!m_writing) {
+		writeBulkFrame();
+	}
+}
+
+void
+CPriorityStreamFilter::writeBuffers(const CSharedBufferList& buffers)
+{
+	if (buffers.empty()) {
+		return;
+	}
+
+	// the first part starts with the message code
+	const CSharedBuffer& head = buffers.front();
+	if (isBulk(head.getData(), head.getSize())) {
+		// bulk messages are queued whole
+		CString message;
+		for (CSharedBufferList::const_iterator i = buffers.begin();
+								i != buffers.end(); ++i) {
+			message.append(reinterpret_cast<const char*>(i->getData()),
+								i->getSize());
+		}
+		write(message.data(), static_cast<UInt32>(message.size()));
+		return;
+	}
+
+	CLock lock(&m_mutex);
+	getStream()->writeBuffers(buffers);
+}
+
+void
+CPriorityStreamFilter::filterEvent(const CEvent& event)
+{
+	if (event.getType() == m_events->forIStream().outputFlushed()) {
+		// the wrapped stream has sent everything so let the next frame
+		// go.  the output isn't really flushed if there was one.
+		CLock lock(&m_mutex);
+		m_writing = false;
+		if (writeBulkFrame()) {
+			return;
+		}
+	}
+
+	// pass event
+	CStreamFilter::filterEvent(event);
+}
+
+bool
+CPriorityStreamFilter::isBulk(const void* buffer, UInt32 n) const
+{
+	// file transfers and the drag info that goes with them.  the drag
+	// info must stay ordered with the file data.
+	return (n >= 4 &&
+			(memcmp(buffer, kMsgDFileTransfer, 4) == 0 ||
+			 memcmp(buffer, kMsgDDragInfo, 4) == 0));
+}
+
+bool
+CPriorityStreamFilter::writeBulkFrame()
+{
+	// note -- m_mutex must be locked on entry
+
+	if (m_bulk.empty()) {
+		return false;
+	}
+
+	const CString& message = m_bulk.front();
+	const UInt32 size      = static_cast<UInt32>(message.size());
+	const UInt8* data      = reinterpret_cast<const UInt8*>(message.data());
+
+	bool sliceable = (size > s_fileTransferHeaderSize &&
+			memcmp(data, kMsgDFileTransfer, 4) == 0 &&
+			data[4] == kFileChunk);
+	if (!sliceable) {
+		getStream()->write(data, size);
+		m_bulkSize -= size;
+		m_bulk.pop_front();
+	}
+	else {
+		// write the next slice of the chunk as a chunk of its own
+		UInt32 remaining = size - s_fileTransferHeaderSize - m_bulkOffset;
+		UInt32 n = (remaining < kFrameSize) ? remaining : kFrameSize;
+
+		UInt8 header[s_fileTransferHeaderSize];
+		memcpy(header, data, 5);
+		header[5] = (UInt8)((n >> 24) & 0xff);
+		header[6] = (UInt8)((n >> 16) & 0xff);
+		header[7] = (UInt8)((n >>  8) & 0xff);
+		header[8] = (UInt8)( n        & 0xff);
+
+		CString frame(reinterpret_cast<const char*>(header), sizeof(header));
+		frame.append(message, s_fileTransferHeaderSize + m_bulkOffset, n);
+		getStream()->write(frame.data(), static_cast<UInt32>(frame.size()));
+
+		m_bulkOffset += n;
+		m_bulkSize   -= n;
+		if (m_bulkOffset == size - s_fileTransferHeaderSize) {
+			m_bulkSize  -= s_fileTransferHeaderSize;
+			m_bulkOffset = 0;
+			m_bulk.pop_front();
+		}
+	}
+
+	m_writing = true;
+	return true;
+}
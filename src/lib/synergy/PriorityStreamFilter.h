@@ -0,0 +1,110 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "io/StreamFilter.h"
+#include "mt/Mutex.h"
+#include "base/String.h"
+#include "common/stddeque.h"
+#include "common/stdmap.h"
+
+class IEventQueue;
+
+//! Message prioritizing stream filter
+/*!
+Filters a stream of protocol messages so bulk transfers don't delay
+input.  Each write must be exactly one message, as written by
+CProtocolUtil::writef() or CProtocolUtil::writefBuffers().  File
+transfer messages go into a bulk queue and the rest are written
+immediately.  The bulk queue is released one small frame at a time,
+only when the wrapped stream has flushed its output, so at most one
+frame is ever ahead of an input message.  File data chunks are sliced into frames of at most kFrameSize bytes;  the
+receiver just appends chunks so this needs no protocol change.
+
+This must be the outermost filter (e.g. above any crypto filter) since
+it reorders messages.  flush() does not wait for the bulk queue.
+*/
+class CPriorityStreamFilter : public CStreamFilter {
+public:
+	//! Largest file data chunk written at once
+	static const UInt32	kFrameSize;
+
+	CPriorityStreamFilter(IEventQueue* events, synergy::IStream* stream, bool adoptStream = true);
+	~CPriorityStreamFilter();
+
+	//! @name accessors
+	//@{
+
+	//! Get bulk queue size
+	/*!
+	Returns the number of bytes of bulk messages not yet written to the
+	wrapped stream.
+	*/
+	UInt32				getBulkSize() const;
+
+	//! Get the filtered stream
+	/*!
+	Returns the stream this filter writes to, e.g. to reach a crypto
+	stream beneath it.
+	*/
+	synergy::IStream*	getFilteredStream() const;
+
+	//! Get bulk queue size of a connection
+	/*!
+	Returns the number of bytes of bulk messages not yet written by the
+	filter that is \c stream, or 0 if \c stream isn't a filter or has
+	gone.  File senders use this to avoid reading far ahead of the
+	connection they send to.  It's safe to call from any thread.
+	*/
+	static UInt32		getBulkSize(const synergy::IStream* stream);
+
+	//@}
+
+	// IStream overrides
+	virtual void		close();
+	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		writeBuffers(const CSharedBufferList& buffers);
+
+protected:
+	// CStreamFilter overrides
+	virtual void		filterEvent(const CEvent&);
+
+private:
+	bool				isBulk(const void* buffer, UInt32 n) const;
+
+	// write the next frame of the bulk queue.  returns false if the
+	// queue was empty.
+	bool				writeBulkFrame();
+
+	// the filters that exist, for getBulkSize().  the mutex is made
+	// with the first filter and never destroyed.
+	static CMutex*		getFiltersMutex();
+
+private:
+	typedef std::deque<CString> CBulkQueue;
+	typedef std::map<const synergy::IStream*, CPriorityStreamFilter*> CFilterMap;
+
+	mutable CMutex		m_mutex;
+	CBulkQueue			m_bulk;
+	UInt32				m_bulkOffset;
+	UInt32				m_bulkSize;
+	bool				m_writing;
+	IEventQueue*		m_events;
+
+	static CFilterMap	s_filters;
+};
@@ -0,0 +1,177 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/ProtocolCapture.h"
+#include "mt/Lock.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static const char		s_magic[] = "SYNCAP";
+static const UInt8		s_version = 1;
+
+static void
+writeVarint(std::ostream& stream, UInt64 value)
+{
+	char buffer[10];
+	UInt32 n = 0;
+	do {
+		buffer[n] = static_cast<char>(value & 0x7f);
+		value >>= 7;
+		if (value != 0) {
+			buffer[n] |= 0x80;
+		}
+		++n;
+	} while (value != 0);
+	stream.write(buffer, n);
+}
+
+static bool
+readVarint(std::istream& stream, UInt64& value)
+{
+	value = 0;
+	for (UInt32 shift = 0; shift < 64; shift += 7) {
+		int c = stream.get();
+		if (c == EOF) {
+			return false;
+		}
+		value |= static_cast<UInt64>(c & 0x7f) << shift;
+		if ((c & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//
+// CProtocolCapture
+//
+
+UInt32					CProtocolCapture::s_numPaths = 0;
+
+CProtocolCapture::CProtocolCapture() :
+	m_file(NULL),
+	m_start(0.0),
+	m_last(0)
+{
+	// do nothing
+}
+
+CProtocolCapture::~CProtocolCapture()
+{
+	delete m_file;
+}
+
+bool
+CProtocolCapture::open(const CString& path, ESide side)
+{
+	CLock lock(&m_mutex);
+
+	delete m_file;
+	m_file = new std::ofstream(path.c_str(),
+							std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_file->is_open()) {
+		LOG((CLOG_ERR "cannot write capture \"%s\"", path.c_str()));
+		delete m_file;
+		m_file = NULL;
+		return false;
+	}
+
+	m_file->write(s_magic, sizeof(s_magic) - 1);
+	m_file->put(static_cast<char>(s_version));
+	m_file->put(static_cast<char>(side));
+	m_start = ARCH->time();
+	m_last  = 0;
+	LOG((CLOG_NOTE "capturing messages to \"%s\"", path.c_str()));
+	return true;
+}
+
+void
+CProtocolCapture::write(bool sent, const void* data, UInt32 n)
+{
+	CLock lock(&m_mutex);
+	if (m_file == NULL) {
+		return;
+	}
+
+	// times are stored as differences so most take a byte or two
+	UInt64 now = static_cast<UInt64>(1.0e6 * (ARCH->time() - m_start));
+	if (now < m_last) {
+		now = m_last;
+	}
+	m_file->put(sent ? 1 : 0);
+	writeVarint(*m_file, now - m_last);
+	writeVarint(*m_file, n);
+	m_file->write(static_cast<const char*>(data), n);
+	m_last = now;
+}
+
+bool
+CProtocolCapture::load(const CString& path, ESide& side, CMessageList& messages)
+{
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
+		LOG((CLOG_ERR "cannot read capture \"%s\"", path.c_str()));
+		return false;
+	}
+
+	char header[sizeof(s_magic) + 1];
+	if (!file.read(header, sizeof(header)) ||
+		memcmp(header, s_magic, sizeof(s_magic) - 1) != 0 ||
+		static_cast<UInt8>(header[sizeof(s_magic) - 1]) != s_version ||
+		(header[sizeof(s_magic)] != kClient &&
+		 header[sizeof(s_magic)] != kServer)) {
+		LOG((CLOG_ERR "\"%s\" isn't a capture", path.c_str()));
+		return false;
+	}
+	side = static_cast<ESide>(header[sizeof(s_magic)]);
+
+	messages.clear();
+	UInt64 time = 0;
+	for (;;) {
+		int sent = file.get();
+		UInt64 delta, size;
+		if (sent == EOF ||
+			!readVarint(file, delta) || !readVarint(file, size) ||
+			size > 0xffffffffu) {
+			break;
+		}
+
+		CMessage message;
+		message.m_data.resize(static_cast<size_t>(size));
+		if (size != 0 && !file.read(&message.m_data[0], message.m_data.size())) {
+			break;
+		}
+		time          += delta;
+		message.m_time = 1.0e-6 * static_cast<double>(time);
+		message.m_sent = (sent != 0);
+		messages.push_back(message);
+	}
+	return true;
+}
+
+CString
+CProtocolCapture::getNextPath(const CString& path)
+{
+	char suffix[16];
+	sprintf(suffix, ".%u", ++s_numPaths);
+	return path + suffix;
+}
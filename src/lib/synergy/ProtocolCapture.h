@@ -0,0 +1,120 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "mt/Mutex.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+#include <iosfwd>
+
+//! Protocol message capture
+/*!
+A file of the messages one end of a connection sent and received, each
+with the time it was sent or received, so the traffic can be replayed
+later (see CProtocolReplay).  The file starts with a header:
+
+\code
+"SYNCAP"  6 bytes
+version   1 byte (1)
+side      1 byte ('c' for a client, 's' for a server)
+\endcode
+
+followed by one record per message:
+
+\code
+sent      1 byte (1 if sent, 0 if received)
+time      varint, microseconds since the previous message
+size      varint
+data      size bytes
+\endcode
+
+A varint holds 7 bits per byte, least significant first, with the top
+bit set on every byte but the last.
+*/
+class CProtocolCapture {
+public:
+	enum ESide {
+		kClient = 'c',
+		kServer = 's'
+	};
+
+	//! A captured message
+	class CMessage {
+	public:
+		CMessage() : m_time(0.0), m_sent(false) { }
+
+	public:
+		// seconds since the start of the capture
+		double			m_time;
+		bool			m_sent;
+		CString			m_data;
+	};
+	typedef std::vector<CMessage> CMessageList;
+
+	CProtocolCapture();
+	~CProtocolCapture();
+
+	//! @name manipulators
+	//@{
+
+	//! Start a capture file
+	/*!
+	Creates the file at \p path for \p side.  Returns false if it can't
+	be written.
+	*/
+	bool				open(const CString& path, ESide side);
+
+	//! Capture a message
+	/*!
+	Appends a message that was just sent or received.  Thread safe.
+	*/
+	void				write(bool sent, const void* data, UInt32 n);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Load a capture file
+	/*!
+	Reads the messages in the file at \p path.  Returns false if the file
+	can't be read or isn't a capture;  a capture cut short (e.g. because
+	the program stopped) loads up to the last whole message.
+	*/
+	static bool			load(const CString& path,
+							ESide& side, CMessageList& messages);
+
+	//! Get path for a new capture
+	/*!
+	Returns \p path with a number added that's different each call, so
+	each connection can have its own capture.
+	*/
+	static CString		getNextPath(const CString& path);
+
+	//@}
+
+private:
+	CMutex				m_mutex;
+	std::ofstream*		m_file;
+	double				m_start;
+	UInt64				m_last;
+
+	static UInt32		s_numPaths;
+};
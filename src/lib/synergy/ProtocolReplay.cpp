@@ -0,0 +1,1017 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/ProtocolReplay.h"
+#include "client/Client.h"
+#include "server/Server.h"
+#include "server/Config.h"
+#include "server/PrimaryClient.h"
+#include "server/ClientProxy.h"
+#include "server/ClientProxyUnknown.h"
+#include "synergy/Screen.h"
+#include "synergy/PacketStreamFilter.h"
+#include "synergy/PriorityStreamFilter.h"
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "platform/VirtualScreen.h"
+#include "net/IDataSocket.h"
+#include "net/ISocketFactory.h"
+#include "net/NetworkAddress.h"
+#include "base/EventQueue.h"
+#include "base/Stopwatch.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// size of the virtual screens
+static const SInt32		s_width  = 1920;
+static const SInt32		s_height = 1080;
+
+// seconds before the replay starts, once the event queue is running
+static const double		s_startTime = 0.001;
+
+// seconds the server waits for the client's hello
+static const double		s_helloTimeout = 30.0;
+
+static double
+percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty()) {
+		return 0.0;
+	}
+	size_t i = static_cast<size_t>(p * sorted.size());
+	return sorted[std::min(i, sorted.size() - 1)];
+}
+
+//
+// CReplaySocket
+//
+
+//! Socket that reads captured messages
+/*!
+Reads the messages pushed to it, each with the size prefix a
+CPacketStreamFilter expects, and throws away whatever is written to it.
+Clears \c *owner when destroyed so the replay knows the connection was
+closed.
+*/
+class CReplaySocket : public IDataSocket {
+public:
+	CReplaySocket(IEventQueue* events, CReplaySocket** owner);
+	~CReplaySocket();
+
+	//! Make a message available to read
+	void				push(const CString& message);
+
+	// ISocket overrides
+	virtual void		bind(const CNetworkAddress&);
+	virtual void		close();
+	virtual void*		getEventTarget() const;
+
+	// IStream overrides
+	virtual UInt32		read(void* buffer, UInt32 n);
+	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		writeBuffers(const CSharedBufferList& buffers);
+	virtual void		flush();
+	virtual void		shutdownInput();
+	virtual void		shutdownOutput();
+	virtual bool		isReady() const;
+	virtual UInt32		getSize() const;
+
+	// IDataSocket overrides
+	virtual void		connect(const CNetworkAddress&);
+
+private:
+	IEventQueue*		m_events;
+	CReplaySocket**		m_owner;
+	CString				m_input;
+	UInt32				m_offset;
+};
+
+CReplaySocket::CReplaySocket(IEventQueue* events, CReplaySocket** owner) :
+	IDataSocket(events),
+	m_events(events),
+	m_owner(owner),
+	m_offset(0)
+{
+	*m_owner = this;
+}
+
+CReplaySocket::~CReplaySocket()
+{
+	if (*m_owner == this) {
+		*m_owner = NULL;
+	}
+}
+
+void
+CReplaySocket::push(const CString& message)
+{
+	// drop what's been read already
+	if (m_offset == m_input.size()) {
+		m_input.clear();
+		m_offset = 0;
+	}
+
+	UInt32 n = static_cast<UInt32>(message.size());
+	m_input += static_cast<char>((n >> 24) & 0xff);
+	m_input += static_cast<char>((n >> 16) & 0xff);
+	m_input += static_cast<char>((n >>  8) & 0xff);
+	m_input += static_cast<char>( n        & 0xff);
+	m_input += message;
+	m_events->addEvent(CEvent(m_events->forIStream().inputReady(),
+							getEventTarget(), NULL));
+}
+
+void
+CReplaySocket::bind(const CNetworkAddress&)
+{
+	// do nothing
+}
+
+void
+CReplaySocket::close()
+{
+	// do nothing
+}
+
+void*
+CReplaySocket::getEventTarget() const
+{
+	return const_cast<void*>(reinterpret_cast<const void*>(this));
+}
+
+UInt32
+CReplaySocket::read(void* buffer, UInt32 n)
+{
+	UInt32 available = getSize();
+	if (n > available) {
+		n = available;
+	}
+	if (buffer != NULL) {
+		memcpy(buffer, m_input.data() + m_offset, n);
+	}
+	m_offset += n;
+	return n;
+}
+
+void
+CReplaySocket::write(const void*, UInt32)
+{
+	// discard
+}
+
+void
+CReplaySocket::writeBuffers(const CSharedBufferList&)
+{
+	// discard
+}
+
+void
+CReplaySocket::flush()
+{
+	// do nothing
+}
+
+void
+CReplaySocket::shutdownInput()
+{
+	// do nothing
+}
+
+void
+CReplaySocket::shutdownOutput()
+{
+	// do nothing
+}
+
+bool
+CReplaySocket::isReady() const
+{
+	return (getSize() > 0);
+}
+
+UInt32
+CReplaySocket::getSize() const
+{
+	return static_cast<UInt32>(m_input.size()) - m_offset;
+}
+
+void
+CReplaySocket::connect(const CNetworkAddress&)
+{
+	m_events->addEvent(CEvent(m_events->forIDataSocket().connected(),
+							getEventTarget(), NULL));
+}
+
+
+//
+// CReplaySocketFactory
+//
+
+//! Factory for one CReplaySocket
+class CReplaySocketFactory : public ISocketFactory {
+public:
+	CReplaySocketFactory(IEventQueue* events, CReplaySocket** socket) :
+		m_events(events), m_socket(socket) { }
+
+	// ISocketFactory overrides
+	virtual IDataSocket*	create() const
+	{
+		return new CReplaySocket(m_events, m_socket);
+	}
+	virtual IListenSocket*	createListen() const
+	{
+		return NULL;
+	}
+	virtual IDatagramSocket*	createDatagram() const
+	{
+		return NULL;
+	}
+
+private:
+	IEventQueue*		m_events;
+	CReplaySocket**		m_socket;
+};
+
+
+//
+// CWireStream
+//
+
+//! Stream over a string
+/*!
+Reads one message for CProtocolUtil::readf().  Writes are discarded.
+*/
+class CWireStream : public synergy::IStream {
+public:
+	CWireStream() : m_offset(0) { }
+
+	//! Set the bytes to read
+	void				reset(const CString& data)
+	{
+		m_data   = data;
+		m_offset = 0;
+	}
+
+	// IStream overrides
+	virtual void		close() { }
+	virtual UInt32		read(void* buffer, UInt32 n)
+	{
+		n = std::min(n, getSize());
+		if (buffer != NULL) {
+			memcpy(buffer, m_data.data() + m_offset, n);
+		}
+		m_offset += n;
+		return n;
+	}
+	virtual void		write(const void*, UInt32) { }
+	virtual void		writeBuffers(const CSharedBufferList&) { }
+	virtual void		flush() { }
+	virtual void		shutdownInput() { }
+	virtual void		shutdownOutput() { }
+	virtual void*		getEventTarget() const { return NULL; }
+	virtual bool		isReady() const { return (getSize() > 0); }
+	virtual UInt32		getSize() const
+	{
+		return static_cast<UInt32>(m_data.size()) - m_offset;
+	}
+
+private:
+	CString				m_data;
+	UInt32				m_offset;
+};
+
+
+//
+// CWireInput
+//
+
+//! An input message in both forms
+/*!
+The arguments are as for the 4 byte code message, with absolute mouse
+positions.  Entering the screen is included because compact moves are
+relative to where the cursor entered.
+*/
+class CWireInput {
+public:
+	enum EType {
+		kEnter,
+		kMouseMove,
+		kMouseRelMove,
+		kMouseDown,
+		kMouseUp,
+		kMouseWheel,
+		kKeyDown,
+		kKeyRepeat,
+		kKeyUp,
+		kNumTypes
+	};
+
+	CWireInput(EType type, double time,
+				SInt32 a = 0, SInt32 b = 0, SInt32 c = 0, SInt32 d = 0) :
+		m_type(type), m_time(time)
+	{
+		m_args[0] = a;
+		m_args[1] = b;
+		m_args[2] = c;
+		m_args[3] = d;
+	}
+
+	//! Get the 4 byte code message format
+	const char*			getFormat() const
+	{
+		switch (m_type) {
+		case kEnter:		return kMsgCEnter;
+		case kMouseMove:	return kMsgDMouseMove;
+		case kMouseRelMove:	return kMsgDMouseRelMove;
+		case kMouseDown:	return kMsgDMouseDown;
+		case kMouseUp:		return kMsgDMouseUp;
+		case kMouseWheel:	return kMsgDMouseWheel;
+		case kKeyDown:		return kMsgDKeyDown;
+		case kKeyRepeat:	return kMsgDKeyRepeat;
+		case kKeyUp:		return kMsgDKeyUp;
+		default:			return NULL;
+		}
+	}
+
+	//! Get the compact message format
+	const char*			getCompactFormat() const
+	{
+		switch (m_type) {
+		case kEnter:		return kMsgCEnter;
+		case kMouseMove:	return kMsgDCompactMouseMove;
+		case kMouseRelMove:	return kMsgDCompactMouseRelMove;
+		case kMouseDown:	return kMsgDCompactMouseDown;
+		case kMouseUp:		return kMsgDCompactMouseUp;
+		case kMouseWheel:	return kMsgDCompactMouseWheel;
+		case kKeyDown:		return kMsgDCompactKeyDown;
+		case kKeyRepeat:	return kMsgDCompactKeyRepeat;
+		case kKeyUp:		return kMsgDCompactKeyUp;
+		default:			return NULL;
+		}
+	}
+
+	//! Get the compact format of this move followed by \p button
+	const char*			getCompactFormat(const CWireInput& button) const
+	{
+		if (m_type != kMouseMove) {
+			return NULL;
+		}
+		switch (button.m_type) {
+		case kMouseDown:	return kMsgDCompactMoveMouseDown;
+		case kMouseUp:		return kMsgDCompactMoveMouseUp;
+		default:			return NULL;
+		}
+	}
+
+public:
+	EType				m_type;
+	double				m_time;
+	SInt32				m_args[4];
+};
+
+typedef std::vector<CWireInput> CWireInputList;
+
+// seconds between a mouse move and a button within which they're taken
+// to be handled together, so sent as one compact message
+static const double		s_wireBurstTime = 0.001;
+
+// times the input is formatted and parsed when timing it
+static const UInt32		s_wireRepeats = 20;
+
+// size of the CPacketStreamFilter prefix on each message
+static const UInt32		s_wirePrefixSize = 4;
+
+// read the input message in \p data, 4 byte code or compact, into
+// \p inputs.  \p x,y is the position compact moves are relative to.
+// returns false if it isn't input or kMsgCEnter.
+static bool
+readWireInput(const CString& data, double time,
+				SInt32& x, SInt32& y, CWireInputList& inputs)
+{
+	CWireStream stream;
+	stream.reset(data);
+	SInt16 a, b;
+	UInt16 c, d, e, f;
+	UInt8 button;
+	SInt32 dx, dy;
+	UInt32 k[4];
+
+	CString code = data.substr(0, 4);
+	if (code.size() == 4 && memcmp(code.data(), kMsgCEnter, 4) == 0) {
+		UInt32 seqNum;
+		CProtocolUtil::readf(&stream, kMsgCEnter, &a, &b, &seqNum, &c);
+		x = a;
+		y = b;
+		inputs.push_back(CWireInput(CWireInput::kEnter, time,
+							a, b, seqNum, c));
+	}
+	else if (code == "DMMV") {
+		CProtocolUtil::readf(&stream, kMsgDMouseMove, &a, &b);
+		inputs.push_back(CWireInput(CWireInput::kMouseMove, time, a, b));
+	}
+	else if (code == "DMRM") {
+		CProtocolUtil::readf(&stream, kMsgDMouseRelMove, &a, &b);
+		inputs.push_back(CWireInput(CWireInput::kMouseRelMove, time, a, b));
+	}
+	else if (code == "DMDN") {
+		CProtocolUtil::readf(&stream, kMsgDMouseDown, &button);
+		inputs.push_back(CWireInput(CWireInput::kMouseDown, time, button));
+	}
+	else if (code == "DMUP") {
+		CProtocolUtil::readf(&stream, kMsgDMouseUp, &button);
+		inputs.push_back(CWireInput(CWireInput::kMouseUp, time, button));
+	}
+	else if (code == "DMWM" && data.size() == 8) {
+		CProtocolUtil::readf(&stream, kMsgDMouseWheel, &a, &b);
+		inputs.push_back(CWireInput(CWireInput::kMouseWheel, time, a, b));
+	}
+	else if (code == "DKDN" && data.size() == 10) {
+		CProtocolUtil::readf(&stream, kMsgDKeyDown, &c, &d, &e);
+		inputs.push_back(CWireInput(CWireInput::kKeyDown, time, c, d, e));
+	}
+	else if (code == "DKRP" && data.size() == 12) {
+		CProtocolUtil::readf(&stream, kMsgDKeyRepeat, &c, &d, &e, &f);
+		inputs.push_back(CWireInput(CWireInput::kKeyRepeat, time, c, d, e, f));
+	}
+	else if (code == "DKUP" && data.size() == 10) {
+		CProtocolUtil::readf(&stream, kMsgDKeyUp, &c, &d, &e);
+		inputs.push_back(CWireInput(CWireInput::kKeyUp, time, c, d, e));
+	}
+	else if (data.empty()) {
+		return false;
+	}
+	else if (data[0] == kMsgDCompactMouseMove[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactMouseMove, &dx, &dy);
+		x += dx;
+		y += dy;
+		inputs.push_back(CWireInput(CWireInput::kMouseMove, time, x, y));
+	}
+	else if (data[0] == kMsgDCompactMouseRelMove[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactMouseRelMove, &dx, &dy);
+		inputs.push_back(CWireInput(CWireInput::kMouseRelMove, time, dx, dy));
+	}
+	else if (data[0] == kMsgDCompactMouseDown[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactMouseDown, &button);
+		inputs.push_back(CWireInput(CWireInput::kMouseDown, time, button));
+	}
+	else if (data[0] == kMsgDCompactMouseUp[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactMouseUp, &button);
+		inputs.push_back(CWireInput(CWireInput::kMouseUp, time, button));
+	}
+	else if (data[0] == kMsgDCompactMoveMouseDown[0] ||
+			 data[0] == kMsgDCompactMoveMouseUp[0]) {
+		bool down = (data[0] == kMsgDCompactMoveMouseDown[0]);
+		CProtocolUtil::readf(&stream, down ? kMsgDCompactMoveMouseDown :
+							kMsgDCompactMoveMouseUp, &dx, &dy, &button);
+		x += dx;
+		y += dy;
+		inputs.push_back(CWireInput(CWireInput::kMouseMove, time, x, y));
+		inputs.push_back(CWireInput(down ? CWireInput::kMouseDown :
+							CWireInput::kMouseUp, time, button));
+	}
+	else if (data[0] == kMsgDCompactMouseWheel[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactMouseWheel, &dx, &dy);
+		inputs.push_back(CWireInput(CWireInput::kMouseWheel, time, dx, dy));
+	}
+	else if (data[0] == kMsgDCompactKeyDown[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactKeyDown, &k[0], &k[1], &k[2]);
+		inputs.push_back(CWireInput(CWireInput::kKeyDown, time,
+							k[0], k[1], k[2]));
+	}
+	else if (data[0] == kMsgDCompactKeyRepeat[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactKeyRepeat,
+							&k[0], &k[1], &k[2], &k[3]);
+		inputs.push_back(CWireInput(CWireInput::kKeyRepeat, time,
+							k[0], k[1], k[2], k[3]));
+	}
+	else if (data[0] == kMsgDCompactKeyUp[0]) {
+		CProtocolUtil::readf(&stream, kMsgDCompactKeyUp, &k[0], &k[1], &k[2]);
+		inputs.push_back(CWireInput(CWireInput::kKeyUp, time,
+							k[0], k[1], k[2]));
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+//! A message to format
+class CWireMessage {
+public:
+	CWireMessage(const char* fmt, UInt32 codeSize,
+				SInt32 a = 0, SInt32 b = 0, SInt32 c = 0, SInt32 d = 0) :
+		m_format(fmt), m_codeSize(codeSize)
+	{
+		m_args[0] = a;
+		m_args[1] = b;
+		m_args[2] = c;
+		m_args[3] = d;
+	}
+
+public:
+	const char*			m_format;
+	UInt32				m_codeSize;
+	SInt32				m_args[4];
+};
+
+typedef std::vector<CWireMessage> CWireMessageList;
+
+// get the bytes on the wire for \p messages
+static UInt32
+getWireSize(const CWireMessageList& messages)
+{
+	UInt32 size = 0;
+	for (size_t i = 0; i < messages.size(); ++i) {
+		const CWireMessage& m = messages[i];
+		size += s_wirePrefixSize + static_cast<UInt32>(
+			CProtocolUtil::formatf(m.m_format,
+				m.m_args[0], m.m_args[1], m.m_args[2], m.m_args[3]).size());
+	}
+	return size;
+}
+
+// format and parse a message the way the server and client would.
+// the arguments are read into 4 byte integers whatever their size,
+// which is wrong but costs the same.
+static void
+formatAndParse(CWireStream& stream, const CWireMessage& m)
+{
+	UInt32 args[4] = { 0, 0, 0, 0 };
+	UInt8 code[4];
+	stream.reset(CProtocolUtil::formatf(m.m_format,
+				m.m_args[0], m.m_args[1], m.m_args[2], m.m_args[3]));
+	stream.read(code, m.m_codeSize);
+	CProtocolUtil::readf(&stream, m.m_format + m.m_codeSize,
+							&args[0], &args[1], &args[2], &args[3]);
+}
+
+// get seconds per message to format and parse \p messages
+static double
+getWireTime(const CWireMessageList& messages)
+{
+	if (messages.empty()) {
+		return 0.0;
+	}
+	CWireStream stream;
+	CStopwatch stopwatch;
+	for (UInt32 r = 0; r < s_wireRepeats; ++r) {
+		for (size_t i = 0; i < messages.size(); ++i) {
+			formatAndParse(stream, messages[i]);
+		}
+	}
+	return stopwatch.getTime() / (s_wireRepeats * messages.size());
+}
+
+
+//
+// CProtocolReplay
+//
+
+CProtocolReplay::CProtocolReplay() :
+	m_speed(1.0),
+	m_logLevel("WARNING"),
+	m_wireSize(false),
+	m_side(CProtocolCapture::kClient),
+	m_events(NULL),
+	m_socket(NULL),
+	m_server(NULL),
+	m_handshakeFailed(false),
+	m_replayTime(0.0)
+{
+	// do nothing
+}
+
+CProtocolReplay::~CProtocolReplay()
+{
+	// do nothing
+}
+
+bool
+CProtocolReplay::parseArgs(int argc, char** argv)
+{
+	for (int i = 0; i < argc; ++i) {
+		const char* arg = argv[i];
+		if (arg[0] != '-') {
+			if (!m_path.empty()) {
+				std::cerr << "more than one capture file" << std::endl;
+				usage();
+				return false;
+			}
+			m_path = arg;
+			continue;
+		}
+		if (strcmp(arg, "--wire-size") == 0) {
+			m_wireSize = true;
+			continue;
+		}
+
+		const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (value == NULL) {
+			std::cerr << "missing value for " << arg << std::endl;
+			usage();
+			return false;
+		}
+		++i;
+
+		if (strcmp(arg, "--speed") == 0) {
+			m_speed = atof(value);
+		}
+		else if (strcmp(arg, "-d") == 0 || strcmp(arg, "--debug") == 0) {
+			m_logLevel = value;
+		}
+		else {
+			std::cerr << "unknown replay arg: " << arg << std::endl;
+			usage();
+			return false;
+		}
+	}
+
+	if (m_path.empty() || m_speed < 0.0) {
+		std::cerr << "invalid replay args" << std::endl;
+		usage();
+		return false;
+	}
+	return true;
+}
+
+bool
+CProtocolReplay::run()
+{
+	if (!CLOG->setFilter(m_logLevel.c_str())) {
+		std::cerr << "invalid log level: " << m_logLevel << std::endl;
+		return false;
+	}
+	if (!CProtocolCapture::load(m_path, m_side, m_messages)) {
+		std::cerr << "cannot load capture: " << m_path << std::endl;
+		return false;
+	}
+	if (m_wireSize) {
+		reportWireSize();
+		return true;
+	}
+
+	// the replay pumps the event queue itself, which it can only do once
+	// the queue is running
+	CEventQueue events;
+	m_events = &events;
+	CEventQueueTimer* timer = m_events->newOneShotTimer(s_startTime, NULL);
+	m_events->adoptHandler(CEvent::kTimer, timer,
+							new TMethodEventJob<CProtocolReplay>(this,
+								&CProtocolReplay::handleStart));
+	m_events->loop();
+	m_events->removeHandler(CEvent::kTimer, timer);
+	m_events->deleteTimer(timer);
+	m_events = NULL;
+
+	report();
+	return true;
+}
+
+void
+CProtocolReplay::replayClient()
+{
+	CScreen* screen = new CScreen(new CVirtualScreen(m_events, false,
+							s_width, s_height, "", ""), m_events);
+	CClient* client = new CClient(m_events, "replay",
+							CNetworkAddress("127.0.0.1", kDefaultPort),
+							new CReplaySocketFactory(m_events, &m_socket),
+							NULL, screen, CCryptoOptions(), false);
+
+	// the client handles the server's hello like any other message
+	client->connect();
+	dispatchEvents();
+	replayMessages();
+
+	delete client;
+	delete screen;
+}
+
+void
+CProtocolReplay::replayServer()
+{
+	CString name = getClientName(m_messages);
+	CConfig config(m_events);
+	config.addScreen("server");
+	config.addScreen(name);
+	config.connect("server", kRight, 0.0f, 1.0f, name, 0.0f, 1.0f);
+	config.connect(name, kLeft, 0.0f, 1.0f, "server", 0.0f, 1.0f);
+
+	CScreen* screen = new CScreen(new CVirtualScreen(m_events, true,
+							s_width, s_height, "", ""), m_events);
+	CPrimaryClient* primaryClient = new CPrimaryClient("server", screen);
+	m_server = new CServer(config, primaryClient, screen, m_events, false);
+
+	// the client proxy is set up the way CClientListener does it, minus
+	// the encryption
+	synergy::IStream* stream = new CReplaySocket(m_events, &m_socket);
+	CPacketStreamFilter* packetStream =
+		new CPacketStreamFilter(m_events, stream, true);
+	stream = new CPriorityStreamFilter(m_events, packetStream, true);
+	CClientProxyUnknown* client = new CClientProxyUnknown(stream,
+							packetStream, NULL,
+							s_helloTimeout, m_server, m_events);
+	m_events->adoptHandler(m_events->forCClientProxyUnknown().success(),
+							client,
+							new TMethodEventJob<CProtocolReplay>(this,
+								&CProtocolReplay::handleHandshake, client));
+	m_events->adoptHandler(m_events->forCClientProxyUnknown().failure(),
+							client,
+							new TMethodEventJob<CProtocolReplay>(this,
+								&CProtocolReplay::handleHandshake, client));
+	replayMessages();
+
+	delete m_server;
+	m_server = NULL;
+	delete primaryClient;
+	delete screen;
+}
+
+void
+CProtocolReplay::replayMessages()
+{
+	UInt32 numReplayed = 0;
+	CStopwatch clock;
+	for (CProtocolCapture::CMessageList::const_iterator
+							i = m_messages.begin(); i != m_messages.end(); ++i) {
+		if (i->m_sent) {
+			continue;
+		}
+		if (m_socket == NULL || m_handshakeFailed) {
+			LOG((CLOG_WARN "connection closed after %d messages",
+				numReplayed));
+			break;
+		}
+
+		// keep the capture's pace, handling timers meanwhile
+		if (m_speed > 0.0) {
+			double due = i->m_time / m_speed;
+			for (double wait = due - clock.getTime(); wait > 0.0;
+							wait = due - clock.getTime()) {
+				dispatchEvent(wait);
+			}
+		}
+
+		m_times[getCode(i->m_data)].push_back(pushMessage(i->m_data));
+		++numReplayed;
+	}
+	m_replayTime = clock.getTime();
+}
+
+double
+CProtocolReplay::pushMessage(const CString& data)
+{
+	CStopwatch stopwatch;
+	m_socket->push(data);
+	dispatchEvents();
+	return stopwatch.getTime();
+}
+
+bool
+CProtocolReplay::dispatchEvent(double timeout)
+{
+	CEvent event;
+	if (!m_events->getEvent(event, timeout)) {
+		return false;
+	}
+	m_events->dispatchEvent(event);
+	CEvent::deleteData(event);
+	return true;
+}
+
+void
+CProtocolReplay::dispatchEvents()
+{
+	while (dispatchEvent(0.0)) {
+		// do nothing
+	}
+}
+
+void
+CProtocolReplay::report() const
+{
+	std::vector<double> all;
+	printf("%-8s %8s %10s %10s %10s %10s\n",
+		"message", "count", "mean us", "p50 us", "p99 us", "max us");
+	for (CTimes::const_iterator i = m_times.begin(); i != m_times.end(); ++i) {
+		std::vector<double> times = i->second;
+		std::sort(times.begin(), times.end());
+		double total = 0.0;
+		for (size_t j = 0; j < times.size(); ++j) {
+			total += times[j];
+		}
+		printf("%-8s %8d %10.1f %10.1f %10.1f %10.1f\n",
+			i->first.c_str(), (int)times.size(),
+			1.0e6 * total / times.size(),
+			1.0e6 * percentile(times, 0.50),
+			1.0e6 * percentile(times, 0.99),
+			1.0e6 * percentile(times, 1.0));
+		all.insert(all.end(), times.begin(), times.end());
+	}
+
+	double total = 0.0;
+	for (size_t j = 0; j < all.size(); ++j) {
+		total += all[j];
+	}
+	printf("replayed:  %d messages in %.2fs, %.2fs handling them\n",
+		(int)all.size(), m_replayTime, total);
+}
+
+void
+CProtocolReplay::reportWireSize() const
+{
+	// read the input the server sent, and count the bytes of the rest
+	CWireInputList inputs;
+	UInt32 otherBytes = 0;
+	SInt32 x = 0, y = 0;
+	for (CProtocolCapture::CMessageList::const_iterator
+							i = m_messages.begin(); i != m_messages.end(); ++i) {
+		bool fromServer = (i->m_sent == (m_side == CProtocolCapture::kServer));
+		if (fromServer &&
+			!readWireInput(i->m_data, i->m_time, x, y, inputs)) {
+			otherBytes += s_wirePrefixSize +
+							static_cast<UInt32>(i->m_data.size());
+		}
+	}
+
+	// each kind of message as sent with 4 byte codes and compact, moves
+	// followed closely by a button going with the button
+	CWireMessageList classic[CWireInput::kNumTypes];
+	CWireMessageList compact[CWireInput::kNumTypes];
+	UInt32 numCombined = 0;
+	x = y = 0;
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		const CWireInput& input = inputs[i];
+		const SInt32* args      = input.m_args;
+		classic[input.m_type].push_back(CWireMessage(input.getFormat(), 4,
+							args[0], args[1], args[2], args[3]));
+
+		switch (input.m_type) {
+		case CWireInput::kEnter:
+			x = args[0];
+			y = args[1];
+			compact[input.m_type].push_back(classic[input.m_type].back());
+			break;
+
+		case CWireInput::kMouseMove: {
+			const CWireInput* next = (i + 1 < inputs.size()) ?
+							&inputs[i + 1] : NULL;
+			const char* fmt = (next != NULL) ?
+							input.getCompactFormat(*next) : NULL;
+			if (fmt != NULL && next->m_time - input.m_time < s_wireBurstTime) {
+				// counted with the button
+				compact[next->m_type].push_back(CWireMessage(fmt, 1,
+							args[0] - x, args[1] - y, next->m_args[0]));
+				classic[next->m_type].push_back(CWireMessage(
+							next->getFormat(), 4, next->m_args[0]));
+				++numCombined;
+				++i;
+			}
+			else {
+				compact[input.m_type].push_back(CWireMessage(
+							input.getCompactFormat(), 1,
+							args[0] - x, args[1] - y));
+			}
+			x = args[0];
+			y = args[1];
+			break;
+		}
+
+		default:
+			compact[input.m_type].push_back(CWireMessage(
+							input.getCompactFormat(), 1,
+							args[0], args[1], args[2], args[3]));
+			break;
+		}
+	}
+
+	printf("%-8s %8s %10s %10s %7s %10s %10s\n",
+		"message", "count", "bytes", "compact", "saved", "ns", "compact ns");
+	UInt32 totalClassic = 0, totalCompact = 0, totalCount = 0;
+	for (UInt32 type = 0; type < CWireInput::kNumTypes; ++type) {
+		if (classic[type].empty()) {
+			continue;
+		}
+		UInt32 classicSize = getWireSize(classic[type]);
+		UInt32 compactSize = getWireSize(compact[type]);
+		double classicTime = getWireTime(classic[type]);
+		double compactTime = getWireTime(compact[type]);
+		printf("%-8.4s %8d %10d %10d %6.0f%% %10.0f %10.0f\n",
+			classic[type][0].m_format, (int)classic[type].size(),
+			classicSize, compactSize,
+			100.0 * (classicSize - compactSize) / classicSize,
+			1.0e9 * classicTime, 1.0e9 * compactTime);
+		totalClassic += classicSize;
+		totalCompact += compactSize;
+		totalCount   += static_cast<UInt32>(classic[type].size());
+	}
+	if (totalClassic == 0) {
+		printf("no input from the server\n");
+		return;
+	}
+	printf("input:    %d messages, %d bytes, %d compact (%.0f%% less), "
+		"%d moves sent with a button\n",
+		totalCount, totalClassic, totalCompact,
+		100.0 * (totalClassic - totalCompact) / totalClassic, numCombined);
+	printf("all:      %d bytes from the server, %d compact (%.0f%% less)\n",
+		totalClassic + otherBytes, totalCompact + otherBytes,
+		100.0 * (totalClassic - totalCompact) / (totalClassic + otherBytes));
+}
+
+void
+CProtocolReplay::handleStart(const CEvent&, void*)
+{
+	if (m_side == CProtocolCapture::kClient) {
+		replayClient();
+	}
+	else {
+		replayServer();
+	}
+	m_events->addEvent(CEvent(CEvent::kQuit));
+}
+
+void
+CProtocolReplay::handleHandshake(const CEvent&, void* vclient)
+{
+	CClientProxyUnknown* unknownClient =
+		reinterpret_cast<CClientProxyUnknown*>(vclient);
+
+	CClientProxy* client = unknownClient->orphanClientProxy();
+	if (client != NULL) {
+		m_server->adoptClient(client);
+	}
+	else {
+		LOG((CLOG_ERR "replayed handshake failed"));
+		m_handshakeFailed = true;
+	}
+
+	m_events->removeHandler(m_events->forCClientProxyUnknown().success(),
+							unknownClient);
+	m_events->removeHandler(m_events->forCClientProxyUnknown().failure(),
+							unknownClient);
+	delete unknownClient;
+}
+
+CString
+CProtocolReplay::getCode(const CString& data)
+{
+	// the hello has no code of its own
+	if (data.compare(0, 7, "Synergy") == 0) {
+		return "hello";
+	}
+	if (!data.empty() && static_cast<UInt8>(data[0]) < kMsgCompactLimit) {
+		return synergy::string::sprintf("0x%02x", data[0]);
+	}
+	return data.substr(0, 4);
+}
+
+CString
+CProtocolReplay::getClientName(const CProtocolCapture::CMessageList& messages)
+{
+	// the client's name is in its hello, "Synergy" then a 2 byte major
+	// and minor version then the name as a 4 byte size and the bytes
+	for (CProtocolCapture::CMessageList::const_iterator
+							i = messages.begin(); i != messages.end(); ++i) {
+		const CString& data = i->m_data;
+		if (!i->m_sent && getCode(data) == "hello" && data.size() >= 15) {
+			const UInt8* size = reinterpret_cast<const UInt8*>(data.data()) + 11;
+			UInt32 n = (static_cast<UInt32>(size[0]) << 24) |
+					   (static_cast<UInt32>(size[1]) << 16) |
+					   (static_cast<UInt32>(size[2]) <<  8) |
+						static_cast<UInt32>(size[3]);
+			return data.substr(15, n);
+		}
+	}
+	return "client";
+}
+
+void
+CProtocolReplay::usage()
+{
+	std::cerr <<
+		"usage: syntool --replay <capture> [options]\n"
+		"  --speed <x>           times the capture's pace, 0 for no waiting (1)\n"
+		"  --wire-size           compare the input messages' size with the\n"
+		"                        compact messages instead of replaying\n"
+		"  -d, --debug <level>   log level (WARNING)\n";
+}
@@ -0,0 +1,114 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "synergy/ProtocolCapture.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+#include "common/stdvector.h"
+
+class CEvent;
+class CReplaySocket;
+class CServer;
+class IEventQueue;
+
+//! Protocol capture replay
+/*!
+Feeds the messages one end of a connection received, as captured by
+CProtocolCapture, back into a fresh client or server on a virtual screen
+and times how long each takes to handle.  The messages go in through a
+stand-in socket, so everything above it -- the packet and priority
+filters, the handshake and the message handlers -- runs as it did when
+the capture was made.  Messages it sends are thrown away.
+
+Prints, for each kind of message, how many were replayed and the time
+from a message arriving to every event it caused being handled.
+Replaying a capture twice handles the same messages in the same order,
+so the timings can be compared before and after a change.
+
+With \c --wire-size the capture isn't replayed.  Instead the input
+messages in it are counted as sent with and without the compact input
+messages (see kMsgCompactLimit), with the bytes on the wire and the
+time to format and parse each kind.
+*/
+class CProtocolReplay {
+public:
+	CProtocolReplay();
+	~CProtocolReplay();
+
+	//! @name manipulators
+	//@{
+
+	//! Parse arguments
+	/*!
+	Parses the capture file and the replay options.  Returns false and
+	prints the usage if they're invalid.
+	*/
+	bool				parseArgs(int argc, char** argv);
+
+	//! Replay the capture
+	/*!
+	Replays the capture and prints the timings.  Returns false if the
+	capture couldn't be loaded.
+	*/
+	bool				run();
+
+	//@}
+
+private:
+	typedef std::map<CString, std::vector<double> > CTimes;
+
+	void				replayClient();
+	void				replayServer();
+	void				replayMessages();
+	double				pushMessage(const CString& data);
+	bool				dispatchEvent(double timeout);
+	void				dispatchEvents();
+	void				report() const;
+	void				reportWireSize() const;
+
+	void				handleStart(const CEvent&, void*);
+	void				handleHandshake(const CEvent&, void*);
+
+	static CString		getCode(const CString& data);
+	static CString		getClientName(const CProtocolCapture::CMessageList&);
+	static void			usage();
+
+private:
+	// options
+	CString				m_path;
+	double				m_speed;
+	CString				m_logLevel;
+	bool				m_wireSize;
+
+	CProtocolCapture::ESide
+						m_side;
+	CProtocolCapture::CMessageList
+						m_messages;
+
+	IEventQueue*		m_events;
+	CReplaySocket*		m_socket;
+	CServer*			m_server;
+	bool				m_handshakeFailed;
+
+	// seconds to handle each message, by message code
+	CTimes				m_times;
+	double				m_replayTime;
+};
@@ -17,13 +17,19 @@
  */
 
 #include "synergy/ProtocolUtil.h"
+#include "synergy/MessageBroadcast.h"
 #include "io/IStream.h"
 #include "base/Log.h"
+#include "base/Metrics.h"
 #include "common/stdvector.h"
 
 #include <cctype>
 #include <cstring>
 
+// every message written, by code, whichever end of a connection or ipc
+// this process is
+static CCodeCounter		s_sent("protocol.sent");
+
 //
 // CProtocolUtil
 //
@@ -34,6 +40,7 @@ CProtocolUtil::writef(synergy::IStream* stream, const char* fmt, ...)
 	assert(stream != NULL);
 	assert(fmt != NULL);
 	LOG((CLOG_DEBUG2 "writef(%s)", fmt));
+	s_sent.add(reinterpret_cast<const UInt8*>(fmt));
 
 	va_list args;
 	va_start(args, fmt);
@@ -44,6 +51,117 @@ CProtocolUtil::writef(synergy::IStream* stream, const char* fmt, ...)
 	va_end(args);
 }
 
+void
+CProtocolUtil::writefBuffers(synergy::IStream* stream,
+				const CSharedBufferList& buffers, const char* fmt, ...)
+{
+	assert(stream != NULL);
+	assert(fmt != NULL);
+	LOG((CLOG_DEBUG2 "writefBuffers(%s)", fmt));
+	s_sent.add(reinterpret_cast<const UInt8*>(fmt));
+
+	// format everything before the final %s
+	const size_t fmtLength = strlen(fmt);
+	assert(fmtLength >= 2 && strcmp(fmt + fmtLength - 2, "%s") == 0);
+	const CString head(fmt, fmtLength - 2);
+
+	va_list args;
+	va_start(args, fmt);
+	UInt32 size = getLength(head.c_str(), args);
+	va_end(args);
+
+	CString header(size + 4, '\0');
+	UInt8* buffer = reinterpret_cast<UInt8*>(&header[0]);
+	va_start(args, fmt);
+	writef(buffer, head.c_str(), args);
+	va_end(args);
+
+	// then the string length
+	UInt32 len = 0;
+	for (CSharedBufferList::const_iterator i = buffers.begin();
+							i != buffers.end(); ++i) {
+		len += i->getSize();
+	}
+	buffer += size;
+	buffer[0] = static_cast<UInt8>((len >> 24) & 0xff);
+	buffer[1] = static_cast<UInt8>((len >> 16) & 0xff);
+	buffer[2] = static_cast<UInt8>((len >>  8) & 0xff);
+	buffer[3] = static_cast<UInt8>( len        & 0xff);
+
+	// and the string itself, still in its buffers
+	CSharedBufferList message;
+	message.reserve(buffers.size() + 1);
+	message.push_back(CSharedBuffer::adopt(header));
+	message.insert(message.end(), buffers.begin(), buffers.end());
+	stream->writeBuffers(message);
+	LOG((CLOG_DEBUG2 "wrote %d bytes", size + 4 + len));
+}
+
+void
+CProtocolUtil::writefBroadcast(synergy::IStream* stream,
+				CMessageBroadcast* broadcast, const char* fmt, ...)
+{
+	assert(stream != NULL);
+	assert(fmt != NULL);
+	s_sent.add(reinterpret_cast<const UInt8*>(fmt));
+
+	// format the message unless an earlier stream already did.  only
+	// log when formatting;  logging costs more than a shared write.
+	va_list args;
+	const CSharedBuffer* message = NULL;
+	if (broadcast != NULL) {
+		message = broadcast->find(fmt);
+	}
+	if (message == NULL) {
+		LOG((CLOG_DEBUG2 "writefBroadcast(%s)", fmt));
+		va_start(args, fmt);
+		UInt32 size = getLength(fmt, args);
+		va_end(args);
+
+		// not shared
+		if (broadcast == NULL) {
+			va_start(args, fmt);
+			vwritef(stream, fmt, size, args);
+			va_end(args);
+			return;
+		}
+
+		CString data(size, '\0');
+		if (size != 0) {
+			va_start(args, fmt);
+			writef(&data[0], fmt, args);
+			va_end(args);
+		}
+		message = &broadcast->add(fmt, CSharedBuffer::adopt(data));
+	}
+
+	// done if nothing to write
+	if (message->getSize() == 0) {
+		return;
+	}
+
+	stream->writeBuffers(CSharedBufferList(1, *message));
+}
+
+CString
+CProtocolUtil::formatf(const char* fmt, ...)
+{
+	assert(fmt != NULL);
+
+	va_list args;
+	va_start(args, fmt);
+	UInt32 size = getLength(fmt, args);
+	va_end(args);
+
+	CString data(size, '\0');
+	if (size != 0) {
+		va_start(args, fmt);
+		writef(&data[0], fmt, args);
+		va_end(args);
+	}
+	return data;
+}
+
 bool
 CProtocolUtil::readf(synergy::IStream* stream, const char* fmt, ...)
 {
@@ -199,50 +317,46 @@ CProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 				break;
 			}
 
+			case 'v': {
+				assert(len == 0);
+				UInt32* v = va_arg(args, UInt32*);
+				*v = readVarint(stream);
+				LOG((CLOG_DEBUG2 "readf: read varint: %u", *v));
+				break;
+			}
+
+			case 'z': {
+				assert(len == 0);
+				UInt32 u = readVarint(stream);
+				SInt32* v = va_arg(args, SInt32*);
+				*v = static_cast<SInt32>(u >> 1) ^ -static_cast<SInt32>(u & 1);
+				LOG((CLOG_DEBUG2 "readf: read zigzag varint: %d", *v));
+				break;
+			}
+
 			case 's': {
 				assert(len == 0);
 
 				// read the string length
-				UInt8 buffer[128];
+				UInt8 buffer[4];
 				read(stream, buffer, 4);
 				UInt32 len = (static_cast<UInt32>(buffer[0]) << 24) |
 							 (static_cast<UInt32>(buffer[1]) << 16) |
 							 (static_cast<UInt32>(buffer[2]) <<  8) |
 							  static_cast<UInt32>(buffer[3]);
 
-				// use a fixed size buffer if its big enough
-				const bool useFixed = (len <= sizeof(buffer));
-
-				// allocate a buffer to read the data
-				UInt8* sBuffer = buffer;
-				if (!useFixed) {
-					sBuffer = new UInt8[len];
-				}
-
-				// read the data
-				try {
-					read(stream, sBuffer, len);
-				}
-				catch (...) {
-					if (!useFixed) {
-						delete[] sBuffer;
-					}
-					throw;
+				// read the data straight into the string so large
+				// strings aren't copied
+				CString* dst = va_arg(args, CString*);
+				dst->resize(len);
+				if (len != 0) {
+					read(stream, &(*dst)[0], len);
 				}
 
 				// don't cause buffer overrun, using +100 chars in case
 				// someone modifies this log message in future.
 				if (len + 100 < kLogMessageLength) {
-					LOG((CLOG_DEBUG2 "readf: read %d byte string: %.*s", len, len, sBuffer));
-				}
-
-				// save the data
-				CString* dst = va_arg(args, CString*);
-				dst->assign((const char*)sBuffer, len);
-
-				// release the buffer
-				if (!useFixed) {
-					delete[] sBuffer;
+					LOG((CLOG_DEBUG2 "readf: read %d byte string: %.*s", len, len, dst->data()));
 				}
 				break;
 			}
@@ -307,6 +421,19 @@ CProtocolUtil::getLength(const char* fmt, va_list args)
 				}
 				break;
 
+			case 'v':
+				assert(len == 0);
+				len = getVarintLength(va_arg(args, UInt32));
+				break;
+
+			case 'z': {
+				assert(len == 0);
+				const SInt32 v = va_arg(args, SInt32);
+				len = getVarintLength((static_cast<UInt32>(v) << 1) ^
+										static_cast<UInt32>(v >> 31));
+				break;
+			}
+
 			case 's':
 				assert(len == 0);
 				len = (UInt32)(va_arg(args, CString*))->size() + 4;
@@ -441,6 +568,19 @@ CProtocolUtil::writef(void* buffer, const char* fmt, va_list args)
 				break;
 			}
 
+			case 'v':
+				assert(len == 0);
+				dst = writeVarint(dst, va_arg(args, UInt32));
+				break;
+
+			case 'z': {
+				assert(len == 0);
+				const SInt32 v = va_arg(args, SInt32);
+				dst = writeVarint(dst, (static_cast<UInt32>(v) << 1) ^
+										static_cast<UInt32>(v >> 31));
+				break;
+			}
+
 			case 's': {
 				assert(len == 0);
 				const CString* src = va_arg(args, CString*);
@@ -513,6 +653,46 @@ CProtocolUtil::eatLength(const char** pfmt)
 	}
 }
 
+UInt32
+CProtocolUtil::getVarintLength(UInt32 v)
+{
+	UInt32 n = 1;
+	while (v >= 0x80) {
+		v >>= 7;
+		++n;
+	}
+	return n;
+}
+
+UInt8*
+CProtocolUtil::writeVarint(UInt8* dst, UInt32 v)
+{
+	while (v >= 0x80) {
+		*dst++ = static_cast<UInt8>((v & 0x7f) | 0x80);
+		v >>= 7;
+	}
+	*dst++ = static_cast<UInt8>(v);
+	return dst;
+}
+
+UInt32
+CProtocolUtil::readVarint(synergy::IStream* stream)
+{
+	UInt32 v = 0;
+	for (UInt32 shift = 0; shift < 35; shift += 7) {
+		UInt8 byte;
+		read(stream, &byte, 1);
+		v |= static_cast<UInt32>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return v;
+		}
+	}
+
+	// more than 5 bytes can't be a 32 bit integer
+	LOG((CLOG_DEBUG2 "readf: varint too long"));
+	throw XIOReadMismatch();
+}
+
 void
 CProtocolUtil::read(synergy::IStream* stream, void* vbuffer, UInt32 count)
 {
@@ -19,11 +19,13 @@
 #pragma once
 
 #include "io/XIO.h"
+#include "io/SharedBuffer.h"
 #include "base/EventTypes.h"
 
 #include <stdarg.h>
 
 namespace synergy { class IStream; }
+class CMessageBroadcast;
 
 //! Synergy protocol utilities
 /*!
@@ -47,12 +49,50 @@ public:
 	- \%1I  -- converts std::vector<UInt8>* to 1 byte integers
 	- \%2I  -- converts std::vector<UInt16>* to 2 byte integers in NBO
 	- \%4I  -- converts std::vector<UInt32>* to 4 byte integers in NBO
+	- \%v   -- converts integer argument to a 1 to 5 byte varint
+	- \%z   -- converts signed integer argument to a zigzag varint
 	- \%s   -- converts CString* to stream of bytes
 	- \%S   -- converts integer N and const UInt8* to stream of N bytes
+
+	A varint holds 7 bits per byte, least significant first, with the
+	top bit set on every byte but the last.  A zigzag varint maps 0, -1,
+	1, -2, ... to 0, 1, 2, 3, ... first so small negative numbers are
+	short too.
 	*/
 	static void			writef(synergy::IStream*,
 							const char* fmt, ...);
 
+	//! Write formatted data and buffers
+	/*!
+	Like writef() except that the last format specifier in \c fmt must
+	be \%s and it has no argument.  Instead it's written as the bytes of
+	\c buffers, which are passed to IStream::writeBuffers() without
+	being copied into the message.  Use this for large messages.
+	*/
+	static void			writefBuffers(synergy::IStream*,
+							const CSharedBufferList& buffers,
+							const char* fmt, ...);
+
+	//! Write formatted data shared with other streams
+	/*!
+	Like writef() except that if \c broadcast already has a message for
+	\c fmt then those bytes are written instead, and otherwise the
+	message is formatted into \c broadcast for the next stream.  The
+	bytes are passed to IStream::writeBuffers() so streams can queue
+	them without copying.  If \c broadcast is NULL this is the same as
+	writef().
+	*/
+	static void			writefBroadcast(synergy::IStream*,
+							CMessageBroadcast* broadcast,
+							const char* fmt, ...);
+
+	//! Format data
+	/*!
+	Like writef() except that the bytes are returned instead of being
+	written to a stream.
+	*/
+	static CString		formatf(const char* fmt, ...);
+
 	//! Read formatted data
 	/*!
 	Read formatted binary data from a buffer.  This performs the
@@ -67,6 +107,8 @@ public:
 	- \%1I  -- reads 1 byte integers;  arg is std::vector<UInt8>*
 	- \%2I  -- reads NBO 2 byte integers;  arg is std::vector<UInt16>*
 	- \%4I  -- reads NBO 4 byte integers;  arg is std::vector<UInt32>*
+	- \%v   -- reads a varint;  arg is UInt32*
+	- \%z   -- reads a zigzag varint;  arg is SInt32*
 	- \%s   -- reads bytes;  argument must be a CString*, \b not a char*
 	*/
 	static bool			readf(synergy::IStream*,
@@ -81,6 +123,9 @@ private:
 	static UInt32		getLength(const char* fmt, va_list);
 	static void			writef(void*, const char* fmt, va_list);
 	static UInt32		eatLength(const char** fmt);
+	static UInt32		getVarintLength(UInt32);
+	static UInt8*		writeVarint(UInt8*, UInt32);
+	static UInt32		readVarint(synergy::IStream*);
 	static void			read(synergy::IStream*, void*, UInt32);
 };
 
@@ -0,0 +1,118 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/RetryScheduler.h"
+
+#include "arch/Arch.h"
+
+//
+// CRetryScheduler
+//
+
+CRetryScheduler::CRetryScheduler(double minDelay, double maxDelay) :
+	m_minDelay(minDelay),
+	m_maxDelay(maxDelay),
+	m_backoff(minDelay),
+	m_hint(0.0),
+	m_cleanClose(false),
+	m_attempts(0)
+{
+	// seed from the clock so clients started together still diverge
+	double now = ARCH->time();
+	setSeed(static_cast<UInt32>(now * 1000000.0) ^
+			static_cast<UInt32>(reinterpret_cast<size_t>(this)));
+}
+
+CRetryScheduler::~CRetryScheduler()
+{
+	// do nothing
+}
+
+void
+CRetryScheduler::reset()
+{
+	m_backoff    = m_minDelay;
+	m_hint       = 0.0;
+	m_cleanClose = false;
+	m_attempts   = 0;
+}
+
+double
+CRetryScheduler::next()
+{
+	++m_attempts;
+
+	// a clean close retries right away, over the hint's window if the
+	// peer sent one.  otherwise a hint from the peer wins.
+	double delay;
+	if (m_cleanClose) {
+		delay = (m_hint > 0.0 ? m_hint : m_minDelay) * random();
+	}
+	else if (m_hint > 0.0) {
+		delay = 0.5 * m_hint * (1.0 + random());
+	}
+	else {
+		delay = 0.5 * m_backoff * (1.0 + random());
+		m_backoff *= 2.0;
+		if (m_backoff > m_maxDelay) {
+			m_backoff = m_maxDelay;
+		}
+	}
+	m_hint       = 0.0;
+	m_cleanClose = false;
+	return delay;
+}
+
+void
+CRetryScheduler::setCleanClose()
+{
+	m_cleanClose = true;
+}
+
+void
+CRetryScheduler::setHint(double seconds)
+{
+	if (seconds > 0.0) {
+		m_hint = seconds;
+	}
+}
+
+void
+CRetryScheduler::setSeed(UInt32 seed)
+{
+	// scatter the bits so nearby seeds give unrelated sequences
+	m_seed = seed * 2654435761u;
+}
+
+UInt32
+CRetryScheduler::getAttempts() const
+{
+	return m_attempts;
+}
+
+double
+CRetryScheduler::random()
+{
+	// xorshift32;  doesn't need to be good, just cheap and per-instance
+	if (m_seed == 0) {
+		m_seed = 0x9e3779b9;
+	}
+	m_seed ^= m_seed << 13;
+	m_seed ^= m_seed >> 17;
+	m_seed ^= m_seed << 5;
+	return static_cast<double>(m_seed) / 4294967296.0;
+}
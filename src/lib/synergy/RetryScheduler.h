@@ -0,0 +1,103 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/basic_types.h"
+
+//! Retry delay scheduler
+/*!
+Chooses how long to wait before retrying a failed connection (or
+other operation).  Delays grow exponentially from a minimum to a
+maximum and are jittered so that many clients that lost the same
+server don't all retry at the same moment.  A clean close by the
+server or a retry hint sent by the server overrides the backoff for
+the next attempt;  a clean close takes priority.
+*/
+class CRetryScheduler {
+public:
+	CRetryScheduler(double minDelay, double maxDelay);
+	~CRetryScheduler();
+
+	//! @name manipulators
+	//@{
+
+	//! Reset the backoff
+	/*!
+	Call after a successful attempt.  The next delay starts over from
+	the minimum.
+	*/
+	void				reset();
+
+	//! Get the next delay
+	/*!
+	Returns the number of seconds to wait before the next attempt and
+	advances the backoff.  Without a hint the delay is uniformly chosen
+	between half and all of the current backoff, which doubles after
+	each attempt up to the maximum.
+	*/
+	double				next();
+
+	//! Note a clean close
+	/*!
+	The peer closed the connection deliberately, e.g. because it is
+	restarting, so the next attempt may be made right away.  The next
+	delay is uniformly chosen between zero and the retry hint, if there
+	is one, or the minimum delay.
+	*/
+	void				setCleanClose();
+
+	//! Set a retry hint
+	/*!
+	The peer asked us to wait about \p seconds.  The next delay is
+	uniformly chosen between half and all of \p seconds, or up to
+	\p seconds after a clean close.  A hint of zero is ignored.
+	*/
+	void				setHint(double seconds);
+
+	//! Seed the jitter
+	/*!
+	Jitter is seeded from the clock by default;  use this to make the
+	sequence of delays repeatable.
+	*/
+	void				setSeed(UInt32 seed);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get number of attempts
+	/*!
+	Returns the number of delays handed out since the last reset().
+	*/
+	UInt32				getAttempts() const;
+
+	//@}
+
+private:
+	// returns a number in [0, 1)
+	double				random();
+
+private:
+	double				m_minDelay;
+	double				m_maxDelay;
+	double				m_backoff;
+	double				m_hint;
+	bool				m_cleanClose;
+	UInt32				m_attempts;
+	UInt32				m_seed;
+};
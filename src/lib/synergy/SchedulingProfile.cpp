@@ -0,0 +1,164 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/SchedulingProfile.h"
+
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+// default priorities.  the real-time priority is low enough to stay
+// below kernel threads and audio servers.
+static const int		s_defaultNice     = -10;
+static const int		s_defaultRealtime = 10;
+
+//
+// CSchedulingProfile
+//
+
+CSchedulingProfile::CSchedulingProfile() :
+	m_policy(IArchMultithread::kSCHEDULE_NORMAL),
+	m_priority(0),
+	m_hasPriority(false),
+	m_cpu(-1),
+	m_lockMemory(false)
+{
+	// do nothing
+}
+
+CSchedulingProfile::~CSchedulingProfile()
+{
+	// do nothing
+}
+
+bool
+CSchedulingProfile::setPolicy(const CString& name)
+{
+	if (name == "normal") {
+		m_policy = IArchMultithread::kSCHEDULE_NORMAL;
+	}
+	else if (name == "nice") {
+		m_policy = IArchMultithread::kSCHEDULE_NICE;
+	}
+	else if (name == "rr") {
+		m_policy = IArchMultithread::kSCHEDULE_ROUND_ROBIN;
+	}
+	else if (name == "fifo") {
+		m_policy = IArchMultithread::kSCHEDULE_FIFO;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+void
+CSchedulingProfile::setPriority(int priority)
+{
+	m_priority    = priority;
+	m_hasPriority = true;
+}
+
+void
+CSchedulingProfile::setCPU(int cpu)
+{
+	m_cpu = cpu;
+}
+
+void
+CSchedulingProfile::setLockMemory(bool lock)
+{
+	m_lockMemory = lock;
+}
+
+bool
+CSchedulingProfile::isDefault() const
+{
+	return (m_policy == IArchMultithread::kSCHEDULE_NORMAL &&
+			m_cpu < 0 && !m_lockMemory);
+}
+
+IArchMultithread::ESchedulingPolicy
+CSchedulingProfile::getPolicy() const
+{
+	return m_policy;
+}
+
+int
+CSchedulingProfile::getPriority() const
+{
+	if (m_hasPriority) {
+		return m_priority;
+	}
+	switch (m_policy) {
+	case IArchMultithread::kSCHEDULE_NICE:
+		return s_defaultNice;
+
+	case IArchMultithread::kSCHEDULE_ROUND_ROBIN:
+	case IArchMultithread::kSCHEDULE_FIFO:
+		return s_defaultRealtime;
+
+	default:
+		return 0;
+	}
+}
+
+bool
+CSchedulingProfile::apply(CThread& thread, const char* name) const
+{
+	bool applied = true;
+	if (m_policy != IArchMultithread::kSCHEDULE_NORMAL) {
+		int priority = getPriority();
+		if (thread.setScheduling(m_policy, priority)) {
+			LOG((CLOG_DEBUG "%s thread scheduled with priority %d", name, priority));
+		}
+		else if (m_policy != IArchMultithread::kSCHEDULE_NICE &&
+				thread.setScheduling(IArchMultithread::kSCHEDULE_NICE,
+							s_defaultNice)) {
+			LOG((CLOG_NOTE "real-time scheduling not permitted, %s thread using niceness %d", name, s_defaultNice));
+			applied = false;
+		}
+		else {
+			LOG((CLOG_WARN "cannot raise priority of %s thread, using normal scheduling", name));
+			applied = false;
+		}
+	}
+
+	if (m_cpu >= 0) {
+		if (thread.setAffinity(m_cpu)) {
+			LOG((CLOG_DEBUG "%s thread pinned to cpu %d", name, m_cpu));
+		}
+		else {
+			LOG((CLOG_WARN "cannot pin %s thread to cpu %d", name, m_cpu));
+			applied = false;
+		}
+	}
+	return applied;
+}
+
+void
+CSchedulingProfile::applyToProcess() const
+{
+	if (m_lockMemory) {
+		if (ARCH->lockMemory()) {
+			LOG((CLOG_DEBUG "locked process memory"));
+		}
+		else {
+			LOG((CLOG_WARN "cannot lock process memory"));
+		}
+	}
+}
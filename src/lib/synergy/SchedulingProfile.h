@@ -0,0 +1,116 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "arch/IArchMultithread.h"
+#include "base/String.h"
+
+class CThread;
+
+//! Scheduling profile for input critical threads
+/*!
+Describes how the threads that carry input (the main event thread and
+the socket multiplexer thread) should be scheduled so that other work
+on a busy system doesn't delay them:  a scheduling policy and priority,
+optionally a CPU to pin them to and whether to lock the process in
+memory.  The default profile leaves scheduling alone.
+*/
+class CSchedulingProfile {
+public:
+	CSchedulingProfile();
+	~CSchedulingProfile();
+
+	//! @name manipulators
+	//@{
+
+	//! Set policy by name
+	/*!
+	Sets the policy from one of "normal", "nice", "rr" or "fifo".
+	Returns false if \p name isn't one of these.
+	*/
+	bool				setPolicy(const CString& name);
+
+	//! Set priority
+	/*!
+	Sets the niceness for the "nice" policy or the real-time priority
+	for "rr" and "fifo".  Each policy has a reasonable default.
+	*/
+	void				setPriority(int priority);
+
+	//! Set CPU
+	/*!
+	Pins the threads to CPU number \p cpu.  -1 (the default) doesn't
+	pin them.
+	*/
+	void				setCPU(int cpu);
+
+	//! Set memory locking
+	/*!
+	If \p lock is true then applyToProcess() locks the process into
+	memory.
+	*/
+	void				setLockMemory(bool lock);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test for default profile
+	/*!
+	Returns true iff the profile changes nothing.
+	*/
+	bool				isDefault() const;
+
+	//! Get policy
+	IArchMultithread::ESchedulingPolicy
+						getPolicy() const;
+
+	//! Get priority
+	/*!
+	Returns the priority set with setPriority() or the default for the
+	policy.
+	*/
+	int					getPriority() const;
+
+	//! Apply profile to a thread
+	/*!
+	Schedules \p thread according to the profile.  \p name describes
+	the thread in log messages.  If real-time scheduling isn't permitted
+	this falls back to a raised niceness and, if that isn't permitted
+	either, leaves the thread's scheduling alone.  Returns true iff the
+	requested policy was applied.  Threads that \p thread starts
+	afterwards don't inherit the profile.
+	*/
+	bool				apply(CThread& thread, const char* name) const;
+
+	//! Apply process wide settings
+	/*!
+	Locks the process into memory if requested.  Logs and carries on
+	if that isn't permitted.
+	*/
+	void				applyToProcess() const;
+
+	//@}
+
+private:
+	IArchMultithread::ESchedulingPolicy m_policy;
+	int					m_priority;
+	bool				m_hasPriority;
+	int					m_cpu;
+	bool				m_lockMemory;
+};
@@ -20,6 +20,7 @@
 
 #include "server/Server.h"
 #include "server/ClientListener.h"
+#include "server/MotionListener.h"
 #include "server/ClientProxy.h"
 #include "server/PrimaryClient.h"
 #include "synergy/Screen.h"
@@ -49,6 +50,7 @@
 #elif WINAPI_CARBON
 #include "platform/OSXScreen.h"
 #endif
+#include "platform/VirtualScreen.h"
 
 #if defined(__APPLE__)
 #include "platform/OSXDragSimulator.h"
@@ -56,6 +58,8 @@
 
 #include <iostream>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <fstream>
 
 //
@@ -69,7 +73,9 @@ CServerApp::CServerApp(IEventQueue* events, CreateTaskBarReceiverFunc createTask
 	m_serverScreen(NULL),
 	m_primaryClient(NULL),
 	m_listener(NULL),
-	m_timer(NULL)
+	m_motionListener(NULL),
+	m_timer(NULL),
+	m_retryScheduler(1.0, 10.0)
 {
 }
 
@@ -79,7 +85,11 @@ CServerApp::~CServerApp()
 
 CServerApp::CArgs::CArgs() :
 m_synergyAddress(NULL),
-m_config(NULL)
+m_config(NULL),
+m_connectBurst(0),
+m_ioThreads(1),
+m_motionLoss(0.0),
+m_batchDelay(0.0)
 {
 }
 
@@ -115,6 +125,57 @@ CServerApp::parseArg(const int& argc, const char* const* argv, int& i)
 		args().m_configFile = argv[++i];
 	}
 
+	else if (isArg(i, argc, argv, NULL, "--connect-burst", 1)) {
+		// save connections allowed at once from one address
+		int burst = atoi(argv[++i]);
+		if (burst <= 0) {
+			LOG((CLOG_PRINT "%s: invalid connection burst: %s" BYE,
+				args().m_pname, argv[i], args().m_pname));
+			m_bye(kExitArgs);
+		}
+		args().m_connectBurst = static_cast<UInt32>(burst);
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--io-threads", 1)) {
+		// save number of threads to read and write sockets on
+		int threads = atoi(argv[++i]);
+		if (threads <= 0) {
+			LOG((CLOG_PRINT "%s: invalid number of I/O threads: %s" BYE,
+				args().m_pname, argv[i], args().m_pname));
+			m_bye(kExitArgs);
+		}
+		args().m_ioThreads = static_cast<UInt32>(threads);
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--udp-motion-loss", 1)) {
+		// save percentage of motion datagrams to drop, for testing
+		double loss = atof(argv[++i]);
+		if (loss < 0.0 || loss > 100.0) {
+			LOG((CLOG_PRINT "%s: invalid loss percentage: %s" BYE,
+				args().m_pname, argv[i], args().m_pname));
+			m_bye(kExitArgs);
+		}
+		args().m_motionLoss = loss / 100.0;
+	}
+
+	else if (isArg(i, argc, argv, NULL, "--batch-delay", 1)) {
+		// save how long to hold input to send it in fewer packets
+		const char* delay = argv[++i];
+		if (strcmp(delay, "off") == 0) {
+			args().m_batchDelay = -1.0;
+		}
+		else {
+			char* end;
+			double ms = strtod(delay, &end);
+			if (end == delay || *end != '\0' || ms < 0.0 || ms > 100.0) {
+				LOG((CLOG_PRINT "%s: invalid batch delay: %s" BYE,
+					args().m_pname, delay, args().m_pname));
+				m_bye(kExitArgs);
+			}
+			args().m_batchDelay = ms / 1000.0;
+		}
+	}
+
 	else {
 		// option not supported here
 		return false;
@@ -170,12 +231,16 @@ CServerApp::help()
 #  define WINAPI_INFO
 #endif
 
-	char buffer[2000];
+	char buffer[4000];
 	sprintf(
 		buffer,
 		"Usage: %s"
 		" [--address <address>]"
 		" [--config <pathname>]"
+		" [--connect-burst <n>]"
+		" [--io-threads <n>]"
+		" [--udp-motion-loss <percent>]"
+		" [--batch-delay <ms>|off]"
 		WINAPI_ARGS
 		HELP_SYS_ARGS
 		HELP_COMMON_ARGS
@@ -184,6 +249,17 @@ CServerApp::help()
 		"\n"
 		"  -a, --address <address>  listen for clients on the given address.\n"
 		"  -c, --config <pathname>  use the named configuration file instead.\n"
+		"      --connect-burst <n>  let one address connect <n> times at once\n"
+		"                             (default 8), then once a second.\n"
+		"      --io-threads <n>     read and write client sockets on <n>\n"
+		"                             threads (default 1).\n"
+		"      --udp-motion-loss <percent>\n"
+		"                           drop <percent> of the mouse motion sent\n"
+		"                             over UDP, for testing.\n"
+		"      --batch-delay <ms>|off\n"
+		"                           hold input for clients up to <ms> to send\n"
+		"                             it in fewer packets (default 0, just\n"
+		"                             while handling one event).\n"
 		HELP_COMMON_INFO_1
 		WINAPI_INFO
 		HELP_SYS_INFO
@@ -220,12 +296,21 @@ void
 CServerApp::reloadConfig(const CEvent&, void*)
 {
 	LOG((CLOG_DEBUG "reload configuration"));
-	if (loadConfig(args().m_configFile)) {
-		if (m_server != NULL) {
-			m_server->setConfig(*args().m_config);
-		}
-		LOG((CLOG_NOTE "reloaded configuration"));
+
+	// read into a separate configuration so the server can work out
+	// what changed and apply only that.
+	CConfig config(m_events);
+	if (!readConfig(args().m_configFile, config)) {
+		return;
 	}
+	if (m_server == NULL) {
+		*args().m_config = config;
+	}
+	else if (!m_server->updateConfig(config)) {
+		LOG((CLOG_ERR "cannot reload configuration: it does not include this screen"));
+		return;
+	}
+	LOG((CLOG_NOTE "reloaded configuration"));
 }
 
 void
@@ -273,6 +358,12 @@ CServerApp::loadConfig()
 
 bool
 CServerApp::loadConfig(const CString& pathname)
+{
+	return readConfig(pathname, *args().m_config);
+}
+
+bool
+CServerApp::readConfig(const CString& pathname, CConfig& config)
 {
 	try {
 		// load configuration
@@ -286,7 +377,7 @@ CServerApp::loadConfig(const CString& pathname)
 				pathname.c_str()));
 			return false;
 		}
-		configStream >> *args().m_config;
+		configStream >> config;
 		LOG((CLOG_DEBUG "configuration read successfully"));
 		return true;
 	}
@@ -390,8 +481,10 @@ CServerApp::stopServer()
 	if (m_serverState == kStarted) {
 		closeClientListener(m_listener);
 		closeServer(m_server);
-		m_server      = NULL;
-		m_listener    = NULL;
+		delete m_motionListener;
+		m_server         = NULL;
+		m_listener       = NULL;
+		m_motionListener = NULL;
 		m_serverState = kInitialized;
 	}
 	else if (m_serverState == kStarting) {
@@ -506,6 +599,7 @@ bool CServerApp::initServer()
 		m_serverScreen  = serverScreen;
 		m_primaryClient = primaryClient;
 		m_serverState   = kInitialized;
+		m_retryScheduler.reset();
 		updateStatus();
 		return true;
 	}
@@ -514,7 +608,8 @@ bool CServerApp::initServer()
 		closePrimaryClient(primaryClient);
 		closeServerScreen(serverScreen);
 		updateStatus(CString("primary screen unavailable: ") + e.what());
-		retryTime = e.getRetryTime();
+		m_retryScheduler.setHint(e.getRetryTime());
+		retryTime = m_retryScheduler.next();
 	}
 	catch (XScreenOpenFailure& e) {
 		LOG((CLOG_CRIT "failed to start server: %s", e.what()));
@@ -532,7 +627,7 @@ bool CServerApp::initServer()
 	if (args().m_restartable) {
 		// install a timer and handler to retry later
 		assert(m_timer == NULL);
-		LOG((CLOG_DEBUG "retry in %.0f seconds", retryTime));
+		LOG((CLOG_DEBUG "retry in %.1f seconds", retryTime));
 		m_timer = m_events->newOneShotTimer(retryTime, NULL);
 		m_events->adoptHandler(CEvent::kTimer, m_timer,
 			new TMethodEventJob<CServerApp>(this, &CServerApp::retryHandler));
@@ -593,16 +688,21 @@ CServerApp::startServer()
 		m_server   = openServer(*args().m_config, m_primaryClient);
 		listener->setServer(m_server);
 		m_listener = listener;
+		m_motionListener = openMotionListener(
+							args().m_config->getSynergyAddress());
+		m_server->setMotionListener(m_motionListener);
+		m_server->setBatchDelay(args().m_batchDelay);
 		updateStatus();
 		LOG((CLOG_NOTE "started server, waiting for clients"));
 		m_serverState = kStarted;
+		m_retryScheduler.reset();
 		return true;
 	}
 	catch (XSocketAddressInUse& e) {
 		LOG((CLOG_WARN "cannot listen for clients: %s", e.what()));
 		closeClientListener(listener);
 		updateStatus(CString("cannot listen for clients: ") + e.what());
-		retryTime = 10.0;
+		retryTime = m_retryScheduler.next();
 	}
 	catch (XBase& e) {
 		LOG((CLOG_CRIT "failed to start server: %s", e.what()));
@@ -613,7 +713,7 @@ CServerApp::startServer()
 	if (args().m_restartable) {
 		// install a timer and handler to retry later
 		assert(m_timer == NULL);
-		LOG((CLOG_DEBUG "retry in %.0f seconds", retryTime));
+		LOG((CLOG_DEBUG "retry in %.1f seconds", retryTime));
 		m_timer = m_events->newOneShotTimer(retryTime, NULL);
 		m_events->adoptHandler(CEvent::kTimer, m_timer,
 			new TMethodEventJob<CServerApp>(this, &CServerApp::retryHandler));
@@ -629,6 +729,12 @@ CServerApp::startServer()
 CScreen* 
 CServerApp::createScreen()
 {
+	if (args().m_virtualScreen) {
+		return new CScreen(new CVirtualScreen(m_events, true,
+			args().m_virtualWidth, args().m_virtualHeight,
+			args().m_virtualInput, args().m_virtualRecord), m_events);
+	}
+
 #if WINAPI_MSWINDOWS
 	return new CScreen(new CMSWindowsScreen(
 		true, args().m_noHooks, args().m_stopOnDeskSwitch, m_events), m_events);
@@ -684,6 +790,10 @@ CServerApp::openClientListener(const CNetworkAddress& address)
 		NULL,
 		args().m_crypto,
 		m_events);
+	if (args().m_connectBurst != 0) {
+		listen->setSourceBurst(args().m_connectBurst);
+	}
+	listen->setCapturePath(args().m_capturePath);
 	
 	m_events->adoptHandler(
 		m_events->forCClientListener().connected(), listen,
@@ -693,6 +803,28 @@ CServerApp::openClientListener(const CNetworkAddress& address)
 	return listen;
 }
 
+CMotionListener*
+CServerApp::openMotionListener(const CNetworkAddress& address)
+{
+	if (!args().m_udpMotion) {
+		return NULL;
+	}
+
+	// clients still work without the motion channel, so don't fail
+	try {
+		CMotionListener* listen = new CMotionListener(
+			address,
+			new CTCPSocketFactory(m_events, getSocketMultiplexer()),
+			m_events);
+		listen->setLoss(args().m_motionLoss);
+		return listen;
+	}
+	catch (XBase& e) {
+		LOG((CLOG_WARN "cannot listen for mouse motion: %s", e.what()));
+		return NULL;
+	}
+}
+
 CServer* 
 CServerApp::openServer(CConfig& config, CPrimaryClient* primaryClient)
 {
@@ -730,8 +862,9 @@ CServerApp::mainLoop()
 {
 	// create socket multiplexer.  this must happen after daemonization
 	// on unix because threads evaporate across a fork().
-	CSocketMultiplexer multiplexer;
+	CSocketMultiplexer multiplexer(args().m_ioThreads);
 	setSocketMultiplexer(&multiplexer);
+	applySchedulingProfile();
 
 	// if configuration has no screens then add this system
 	// as the default
@@ -25,6 +25,7 @@
 #include "arch/Arch.h"
 #include "arch/IArchMultithread.h"
 #include "synergy/ArgsBase.h"
+#include "synergy/RetryScheduler.h"
 #include "base/EventTypes.h"
 
 #include <map>
@@ -41,6 +42,7 @@ enum EServerState {
 class CServer;
 class CScreen;
 class CClientListener;
+class CMotionListener;
 class CEventQueueTimer;
 class ILogOutputter;
 class IEventQueue;
@@ -56,6 +58,10 @@ public:
 		CString	m_configFile;
 		CNetworkAddress* m_synergyAddress;
 		CConfig* m_config;
+		UInt32 m_connectBurst;
+		UInt32 m_ioThreads;
+		double m_motionLoss;
+		double m_batchDelay;
 	};
 
 	CServerApp(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBarReceiver);
@@ -79,6 +85,7 @@ public:
 	void reloadConfig(const CEvent&, void*);
 	void loadConfig();
 	bool loadConfig(const CString& pathname);
+	bool readConfig(const CString& pathname, CConfig& config);
 	void forceReconnect(const CEvent&, void*);
 	void resetServer(const CEvent&, void*);
 	void handleClientConnected(const CEvent&, void* vlistener);
@@ -101,6 +108,7 @@ public:
 	void handleSuspend(const CEvent&, void*);
 	void handleResume(const CEvent&, void*);
 	CClientListener* openClientListener(const CNetworkAddress& address);
+	CMotionListener* openMotionListener(const CNetworkAddress& address);
 	CServer* openServer(CConfig& config, CPrimaryClient* primaryClient);
 	void handleNoClients(const CEvent&, void*);
 	bool startServer();
@@ -119,7 +127,9 @@ public:
 	CScreen*			m_serverScreen;
 	CPrimaryClient*		m_primaryClient;
 	CClientListener*	m_listener;
+	CMotionListener*	m_motionListener;
 	CEventQueueTimer*	m_timer;
+	CRetryScheduler		m_retryScheduler;
 
 private:
 	virtual bool parseArg(const int& argc, const char* const* argv, int& i);
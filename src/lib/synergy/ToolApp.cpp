@@ -16,6 +16,9 @@
  */
 
 #include "synergy/ToolApp.h"
+#include "synergy/LoadGenerator.h"
+#include "synergy/MetricsMonitor.h"
+#include "synergy/ProtocolReplay.h"
 #include "arch/Arch.h"
 #include "base/String.h"
 
@@ -46,6 +49,15 @@ CToolApp::run(int argc, char** argv)
 				premiumAuth();
 				return kErrorOk;
 			}
+			else if (strcmp(argv[i], "--load-test") == 0) {
+				return loadTest(argv[0], argc - i - 1, argv + i + 1);
+			}
+			else if (strcmp(argv[i], "--replay") == 0) {
+				return replay(argc - i - 1, argv + i + 1);
+			}
+			else if (strcmp(argv[i], "--metrics") == 0) {
+				return metrics(argc - i - 1, argv + i + 1);
+			}
 			else {
 				std::cerr << "unknown arg: " << argv[i] << std::endl;
 				return kErrorArgs;
@@ -81,3 +93,33 @@ CToolApp::premiumAuth()
 
 	std::cout << ARCH->internet().get(ss.str()) << std::endl;
 }
+
+UInt32
+CToolApp::loadTest(const char* toolPath, int argc, char** argv)
+{
+	CLoadGenerator generator(toolPath);
+	if (!generator.parseArgs(argc, argv)) {
+		return kErrorArgs;
+	}
+	return generator.run() ? kErrorOk : kErrorUnknown;
+}
+
+UInt32
+CToolApp::replay(int argc, char** argv)
+{
+	CProtocolReplay replay;
+	if (!replay.parseArgs(argc, argv)) {
+		return kErrorArgs;
+	}
+	return replay.run() ? kErrorOk : kErrorUnknown;
+}
+
+UInt32
+CToolApp::metrics(int argc, char** argv)
+{
+	CMetricsMonitor monitor;
+	if (!monitor.parseArgs(argc, argv)) {
+		return kErrorArgs;
+	}
+	return monitor.run() ? kErrorOk : kErrorUnknown;
+}
@@ -25,4 +25,8 @@ public:
 
 private:
 	void				premiumAuth();
+	UInt32				loadTest(const char* toolPath,
+							int argc, char** argv);
+	UInt32				replay(int argc, char** argv);
+	UInt32				metrics(int argc, char** argv);
 };
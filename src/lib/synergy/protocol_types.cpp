@@ -22,6 +22,7 @@ const char*				kMsgHello			= "Synergy%2i%2i";
 const char*				kMsgHelloBack		= "Synergy%2i%2i%s";
 const char*				kMsgCNoop 			= "CNOP";
 const char*				kMsgCClose 			= "CBYE";
+const char*				kMsgCCloseRetry		= "CBYE%4i";
 const char*				kMsgCEnter 			= "CINN%2i%2i%4i%2i";
 const char*				kMsgCLeave 			= "COUT";
 const char*				kMsgCClipboard 		= "CCLP%1i%4i";
@@ -29,6 +30,7 @@ const char*				kMsgCScreenSaver 	= "CSEC%1i";
 const char*				kMsgCResetOptions	= "CROP";
 const char*				kMsgCInfoAck		= "CIAK";
 const char*				kMsgCKeepAlive		= "CALV";
+const char*				kMsgCMotionChannel	= "CUDP%4i";
 const char*				kMsgDKeyDown		= "DKDN%2i%2i%2i";
 const char*				kMsgDKeyDown1_0		= "DKDN%2i%2i";
 const char*				kMsgDKeyRepeat		= "DKRP%2i%2i%2i%2i";
@@ -39,6 +41,7 @@ const char*				kMsgDMouseDown		= "DMDN%1i";
 const char*				kMsgDMouseUp		= "DMUP%1i";
 const char*				kMsgDMouseMove		= "DMMV%2i%2i";
 const char*				kMsgDMouseRelMove	= "DMRM%2i%2i";
+const char*				kMsgDMouseMoveSeq	= "DMMS%4i%1i%4i%4i";
 const char*				kMsgDMouseWheel		= "DMWM%2i%2i";
 const char*				kMsgDMouseWheel1_0	= "DMWM%2i";
 const char*				kMsgDClipboard		= "DCLP%1i%4i%s";
@@ -47,8 +50,19 @@ const char*				kMsgDSetOptions		= "DSOP%4I";
 const char*				kMsgDCryptoIv		= "DCIV%s";
 const char*				kMsgDFileTransfer	= "DFTR%1i%s";
 const char*				kMsgDDragInfo		= "DDRG%2i%s";
+const char*				kMsgDCompactMouseMove		= "\001%z%z";
+const char*				kMsgDCompactMouseRelMove	= "\002%z%z";
+const char*				kMsgDCompactMouseDown		= "\003%1i";
+const char*				kMsgDCompactMouseUp			= "\004%1i";
+const char*				kMsgDCompactMoveMouseDown	= "\005%z%z%1i";
+const char*				kMsgDCompactMoveMouseUp		= "\006%z%z%1i";
+const char*				kMsgDCompactMouseWheel		= "\007%z%z";
+const char*				kMsgDCompactKeyDown			= "\010%v%v%v";
+const char*				kMsgDCompactKeyRepeat		= "\011%v%v%v%v";
+const char*				kMsgDCompactKeyUp			= "\012%v%v%v";
 const char*				kMsgQInfo			= "QINF";
 const char*				kMsgEIncompatible	= "EICV%2i%2i";
 const char*				kMsgEBusy 			= "EBSY";
+const char*				kMsgEBusyRetry		= "EBSY%4i";
 const char*				kMsgEUnknown		= "EUNK";
 const char*				kMsgEBad			= "EBAD";
@@ -27,9 +27,14 @@
 // 1.3:  adds keep alive and deprecates heartbeats,
 //       adds horizontal mouse scrolling
 // 1.4:  adds crypto support
+// 1.5:  adds file transfer and drag and drop
+// 1.6:  adds the mouse motion side-channel and retry hints on
+//       close and busy
+// 1.7:  adds compact input messages
+// 1.8:  lets the server send several messages in one packet
 // NOTE: with new version, synergy minor version should increment
 static const SInt16		kProtocolMajorVersion = 1;
-static const SInt16		kProtocolMinorVersion = 5;
+static const SInt16		kProtocolMinorVersion = 8;
 
 // default contact port number
 static const UInt16		kDefaultPort = 24800;
@@ -68,11 +73,13 @@ enum EDirectionMask {
 	kBottomMask = 1 << kBottom
 };
 
-// file transfer constants
+// file transfer constants.  peers ignore marks they don't know.
 enum EFileTransfer {
 	kFileStart = 1,
 	kFileChunk = 2,
-	kFileEnd = 3
+	kFileEnd = 3,
+	kFileCheck = 4,
+	kFileResume = 5
 };
 
 
@@ -80,7 +87,12 @@ enum EFileTransfer {
 // message codes (trailing NUL is not part of code).  in comments, $n
 // refers to the n'th argument (counting from one).  message codes are
 // always 4 bytes optionally followed by message specific parameters
-// except those for the greeting handshake.
+// except those for the greeting handshake and the compact input
+// messages, whose codes are 1 byte below kMsgCompactLimit.
+//
+// each packet on the stream holds one message, except that from 1.8 a
+// packet from the server may hold several, a frame.  messages are
+// never split across packets.
 //
 
 //
@@ -113,6 +125,12 @@ extern const char*		kMsgCNoop;
 // close connection;  primary -> secondary
 extern const char*		kMsgCClose;
 
+// close connection with retry hint;  primary -> secondary
+// same as kMsgCClose but $1 = milliseconds over which the secondary
+// should spread its reconnect, which it may make right away.  only sent to secondaries at 1.6 or
+// later;  older secondaries get plain kMsgCClose.
+extern const char*		kMsgCCloseRetry;
+
 // enter screen:  primary -> secondary
 // entering screen at screen position $1 = x, $2 = y.  x,y are
 // absolute screen coordinates.  $3 = sequence number, which is
@@ -163,6 +181,17 @@ extern const char*		kMsgCInfoAck;
 // defined by an option.
 extern const char*		kMsgCKeepAlive;
 
+// mouse motion channel:  primary -> secondary
+// $1 = token.  offers a datagram channel for mouse motion on the
+// primary's port (see CMotionChannel).  a secondary that wants it
+// sends kReport datagrams with token $1 to the primary's address, at
+// least every second, and the primary then sends mouse motion as
+// datagrams while the reports keep coming.  the primary falls back to
+// kMsgDMouseMoveSeq when they stop or show the datagrams aren't getting
+// through.  a secondary that doesn't want the
+// channel ignores this message.
+extern const char*		kMsgCMotionChannel;
+
 //
 // data codes
 //
@@ -213,6 +242,14 @@ extern const char*		kMsgDMouseMove;
 // $1 = dx, $2 = dy.  dx,dy are motion deltas.
 extern const char*		kMsgDMouseRelMove;
 
+// sequenced mouse move:  primary -> secondary
+// $1 = sequence number, $2 = CMotionChannel::EType, $3, $4 = absolute
+// position or relative motion totals.  the same as a motion datagram
+// but sent on the stream, when the motion channel is down or to make
+// sure the latest motion arrived before a button or key event.  the
+// secondary ignores it if it already applied a higher sequence number.
+extern const char*		kMsgDMouseMoveSeq;
+
 // mouse scroll:  primary -> secondary
 // $1 = xDelta, $2 = yDelta.  the delta should be +120 for one tick forward
 // (away from the user) or right and -120 for one tick backward (toward
@@ -258,9 +295,12 @@ extern const char*		kMsgDCryptoIv;
 
 // file data:  primary <-> secondary
 // transfer file data. A mark is used in the first byte.
-// 0 means the content followed is the file size.
-// 1 means the content followed is the chunk data.
-// 2 means the file transfer is finished.
+// kFileStart means the content followed is the file header.
+// kFileChunk means the content followed is the chunk data.
+// kFileEnd means the file is finished.
+// kFileCheck means the content followed is the chunk checksum.
+// kFileResume (receiver -> sender) asks to resume a transfer.
+// see CFileChunker for the content of each.
 extern const char*		kMsgDFileTransfer;
 
 // drag infomation:  primary <-> secondary
@@ -269,6 +309,61 @@ extern const char*		kMsgDFileTransfer;
 // of each object's directory.
 extern const char*		kMsgDDragInfo;
 
+//
+// compact input messages
+//
+// sent instead of the data codes above to secondaries that support
+// protocol 1.7 or later.  the code is 1 byte and integers are varints
+// (%v) or zigzag varints (%z) so small values take 1 byte.  absolute
+// positions are sent as the difference from the last position sent
+// in a compact message or kMsgCEnter.
+//
+
+// the 4 byte message codes all start with a letter, so a code byte
+// below this is a compact message
+static const UInt8		kMsgCompactLimit = 0x20;
+
+// mouse moved:  primary -> secondary
+// $1 = dx, $2 = dy from the last position.
+extern const char*		kMsgDCompactMouseMove;
+
+// relative mouse move:  primary -> secondary
+// $1 = dx, $2 = dy.  dx,dy are motion deltas.
+extern const char*		kMsgDCompactMouseRelMove;
+
+// mouse button pressed:  primary -> secondary
+// $1 = ButtonID
+extern const char*		kMsgDCompactMouseDown;
+
+// mouse button released:  primary -> secondary
+// $1 = ButtonID
+extern const char*		kMsgDCompactMouseUp;
+
+// mouse moved then button pressed:  primary -> secondary
+// $1 = dx, $2 = dy from the last position, $3 = ButtonID.  the same as
+// kMsgDCompactMouseMove followed by kMsgDCompactMouseDown.
+extern const char*		kMsgDCompactMoveMouseDown;
+
+// mouse moved then button released:  primary -> secondary
+// $1 = dx, $2 = dy from the last position, $3 = ButtonID
+extern const char*		kMsgDCompactMoveMouseUp;
+
+// mouse scroll:  primary -> secondary
+// $1 = xDelta, $2 = yDelta, as kMsgDMouseWheel
+extern const char*		kMsgDCompactMouseWheel;
+
+// key pressed:  primary -> secondary
+// $1 = KeyID, $2 = KeyModifierMask, $3 = KeyButton, as kMsgDKeyDown
+extern const char*		kMsgDCompactKeyDown;
+
+// key auto-repeat:  primary -> secondary
+// $1 = KeyID, $2 = KeyModifierMask, $3 = number of repeats, $4 = KeyButton
+extern const char*		kMsgDCompactKeyRepeat;
+
+// key released:  primary -> secondary
+// $1 = KeyID, $2 = KeyModifierMask, $3 = KeyButton
+extern const char*		kMsgDCompactKeyUp;
+
 //
 // query codes
 //
@@ -289,6 +384,12 @@ extern const char*		kMsgEIncompatible;
 // name provided when connecting is already in use:  primary -> secondary
 extern const char*		kMsgEBusy;
 
+// name in use with retry hint:  primary -> secondary
+// same as kMsgEBusy but $1 = milliseconds the secondary should wait
+// (roughly) before trying again.  only sent to secondaries at 1.6 or
+// later;  older secondaries get plain kMsgEBusy.
+extern const char*		kMsgEBusyRetry;
+
 // unknown client:  primary -> secondary
 // name provided when connecting is not in primary's screen
 // configuration map.
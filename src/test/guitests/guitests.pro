@@ -7,9 +7,11 @@ CONFIG -= app_bundle
 TEMPLATE = app
 INCLUDEPATH += ../../gui/src
 SOURCES += src/main.cpp \
-    src/VersionCheckerTests.cpp
+    src/VersionCheckerTests.cpp \
+    src/IpcReaderTests.cpp
 HEADERS += src/VersionCheckerTests.h \
-    src/VersionChecker.h
+    src/VersionChecker.h \
+    src/IpcReaderTests.h
 win32 { 
     Debug:DESTDIR = ../../../bin/Debug
     Release:DESTDIR = ../../../bin/Release
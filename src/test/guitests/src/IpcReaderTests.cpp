@@ -0,0 +1,127 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "IpcReaderTests.h"
+#include "IpcReader.cpp"
+#include "LogModel.cpp"
+#include "Ipc.cpp"
+#include "../../gui/tmp/debug/moc_IpcReader.cpp"
+#include "../../gui/tmp/debug/moc_LogModel.cpp"
+
+#include <QtTest/QTest>
+#include <QtTest/QSignalSpy>
+#include <QElapsedTimer>
+
+// a log line message as the daemon sends it
+static QByteArray logLineMessage(const QString& text)
+{
+	QByteArray utf8 = text.toUtf8();
+	int len = utf8.size();
+
+	QByteArray message(kIpcMsgLogLine, 4);
+	message.append(char((len >> 24) & 0xff));
+	message.append(char((len >> 16) & 0xff));
+	message.append(char((len >> 8) & 0xff));
+	message.append(char(len & 0xff));
+	message.append(utf8);
+	return message;
+}
+
+void IpcReaderTests::append_partialMessages()
+{
+	IpcReader reader(NULL);
+	QSignalSpy spy(&reader, SIGNAL(readLogLine(const QString&)));
+
+	QByteArray data = logLineMessage("first") + logLineMessage("second");
+
+	// one byte at a time, nothing until a message is whole
+	for (int i = 0; i < data.size(); i++) {
+		reader.append(data.mid(i, 1));
+		QCOMPARE(spy.count(), i < 12 ? 0 : (i < data.size() - 1 ? 1 : 2));
+	}
+
+	QCOMPARE(spy.at(0).at(0).toString(), QString("first"));
+	QCOMPARE(spy.at(1).at(0).toString(), QString("second"));
+}
+
+void IpcReaderTests::append_invalidMessage()
+{
+	IpcReader reader(NULL);
+	QSignalSpy lineSpy(&reader, SIGNAL(readLogLine(const QString&)));
+	QSignalSpy errorSpy(&reader, SIGNAL(errorMessage(const QString&)));
+
+	// reported to the log, not the console, and then reading goes on
+	reader.append(QByteArray("JUNKJUNK"));
+	QCOMPARE(errorSpy.count(), 1);
+	QCOMPARE(lineSpy.count(), 0);
+
+	reader.append(logLineMessage("after"));
+	QCOMPARE(lineSpy.count(), 1);
+	QCOMPARE(lineSpy.at(0).at(0).toString(), QString("after"));
+}
+
+void IpcReaderTests::append_stress()
+{
+	// 100k lines in chunks of 100, as the log outputter sends them
+	const int chunks = 1000;
+	const int linesPerChunk = 100;
+
+	QByteArray data;
+	for (int i = 0; i < chunks; i++) {
+		QStringList lines;
+		for (int j = 0; j < linesPerChunk; j++) {
+			lines.append(QString("[2014-01-01T12:00:00] DEBUG: log line %1 of the stress test")
+				.arg(i * linesPerChunk + j));
+		}
+		data.append(logLineMessage(lines.join("\n")));
+	}
+
+	IpcReader reader(NULL);
+	LogModel model;
+	QObject::connect(&reader, SIGNAL(readLogLine(const QString&)),
+		&model, SLOT(appendLines(const QString&)));
+
+	// reads rarely line up with messages
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < data.size(); i += 1000) {
+		reader.append(data.mid(i, 1000));
+	}
+	qint64 elapsed = timer.elapsed();
+
+	qDebug("%d lines in %lldms", chunks * linesPerChunk, elapsed);
+
+	QCOMPARE(model.rowCount(), int(LogModel::kDefaultCapacity));
+	QCOMPARE(model.line(model.rowCount() - 1),
+		QString("[2014-01-01T12:00:00] DEBUG: log line 99999 of the stress test"));
+
+	// must keep up with 100k lines per second
+	QVERIFY(elapsed < 1000);
+}
+
+void IpcReaderTests::logModel_text()
+{
+	LogModel model(3);
+	model.appendLines("one\ntwo\nthree\nfour");
+
+	// selected in any order, copied oldest first
+	QModelIndexList indexes;
+	indexes.append(model.index(2));
+	indexes.append(model.index(0));
+	QCOMPARE(model.text(indexes), QString("two\nfour"));
+}
@@ -1,11 +1,11 @@
 /*
  * synergy -- mouse and keyboard sharing utility
  * Copyright (C) 2014 Bolton Software Ltd.
- * 
+ *
  * This package is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
  * found in the file COPYING that should have accompanied this file.
- * 
+ *
  * This package is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
@@ -15,13 +15,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #pragma once
 
-#include "synergy/DragInformation.h"
-#include "base/String.h"
+#include <QObject>
 
-class CDropHelper {
-public:
-	static void			writeToDir(const CString& destination,
-							CDragFileList& fileList, CString& data);
+class IpcReaderTests : public QObject
+{
+	Q_OBJECT
+private slots:
+	void append_partialMessages();
+	void append_invalidMessage();
+	void append_stress();
+	void logModel_text();
 };
@@ -18,9 +18,13 @@
 
 #include <QtTest/QTest>
 #include "VersionCheckerTests.h"
+#include "IpcReaderTests.h"
 
 int main(int argc, char *argv[])
 {
 	VersionCheckerTests versionCheckerTests;
 	QTest::qExec(&versionCheckerTests, argc, argv);
+
+	IpcReaderTests ipcReaderTests;
+	QTest::qExec(&ipcReaderTests, argc, argv);
 }
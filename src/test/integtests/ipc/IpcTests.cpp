@@ -29,6 +29,9 @@
 #include "ipc/IpcClientProxy.h"
 #include "ipc/Ipc.h"
 #include "net/SocketMultiplexer.h"
+#include "net/LocalSocketFactory.h"
+#include "net/TCPSocketFactory.h"
+#include "net/NetworkAddress.h"
 #include "mt/Thread.h"
 #include "arch/Arch.h"
 #include "base/TMethodJob.h"
@@ -36,11 +39,25 @@
 #include "base/Log.h"
 #include "base/EventQueue.h"
 #include "base/TMethodEventJob.h"
+#include "base/Stopwatch.h"
+#include "base/Metrics.h"
 
 #include "test/global/gtest.h"
 
+#include <algorithm>
+#include <vector>
+#include <ctime>
+#if SYSAPI_UNIX
+#	include <stdlib.h>
+#	include <unistd.h>
+#endif
+
 #define TEST_IPC_PORT 24802
 
+// the log outputter sends lines in chunks of this many
+const int g_ipc_linesPerChunk = 100;
+const int g_ipc_numLines      = 1000000;
+
 class CIpcTests : public ::testing::Test
 {
 public:
@@ -51,6 +68,11 @@ public:
 	void				sendMessageToServer_serverHandleMessageReceived(const CEvent&, void*);
 	void				sendMessageToClient_serverHandleClientConnected(const CEvent&, void*);
 	void				sendMessageToClient_clientHandleMessageReceived(const CEvent&, void*);
+	void				sendLogLines(const char* name, CIpcServer& server, CIpcClient& client);
+	void				sendLogLines_serverHandleMessageReceived(const CEvent&, void*);
+	void				sendLogLines_clientHandleMessageReceived(const CEvent&, void*);
+	void				sendMetrics_serverHandleMessageReceived(const CEvent&, void*);
+	void				sendMetrics_monitorHandleMessageReceived(const CEvent&, void*);
 
 public:
 	CSocketMultiplexer	m_multiplexer;
@@ -61,6 +83,12 @@ public:
 	CString				m_sendMessageToClient_receivedString;
 	CIpcClient*			m_sendMessageToServer_client;
 	CIpcServer*			m_sendMessageToClient_server;
+	CIpcServer*			m_sendLogLines_server;
+	int					m_sendLogLines_receivedLines;
+	CIpcServer*			m_sendMetrics_server;
+	CIpcClient*			m_sendMetrics_node;
+	int					m_sendMetrics_hellos;
+	CString				m_sendMetrics_snapshot;
 	CTestEventQueue		m_events;
 
 };
@@ -143,12 +171,125 @@ TEST_F(CIpcTests, sendMessageToClient)
 	EXPECT_EQ("test", m_sendMessageToClient_receivedString);
 }
 
+TEST_F(CIpcTests, sendLogLines_tcp)
+{
+	CSocketMultiplexer socketMultiplexer;
+	CIpcServer server(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+	server.listen();
+
+	CIpcClient client(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+	sendLogLines("tcp", server, client);
+
+	EXPECT_EQ(g_ipc_numLines, m_sendLogLines_receivedLines);
+}
+
+#if SYSAPI_UNIX
+TEST_F(CIpcTests, sendLogLines_local)
+{
+	// a fresh directory so tests running at once don't share a socket
+	CString dirTemplate = ARCH->concatPath(ARCH->getTempDirectory(),
+							"synergy-ipc-test-XXXXXX");
+	std::vector<char> dir(dirTemplate.begin(), dirTemplate.end());
+	dir.push_back('\0');
+	ASSERT_TRUE(mkdtemp(&dir[0]) != NULL);
+	CString path = ARCH->concatPath(&dir[0], IPC_LOCAL_NAME);
+
+	{
+		CSocketMultiplexer socketMultiplexer;
+		CIpcServer server(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+		server.listen(new CLocalSocketFactory(&m_events, &socketMultiplexer),
+							path);
+
+		CIpcClient client(&m_events,
+							new CLocalSocketFactory(&m_events, &socketMultiplexer),
+							CNetworkAddress::local(path));
+		sendLogLines("local", server, client);
+	}
+
+	unlink(path.c_str());
+	rmdir(&dir[0]);
+
+	EXPECT_EQ(g_ipc_numLines, m_sendLogLines_receivedLines);
+}
+
+TEST_F(CIpcTests, connectToServer_noLocalSocket_fallsBackToTcp)
+{
+	// like a daemon that only listens on the port
+	CSocketMultiplexer socketMultiplexer;
+	CIpcServer server(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+	server.listen();
+	m_connectToServer_server = &server;
+
+	m_events.adoptHandler(
+		m_events.forCIpcServer().messageReceived(), &server,
+		new TMethodEventJob<CIpcTests>(
+		this, &CIpcTests::connectToServer_handleMessageReceived));
+
+	CString path = ARCH->concatPath(ARCH->getTempDirectory(),
+							"synergy-ipc-test-missing/" IPC_LOCAL_NAME);
+	CIpcClient client(&m_events,
+							new CLocalSocketFactory(&m_events, &socketMultiplexer),
+							CNetworkAddress::local(path));
+	client.setFallbackPort(&socketMultiplexer, TEST_IPC_PORT);
+	client.connect();
+
+	m_events.initQuitTimeout(5);
+	m_events.loop();
+	m_events.removeHandler(m_events.forCIpcServer().messageReceived(), &server);
+	m_events.cleanupQuitTimeout();
+
+	EXPECT_EQ(true, m_connectToServer_helloMessageReceived);
+	EXPECT_EQ(true, m_connectToServer_hasClientNode);
+}
+#endif
+
+TEST_F(CIpcTests, sendMetrics_forwardedToMonitor)
+{
+	CSocketMultiplexer socketMultiplexer;
+	CIpcServer server(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+	server.listen();
+	m_sendMetrics_server = &server;
+
+	// the server passes metrics from the node on to the monitor, as the
+	// daemon does
+	m_events.adoptHandler(
+		m_events.forCIpcServer().messageReceived(), &server,
+		new TMethodEventJob<CIpcTests>(
+		this, &CIpcTests::sendMetrics_serverHandleMessageReceived));
+
+	CIpcClient node(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+	m_sendMetrics_node = &node;
+	node.connect();
+
+	CIpcClient monitor(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+	monitor.setClientType(kIpcClientMonitor);
+	m_events.adoptHandler(
+		m_events.forCIpcClient().messageReceived(), &monitor,
+		new TMethodEventJob<CIpcTests>(
+		this, &CIpcTests::sendMetrics_monitorHandleMessageReceived));
+	monitor.connect();
+
+	m_events.initQuitTimeout(5);
+	m_events.loop();
+	m_events.removeHandler(m_events.forCIpcServer().messageReceived(), &server);
+	m_events.removeHandler(m_events.forCIpcClient().messageReceived(), &monitor);
+	m_events.cleanupQuitTimeout();
+
+	// the sockets above are counted
+	EXPECT_NE(CString::npos, m_sendMetrics_snapshot.find("\nnet.sockets "));
+}
+
 CIpcTests::CIpcTests() :
 m_connectToServer_helloMessageReceived(false),
 m_connectToServer_hasClientNode(false),
 m_connectToServer_server(nullptr),
 m_sendMessageToClient_server(nullptr),
-m_sendMessageToServer_client(nullptr)
+m_sendMessageToServer_client(nullptr),
+m_sendLogLines_server(nullptr),
+m_sendLogLines_receivedLines(0),
+m_sendMetrics_server(nullptr),
+m_sendMetrics_node(nullptr),
+m_sendMetrics_hellos(0)
 {
 }
 
@@ -208,4 +349,106 @@ CIpcTests::sendMessageToClient_clientHandleMessageReceived(const CEvent& e, void
 	}
 }
 
+void
+CIpcTests::sendLogLines(const char* name, CIpcServer& server, CIpcClient& client)
+{
+	m_sendLogLines_server = &server;
+
+	// server sends all the lines when the client says hello
+	m_events.adoptHandler(
+		m_events.forCIpcServer().messageReceived(), &server,
+		new TMethodEventJob<CIpcTests>(
+		this, &CIpcTests::sendLogLines_serverHandleMessageReceived));
+	m_events.adoptHandler(
+		m_events.forCIpcClient().messageReceived(), &client,
+		new TMethodEventJob<CIpcTests>(
+		this, &CIpcTests::sendLogLines_clientHandleMessageReceived));
+
+	// per message debug logging would swamp the transport
+	int filter = CLOG->getFilter();
+	CLOG->setFilter(kINFO);
+
+	CStopwatch stopwatch;
+	clock_t cpu = clock();
+	client.connect();
+
+	m_events.initQuitTimeout(60);
+	m_events.loop();
+	m_events.removeHandler(m_events.forCIpcServer().messageReceived(), &server);
+	m_events.removeHandler(m_events.forCIpcClient().messageReceived(), &client);
+	m_events.cleanupQuitTimeout();
+
+	double wall = stopwatch.getTime();
+	double used = static_cast<double>(clock() - cpu) / CLOCKS_PER_SEC;
+	CLOG->setFilter(filter);
+	LOG((CLOG_INFO "%s: %d log lines in %.2fs, %.0f lines/s, %.2fs cpu",
+		name, m_sendLogLines_receivedLines, wall,
+		m_sendLogLines_receivedLines / wall, used));
+
+	client.disconnect();
+}
+
+void
+CIpcTests::sendLogLines_serverHandleMessageReceived(const CEvent& e, void*)
+{
+	CIpcMessage* m = static_cast<CIpcMessage*>(e.getDataObject());
+	if (m->type() != kIpcHello) {
+		return;
+	}
+
+	// lines about as long as real ones, joined like CIpcLogOutputter
+	CString chunk;
+	for (int i = 0; i < g_ipc_linesPerChunk; ++i) {
+		if (i != 0) {
+			chunk += "\n";
+		}
+		chunk += synergy::string::sprintf(
+			"[2014-01-01T12:00:00] DEBUG: log line %d of the ipc test", i);
+	}
+
+	CIpcLogLineMessage message(chunk);
+	for (int n = 0; n < g_ipc_numLines; n += g_ipc_linesPerChunk) {
+		m_sendLogLines_server->send(message, kIpcClientNode);
+	}
+}
+
+void
+CIpcTests::sendLogLines_clientHandleMessageReceived(const CEvent& e, void*)
+{
+	CIpcMessage* m = static_cast<CIpcMessage*>(e.getDataObject());
+	if (m->type() == kIpcLogLine) {
+		const CString& lines = static_cast<CIpcLogLineMessage*>(m)->logLine();
+		m_sendLogLines_receivedLines +=
+			1 + static_cast<int>(std::count(lines.begin(), lines.end(), '\n'));
+		if (m_sendLogLines_receivedLines >= g_ipc_numLines) {
+			m_events.raiseQuitEvent();
+		}
+	}
+}
+
+void
+CIpcTests::sendMetrics_serverHandleMessageReceived(const CEvent& e, void*)
+{
+	CIpcMessage* m = static_cast<CIpcMessage*>(e.getDataObject());
+	if (m->type() == kIpcHello) {
+		// once both are connected the node sends a snapshot
+		if (++m_sendMetrics_hellos == 2) {
+			m_sendMetrics_node->send(CIpcMetricsMessage(CMetric::snapshot()));
+		}
+	}
+	else if (m->type() == kIpcMetrics) {
+		m_sendMetrics_server->send(*m, kIpcClientMonitor);
+	}
+}
+
+void
+CIpcTests::sendMetrics_monitorHandleMessageReceived(const CEvent& e, void*)
+{
+	CIpcMessage* m = static_cast<CIpcMessage*>(e.getDataObject());
+	if (m->type() == kIpcMetrics) {
+		m_sendMetrics_snapshot = static_cast<CIpcMetricsMessage*>(m)->snapshot();
+		m_events.raiseQuitEvent();
+	}
+}
+
 #endif // WINAPI_CARBON
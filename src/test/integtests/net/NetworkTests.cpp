@@ -415,7 +415,9 @@ NetworkTests::sendMockData(void* eventTarget)
 	chunkData[0] = kFileStart;
 	memcpy(&chunkData[1], size.c_str(), sizeLength);
 	chunkData[sizeLength + 1] = '\0';
-	m_events.addEvent(CEvent(m_events.forIScreen().fileChunkSending(), eventTarget, sizeMessage));
+	CEvent sizeMessageEvent(m_events.forIScreen().fileChunkSending(), eventTarget);
+	sizeMessageEvent.setDataObject(sizeMessage);
+	m_events.addEvent(sizeMessageEvent);
 
 	// send chunk messages with incrementing chunk size
 	size_t lastSize = 0;
@@ -435,7 +437,9 @@ NetworkTests::sendMockData(void* eventTarget)
 		chunkData[0] = kFileChunk;
 		memcpy(&chunkData[1], &m_mockData[sentLength], chunkSize);
 		chunkData[chunkSize + 1] = '\0';
-		m_events.addEvent(CEvent(m_events.forIScreen().fileChunkSending(), eventTarget, fileChunk));
+		CEvent fileChunkEvent(m_events.forIScreen().fileChunkSending(), eventTarget);
+		fileChunkEvent.setDataObject(fileChunk);
+		m_events.addEvent(fileChunkEvent);
 
 		sentLength += chunkSize;
 		lastSize = chunkSize;
@@ -452,7 +456,9 @@ NetworkTests::sendMockData(void* eventTarget)
 
 	chunkData[0] = kFileEnd;
 	chunkData[1] = '\0';
-	m_events.addEvent(CEvent(m_events.forIScreen().fileChunkSending(), eventTarget, transferFinished));
+	CEvent transferFinishedEvent(m_events.forIScreen().fileChunkSending(), eventTarget);
+	transferFinishedEvent.setDataObject(transferFinished);
+	m_events.addEvent(transferFinishedEvent);
 }
 
 UInt8*
@@ -31,6 +31,8 @@ class CMockClient : public CClient
 public:
 	CMockClient() : CClient() { }
 	MOCK_METHOD2(mouseMove, void(SInt32, SInt32));
+	MOCK_METHOD1(mouseDown, void(ButtonID));
+	MOCK_METHOD3(keyDown, void(KeyID, KeyModifierMask, KeyButton));
 	MOCK_METHOD1(setOptions, void(const COptionsList&));
 	MOCK_METHOD0(handshakeComplete, void());
 	MOCK_METHOD1(setDecryptIv, void(const UInt8*));
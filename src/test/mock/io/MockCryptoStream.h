@@ -29,4 +29,5 @@ public:
 		CCryptoStream(eventQueue, stream, CCryptoOptions("gcm", "stub"), false) { }
 	MOCK_METHOD2(read, UInt32(void*, UInt32));
 	MOCK_METHOD2(write, void(const void*, UInt32));
+	MOCK_METHOD1(writeBuffers, void(const CSharedBufferList&));
 };
@@ -31,6 +31,7 @@ public:
 	MOCK_METHOD0(close, void());
 	MOCK_METHOD2(read, UInt32(void*, UInt32));
 	MOCK_METHOD2(write, void(const void*, UInt32));
+	MOCK_METHOD1(writeBuffers, void(const CSharedBufferList&));
 	MOCK_METHOD0(flush, void());
 	MOCK_METHOD0(shutdownInput, void());
 	MOCK_METHOD0(shutdownOutput, void());
@@ -32,6 +32,8 @@ public:
 	MOCK_METHOD1(adoptBuffer, void(IEventQueueBuffer*));
 	MOCK_METHOD2(registerTypeOnce, CEvent::Type(CEvent::Type&, const char*));
 	MOCK_METHOD1(removeHandlers, void(void*));
+	MOCK_METHOD2(adoptEndDispatchHandler, void(void*, IEventJob*));
+	MOCK_METHOD1(removeEndDispatchHandler, void(void*));
 	MOCK_METHOD1(registerType, CEvent::Type(const char*));
 	MOCK_CONST_METHOD0(isEmpty, bool());
 	MOCK_METHOD3(adoptHandler, void(CEvent::Type, void*, IEventJob*));
@@ -54,6 +56,7 @@ public:
 	MOCK_METHOD0(forISocket, ISocketEvents&());
 	MOCK_METHOD0(forCOSXScreen, COSXScreenEvents&());
 	MOCK_METHOD0(forCClientListener, CClientListenerEvents&());
+	MOCK_METHOD0(forCLivenessMonitor, CLivenessMonitorEvents&());
 	MOCK_METHOD0(forCClientProxy, CClientProxyEvents&());
 	MOCK_METHOD0(forCClientProxyUnknown, CClientProxyUnknownEvents&());
 	MOCK_METHOD0(forCServer, CServerEvents&());
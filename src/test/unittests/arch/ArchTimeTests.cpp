@@ -0,0 +1,87 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arch/Arch.h"
+#include "base/EventQueue.h"
+#include "base/Stopwatch.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+#if HAVE_CLOCK_GETTIME
+#include <time.h>
+#endif
+
+const UInt32 g_archTime_numReads = 100000;
+const double g_archTime_timeout = 0.1;
+
+#if HAVE_CLOCK_GETTIME
+TEST(CArchTimeTests, time_followsMonotonicClock)
+{
+	// the wall clock can be set at any time.  the monotonic clock can't,
+	// so if time() follows it, no wall clock jump can move stopwatches
+	// or timers.
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	double monotonic = (double)t.tv_sec + 1.0e-9 * (double)t.tv_nsec;
+
+	EXPECT_NEAR(monotonic, ARCH->time(), 0.01);
+	EXPECT_NEAR(monotonic, ARCH->coarseTime(), 0.05);
+}
+#endif
+
+TEST(CArchTimeTests, nanoTime_neverGoesBackwards)
+{
+	UInt64 last = ARCH->nanoTime();
+	UInt32 backwards = 0;
+	CStopwatch stopwatch;
+	for (UInt32 i = 0; i < g_archTime_numReads; ++i) {
+		UInt64 now = ARCH->nanoTime();
+		if (now < last) {
+			++backwards;
+		}
+		last = now;
+	}
+	double elapsed = stopwatch.getTime();
+
+	EXPECT_EQ(0, backwards);
+	LOG((CLOG_INFO "read clock %d times in %.3fms (%.1fns/read)",
+		g_archTime_numReads, 1000.0 * elapsed,
+		1.0e+9 * elapsed / g_archTime_numReads));
+}
+
+TEST(CArchTimeTests, timer_firesOnSchedule)
+{
+	CEventQueue events;
+	CEventQueueTimer* timer = events.newOneShotTimer(g_archTime_timeout, NULL);
+
+	CStopwatch stopwatch;
+	CEvent event;
+	bool fired = false;
+	while (!fired && stopwatch.getTime() < 10 * g_archTime_timeout) {
+		if (events.getEvent(event, g_archTime_timeout) &&
+			event.getType() == CEvent::kTimer) {
+			fired = true;
+		}
+	}
+	double elapsed = stopwatch.getTime();
+	events.deleteTimer(timer);
+
+	EXPECT_TRUE(fired);
+	EXPECT_LE(g_archTime_timeout - 0.001, elapsed);
+	EXPECT_GT(2 * g_archTime_timeout, elapsed);
+}
@@ -0,0 +1,123 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "base/Metrics.h"
+
+#include "test/global/gtest.h"
+
+// metrics must be static;  each test uses its own
+static CCounter			g_metrics_counter("test.metrics.counter");
+static CCodeCounter		g_metrics_codes("test.metrics.codes");
+static CCodeCounter		g_metrics_full("test.metrics.full");
+static CCodeCounter		g_metrics_escaped("test.metrics.escaped");
+static CGauge			g_metrics_gauge("test.metrics.gauge");
+static CHistogram		g_metrics_histogram("test.metrics.histogram");
+static CHistogram		g_metrics_empty("test.metrics.empty");
+
+static bool
+metrics_hasLine(const CString& snapshot, const char* line)
+{
+	return snapshot.find(CString(line) + "\n") != CString::npos;
+}
+
+TEST(CMetricsTests, counter_add_inSnapshot)
+{
+	g_metrics_counter.add();
+	g_metrics_counter.add(41);
+
+	EXPECT_EQ(42, g_metrics_counter.get());
+	EXPECT_TRUE(metrics_hasLine(CMetric::snapshot(), "test.metrics.counter 42"));
+}
+
+TEST(CMetricsTests, codeCounter_fullAndCompactCodes_countedApart)
+{
+	const UInt8 compact[] = { 0x01, 0, 0, 0 };
+	g_metrics_codes.add(reinterpret_cast<const UInt8*>("DMMV"));
+	g_metrics_codes.add(reinterpret_cast<const UInt8*>("DMMV"));
+	g_metrics_codes.add(reinterpret_cast<const UInt8*>("CNOP"));
+	g_metrics_codes.add(compact);
+
+	EXPECT_EQ(2, g_metrics_codes.get("DMMV"));
+	EXPECT_EQ(1, g_metrics_codes.get("CNOP"));
+	EXPECT_EQ(0, g_metrics_codes.get("DKDN"));
+
+	CString snapshot = CMetric::snapshot();
+	EXPECT_TRUE(metrics_hasLine(snapshot, "test.metrics.codes.DMMV 2"));
+	EXPECT_TRUE(metrics_hasLine(snapshot, "test.metrics.codes.CNOP 1"));
+	EXPECT_TRUE(metrics_hasLine(snapshot, "test.metrics.codes.#1 1"));
+}
+
+TEST(CMetricsTests, codeCounter_unprintableCode_escapedInSnapshot)
+{
+	const UInt8 code[] = { 'D', '\n', '\\', 0xff };
+	g_metrics_escaped.add(code);
+
+	CString snapshot = CMetric::snapshot();
+	EXPECT_TRUE(metrics_hasLine(snapshot, "test.metrics.escaped.D\\x0a\\x5c\\xff 1"));
+	EXPECT_EQ(CString::npos, snapshot.find("D\n"));
+}
+
+TEST(CMetricsTests, codeCounter_tooManyCodes_countedAsOther)
+{
+	for (UInt8 i = 0; i < 70; ++i) {
+		const UInt8 code[] = { 'X', 'X', static_cast<UInt8>('0' + i / 10),
+								static_cast<UInt8>('0' + i % 10) };
+		g_metrics_full.add(code);
+	}
+
+	EXPECT_EQ(1, g_metrics_full.get("XX00"));
+	EXPECT_TRUE(metrics_hasLine(CMetric::snapshot(), "test.metrics.full.other 6"));
+}
+
+TEST(CMetricsTests, gauge_setAndAdd_inSnapshot)
+{
+	g_metrics_gauge.set(10);
+	g_metrics_gauge.add(-3);
+
+	EXPECT_EQ(7, g_metrics_gauge.get());
+	EXPECT_TRUE(metrics_hasLine(CMetric::snapshot(), "test.metrics.gauge 7"));
+}
+
+TEST(CMetricsTests, histogram_record_percentilesAreBucketTops)
+{
+	// 90 small values and 10 large
+	for (UInt32 i = 0; i < 90; ++i) {
+		g_metrics_histogram.record(100);
+	}
+	for (UInt32 i = 0; i < 10; ++i) {
+		g_metrics_histogram.record(5000);
+	}
+
+	EXPECT_EQ(100, g_metrics_histogram.getCount());
+	EXPECT_EQ(90 * 100 + 10 * 5000, g_metrics_histogram.getSum());
+	EXPECT_EQ(5000, g_metrics_histogram.getMax());
+	EXPECT_EQ(127, g_metrics_histogram.getPercentile(50.0));
+	EXPECT_EQ(127, g_metrics_histogram.getPercentile(90.0));
+	EXPECT_EQ(5000, g_metrics_histogram.getPercentile(99.0));
+
+	CString snapshot = CMetric::snapshot();
+	EXPECT_TRUE(metrics_hasLine(snapshot, "test.metrics.histogram.count 100"));
+	EXPECT_TRUE(metrics_hasLine(snapshot, "test.metrics.histogram.p50 127"));
+}
+
+TEST(CMetricsTests, histogram_empty_zeros)
+{
+	EXPECT_EQ(0, g_metrics_empty.getCount());
+	EXPECT_EQ(0, g_metrics_empty.getPercentile(99.0));
+	EXPECT_TRUE(metrics_hasLine(CMetric::snapshot(), "test.metrics.empty.max 0"));
+}
@@ -0,0 +1,180 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/Unicode.h"
+#include "base/Stopwatch.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+#include <cstring>
+
+const UInt32 g_unicode_corpusSize = 8 * 1024 * 1024;
+
+// "a", "é", "日", "😀" -- one character of each UTF-8 length
+static const char* g_unicode_mixed = "a\xc3\xa9\xe6\x97\xa5\xf0\x9f\x98\x80";
+
+static CString
+unicode_utf16(const UInt16* units, UInt32 n)
+{
+	return CString(reinterpret_cast<const char*>(units), 2 * n);
+}
+
+static CString
+unicode_corpus(const char* text)
+{
+	CString corpus;
+	corpus.reserve(g_unicode_corpusSize + 64);
+	while (corpus.size() < g_unicode_corpusSize) {
+		corpus += text;
+	}
+	return corpus;
+}
+
+static void
+unicode_benchmark(const char* name, const CString& utf8)
+{
+	CStopwatch stopwatch;
+	CString utf16 = CUnicode::UTF8ToUTF16(utf8);
+	double toUTF16 = stopwatch.getTime();
+
+	stopwatch.reset();
+	CString back = CUnicode::UTF16ToUTF8(utf16);
+	double toUTF8 = stopwatch.getTime();
+
+	stopwatch.reset();
+	bool valid = CUnicode::isUTF8(utf8);
+	double check = stopwatch.getTime();
+
+	EXPECT_TRUE(valid);
+	EXPECT_TRUE(back == utf8);
+
+	double mb = utf8.size() / (1024.0 * 1024.0);
+	LOG((CLOG_INFO "%s: UTF-8 to UTF-16 %.0fMB/s, UTF-16 to UTF-8 %.0fMB/s, "
+		"validate %.0fMB/s", name, mb / toUTF16, mb / toUTF8, mb / check));
+}
+
+TEST(CUnicodeTests, UTF8ToUTF16_ascii_widened)
+{
+	const UInt16 expected[] = { 'h', 'e', 'l', 'l', 'o' };
+
+	bool errors = true;
+	CString actual = CUnicode::UTF8ToUTF16("hello", &errors);
+
+	EXPECT_FALSE(errors);
+	EXPECT_TRUE(unicode_utf16(expected, 5) == actual);
+}
+
+TEST(CUnicodeTests, UTF8ToUTF16_mixed_surrogatePair)
+{
+	const UInt16 expected[] = { 'a', 0x00e9, 0x65e5, 0xd83d, 0xde00 };
+
+	CString actual = CUnicode::UTF8ToUTF16(g_unicode_mixed);
+
+	EXPECT_TRUE(unicode_utf16(expected, 5) == actual);
+}
+
+TEST(CUnicodeTests, UTF8ToUTF16_invalidByte_replaced)
+{
+	const UInt16 expected[] = { 'a', 0xfffd, 'b' };
+
+	bool errors = true;
+	CString actual = CUnicode::UTF8ToUTF16("a\xff" "b", &errors);
+
+	// decoding errors don't set errors
+	EXPECT_FALSE(errors);
+	EXPECT_TRUE(unicode_utf16(expected, 3) == actual);
+}
+
+TEST(CUnicodeTests, UTF16ToUTF8_byteSwapped_decoded)
+{
+	const UInt16 swapped[] = { 0xfffe, 0x6100, 0xe565, 0x3dd8, 0x00de };
+
+	CString actual = CUnicode::UTF16ToUTF8(unicode_utf16(swapped, 5));
+
+	EXPECT_EQ("a\xe6\x97\xa5\xf0\x9f\x98\x80", actual);
+}
+
+TEST(CUnicodeTests, UTF16ToUTF8_loneSurrogate_error)
+{
+	const UInt16 units[] = { 'a', 0xdc00, 'b' };
+
+	bool errors = false;
+	CString actual = CUnicode::UTF16ToUTF8(unicode_utf16(units, 3), &errors);
+
+	EXPECT_TRUE(errors);
+	EXPECT_EQ("a\xef\xbf\xbd" "b", actual);
+}
+
+TEST(CUnicodeTests, UCS4ToUTF8_roundTrip_matches)
+{
+	CString ucs4 = CUnicode::UTF8ToUCS4(g_unicode_mixed);
+
+	EXPECT_EQ(16, ucs4.size());
+	EXPECT_EQ(g_unicode_mixed, CUnicode::UCS4ToUTF8(ucs4));
+}
+
+TEST(CUnicodeTests, isUTF8_invalidAfterAsciiRun_false)
+{
+	// put the bad byte at every position around the vector widths
+	for (UInt32 i = 0; i < 70; ++i) {
+		CString text(i, 'x');
+		EXPECT_TRUE(CUnicode::isUTF8(text));
+
+		text += "\xe6\x97";
+		text += CString(40, 'y');
+		EXPECT_FALSE(CUnicode::isUTF8(text)) << "at " << i;
+	}
+}
+
+TEST(CUnicodeTests, roundTrip_asciiRunsOfEveryLength_unchanged)
+{
+	// exercises the ascii fast paths starting and stopping at every
+	// alignment, with multibyte characters in between
+	CString text;
+	for (UInt32 i = 0; i < 70; ++i) {
+		text += CString(i, static_cast<char>('0' + i % 64));
+		text += g_unicode_mixed;
+	}
+
+	CString utf16 = CUnicode::UTF8ToUTF16(text);
+	CString utf32 = CUnicode::UTF8ToUTF32(text);
+
+	EXPECT_TRUE(CUnicode::isUTF8(text));
+	EXPECT_EQ(text, CUnicode::UTF16ToUTF8(utf16));
+	EXPECT_EQ(text, CUnicode::UTF32ToUTF8(utf32));
+	EXPECT_EQ(utf16.size() * 2 - 70 * 4, utf32.size());
+}
+
+TEST(CUnicodeTests, benchmark_ascii)
+{
+	unicode_benchmark("ascii", unicode_corpus(
+		"2014-01-01 12:00:00 INFO: switch from \"left\" to \"right\"\n"));
+}
+
+TEST(CUnicodeTests, benchmark_cjk)
+{
+	unicode_benchmark("cjk", unicode_corpus(
+		"\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe6\x96\x87"
+		"\xe7\xab\xa0\xe3\x81\xa7\xe3\x81\x99\xe3\x80\x82"));
+}
+
+TEST(CUnicodeTests, benchmark_mixed)
+{
+	unicode_benchmark("mixed", unicode_corpus(
+		"name,\xe5\x90\x8d\xe5\x89\x8d,caf\xc3\xa9,42,\xf0\x9f\x98\x80\n"));
+}
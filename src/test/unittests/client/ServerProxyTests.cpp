@@ -27,6 +27,7 @@
 #include "test/global/gtest.h"
 
 using ::testing::_;
+using ::testing::InSequence;
 using ::testing::Invoke;
 using ::testing::NiceMock;
 using ::testing::AnyNumber;
@@ -37,6 +38,11 @@ UInt8 g_mouseMove_buffer[g_mouseMove_bufferLen];
 UInt32 g_mouseMove_bufferIndex;
 UInt32 mouseMove_mockRead(void* buffer, UInt32 n);
 
+const UInt8 g_compact_bufferLen = 20;
+UInt8 g_compact_buffer[g_compact_bufferLen];
+UInt32 g_compact_bufferIndex;
+UInt32 compact_mockRead(void* buffer, UInt32 n);
+
 const UInt8 g_readCryptoIv_bufferLen = 20;
 UInt8 g_readCryptoIv_buffer[g_readCryptoIv_bufferLen];
 UInt32 g_readCryptoIv_bufferIndex;
@@ -53,8 +59,11 @@ TEST(CServerProxyTests, mouseMove)
 	NiceMock<CMockClient> client;
 	IStreamEvents streamEvents;
 	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
 	
 	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
 	ON_CALL(stream, read(_, _)).WillByDefault(Invoke(mouseMove_mockRead));
 	
 	EXPECT_CALL(client, mouseMove(1, 2)).Times(1);
@@ -66,6 +75,39 @@ TEST(CServerProxyTests, mouseMove)
 	serverProxy.handleDataForTest();
 }
 
+TEST(CServerProxyTests, compactMessages)
+{
+	g_compact_bufferIndex = 0;
+
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockStream> stream;
+	NiceMock<CMockClient> client;
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+	ON_CALL(stream, read(_, _)).WillByDefault(Invoke(compact_mockRead));
+
+	{
+		InSequence seq;
+		EXPECT_CALL(client, mouseMove(1, 2)).Times(1);
+		EXPECT_CALL(client, mouseMove(0, 1)).Times(1);
+		EXPECT_CALL(client, mouseDown(1)).Times(1);
+		EXPECT_CALL(client, keyDown(0x61, 0, 300)).Times(1);
+	}
+
+	// move by 1,2, then move by -1,-1 and press button 1, then press 'a'
+	// with button 300 -- zigzag deltas and varints
+	const char data[] = "DSOP\0\0\0\0\1\2\4\5\1\1\1\10\x61\0\xac\2";
+	memcpy(g_compact_buffer, data, g_compact_bufferLen);
+
+	CServerProxy serverProxy(&client, &stream, &eventQueue);
+	serverProxy.handleDataForTest();
+}
+
 TEST(CServerProxyTests, readCryptoIv)
 {
 	g_readCryptoIv_bufferIndex = 0;
@@ -75,8 +117,11 @@ TEST(CServerProxyTests, readCryptoIv)
 	NiceMock<CMockStream> stream;
 	IStreamEvents streamEvents;
 	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
 	
 	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
 	ON_CALL(stream, read(_, _)).WillByDefault(Invoke(readCryptoIv_mockRead));
 	ON_CALL(client, setDecryptIv(_)).WillByDefault(Invoke(readCryptoIv_setDecryptIv));
 
@@ -100,6 +145,17 @@ mouseMove_mockRead(void* buffer, UInt32 n)
 	return n;
 }
 
+UInt32
+compact_mockRead(void* buffer, UInt32 n)
+{
+	if (g_compact_bufferIndex >= g_compact_bufferLen) {
+		return 0;
+	}
+	memcpy(buffer, &g_compact_buffer[g_compact_bufferIndex], n);
+	g_compact_bufferIndex += n;
+	return n;
+}
+
 UInt32
 readCryptoIv_mockRead(void* buffer, UInt32 n)
 {
@@ -0,0 +1,171 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mt/CondVar.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "mt/Thread.h"
+#include "base/Stopwatch.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+#include "arch/Arch.h"
+
+#include "test/global/gtest.h"
+
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#if defined(__linux__)
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+const double g_condVar_idleTime = 60.0;
+
+class CCondVarTests : public ::testing::Test {
+public:
+	CCondVarTests() : m_flag(&m_mutex, false), m_waiting(false), m_tid(0) { }
+
+	void				waitForever(void*);
+	void				waitLong(void*);
+	void				waitUntilWaiting();
+
+public:
+	CMutex				m_mutex;
+	CCondVar<bool>		m_flag;
+	bool				m_waiting;
+	int					m_tid;
+};
+
+void
+CCondVarTests::waitForever(void*)
+{
+	CLock lock(&m_mutex);
+	m_waiting = true;
+	while (!m_flag) {
+		m_flag.wait();
+	}
+}
+
+void
+CCondVarTests::waitLong(void*)
+{
+#if defined(__linux__)
+	m_tid = static_cast<int>(syscall(SYS_gettid));
+#endif
+	CStopwatch timer;
+	CLock lock(&m_mutex);
+	m_waiting = true;
+	while (!m_flag) {
+		m_flag.wait(timer, 2.0 * g_condVar_idleTime);
+	}
+}
+
+void
+CCondVarTests::waitUntilWaiting()
+{
+	for (;;) {
+		ARCH->sleep(0.01);
+		CLock lock(&m_mutex);
+		if (m_waiting) {
+			break;
+		}
+	}
+	ARCH->sleep(0.05);
+}
+
+#if defined(__linux__)
+
+// the number of times thread tid has blocked, which for a thread that
+// only waits is the number of times it woke up
+static long
+condVar_getBlockCount(int tid)
+{
+	char path[64];
+	sprintf(path, "/proc/self/task/%d/status", tid);
+	std::ifstream status(path);
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, 24, "voluntary_ctxt_switches:") == 0) {
+			return atol(line.c_str() + 24);
+		}
+	}
+	return -1;
+}
+
+TEST_F(CCondVarTests, wait_idle_noPeriodicWakeups)
+{
+	// an idle server's threads wait on condition variables with long
+	// timeouts.  count how often the kernel wakes such a thread.
+	CThread thread(new TMethodJob<CCondVarTests>(
+		this, &CCondVarTests::waitLong));
+	waitUntilWaiting();
+
+	long before = condVar_getBlockCount(m_tid);
+	ARCH->sleep(g_condVar_idleTime);
+	long after  = condVar_getBlockCount(m_tid);
+
+	m_flag = true;
+	m_flag.broadcast();
+	EXPECT_TRUE(thread.wait(1.0));
+
+	LOG((CLOG_INFO "%d wakeups in %.0fs idle wait",
+		(int)(after - before), g_condVar_idleTime));
+	ASSERT_LE(0, before);
+	EXPECT_GE(2, after - before);
+}
+
+#endif
+
+TEST_F(CCondVarTests, cancel_infiniteWait_wakesPromptly)
+{
+	CThread thread(new TMethodJob<CCondVarTests>(
+		this, &CCondVarTests::waitForever));
+
+	waitUntilWaiting();
+
+	CStopwatch timer;
+	thread.cancel();
+	bool exited = thread.wait(1.0);
+	double latency = timer.getTime();
+
+	LOG((CLOG_INFO "cancelled waiting thread in %.3fms", 1000.0 * latency));
+	EXPECT_TRUE(exited);
+	EXPECT_FALSE(m_flag);
+	EXPECT_GT(0.05, latency);
+}
+
+TEST_F(CCondVarTests, cancel_holdingWaitersMutex_wakesPromptly)
+{
+	CThread thread(new TMethodJob<CCondVarTests>(
+		this, &CCondVarTests::waitForever));
+	waitUntilWaiting();
+
+	// the canceller may hold the mutex the thread waits with
+	CStopwatch timer;
+	{
+		CLock lock(&m_mutex);
+		thread.cancel();
+	}
+	bool exited = thread.wait(1.0);
+	double latency = timer.getTime();
+
+	EXPECT_TRUE(exited);
+	EXPECT_FALSE(m_flag);
+	EXPECT_GT(0.05, latency);
+}
@@ -0,0 +1,116 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mt/Thread.h"
+#include "mt/CondVar.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "base/Stopwatch.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+#include <vector>
+
+const UInt32 g_thread_numThreads = 50;
+const UInt32 g_thread_numLookups = 100000;
+
+class CThreadTests : public ::testing::Test {
+public:
+	CThreadTests() : m_done(&m_mutex, false), m_mismatches(0) { }
+
+	void				idle(void*);
+	void				lookup(void*);
+
+public:
+	CMutex				m_mutex;
+	CCondVar<bool>		m_done;
+	UInt32				m_mismatches;
+};
+
+void
+CThreadTests::idle(void*)
+{
+	CLock lock(&m_mutex);
+	while (!m_done) {
+		m_done.wait();
+	}
+}
+
+void
+CThreadTests::lookup(void*)
+{
+	CThread self = CThread::getCurrentThread();
+	UInt32 mismatches = 0;
+	for (UInt32 i = 0; i < g_thread_numLookups / 10; ++i) {
+		if (CThread::getCurrentThread() != self) {
+			++mismatches;
+		}
+	}
+
+	CLock lock(&m_mutex);
+	m_mismatches += mismatches;
+}
+
+TEST_F(CThreadTests, getCurrentThread_benchmark50Threads)
+{
+	std::vector<CThread*> threads;
+	for (UInt32 i = 0; i < g_thread_numThreads; ++i) {
+		threads.push_back(new CThread(new TMethodJob<CThreadTests>(
+			this, &CThreadTests::idle)));
+	}
+
+	// the main thread was created first so a linear search of the
+	// thread list would have to pass every other thread
+	UInt32 id = CThread::getCurrentThread().getID();
+	UInt32 mismatches = 0;
+	CStopwatch stopwatch;
+	for (UInt32 i = 0; i < g_thread_numLookups; ++i) {
+		if (CThread::getCurrentThread().getID() != id) {
+			++mismatches;
+		}
+	}
+	double elapsed = stopwatch.getTime();
+
+	// look up from several threads at once
+	std::vector<CThread*> lookups;
+	for (UInt32 i = 0; i < 4; ++i) {
+		lookups.push_back(new CThread(new TMethodJob<CThreadTests>(
+			this, &CThreadTests::lookup)));
+	}
+	for (UInt32 i = 0; i < lookups.size(); ++i) {
+		lookups[i]->wait();
+		delete lookups[i];
+	}
+
+	{
+		CLock lock(&m_mutex);
+		m_done = true;
+		m_done.broadcast();
+	}
+	for (UInt32 i = 0; i < threads.size(); ++i) {
+		threads[i]->wait();
+		delete threads[i];
+	}
+
+	EXPECT_EQ(0, mismatches);
+	EXPECT_EQ(0, m_mismatches);
+	LOG((CLOG_INFO "looked up current thread %d times with %d threads in %.3fms (%.1fns/lookup)",
+		g_thread_numLookups, g_thread_numThreads, 1000.0 * elapsed,
+		1.0e+9 * elapsed / g_thread_numLookups));
+}
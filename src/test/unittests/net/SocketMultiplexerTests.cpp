@@ -0,0 +1,143 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "net/SocketMultiplexer.h"
+#include "net/ISocket.h"
+#include "net/ISocketMultiplexerJob.h"
+#include "arch/Arch.h"
+#include "arch/XArch.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+const UInt32 g_socketMultiplexer_pairs     = 8;
+const UInt32 g_socketMultiplexer_chunkSize = 64 * 1024;
+const double g_socketMultiplexer_duration  = 0.5;
+const int    g_socketMultiplexer_port      = 24890;
+
+// the multiplexer only uses the socket as a key
+class CSocketMultiplexerTestSocket : public ISocket {
+public:
+	virtual void		bind(const CNetworkAddress&) { }
+	virtual void		close() { }
+	virtual void*		getEventTarget() const { return NULL; }
+};
+
+// writes or reads as much as it can and counts the bytes
+class CSocketMultiplexerTestJob : public ISocketMultiplexerJob {
+public:
+	CSocketMultiplexerTestJob(CArchSocket socket, bool writer, UInt64* bytes) :
+		m_socket(socket), m_writer(writer), m_bytes(bytes) { }
+
+	virtual ISocketMultiplexerJob*
+						run(bool readable, bool writable, bool error)
+	{
+		static char buffer[g_socketMultiplexer_chunkSize];
+		try {
+			if (m_writer && writable) {
+				*m_bytes += ARCH->writeSocket(m_socket, buffer, sizeof(buffer));
+			}
+			else if (!m_writer && readable) {
+				*m_bytes += ARCH->readSocket(m_socket, buffer, sizeof(buffer));
+			}
+		}
+		catch (XArchNetwork&) {
+			return NULL;
+		}
+		return error ? NULL : this;
+	}
+	virtual CArchSocket	getSocket() const { return m_socket; }
+	virtual bool		isReadable() const { return !m_writer; }
+	virtual bool		isWritable() const { return m_writer; }
+
+private:
+	CArchSocket			m_socket;
+	bool				m_writer;
+	UInt64*				m_bytes;
+};
+
+// pushes bytes through loopback connections on \p threads service
+// threads and returns bytes per second
+static double
+socketMultiplexer_throughput(UInt32 threads)
+{
+	CSocketMultiplexer multiplexer(threads);
+	EXPECT_EQ(threads, multiplexer.getNumServiceThreads());
+
+	CArchNetAddress address = ARCH->nameToAddr("127.0.0.1");
+	ARCH->setAddrPort(address, g_socketMultiplexer_port);
+	CArchSocket listener = ARCH->newSocket(IArchNetwork::kINET,
+							IArchNetwork::kSTREAM);
+	ARCH->setReuseAddrOnSocket(listener, true);
+	ARCH->bindSocket(listener, address);
+	ARCH->listenOnSocket(listener);
+
+	const UInt32 n = 2 * g_socketMultiplexer_pairs;
+	CArchSocket sockets[n];
+	CSocketMultiplexerTestSocket keys[n];
+	UInt64 bytes[n] = { 0 };
+	for (UInt32 i = 0; i < n; i += 2) {
+		sockets[i] = ARCH->newSocket(IArchNetwork::kINET, IArchNetwork::kSTREAM);
+		ARCH->connectSocket(sockets[i], address);
+		CArchNetAddress peer = NULL;
+		while ((sockets[i + 1] = ARCH->acceptSocket(listener, &peer)) == NULL) {
+			ARCH->sleep(0.001);
+		}
+		ARCH->closeAddr(peer);
+	}
+
+	for (UInt32 i = 0; i < n; ++i) {
+		multiplexer.addSocket(&keys[i], new CSocketMultiplexerTestJob(
+							sockets[i], (i % 2) == 0, &bytes[i]));
+	}
+	for (UInt32 i = 0; i < threads; ++i) {
+		EXPECT_EQ(n / threads, multiplexer.getNumSockets(i));
+	}
+
+	ARCH->sleep(g_socketMultiplexer_duration);
+
+	UInt64 total = 0;
+	for (UInt32 i = 0; i < n; ++i) {
+		multiplexer.removeSocket(&keys[i]);
+		if (i % 2 == 1) {
+			total += bytes[i];
+		}
+	}
+	for (UInt32 i = 0; i < threads; ++i) {
+		EXPECT_EQ(0, multiplexer.getNumSockets(i));
+	}
+
+	for (UInt32 i = 0; i < n; ++i) {
+		ARCH->closeSocket(sockets[i]);
+	}
+	ARCH->closeSocket(listener);
+	ARCH->closeAddr(address);
+
+	EXPECT_LT(0, total);
+	return total / g_socketMultiplexer_duration;
+}
+
+TEST(CSocketMultiplexerTests, benchmark_throughputByThreads)
+{
+	const UInt32 threads[] = { 1, 2, 4 };
+	for (UInt32 i = 0; i < 3; ++i) {
+		double rate = socketMultiplexer_throughput(threads[i]);
+		LOG((CLOG_INFO "%d I/O threads, %d connections: %.0fMB/s",
+			threads[i], g_socketMultiplexer_pairs, rate / (1024.0 * 1024.0)));
+	}
+}
@@ -0,0 +1,98 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "platform/VirtualInput.h"
+
+#include "test/global/gtest.h"
+
+#include <sstream>
+
+static bool
+virtualInput_parse(CVirtualInput& input, const char* script)
+{
+	std::istringstream stream(script);
+	return input.parse(stream);
+}
+
+TEST(CVirtualInputTests, parse_actions_inOrder)
+{
+	CVirtualInput input;
+	bool ok = virtualInput_parse(input,
+		"# comment\n"
+		"\n"
+		"move 10 20\n"
+		"down 1\n"
+		"wait 250\n"
+		"clipboard hello world\n");
+
+	EXPECT_TRUE(ok);
+	ASSERT_EQ(4, input.getSize());
+	EXPECT_EQ(CVirtualInput::kMove, input.get(0).m_type);
+	EXPECT_EQ(10, input.get(0).m_x);
+	EXPECT_EQ(20, input.get(0).m_y);
+	EXPECT_EQ(1, input.get(1).m_button);
+	EXPECT_DOUBLE_EQ(0.25, input.get(2).m_wait);
+	EXPECT_EQ("hello world", input.get(3).m_text);
+}
+
+TEST(CVirtualInputTests, parse_key_pressAndRelease)
+{
+	CVirtualInput input;
+	bool ok = virtualInput_parse(input, "key a 0x2\nkeydown 0xef0d\n");
+
+	EXPECT_TRUE(ok);
+	ASSERT_EQ(3, input.getSize());
+	EXPECT_EQ(CVirtualInput::kKeyDown, input.get(0).m_type);
+	EXPECT_EQ(CVirtualInput::kKeyUp, input.get(1).m_type);
+	EXPECT_EQ('a', input.get(1).m_key);
+	EXPECT_EQ(2, input.get(1).m_mask);
+	EXPECT_EQ(0xef0d, input.get(2).m_key);
+}
+
+TEST(CVirtualInputTests, parse_nestedRepeat_endsMatched)
+{
+	CVirtualInput input;
+	bool ok = virtualInput_parse(input,
+		"repeat 3\n"
+		"repeat 0\n"
+		"rmove 1 0\n"
+		"end\n"
+		"end\n");
+
+	EXPECT_TRUE(ok);
+	ASSERT_EQ(5, input.getSize());
+	EXPECT_EQ(1, input.get(3).m_index);
+	EXPECT_EQ(0, input.get(3).m_count);
+	EXPECT_EQ(0, input.get(4).m_index);
+	EXPECT_EQ(3, input.get(4).m_count);
+}
+
+TEST(CVirtualInputTests, parse_badLines_skipped)
+{
+	CVirtualInput input;
+	bool ok = virtualInput_parse(input,
+		"jump 1 2\n"
+		"move 1\n"
+		"end\n"
+		"wait -5\n"
+		"quit\n");
+
+	EXPECT_FALSE(ok);
+	ASSERT_EQ(1, input.getSize());
+	EXPECT_EQ(CVirtualInput::kQuit, input.get(0).m_type);
+}
@@ -19,15 +19,103 @@
 #include "test/mock/io/MockStream.h"
 #include "test/mock/io/MockCryptoStream.h"
 #include "test/mock/synergy/MockEventQueue.h"
+#include "test/global/TestEventQueue.h"
 #include "server/ClientProxy1_4.h"
+#include "server/ClientProxy1_7.h"
+#include "server/Config.h"
+#include "synergy/PriorityStreamFilter.h"
+#include "synergy/CaptureStreamFilter.h"
+#include "synergy/MessageBroadcast.h"
+#include "synergy/protocol_types.h"
+#include "io/StreamBuffer.h"
+#include "synergy/ProtocolUtil.h"
+#include "base/TMethodEventJob.h"
+#include "base/Stopwatch.h"
+#include "base/Log.h"
+#include "arch/Arch.h"
 
 #include "test/global/gtest.h"
 
+#include <cstdio>
+
 using ::testing::_;
 using ::testing::NiceMock;
 using ::testing::Invoke;
 using ::testing::ReturnRef;
 
+// queues writes like CTCPSocket
+class CClientProxyTestSocket {
+public:
+	void				write(const void* buffer, UInt32 n)
+	{
+		m_buffer.write(buffer, n);
+	}
+
+	void				writeBuffers(const CSharedBufferList& buffers)
+	{
+		for (CSharedBufferList::const_iterator i = buffers.begin();
+								i != buffers.end(); ++i) {
+			m_buffer.write(*i);
+		}
+	}
+
+	CString				readAll()
+	{
+		CString data(m_buffer.getSize(), '\0');
+		if (!data.empty()) {
+			m_buffer.read(&data[0], (UInt32)data.size());
+		}
+		return data;
+	}
+
+public:
+	CStreamBuffer		m_buffer;
+};
+
+// a client proxy on a CClientProxyTestSocket
+class CClientProxyTestClient {
+public:
+	CClientProxyTestClient(IEventQueue* events, CServer* server,
+							const CString& name = "stub") :
+		m_proxy(NULL)
+	{
+		// the proxy deletes the stream
+		NiceMock<CMockStream>* stream = new NiceMock<CMockStream>;
+		ON_CALL(*stream, write(_, _)).WillByDefault(
+			Invoke(&m_socket, &CClientProxyTestSocket::write));
+		ON_CALL(*stream, writeBuffers(_)).WillByDefault(
+			Invoke(&m_socket, &CClientProxyTestSocket::writeBuffers));
+		m_proxy = new CClientProxy1_4(name, stream, NULL, server, events);
+		m_socket.readAll();
+	}
+
+	~CClientProxyTestClient()
+	{
+		delete m_proxy;
+	}
+
+public:
+	CClientProxyTestSocket	m_socket;
+	CClientProxy1_4*		m_proxy;
+};
+
+static const UInt32 g_clientProxy_benchmarkClients = 64;
+static const UInt32 g_clientProxy_benchmarkKeys    = 1000;
+
+// options the way CServer::sendOptions() shares them
+static void
+clientProxy_sendOptions(const CConfig& config, CBaseClientProxy* client,
+				const COptionsList& options, CMessageBroadcast* broadcast)
+{
+	client->setBroadcast(broadcast);
+	client->resetOptions();
+	if (config.hasScreenOptions(client->getName())) {
+		client->setBroadcast(NULL);
+	}
+	client->setOptions(options);
+	client->setBroadcast(NULL);
+}
+
 const UInt8 g_cryptoIvWrite_bufferLen = 200;
 UInt8 g_cryptoIvWrite_buffer[g_cryptoIvWrite_bufferLen];
 UInt32 g_cryptoIvWrite_writeBufferIndex;
@@ -36,6 +124,56 @@ UInt32 g_cryptoIvWrite_readBufferIndex;
 void cryptoIv_mockWrite(const void* in, UInt32 n);
 UInt8 cryptoIv_mockRead(void* out, UInt32 n);
 
+// keeps an event queue busy for a few events, moving the mouse in the
+// first and noting what had been written by the start of the second
+class CClientProxyBusyQueue {
+public:
+	CClientProxyBusyQueue(IEventQueue* events, IClient* client,
+							CClientProxyTestSocket* socket) :
+		m_events(events),
+		m_client(client),
+		m_socket(socket),
+		m_type(CEvent::kUnknown),
+		m_numEvents(0)
+	{
+		m_events->registerTypeOnce(m_type, "CClientProxyBusyQueue::busy");
+		m_events->adoptHandler(m_type, this,
+							new TMethodEventJob<CClientProxyBusyQueue>(this,
+								&CClientProxyBusyQueue::handleEvent));
+		m_events->addEvent(CEvent(m_type, this));
+	}
+
+	~CClientProxyBusyQueue()
+	{
+		m_events->removeHandlers(this);
+	}
+
+	void				handleEvent(const CEvent&, void*)
+	{
+		// queue the next event first so the queue is never empty
+		if (++m_numEvents < 3) {
+			m_events->addEvent(CEvent(m_type, this));
+		}
+		else {
+			m_events->addEvent(CEvent(CEvent::kQuit));
+		}
+		if (m_numEvents == 1) {
+			m_client->mouseMove(10, 20);
+		}
+		else if (m_numEvents == 2) {
+			m_written = m_socket->readAll();
+		}
+	}
+
+public:
+	IEventQueue*		m_events;
+	IClient*			m_client;
+	CClientProxyTestSocket*	m_socket;
+	CEvent::Type		m_type;
+	UInt32				m_numEvents;
+	CString				m_written;
+};
+
 TEST(CClientProxyTests, cryptoIvWrite)
 {
 	g_cryptoIvWrite_writeBufferIndex = 0;
@@ -47,6 +185,8 @@ TEST(CClientProxyTests, cryptoIvWrite)
 	CCryptoOptions options("cfb", "mock");
 	IStreamEvents streamEvents;
 	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
 
 	CCryptoStream* serverStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
 	CCryptoStream* clientStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
@@ -57,10 +197,11 @@ TEST(CClientProxyTests, cryptoIvWrite)
 	clientStream->setDecryptIv(iv);
 	
 	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
 	ON_CALL(innerStream, write(_, _)).WillByDefault(Invoke(cryptoIv_mockWrite));
 	ON_CALL(innerStream, read(_, _)).WillByDefault(Invoke(cryptoIv_mockRead));
 
-	CClientProxy1_4 clientProxy("stub", serverStream, &server, &eventQueue);
+	CClientProxy1_4 clientProxy("stub", serverStream, serverStream, &server, &eventQueue);
 	
 	UInt8 buffer[100];
 	clientStream->read(buffer, 4);
@@ -117,6 +258,381 @@ TEST(CClientProxyTests, cryptoIvWrite)
 	EXPECT_EQ('P', buffer[3]);
 }
 
+TEST(CClientProxyTests, cryptoIvWrite_behindPriorityFilter)
+{
+	g_cryptoIvWrite_writeBufferIndex = 0;
+	g_cryptoIvWrite_readBufferIndex = 0;
+
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockStream> innerStream;
+	NiceMock<CMockServer> server;
+	CCryptoOptions options("cfb", "mock");
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+
+	CCryptoStream* serverStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
+	CCryptoStream* clientStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
+	CPriorityStreamFilter* priorityFilter = new CPriorityStreamFilter(&eventQueue, serverStream, true);
+
+	byte iv[CRYPTO_IV_SIZE];
+	serverStream->newIv(iv);
+	serverStream->setEncryptIv(iv);
+	clientStream->setDecryptIv(iv);
+
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+	ON_CALL(innerStream, write(_, _)).WillByDefault(Invoke(cryptoIv_mockWrite));
+	ON_CALL(innerStream, read(_, _)).WillByDefault(Invoke(cryptoIv_mockRead));
+
+	CClientProxy1_4 clientProxy("stub", priorityFilter, serverStream, &server, &eventQueue);
+
+	UInt8 buffer[100];
+	clientStream->read(buffer, 4);
+
+	g_cryptoIvWrite_writeBufferIndex = 0;
+	g_cryptoIvWrite_readBufferIndex = 0;
+
+	// the iv must still change although the proxy's stream is the filter
+	clientProxy.keyDown(1, 2, 3);
+	clientStream->read(buffer, 24);
+	EXPECT_EQ('D', buffer[0]);
+	EXPECT_EQ('C', buffer[1]);
+	EXPECT_EQ('I', buffer[2]);
+	EXPECT_EQ('V', buffer[3]);
+	clientStream->setDecryptIv(&buffer[8]);
+	clientStream->read(buffer, 10);
+	EXPECT_EQ('D', buffer[0]);
+	EXPECT_EQ('K', buffer[1]);
+	EXPECT_EQ('D', buffer[2]);
+	EXPECT_EQ('N', buffer[3]);
+
+	delete clientStream;
+}
+
+TEST(CClientProxyTests, cryptoIvWrite_behindCaptureAndPriorityFilters)
+{
+	g_cryptoIvWrite_writeBufferIndex = 0;
+	g_cryptoIvWrite_readBufferIndex = 0;
+
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockStream> innerStream;
+	NiceMock<CMockServer> server;
+	CCryptoOptions options("cfb", "mock");
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+
+	// stacked the way CClientListener does it
+	CString capturePath = ARCH->concatPath(ARCH->getTempDirectory(),
+							"synergy-clientproxy-test.capture");
+	CCryptoStream* serverStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
+	CCryptoStream* clientStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
+	CCaptureStreamFilter* captureFilter = new CCaptureStreamFilter(&eventQueue,
+							serverStream, capturePath, CProtocolCapture::kServer, true);
+	CPriorityStreamFilter* priorityFilter = new CPriorityStreamFilter(&eventQueue, captureFilter, true);
+
+	byte iv[CRYPTO_IV_SIZE];
+	serverStream->newIv(iv);
+	serverStream->setEncryptIv(iv);
+	clientStream->setDecryptIv(iv);
+
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+	ON_CALL(innerStream, write(_, _)).WillByDefault(Invoke(cryptoIv_mockWrite));
+	ON_CALL(innerStream, read(_, _)).WillByDefault(Invoke(cryptoIv_mockRead));
+
+	CClientProxy1_4 clientProxy("stub", priorityFilter, serverStream, &server, &eventQueue);
+
+	UInt8 buffer[100];
+	clientStream->read(buffer, 4);
+
+	g_cryptoIvWrite_writeBufferIndex = 0;
+	g_cryptoIvWrite_readBufferIndex = 0;
+
+	clientProxy.keyDown(1, 2, 3);
+	clientStream->read(buffer, 24);
+	EXPECT_EQ('D', buffer[0]);
+	EXPECT_EQ('C', buffer[1]);
+	EXPECT_EQ('I', buffer[2]);
+	EXPECT_EQ('V', buffer[3]);
+	clientStream->setDecryptIv(&buffer[8]);
+	clientStream->read(buffer, 10);
+	EXPECT_EQ('D', buffer[0]);
+	EXPECT_EQ('K', buffer[1]);
+	EXPECT_EQ('D', buffer[2]);
+	EXPECT_EQ('N', buffer[3]);
+
+	delete clientStream;
+	std::remove(capturePath.c_str());
+}
+
+TEST(CClientProxyTests, keyDown_broadcast_sameBytesFormattedOnce)
+{
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockServer> server;
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+
+	CClientProxyTestClient client1(&eventQueue, &server);
+	CClientProxyTestClient client2(&eventQueue, &server);
+
+	CMessageBroadcast broadcast;
+	client1.m_proxy->setBroadcast(&broadcast);
+	client1.m_proxy->keyDown(1, 2, 3);
+	client1.m_proxy->setBroadcast(NULL);
+	client2.m_proxy->setBroadcast(&broadcast);
+	client2.m_proxy->keyDown(1, 2, 3);
+	client2.m_proxy->setBroadcast(NULL);
+
+	const char expected[] = { 'D', 'K', 'D', 'N', 0, 1, 0, 2, 0, 3 };
+	EXPECT_EQ(CString(expected, sizeof(expected)), client1.m_socket.readAll());
+	EXPECT_EQ(CString(expected, sizeof(expected)), client2.m_socket.readAll());
+	EXPECT_EQ(1, broadcast.getSize());
+	EXPECT_TRUE(broadcast.find(kMsgDKeyDown) != NULL);
+}
+
+TEST(CClientProxyTests, keyDown_broadcastWithCrypto_ivNotShared)
+{
+	g_cryptoIvWrite_writeBufferIndex = 0;
+	g_cryptoIvWrite_readBufferIndex = 0;
+
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockStream> innerStream;
+	NiceMock<CMockServer> server;
+	CCryptoOptions options("cfb", "mock");
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+
+	CCryptoStream* serverStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
+	CCryptoStream* clientStream = new CCryptoStream(&eventQueue, &innerStream, options, false);
+
+	byte iv[CRYPTO_IV_SIZE];
+	serverStream->newIv(iv);
+	serverStream->setEncryptIv(iv);
+	clientStream->setDecryptIv(iv);
+
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+	ON_CALL(innerStream, write(_, _)).WillByDefault(Invoke(cryptoIv_mockWrite));
+	ON_CALL(innerStream, read(_, _)).WillByDefault(Invoke(cryptoIv_mockRead));
+
+	CClientProxy1_4 clientProxy("stub", serverStream, serverStream, &server, &eventQueue);
+
+	UInt8 buffer[100];
+	clientStream->read(buffer, 4);
+
+	g_cryptoIvWrite_writeBufferIndex = 0;
+	g_cryptoIvWrite_readBufferIndex = 0;
+
+	// the shared message is encrypted by the stream, the iv isn't shared
+	CMessageBroadcast broadcast;
+	clientProxy.setBroadcast(&broadcast);
+	clientProxy.keyDown(1, 2, 3);
+	clientProxy.setBroadcast(NULL);
+	EXPECT_EQ(1, broadcast.getSize());
+	EXPECT_EQ(10, broadcast.find(kMsgDKeyDown)->getSize());
+
+	clientStream->read(buffer, 24);
+	EXPECT_EQ('D', buffer[0]);
+	EXPECT_EQ('C', buffer[1]);
+	EXPECT_EQ('I', buffer[2]);
+	EXPECT_EQ('V', buffer[3]);
+	clientStream->setDecryptIv(&buffer[8]);
+	clientStream->read(buffer, 10);
+	EXPECT_EQ('D', buffer[0]);
+	EXPECT_EQ('K', buffer[1]);
+	EXPECT_EQ('D', buffer[2]);
+	EXPECT_EQ('N', buffer[3]);
+
+	delete clientStream;
+}
+
+TEST(CClientProxyTests, close_clientWithoutRetryHint_sendsCodeOnly)
+{
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockServer> server;
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+
+	// 1.4 predates retry hints so the hint must not follow the code
+	CClientProxyTestClient client(&eventQueue, &server);
+	client.m_proxy->close(kMsgCCloseRetry, 5000);
+
+	EXPECT_EQ(CString("CBYE"), client.m_socket.readAll());
+}
+
+TEST(CClientProxyTests, hasScreenOptions_configuredScreens)
+{
+	CConfig config(NULL);
+	config.addScreen("plain");
+	config.addScreen("tuned");
+	config.addOption("tuned", kOptionHalfDuplexCapsLock, 1);
+	config.addOption("", kOptionScreenSwitchDelay, 250);
+
+	// every configured screen has options but only some have their own
+	EXPECT_TRUE(config.getOptions("plain") != NULL);
+	EXPECT_FALSE(config.hasScreenOptions("plain"));
+	EXPECT_TRUE(config.hasScreenOptions("tuned"));
+	EXPECT_FALSE(config.hasScreenOptions("unknown"));
+	EXPECT_FALSE(config.hasScreenOptions(""));
+}
+
+TEST(CClientProxyTests, setOptions_configuredScreens_sharedWithoutScreenOptions)
+{
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockServer> server;
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+
+	CConfig config(NULL);
+	config.addScreen("plain1");
+	config.addScreen("plain2");
+	config.addScreen("tuned");
+	config.addOption("tuned", kOptionHalfDuplexCapsLock, 1);
+
+	CClientProxyTestClient plain1(&eventQueue, &server, "plain1");
+	CClientProxyTestClient plain2(&eventQueue, &server, "plain2");
+	CClientProxyTestClient tuned(&eventQueue, &server, "tuned");
+
+	// the reset and the options are formatted once for the plain
+	// screens, the tuned screen only shares the reset
+	COptionsList options(2, 0);
+	CMessageBroadcast broadcast;
+	clientProxy_sendOptions(config, plain1.m_proxy, options, &broadcast);
+	clientProxy_sendOptions(config, plain2.m_proxy, options, &broadcast);
+	EXPECT_EQ(2, broadcast.getSize());
+	const CSharedBuffer* shared = broadcast.find(kMsgDSetOptions);
+	ASSERT_TRUE(shared != NULL);
+	clientProxy_sendOptions(config, tuned.m_proxy, options, &broadcast);
+	EXPECT_EQ(shared, broadcast.find(kMsgDSetOptions));
+
+	EXPECT_EQ(plain1.m_socket.readAll(), plain2.m_socket.readAll());
+}
+
+TEST(CClientProxyTests, mouseMove_busyQueue_sentWhenEventHandled)
+{
+	CTestEventQueue eventQueue;
+	NiceMock<CMockServer> server;
+
+	// the proxy deletes the stream
+	CClientProxyTestSocket socket;
+	NiceMock<CMockStream>* stream = new NiceMock<CMockStream>;
+	ON_CALL(*stream, write(_, _)).WillByDefault(
+		Invoke(&socket, &CClientProxyTestSocket::write));
+	ON_CALL(*stream, writeBuffers(_)).WillByDefault(
+		Invoke(&socket, &CClientProxyTestSocket::writeBuffers));
+	CClientProxy1_7 proxy("stub", stream, NULL, &server, &eventQueue);
+	socket.readAll();
+
+	// timers don't fire while the queue is busy but the move held in
+	// the first event goes out when that event has been handled
+	CClientProxyBusyQueue busy(&eventQueue, &proxy, &socket);
+	eventQueue.initQuitTimeout(5);
+	eventQueue.loop();
+	eventQueue.cleanupQuitTimeout();
+
+	EXPECT_EQ(3, busy.m_numEvents);
+	EXPECT_EQ(CProtocolUtil::formatf(kMsgDCompactMouseMove, 10, 20),
+				busy.m_written);
+}
+
+TEST(CClientProxyTests, benchmark_broadcast64Clients)
+{
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockServer> server;
+	IStreamEvents streamEvents;
+	streamEvents.setEvents(&eventQueue);
+	CLivenessMonitorEvents livenessEvents;
+	livenessEvents.setEvents(&eventQueue);
+	ON_CALL(eventQueue, forIStream()).WillByDefault(ReturnRef(streamEvents));
+	ON_CALL(eventQueue, forCLivenessMonitor()).WillByDefault(ReturnRef(livenessEvents));
+
+	// clients of configured screens without options of their own
+	CConfig config(NULL);
+	std::vector<CClientProxyTestClient*> clients;
+	for (UInt32 i = 0; i < g_clientProxy_benchmarkClients; ++i) {
+		CString name = synergy::string::sprintf("client%d", i);
+		config.addScreen(name);
+		clients.push_back(
+			new CClientProxyTestClient(&eventQueue, &server, name));
+	}
+
+	// keyboard broadcast, formatted per client and then once per event
+	double keyTime[2];
+	for (int shared = 0; shared < 2; ++shared) {
+		CStopwatch stopwatch;
+		for (UInt32 key = 0; key < g_clientProxy_benchmarkKeys; ++key) {
+			CMessageBroadcast broadcast;
+			for (UInt32 i = 0; i < clients.size(); ++i) {
+				clients[i]->m_proxy->setBroadcast(shared ? &broadcast : NULL);
+				clients[i]->m_proxy->keyDown(key, 0, key);
+				clients[i]->m_proxy->setBroadcast(NULL);
+			}
+		}
+		keyTime[shared] = stopwatch.getTime();
+		for (UInt32 i = 0; i < clients.size(); ++i) {
+			EXPECT_EQ(10 * g_clientProxy_benchmarkKeys,
+				clients[i]->m_socket.readAll().size());
+		}
+	}
+
+	// a large options list, copied per client and then queued by
+	// reference on every client
+	COptionsList options(256 * 1024, 0);
+	double optionsTime[2];
+	for (int shared = 0; shared < 2; ++shared) {
+		CMessageBroadcast broadcast;
+		CStopwatch stopwatch;
+		for (UInt32 i = 0; i < clients.size(); ++i) {
+			clientProxy_sendOptions(config, clients[i]->m_proxy, options,
+				shared ? &broadcast : NULL);
+		}
+		optionsTime[shared] = stopwatch.getTime();
+
+		// skip the reset, it's too small to be queued by reference
+		for (UInt32 i = 0; i < clients.size(); ++i) {
+			clients[i]->m_socket.m_buffer.pop(4);
+		}
+
+		// when shared every client queues the same bytes
+		CStreamBuffer& first = clients[0]->m_socket.m_buffer;
+		CStreamBuffer& last  = clients.back()->m_socket.m_buffer;
+		const UInt32 size = first.getSize();
+		EXPECT_EQ(size, last.getSize());
+		EXPECT_EQ(shared != 0, first.peek(first.getRunSize()) ==
+								last.peek(last.getRunSize()));
+		for (UInt32 i = 0; i < clients.size(); ++i) {
+			clients[i]->m_socket.m_buffer.pop(size);
+		}
+	}
+
+	LOG((CLOG_INFO "%d clients: %d key downs in %.3fs, %.3fs shared; "
+		"%dKB options in %.3fs, %.3fs shared",
+		clients.size(), g_clientProxy_benchmarkKeys, keyTime[0], keyTime[1],
+		options.size() * 4 / 1024, optionsTime[0], optionsTime[1]));
+
+	for (UInt32 i = 0; i < clients.size(); ++i) {
+		delete clients[i];
+	}
+}
+
 void
 cryptoIv_mockWrite(const void* in, UInt32 n)
 {
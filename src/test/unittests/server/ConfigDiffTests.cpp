@@ -0,0 +1,157 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2013 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ConfigDiff.h"
+#include "server/Config.h"
+
+#include "test/global/gtest.h"
+
+#include <sstream>
+
+const char* g_configDiff_base =
+	"section: screens\n"
+	"	server:\n"
+	"	left:\n"
+	"		switchCorners = none\n"
+	"	right:\n"
+	"end\n"
+	"section: links\n"
+	"	server:\n"
+	"		left = left\n"
+	"		right = right\n"
+	"	left:\n"
+	"		right = server\n"
+	"	right:\n"
+	"		left = server\n"
+	"end\n"
+	"section: aliases\n"
+	"	left:\n"
+	"		left.example.com\n"
+	"end\n"
+	"section: options\n"
+	"	switchDelay = 250\n"
+	"	keystroke(alt+1) = switchToScreen(left)\n"
+	"end\n";
+
+void
+configDiff_read(CConfig& config, const CString& text)
+{
+	std::istringstream stream(text);
+	stream >> config;
+}
+
+CString
+configDiff_replace(CString text, const CString& from, const CString& to)
+{
+	CString::size_type i = text.find(from);
+	text.replace(i, from.size(), to);
+	return text;
+}
+
+TEST(CConfigDiffTests, identicalConfigs_isEmpty)
+{
+	CConfig oldConfig(NULL), newConfig(NULL);
+	configDiff_read(oldConfig, g_configDiff_base);
+	configDiff_read(newConfig, g_configDiff_base);
+
+	CConfigDiff diff(oldConfig, newConfig);
+
+	EXPECT_TRUE(diff.isEmpty());
+	EXPECT_FALSE(diff.needsOptions("left"));
+}
+
+TEST(CConfigDiffTests, screenOptionChanged_onlyThatScreenNeedsOptions)
+{
+	CConfig oldConfig(NULL), newConfig(NULL);
+	configDiff_read(oldConfig, g_configDiff_base);
+	configDiff_read(newConfig, configDiff_replace(g_configDiff_base,
+		"switchCorners = none", "switchCorners = all"));
+
+	CConfigDiff diff(oldConfig, newConfig);
+
+	EXPECT_FALSE(diff.isEmpty());
+	EXPECT_EQ(1, diff.getOptionsChanged().size());
+	EXPECT_TRUE(diff.needsOptions("left"));
+	EXPECT_FALSE(diff.needsOptions("right"));
+	EXPECT_FALSE(diff.haveGlobalOptionsChanged());
+	EXPECT_TRUE(diff.getLinksChanged().empty());
+}
+
+TEST(CConfigDiffTests, globalOptionChanged_everyScreenNeedsOptions)
+{
+	CConfig oldConfig(NULL), newConfig(NULL);
+	configDiff_read(oldConfig, g_configDiff_base);
+	configDiff_read(newConfig, configDiff_replace(g_configDiff_base,
+		"switchDelay = 250", "switchDelay = 500"));
+
+	CConfigDiff diff(oldConfig, newConfig);
+
+	EXPECT_TRUE(diff.haveGlobalOptionsChanged());
+	EXPECT_TRUE(diff.needsOptions("right"));
+	EXPECT_FALSE(diff.hasInputFilterChanged());
+}
+
+TEST(CConfigDiffTests, linkChanged_reportsSourceScreenOnly)
+{
+	CConfig oldConfig(NULL), newConfig(NULL);
+	configDiff_read(oldConfig, g_configDiff_base);
+	configDiff_read(newConfig, configDiff_replace(g_configDiff_base,
+		"		left = server\n", "		left = server\n		right = left\n"));
+
+	CConfigDiff diff(oldConfig, newConfig);
+
+	ASSERT_EQ(1, diff.getLinksChanged().size());
+	EXPECT_EQ("right", *diff.getLinksChanged().begin());
+	EXPECT_TRUE(diff.getOptionsChanged().empty());
+	EXPECT_FALSE(diff.needsOptions("right"));
+}
+
+TEST(CConfigDiffTests, screenRemoved_reportsRemovedAndRelinked)
+{
+	CConfig oldConfig(NULL), newConfig(NULL);
+	configDiff_read(oldConfig, g_configDiff_base);
+	CString text = configDiff_replace(g_configDiff_base, "	right:\n", "");
+	text = configDiff_replace(text, "		right = right\n", "");
+	text = configDiff_replace(text, "	right:\n		left = server\n", "");
+	configDiff_read(newConfig, text);
+
+	CConfigDiff diff(oldConfig, newConfig);
+
+	ASSERT_EQ(1, diff.getRemovedScreens().size());
+	EXPECT_EQ("right", *diff.getRemovedScreens().begin());
+	EXPECT_TRUE(diff.getAddedScreens().empty());
+	ASSERT_EQ(1, diff.getLinksChanged().size());
+	EXPECT_EQ("server", *diff.getLinksChanged().begin());
+	EXPECT_FALSE(diff.haveAliasesChanged());
+}
+
+TEST(CConfigDiffTests, aliasAndHotKeyChanged_reportsAliasesAndFilter)
+{
+	CConfig oldConfig(NULL), newConfig(NULL);
+	configDiff_read(oldConfig, g_configDiff_base);
+	CString text = configDiff_replace(g_configDiff_base,
+		"left.example.com", "left.example.org");
+	text = configDiff_replace(text, "alt+1", "alt+2");
+	configDiff_read(newConfig, text);
+
+	CConfigDiff diff(oldConfig, newConfig);
+
+	EXPECT_TRUE(diff.haveAliasesChanged());
+	EXPECT_TRUE(diff.hasInputFilterChanged());
+	EXPECT_TRUE(diff.getOptionsChanged().empty());
+	EXPECT_FALSE(diff.haveGlobalOptionsChanged());
+}
@@ -0,0 +1,266 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2013 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/mock/server/MockPrimaryClient.h"
+#include "server/InputFilter.h"
+#include "server/Server.h"
+#include "base/EventQueue.h"
+#include "base/Stopwatch.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::Return;
+
+const UInt32 g_inputFilter_numRules = 500;
+const UInt32 g_inputFilter_numEvents = 100000;
+
+class CInputFilterTests : public ::testing::Test {
+public:
+	CInputFilterTests() : m_nextHotKeyID(1) { }
+
+	virtual void		SetUp();
+	virtual void		TearDown();
+
+	UInt32				registerHotKey(KeyID, KeyModifierMask);
+	void				handleSwitchToScreen(const CEvent&, void*);
+	void				handleUnfiltered(const CEvent&, void*);
+
+	void				sendHotKeyDown(UInt32 id);
+	void				sendButtonDown(ButtonID, KeyModifierMask);
+	void				sendKeyDown(KeyID);
+
+public:
+	CEventQueue			m_events;
+	NiceMock<CMockPrimaryClient> m_primary;
+	CInputFilter*		m_filter;
+	UInt32				m_nextHotKeyID;
+	std::vector<CString> m_switches;
+	UInt32				m_unfiltered;
+	int					m_target;
+};
+
+void
+CInputFilterTests::SetUp()
+{
+	m_unfiltered = 0;
+	m_filter = new CInputFilter(&m_events);
+
+	ON_CALL(m_primary, getEventTarget()).WillByDefault(Return(&m_target));
+	ON_CALL(m_primary, registerHotKey(_, _)).WillByDefault(
+		Invoke(this, &CInputFilterTests::registerHotKey));
+
+	m_events.adoptHandler(m_events.forCServer().switchToScreen(), m_filter,
+		new TMethodEventJob<CInputFilterTests>(this,
+			&CInputFilterTests::handleSwitchToScreen));
+	m_events.adoptHandler(m_events.forIKeyState().keyDown(), m_filter,
+		new TMethodEventJob<CInputFilterTests>(this,
+			&CInputFilterTests::handleUnfiltered));
+	m_events.adoptHandler(m_events.forIPrimaryScreen().buttonDown(), m_filter,
+		new TMethodEventJob<CInputFilterTests>(this,
+			&CInputFilterTests::handleUnfiltered));
+}
+
+void
+CInputFilterTests::TearDown()
+{
+	m_events.removeHandlers(m_filter);
+	delete m_filter;
+}
+
+UInt32
+CInputFilterTests::registerHotKey(KeyID, KeyModifierMask)
+{
+	return m_nextHotKeyID++;
+}
+
+void
+CInputFilterTests::handleSwitchToScreen(const CEvent& event, void*)
+{
+	CServer::CSwitchToScreenInfo* info =
+		reinterpret_cast<CServer::CSwitchToScreenInfo*>(event.getData());
+	m_switches.push_back(info->m_screen);
+}
+
+void
+CInputFilterTests::handleUnfiltered(const CEvent&, void*)
+{
+	++m_unfiltered;
+}
+
+void
+CInputFilterTests::sendHotKeyDown(UInt32 id)
+{
+	m_events.addEvent(CEvent(m_events.forIPrimaryScreen().hotKeyDown(),
+		&m_target, IPlatformScreen::CHotKeyInfo::alloc(id),
+		CEvent::kDeliverImmediately));
+}
+
+void
+CInputFilterTests::sendButtonDown(ButtonID button, KeyModifierMask mask)
+{
+	m_events.addEvent(CEvent(m_events.forIPrimaryScreen().buttonDown(),
+		&m_target, IPlatformScreen::CButtonInfo::alloc(button, mask),
+		CEvent::kDeliverImmediately));
+}
+
+void
+CInputFilterTests::sendKeyDown(KeyID key)
+{
+	m_events.addEvent(CEvent(m_events.forIKeyState().keyDown(),
+		&m_target, IPlatformScreen::CKeyInfo::alloc(key, 0, 0, 1),
+		CEvent::kDeliverImmediately));
+}
+
+TEST_F(CInputFilterTests, handleEvent_hotKey_firstMatchingRuleWins)
+{
+	for (UInt32 i = 0; i < g_inputFilter_numRules; ++i) {
+		CInputFilter::CRule rule(new CInputFilter::CKeystrokeCondition(
+			&m_events, 'a' + i, KeyModifierControl));
+		rule.adoptAction(new CInputFilter::CSwitchToScreenAction(&m_events,
+			synergy::string::sprintf("screen%d", i)), true);
+		m_filter->addFilterRule(rule);
+	}
+
+	// a connect rule with an empty screen matches every connect event,
+	// so it must not be considered for hotkeys.
+	CInputFilter::CRule rule(new CInputFilter::CScreenConnectedCondition(
+		&m_events, ""));
+	rule.adoptAction(new CInputFilter::CSwitchToScreenAction(&m_events,
+		"connected"), true);
+	m_filter->addFilterRule(rule);
+
+	m_filter->setPrimaryClient(&m_primary);
+
+	sendHotKeyDown(1);
+	sendHotKeyDown(g_inputFilter_numRules);
+	sendHotKeyDown(g_inputFilter_numRules + 1);
+
+	ASSERT_EQ(2, m_switches.size());
+	EXPECT_EQ("screen0", m_switches[0]);
+	EXPECT_EQ(synergy::string::sprintf("screen%d",
+		g_inputFilter_numRules - 1), m_switches[1]);
+
+	m_filter->setPrimaryClient(NULL);
+}
+
+TEST_F(CInputFilterTests, handleEvent_mouseButton_ignoresLockModifiers)
+{
+	CInputFilter::CRule rule(new CInputFilter::CMouseButtonCondition(
+		&m_events, 3, KeyModifierShift));
+	rule.adoptAction(new CInputFilter::CSwitchToScreenAction(&m_events,
+		"button"), true);
+	m_filter->addFilterRule(rule);
+	m_filter->setPrimaryClient(&m_primary);
+
+	sendButtonDown(3, KeyModifierShift | KeyModifierNumLock);
+	sendButtonDown(3, KeyModifierControl);
+	sendButtonDown(2, KeyModifierShift);
+
+	ASSERT_EQ(1, m_switches.size());
+	EXPECT_EQ("button", m_switches[0]);
+	EXPECT_EQ(2, m_unfiltered);
+
+	m_filter->setPrimaryClient(NULL);
+}
+
+TEST_F(CInputFilterTests, handleEvent_removeRule_recompilesIndex)
+{
+	for (UInt32 i = 0; i < 2; ++i) {
+		CInputFilter::CRule rule(new CInputFilter::CMouseButtonCondition(
+			&m_events, 1, 0));
+		rule.adoptAction(new CInputFilter::CSwitchToScreenAction(&m_events,
+			synergy::string::sprintf("screen%d", i)), true);
+		m_filter->addFilterRule(rule);
+	}
+	m_filter->setPrimaryClient(&m_primary);
+
+	sendButtonDown(1, 0);
+	m_filter->removeFilterRule(0);
+	sendButtonDown(1, 0);
+
+	ASSERT_EQ(2, m_switches.size());
+	EXPECT_EQ("screen0", m_switches[0]);
+	EXPECT_EQ("screen1", m_switches[1]);
+
+	m_filter->setPrimaryClient(NULL);
+}
+
+TEST_F(CInputFilterTests, assign_sameRules_copiesAnyway)
+{
+	CInputFilter other(&m_events);
+	CInputFilter::CRule rule(new CInputFilter::CKeystrokeCondition(
+		&m_events, 'a', KeyModifierControl));
+	rule.adoptAction(new CInputFilter::CSwitchToScreenAction(&m_events,
+		"screen"), true);
+	m_filter->addFilterRule(rule);
+	other.addFilterRule(rule);
+	m_filter->setPrimaryClient(&m_primary);
+	EXPECT_TRUE(m_filter->hasSameRules(other));
+
+	// assignment is a plain copy, reregistering the hotkey.  callers
+	// that want to keep it compare the rules first.
+	*m_filter = other;
+	sendHotKeyDown(2);
+
+	ASSERT_EQ(1, m_switches.size());
+	EXPECT_EQ(3, m_nextHotKeyID);
+
+	m_filter->setPrimaryClient(NULL);
+}
+
+TEST_F(CInputFilterTests, handleEvent_benchmark500Rules)
+{
+	for (UInt32 i = 0; i < g_inputFilter_numRules; ++i) {
+		CInputFilter::CRule rule;
+		if ((i & 1) == 0) {
+			rule.setCondition(new CInputFilter::CKeystrokeCondition(
+				&m_events, 'a' + i, KeyModifierAlt));
+		}
+		else {
+			rule.setCondition(new CInputFilter::CMouseButtonCondition(
+				&m_events, static_cast<ButtonID>(1 + (i % 200)),
+				KeyModifierShift | KeyModifierControl));
+		}
+		rule.adoptAction(new CInputFilter::CSwitchToScreenAction(&m_events,
+			"hotkey"), true);
+		m_filter->addFilterRule(rule);
+	}
+	m_filter->setPrimaryClient(&m_primary);
+	m_filter->compileRules();
+
+	// ordinary typing and clicking matches no rule, which is the common
+	// case on the input path.
+	CStopwatch stopwatch;
+	for (UInt32 i = 0; i < g_inputFilter_numEvents / 2; ++i) {
+		sendKeyDown('a' + (i % 26));
+		sendButtonDown(1, 0);
+	}
+	double elapsed = stopwatch.getTime();
+
+	EXPECT_EQ(g_inputFilter_numEvents, m_unfiltered);
+	EXPECT_TRUE(m_switches.empty());
+	LOG((CLOG_INFO "filtered %d events through %d rules in %.3fs (%.0f events/s)",
+		g_inputFilter_numEvents, g_inputFilter_numRules, elapsed,
+		g_inputFilter_numEvents / elapsed));
+
+	m_filter->setPrimaryClient(NULL);
+}
@@ -0,0 +1,132 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test/mock/io/MockStream.h"
+#include "synergy/CaptureStreamFilter.h"
+#include "base/EventQueue.h"
+
+#include "test/global/gtest.h"
+
+#include <cstdio>
+#include <cstring>
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::Return;
+
+const char* g_captureStreamFilter_path = "CaptureStreamFilterTests.cap";
+
+// a mouse move, read by the tests in two pieces
+const char g_captureStreamFilter_move[] = "DMMV\x00\x10\x00\x20";
+const UInt32 g_captureStreamFilter_moveSize = 8;
+UInt32 g_captureStreamFilter_readOffset = 0;
+
+static UInt32
+captureStreamFilter_readMove(void* buffer, UInt32 n)
+{
+	UInt32 left = g_captureStreamFilter_moveSize -
+					g_captureStreamFilter_readOffset;
+	if (n > left) {
+		n = left;
+	}
+	memcpy(buffer, g_captureStreamFilter_move +
+					g_captureStreamFilter_readOffset, n);
+	g_captureStreamFilter_readOffset += n;
+	return n;
+}
+
+TEST(CCaptureStreamFilterTests, readAndWrite_captured_loadsInOrder)
+{
+	CEventQueue events;
+	NiceMock<CMockStream> stream;
+	g_captureStreamFilter_readOffset = 0;
+	ON_CALL(stream, getSize()).WillByDefault(
+		Return(g_captureStreamFilter_moveSize));
+	ON_CALL(stream, read(_, _)).WillByDefault(
+		Invoke(captureStreamFilter_readMove));
+
+	{
+		CCaptureStreamFilter filter(&events, &stream,
+			g_captureStreamFilter_path, CProtocolCapture::kServer, false);
+		filter.write("QINF", 4);
+
+		char buffer[8];
+		EXPECT_EQ(4, filter.read(buffer, 4));
+		EXPECT_EQ(4, filter.read(buffer + 4, 4));
+		EXPECT_EQ(0, memcmp(buffer, g_captureStreamFilter_move, 8));
+
+		CSharedBufferList buffers;
+		buffers.push_back(CSharedBuffer("CNOP", 4));
+		buffers.push_back(CSharedBuffer("\x01", 1));
+		filter.writeBuffers(buffers);
+	}
+
+	CProtocolCapture::ESide side;
+	CProtocolCapture::CMessageList messages;
+	bool loaded = CProtocolCapture::load(g_captureStreamFilter_path,
+							side, messages);
+	remove(g_captureStreamFilter_path);
+
+	ASSERT_TRUE(loaded);
+	EXPECT_EQ(CProtocolCapture::kServer, side);
+	ASSERT_EQ(3, messages.size());
+	EXPECT_TRUE(messages[0].m_sent);
+	EXPECT_EQ("QINF", messages[0].m_data);
+	EXPECT_FALSE(messages[1].m_sent);
+	EXPECT_EQ(CString(g_captureStreamFilter_move, 8), messages[1].m_data);
+	EXPECT_TRUE(messages[2].m_sent);
+	EXPECT_EQ(CString("CNOP\x01", 5), messages[2].m_data);
+	EXPECT_LE(messages[0].m_time, messages[1].m_time);
+	EXPECT_LE(messages[1].m_time, messages[2].m_time);
+}
+
+TEST(CCaptureStreamFilterTests, load_cutShort_keepsWholeMessages)
+{
+	{
+		CProtocolCapture capture;
+		ASSERT_TRUE(capture.open(g_captureStreamFilter_path,
+							CProtocolCapture::kClient));
+		capture.write(false, "CALV", 4);
+		capture.write(false, "DKDN\x00\x61", 6);
+	}
+
+	// drop the last byte, as if the program stopped mid-write
+	CString data;
+	{
+		FILE* file = fopen(g_captureStreamFilter_path, "rb");
+		ASSERT_TRUE(file != NULL);
+		char buffer[256];
+		data.assign(buffer, fread(buffer, 1, sizeof(buffer), file));
+		fclose(file);
+		file = fopen(g_captureStreamFilter_path, "wb");
+		fwrite(data.data(), 1, data.size() - 1, file);
+		fclose(file);
+	}
+
+	CProtocolCapture::ESide side;
+	CProtocolCapture::CMessageList messages;
+	bool loaded = CProtocolCapture::load(g_captureStreamFilter_path,
+							side, messages);
+	remove(g_captureStreamFilter_path);
+
+	ASSERT_TRUE(loaded);
+	EXPECT_EQ(CProtocolCapture::kClient, side);
+	ASSERT_EQ(1, messages.size());
+	EXPECT_EQ("CALV", messages[0].m_data);
+}
@@ -16,10 +16,55 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "test/mock/io/MockStream.h"
 #include "synergy/Clipboard.h"
+#include "synergy/PacketStreamFilter.h"
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "synergy/clipboard_types.h"
+#include "io/StreamBuffer.h"
+#include "base/EventQueue.h"
+#include "base/Stopwatch.h"
+#include "base/Log.h"
 
 #include "test/global/gtest.h"
 
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::Return;
+
+const UInt32 g_clipboard_benchmarkSize = 100 * 1024 * 1024;
+
+// a socket:  what's written can be read back
+class CClipboardTestSocket {
+public:
+	void				write(const void* buffer, UInt32 n)
+	{
+		m_buffer.write(buffer, n);
+	}
+
+	void				writeBuffers(const CSharedBufferList& buffers)
+	{
+		for (CSharedBufferList::const_iterator i = buffers.begin();
+								i != buffers.end(); ++i) {
+			m_buffer.write(*i);
+		}
+	}
+
+	UInt32				read(void* buffer, UInt32 n)
+	{
+		if (n > m_buffer.getSize()) {
+			n = m_buffer.getSize();
+		}
+		m_buffer.read(buffer, n);
+		return n;
+	}
+
+public:
+	CStreamBuffer		m_buffer;
+};
+
 TEST(CClipboardTests, empty_openCalled_returnsTrue)
 {
 	CClipboard clipboard;
@@ -402,3 +447,102 @@ TEST(CClipboardTests, copy_withSingleText_clipboardsAreEqual)
 	CString actual = clipboard2.get(CClipboard::kText);
 	EXPECT_EQ("synergy rocks!", actual);
 }
+
+TEST(CClipboardTests, marshallBuffers_textAndHtml_sameAsMarshall)
+{
+	CClipboard clipboard;
+	clipboard.open(0);
+	clipboard.add(IClipboard::kText, "synergy rocks!");
+	clipboard.add(IClipboard::kHTML, "html sucks");
+	clipboard.close();
+
+	CSharedBufferList buffers;
+	UInt32 size = clipboard.marshall(buffers);
+	UInt32 genericSize = IClipboard::marshall(&clipboard, buffers);
+
+	CString actual;
+	for (CSharedBufferList::const_iterator i = buffers.begin();
+							i != buffers.end(); ++i) {
+		actual += i->toString();
+	}
+	CString expected = clipboard.marshall();
+	EXPECT_EQ(expected.size(), size);
+	EXPECT_EQ(expected.size(), genericSize);
+	EXPECT_EQ(expected + expected, actual);
+}
+
+TEST(CClipboardTests, unmarshallBuffer_truncated_keepsWholeFormats)
+{
+	CClipboard source;
+	source.open(0);
+	source.add(IClipboard::kText, "synergy rocks!");
+	source.add(IClipboard::kHTML, "html sucks");
+	source.close();
+	CString data = source.marshall();
+	data.resize(data.size() - 1);
+
+	CClipboard clipboard;
+	clipboard.unmarshall(CSharedBuffer::adopt(data), 0);
+
+	clipboard.open(0);
+	EXPECT_EQ("synergy rocks!", clipboard.get(IClipboard::kText));
+	EXPECT_FALSE(clipboard.has(IClipboard::kHTML));
+	clipboard.close();
+}
+
+TEST(CClipboardTests, benchmark_100MBThroughPacketStream)
+{
+	CEventQueue events;
+	int target;
+	CClipboardTestSocket socket;
+	NiceMock<CMockStream> stream;
+	ON_CALL(stream, getEventTarget()).WillByDefault(Return(&target));
+	ON_CALL(stream, write(_, _)).WillByDefault(
+		Invoke(&socket, &CClipboardTestSocket::write));
+	ON_CALL(stream, writeBuffers(_)).WillByDefault(
+		Invoke(&socket, &CClipboardTestSocket::writeBuffers));
+	ON_CALL(stream, read(_, _)).WillByDefault(
+		Invoke(&socket, &CClipboardTestSocket::read));
+
+	CClipboard source;
+	source.open(0);
+	source.empty();
+	source.add(IClipboard::kText, CString(g_clipboard_benchmarkSize, 'x'));
+	source.add(IClipboard::kHTML, "<p>x</p>");
+	source.close();
+
+	// send it as the server does
+	CStopwatch stopwatch;
+	{
+		CPacketStreamFilter packetStream(&events, &stream, false);
+		CSharedBufferList data;
+		source.marshall(data);
+		CProtocolUtil::writefBuffers(&packetStream, data, kMsgDClipboard, 0, 1);
+	}
+	double sendTime = stopwatch.getTime();
+
+	// receive it as the client does, after the packet filter
+	stopwatch.reset();
+	UInt8 length[4];
+	socket.read(length, 4);
+	UInt8 code[4];
+	socket.read(code, 4);
+	ClipboardID id;
+	UInt32 seqNum;
+	CString data;
+	EXPECT_TRUE(CProtocolUtil::readf(&stream, kMsgDClipboard + 4,
+		&id, &seqNum, &data));
+	CClipboard received;
+	received.unmarshall(CSharedBuffer::adopt(data), 0);
+	double receiveTime = stopwatch.getTime();
+
+	// check the parts rather than get() a 100MB copy
+	CSharedBufferList parts;
+	EXPECT_EQ(source.marshall(parts), received.marshall(parts));
+	EXPECT_EQ(g_clipboard_benchmarkSize, parts[7].getSize());
+	EXPECT_EQ("<p>x</p>", parts[9].toString());
+	EXPECT_EQ(0, socket.m_buffer.getSize());
+
+	LOG((CLOG_INFO "clipboard of %dMB sent in %.3fs, received in %.3fs",
+		g_clipboard_benchmarkSize / (1024 * 1024), sendTime, receiveTime));
+}
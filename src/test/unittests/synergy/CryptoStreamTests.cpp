@@ -273,6 +273,23 @@ TEST(CCryptoStreamTests, newIvDoesNotChangeIv)
 	EXPECT_EQ(92, g_newIvDoesNotChangeIv_buffer[0]);
 }
 
+TEST(CCryptoStreamTests, precomputedKey_sameAsPassword)
+{
+	NiceMock<CMockEventQueue> eventQueue;
+	NiceMock<CMockStream> innerStream;
+	CCryptoOptions options("cfb", "mock");
+
+	ON_CALL(innerStream, write(_, _)).WillByDefault(Invoke(newIvDoesNotChangeIv_mockWrite));
+
+	byte key[synergy::crypto::kKeyLength];
+	byte iv[CRYPTO_IV_SIZE];
+	CCryptoStream::createKeys(options, key, iv);
+
+	CCryptoStream cs1(&eventQueue, &innerStream, options, key, iv, false);
+	cs1.write("a", 1);
+	EXPECT_EQ(175, g_newIvDoesNotChangeIv_buffer[0]);
+}
+
 void
 write_mockWrite(const void* in, UInt32 n)
 {
@@ -0,0 +1,460 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/FileReceiver.h"
+#include "synergy/FileChunker.h"
+#include "synergy/FileSender.h"
+#include "synergy/protocol_types.h"
+#include "arch/Arch.h"
+#include "base/EventQueue.h"
+#include "base/EventTypes.h"
+#include "base/Stopwatch.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+#include <fstream>
+#include <cstdio>
+#include <iterator>
+
+const UInt32 g_fileReceiver_numSmallFiles = 1000;
+const UInt64 g_fileReceiver_largeFileSize = 64 * 1024 * 1024;
+const UInt64 g_fileReceiver_hugeFileSize = 4ULL * 1024 * 1024 * 1024;
+const double g_fileReceiver_timeout = 600;
+const UInt64 g_fileReceiver_resumeFileSize = 8 * 1024 * 1024 + 1000;
+const UInt32 g_fileReceiver_interruptAt = 5;
+
+// not a real mark.  stands for the connection coming back.
+const UInt8 g_fileReceiver_reconnect = 0;
+
+CString
+fileReceiver_checksum(const CString& data)
+{
+	char checksum[9];
+	sprintf(checksum, "%08x",
+		CFileChunker::checksum(0, data.data(), data.size()));
+	return checksum;
+}
+
+class CFileReceiverTests : public ::testing::Test {
+public:
+	virtual void		SetUp();
+	virtual void		TearDown();
+
+	// sends m_paths through a real event queue into m_receiver.  if
+	// m_interruptAt is set the connection is lost at that data chunk
+	// and the transfer is resumed.
+	void				transfer();
+
+	void				handleChunk(const CEvent&, void*);
+	void				handleTimeout(const CEvent&, void*);
+
+	CString				path(const CString& name) const;
+	void				writeFile(const CString& name, UInt64 size, UInt8 seed);
+	bool				compareFile(const CString& from, const CString& to);
+	void				removeAll(const CString& path);
+
+public:
+	CEventQueue			m_events;
+	CFileReceiver*		m_receiver;
+	CFileSender*		m_sender;
+	CString				m_root;
+	CString				m_paths;
+	bool				m_complete;
+	bool				m_disconnected;
+	UInt32				m_dataChunks;
+	UInt32				m_interruptAt;
+	bool				m_firstFileOnly;
+};
+
+void
+CFileReceiverTests::SetUp()
+{
+	char name[40];
+	sprintf(name, "synergy-test-%08x", static_cast<UInt32>(ARCH->nanoTime()));
+	m_root = ARCH->concatPath(ARCH->getTempDirectory(), name);
+	ASSERT_TRUE(ARCH->makeDirectory(m_root));
+	ASSERT_TRUE(ARCH->makeDirectory(path("in")));
+	ASSERT_TRUE(ARCH->makeDirectory(path("out")));
+	m_receiver      = new CFileReceiver("test", m_root);
+	m_sender        = NULL;
+	m_complete      = false;
+	m_disconnected  = false;
+	m_dataChunks    = 0;
+	m_interruptAt   = 0;
+	m_firstFileOnly = false;
+}
+
+void
+CFileReceiverTests::TearDown()
+{
+	m_receiver->clear();
+	delete m_receiver;
+	removeAll(m_root);
+}
+
+void
+CFileReceiverTests::transfer()
+{
+	int target;
+	m_events.adoptHandler(m_events.forIScreen().fileChunkSending(), &target,
+		new TMethodEventJob<CFileReceiverTests>(this,
+			&CFileReceiverTests::handleChunk));
+	CEventQueueTimer* timeout = m_events.newOneShotTimer(g_fileReceiver_timeout, NULL);
+	m_events.adoptHandler(CEvent::kTimer, timeout,
+		new TMethodEventJob<CFileReceiverTests>(this,
+			&CFileReceiverTests::handleTimeout));
+
+	m_sender = new CFileSender(&m_events, &target);
+	m_sender->send(m_paths, m_firstFileOnly);
+	m_events.loop();
+	delete m_sender;
+	m_sender = NULL;
+
+	m_events.removeHandler(CEvent::kTimer, timeout);
+	m_events.deleteTimer(timeout);
+	m_events.removeHandlers(&target);
+}
+
+void
+CFileReceiverTests::handleChunk(const CEvent& event, void*)
+{
+	CFileChunker::CFileChunk* chunk =
+		static_cast<CFileChunker::CFileChunk*>(event.getDataObject());
+	CString content(chunk->m_chunk + 1, chunk->m_dataSize);
+	UInt8 mark = chunk->m_chunk[0];
+
+	if (mark == g_fileReceiver_reconnect) {
+		CString request;
+		m_disconnected = false;
+		if (m_receiver->getResumeRequest(request)) {
+			m_sender->resume(request);
+		}
+		return;
+	}
+	if (m_disconnected) {
+		return;
+	}
+	if (mark == kFileChunk && ++m_dataChunks == m_interruptAt) {
+		// lose this chunk and any already queued, then reconnect
+		m_disconnected = true;
+		m_sender->suspend();
+		CFileChunker::CFileChunk* reconnect = new CFileChunker::CFileChunk(2);
+		reconnect->m_chunk[0] = g_fileReceiver_reconnect;
+		reconnect->m_chunk[1] = '\0';
+		CEvent reconnectEvent(m_events.forIScreen().fileChunkSending(),
+							event.getTarget());
+		reconnectEvent.setDataObject(reconnect);
+		m_events.addEvent(reconnectEvent);
+		return;
+	}
+
+	switch (mark) {
+	case kFileStart:
+		m_receiver->start(content, "");
+		break;
+
+	case kFileChunk:
+		m_receiver->write(content);
+		break;
+
+	case kFileCheck:
+		m_receiver->check(content);
+		break;
+
+	case kFileEnd:
+		if (m_receiver->end()) {
+			m_complete = true;
+			m_events.addEvent(CEvent(CEvent::kQuit));
+		}
+		break;
+	}
+}
+
+void
+CFileReceiverTests::handleTimeout(const CEvent&, void*)
+{
+	m_events.addEvent(CEvent(CEvent::kQuit));
+}
+
+CString
+CFileReceiverTests::path(const CString& name) const
+{
+	return ARCH->concatPath(m_root, name);
+}
+
+void
+CFileReceiverTests::writeFile(const CString& name, UInt64 size, UInt8 seed)
+{
+	std::ofstream file(path(name).c_str(), std::ios::out | std::ios::binary);
+	std::vector<char> buffer(64 * 1024);
+	for (size_t i = 0; i < buffer.size(); ++i) {
+		buffer[i] = static_cast<char>(seed + i * 7);
+	}
+	while (size > 0) {
+		size_t n = (size < buffer.size()) ? static_cast<size_t>(size) : buffer.size();
+		file.write(&buffer[0], n);
+		size -= n;
+	}
+}
+
+bool
+CFileReceiverTests::compareFile(const CString& from, const CString& to)
+{
+	std::ifstream a(path(from).c_str(), std::ios::in | std::ios::binary);
+	std::ifstream b(path(to).c_str(), std::ios::in | std::ios::binary);
+	if (!a.is_open() || !b.is_open()) {
+		return false;
+	}
+
+	std::vector<char> bufferA(64 * 1024), bufferB(64 * 1024);
+	while (a && b) {
+		a.read(&bufferA[0], bufferA.size());
+		b.read(&bufferB[0], bufferB.size());
+		if (a.gcount() != b.gcount() ||
+			!std::equal(bufferA.begin(), bufferA.begin() + a.gcount(), bufferB.begin())) {
+			return false;
+		}
+	}
+	return !a && !b;
+}
+
+void
+CFileReceiverTests::removeAll(const CString& name)
+{
+	if (ARCH->isDirectory(name)) {
+		std::vector<std::string> names;
+		ARCH->listDirectory(name, names);
+		for (size_t i = 0; i < names.size(); ++i) {
+			removeAll(ARCH->concatPath(name, names[i]));
+		}
+	}
+	remove(name.c_str());
+}
+
+TEST_F(CFileReceiverTests, transfer_twoFiles_namedAndValid)
+{
+	writeFile("in/first.txt", 1000, 1);
+	writeFile("in/empty", 0, 2);
+	m_paths = path("in/first.txt") + "\n" + path("in/empty") + "\n";
+
+	transfer();
+
+	ASSERT_TRUE(m_complete);
+	EXPECT_TRUE(m_receiver->isValid());
+	ASSERT_EQ(2, m_receiver->getFiles().size());
+	EXPECT_EQ("first.txt", m_receiver->getFiles()[0].m_name);
+	EXPECT_EQ("empty", m_receiver->getFiles()[1].m_name);
+
+	EXPECT_TRUE(m_receiver->moveTo(path("out")));
+	EXPECT_TRUE(compareFile("in/first.txt", "out/first.txt"));
+	EXPECT_TRUE(compareFile("in/empty", "out/empty"));
+	EXPECT_TRUE(m_receiver->getFiles().empty());
+}
+
+TEST_F(CFileReceiverTests, transfer_firstFileOnly_oneFileSent)
+{
+	// what an old receiver gets from a multi-file drag
+	writeFile("in/first.txt", 1000, 1);
+	writeFile("in/second.txt", 1000, 2);
+	m_paths = path("in/first.txt") + "\n" + path("in/second.txt");
+	m_firstFileOnly = true;
+
+	transfer();
+
+	ASSERT_TRUE(m_complete);
+	EXPECT_TRUE(m_receiver->isValid());
+	ASSERT_EQ(1, m_receiver->getFiles().size());
+	EXPECT_EQ("first.txt", m_receiver->getFiles()[0].m_name);
+}
+
+TEST_F(CFileReceiverTests, transfer_directoryOfSmallFiles_treeRecreated)
+{
+	ASSERT_TRUE(ARCH->makeDirectory(path("in/tree")));
+	ASSERT_TRUE(ARCH->makeDirectory(path("in/tree/sub")));
+	for (UInt32 i = 0; i < g_fileReceiver_numSmallFiles; ++i) {
+		CString name = (i % 2 == 0) ? "in/tree/" : "in/tree/sub/";
+		writeFile(name + CFileChunker::intToString(i), 100 + i, static_cast<UInt8>(i));
+	}
+	m_paths = path("in/tree");
+
+	CStopwatch stopwatch;
+	transfer();
+	double elapsed = stopwatch.getTime();
+
+	ASSERT_TRUE(m_complete);
+	EXPECT_TRUE(m_receiver->isValid());
+	EXPECT_EQ(g_fileReceiver_numSmallFiles, m_receiver->getFiles().size());
+	EXPECT_TRUE(m_receiver->moveTo(path("out")));
+	EXPECT_TRUE(compareFile("in/tree/0", "out/tree/0"));
+	EXPECT_TRUE(compareFile("in/tree/sub/999", "out/tree/sub/999"));
+
+	LOG((CLOG_INFO "%d small files in %.3fs, %.0f files/s",
+		g_fileReceiver_numSmallFiles, elapsed,
+		g_fileReceiver_numSmallFiles / elapsed));
+}
+
+TEST_F(CFileReceiverTests, transfer_largeFile_valid)
+{
+	writeFile("in/large", g_fileReceiver_largeFileSize, 3);
+	m_paths = path("in/large");
+
+	CStopwatch stopwatch;
+	transfer();
+	double elapsed = stopwatch.getTime();
+
+	ASSERT_TRUE(m_complete);
+	EXPECT_TRUE(m_receiver->isValid());
+	EXPECT_TRUE(m_receiver->moveTo(path("out")));
+	EXPECT_TRUE(compareFile("in/large", "out/large"));
+
+	LOG((CLOG_INFO "%.0fMB file in %.3fs, %.1fMB/s",
+		g_fileReceiver_largeFileSize / 1048576.0, elapsed,
+		g_fileReceiver_largeFileSize / 1048576.0 / elapsed));
+}
+
+// takes about a minute and 8GB of disk, run by hand
+TEST_F(CFileReceiverTests, DISABLED_transfer_hugeFile_valid)
+{
+	writeFile("in/huge", g_fileReceiver_hugeFileSize, 4);
+	m_paths = path("in/huge");
+
+	CStopwatch stopwatch;
+	transfer();
+	double elapsed = stopwatch.getTime();
+
+	ASSERT_TRUE(m_complete);
+	EXPECT_TRUE(m_receiver->isValid());
+	EXPECT_EQ(g_fileReceiver_hugeFileSize, m_receiver->getExpectedSize());
+
+	LOG((CLOG_INFO "%.0fMB file in %.3fs, %.1fMB/s",
+		g_fileReceiver_hugeFileSize / 1048576.0, elapsed,
+		g_fileReceiver_hugeFileSize / 1048576.0 / elapsed));
+}
+
+TEST_F(CFileReceiverTests, transfer_interrupted_resumesFromVerifiedOffset)
+{
+	writeFile("in/first", 1000, 5);
+	writeFile("in/resumed", g_fileReceiver_resumeFileSize, 6);
+	m_paths = path("in/first") + "\n" + path("in/resumed");
+	m_interruptAt = g_fileReceiver_interruptAt;
+
+	transfer();
+
+	ASSERT_TRUE(m_complete);
+	EXPECT_TRUE(m_receiver->isValid());
+	ASSERT_EQ(2, m_receiver->getFiles().size());
+	EXPECT_TRUE(m_receiver->moveTo(path("out")));
+	EXPECT_TRUE(compareFile("in/first", "out/first"));
+	EXPECT_TRUE(compareFile("in/resumed", "out/resumed"));
+}
+
+TEST_F(CFileReceiverTests, recover_partialTransfer_resumesFromJournal)
+{
+	CString verified(1000, 'x');
+	CString lost(500, 'y');
+	{
+		// receiver goes away before the second check arrives
+		CFileReceiver receiver("recover", m_root);
+		receiver.start("1500,1,42,0,part.bin", "");
+		receiver.write(verified);
+		receiver.check(fileReceiver_checksum(verified));
+		receiver.write(lost);
+	}
+
+	CFileReceiver receiver("recover", m_root);
+	ASSERT_TRUE(receiver.recover());
+	CString request;
+	ASSERT_TRUE(receiver.getResumeRequest(request));
+	EXPECT_EQ("42,0,1000", request);
+
+	receiver.start("1500,1,42,1000,part.bin", "");
+	receiver.write(lost);
+	receiver.check(fileReceiver_checksum(lost));
+	EXPECT_TRUE(receiver.end());
+	EXPECT_TRUE(receiver.isValid());
+	EXPECT_FALSE(receiver.getResumeRequest(request));
+
+	EXPECT_TRUE(receiver.moveTo(path("out")));
+	std::ifstream file(path("out/part.bin").c_str(), std::ios::in | std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(file)),
+						std::istreambuf_iterator<char>());
+	EXPECT_EQ(verified + lost, content);
+}
+
+TEST_F(CFileReceiverTests, recover_unsafeNameInJournal_discarded)
+{
+	CString journalPath = path("synergy-unsafe-0000002a.journal");
+	{
+		std::ofstream journal(journalPath.c_str());
+		journal << "T 42 2\n" << "F 0 10 safe.txt\n" << "E 0 1\n"
+				<< "F 1 10 ../../.profile\n";
+	}
+
+	CFileReceiver receiver("unsafe", m_root);
+	EXPECT_FALSE(receiver.recover());
+	EXPECT_TRUE(receiver.getFiles().empty());
+	std::ifstream file(journalPath.c_str());
+	EXPECT_FALSE(file.is_open());
+}
+
+TEST_F(CFileReceiverTests, start_unsafeName_usesDefault)
+{
+	m_receiver->start("3,1,0,0,../../.profile", "safe.txt");
+	m_receiver->write("abc");
+	EXPECT_TRUE(m_receiver->end());
+
+	EXPECT_EQ("safe.txt", m_receiver->getFiles()[0].m_name);
+	EXPECT_TRUE(m_receiver->isValid());
+}
+
+TEST_F(CFileReceiverTests, start_oldHeader_sizeOnly)
+{
+	m_receiver->start("3", "old.txt");
+	m_receiver->write("abc");
+	EXPECT_TRUE(m_receiver->end());
+
+	EXPECT_EQ("old.txt", m_receiver->getFiles()[0].m_name);
+	EXPECT_EQ(3, m_receiver->getExpectedSize());
+	EXPECT_TRUE(m_receiver->isValid());
+}
+
+TEST_F(CFileReceiverTests, check_mismatch_invalidAndDiscarded)
+{
+	m_receiver->start("3,1,7,0,bad.txt", "");
+	m_receiver->write("abc");
+	m_receiver->check("00000000");
+	EXPECT_TRUE(m_receiver->end());
+
+	EXPECT_FALSE(m_receiver->isValid());
+	EXPECT_TRUE(m_receiver->moveTo(path("out")));
+	EXPECT_FALSE(ARCH->isDirectory(path("out/bad.txt")));
+	std::ifstream file(path("out/bad.txt").c_str());
+	EXPECT_FALSE(file.is_open());
+}
+
+TEST(CFileReceiverNameTests, isSafeName)
+{
+	EXPECT_TRUE(CFileReceiver::isSafeName("a.txt"));
+	EXPECT_TRUE(CFileReceiver::isSafeName("dir/sub/a.txt"));
+	EXPECT_FALSE(CFileReceiver::isSafeName(""));
+	EXPECT_FALSE(CFileReceiver::isSafeName("/etc/passwd"));
+	EXPECT_FALSE(CFileReceiver::isSafeName("dir/../../a"));
+	EXPECT_FALSE(CFileReceiver::isSafeName("dir//a"));
+	EXPECT_FALSE(CFileReceiver::isSafeName("c:\\a"));
+}
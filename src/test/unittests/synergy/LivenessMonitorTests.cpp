@@ -0,0 +1,177 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/LivenessMonitor.h"
+#include "base/EventQueue.h"
+#include "base/EventTypes.h"
+#include "base/Stopwatch.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+const double g_liveness_sweepRate = 0.05;
+const double g_liveness_timeout = 0.2;
+const UInt32 g_liveness_numPeers = 8;
+const UInt32 g_liveness_numBatches = 100000;
+
+class CLivenessMonitorTests : public ::testing::Test {
+public:
+	void				handleDead(const CEvent&, void*);
+	void				handleDeadUnwatch(const CEvent&, void*);
+	void				handleChatter(const CEvent&, void*);
+	void				handleQuit(const CEvent&, void*);
+
+public:
+	CEventQueue			m_events;
+	std::vector<void*>	m_dead;
+	CLivenessMonitor*	m_monitor;
+	double				m_chattyActivity;
+};
+
+void
+CLivenessMonitorTests::handleDead(const CEvent& event, void*)
+{
+	m_dead.push_back(event.getTarget());
+}
+
+void
+CLivenessMonitorTests::handleDeadUnwatch(const CEvent& event, void* target)
+{
+	// like a connection going away, and another taking its address
+	m_dead.push_back(event.getTarget());
+	m_monitor->unwatch(target);
+}
+
+void
+CLivenessMonitorTests::handleChatter(const CEvent&, void*)
+{
+	CLivenessMonitor::touch(m_chattyActivity);
+}
+
+void
+CLivenessMonitorTests::handleQuit(const CEvent&, void*)
+{
+	m_events.addEvent(CEvent(CEvent::kQuit));
+}
+
+TEST_F(CLivenessMonitorTests, sweep_silentPeerReportedOnce)
+{
+	CLivenessMonitor monitor(&m_events, g_liveness_sweepRate);
+	int chatty, silent;
+	double silentActivity;
+	m_events.adoptHandler(m_events.forCLivenessMonitor().dead(), &chatty,
+		new TMethodEventJob<CLivenessMonitorTests>(this,
+			&CLivenessMonitorTests::handleDead));
+	m_events.adoptHandler(m_events.forCLivenessMonitor().dead(), &silent,
+		new TMethodEventJob<CLivenessMonitorTests>(this,
+			&CLivenessMonitorTests::handleDead));
+
+	// one peer keeps talking, the other goes quiet
+	CEventQueueTimer* chatter = m_events.newTimer(g_liveness_sweepRate / 2, NULL);
+	m_events.adoptHandler(CEvent::kTimer, chatter,
+		new TMethodEventJob<CLivenessMonitorTests>(this,
+			&CLivenessMonitorTests::handleChatter));
+	CEventQueueTimer* quit = m_events.newOneShotTimer(3 * g_liveness_timeout, NULL);
+	m_events.adoptHandler(CEvent::kTimer, quit,
+		new TMethodEventJob<CLivenessMonitorTests>(this,
+			&CLivenessMonitorTests::handleQuit));
+
+	monitor.watch(&chatty, &m_chattyActivity, g_liveness_timeout);
+	monitor.watch(&silent, &silentActivity, g_liveness_timeout);
+	m_events.loop();
+
+	ASSERT_EQ(1, m_dead.size());
+	EXPECT_EQ(&silent, m_dead[0]);
+	EXPECT_EQ(1, monitor.getNumWatched());
+
+	monitor.unwatch(&chatty);
+	m_events.removeHandler(CEvent::kTimer, chatter);
+	m_events.removeHandler(CEvent::kTimer, quit);
+	m_events.deleteTimer(chatter);
+	m_events.deleteTimer(quit);
+	m_events.removeHandlers(&chatty);
+	m_events.removeHandlers(&silent);
+}
+
+TEST_F(CLivenessMonitorTests, sweep_unwatchedBeforeReport_notReported)
+{
+	CLivenessMonitor monitor(&m_events, g_liveness_sweepRate);
+	m_monitor = &monitor;
+	int peers[2];
+	double activity[2];
+
+	// both go quiet in the same sweep.  reporting the first unwatches
+	// the second before it's reported.
+	m_events.adoptHandler(m_events.forCLivenessMonitor().dead(), &peers[0],
+		new TMethodEventJob<CLivenessMonitorTests>(this,
+			&CLivenessMonitorTests::handleDeadUnwatch, &peers[1]));
+	m_events.adoptHandler(m_events.forCLivenessMonitor().dead(), &peers[1],
+		new TMethodEventJob<CLivenessMonitorTests>(this,
+			&CLivenessMonitorTests::handleDead));
+	CEventQueueTimer* quit = m_events.newOneShotTimer(3 * g_liveness_timeout, NULL);
+	m_events.adoptHandler(CEvent::kTimer, quit,
+		new TMethodEventJob<CLivenessMonitorTests>(this,
+			&CLivenessMonitorTests::handleQuit));
+
+	monitor.watch(&peers[0], &activity[0], g_liveness_timeout);
+	monitor.watch(&peers[1], &activity[1], g_liveness_timeout);
+	m_events.loop();
+
+	ASSERT_EQ(1, m_dead.size());
+	EXPECT_EQ(&peers[0], m_dead[0]);
+
+	m_events.removeHandler(CEvent::kTimer, quit);
+	m_events.deleteTimer(quit);
+	m_events.removeHandlers(&peers[0]);
+	m_events.removeHandlers(&peers[1]);
+}
+
+TEST_F(CLivenessMonitorTests, touch_motionStorm_noTimerChurn)
+{
+	CLivenessMonitor monitor(&m_events, g_liveness_sweepRate);
+	double activity[g_liveness_numPeers];
+	for (UInt32 i = 0; i < g_liveness_numPeers; ++i) {
+		monitor.watch(&activity[i], &activity[i], g_liveness_timeout);
+	}
+
+	// what a connection does for every batch of messages now
+	CStopwatch stopwatch;
+	for (UInt32 i = 0; i < g_liveness_numBatches; ++i) {
+		CLivenessMonitor::touch(activity[i % g_liveness_numPeers]);
+	}
+	double touchTime = stopwatch.getTime();
+
+	// what it used to do
+	CEventQueueTimer* timer = m_events.newOneShotTimer(g_liveness_timeout, NULL);
+	stopwatch.reset();
+	for (UInt32 i = 0; i < g_liveness_numBatches; ++i) {
+		m_events.deleteTimer(timer);
+		timer = m_events.newOneShotTimer(g_liveness_timeout, NULL);
+	}
+	double timerTime = stopwatch.getTime();
+	m_events.deleteTimer(timer);
+
+	EXPECT_EQ(1, monitor.getNumTimers());
+	LOG((CLOG_INFO "%d batches: touch %.3fms, timer reset %.3fms",
+		g_liveness_numBatches, 1000.0 * touchTime, 1000.0 * timerTime));
+
+	for (UInt32 i = 0; i < g_liveness_numPeers; ++i) {
+		monitor.unwatch(&activity[i]);
+	}
+	EXPECT_EQ(0, monitor.getNumWatched());
+}
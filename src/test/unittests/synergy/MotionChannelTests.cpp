@@ -0,0 +1,136 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/MotionChannel.h"
+
+#include "test/global/gtest.h"
+
+#include <cstring>
+
+static const UInt8 g_motion_key[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+	0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+	0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20
+};
+
+static const CMotionChannel::CPacket g_motion_packet(
+	42, CMotionChannel::kRelative, -5, 100000);
+
+TEST(CMotionChannelTests, decode_plain_roundTrip)
+{
+	CMotionChannel server(0x1234, NULL);
+	CMotionChannel client(0x1234, NULL);
+	CString data = server.encode(CMotionChannel::kToClient, g_motion_packet);
+
+	CMotionChannel::CPacket packet;
+	bool valid = client.decode(CMotionChannel::kToClient, data, packet);
+
+	EXPECT_TRUE(valid);
+	EXPECT_EQ(CMotionChannel::kSize, data.size());
+	EXPECT_EQ(42, packet.m_seq);
+	EXPECT_EQ(CMotionChannel::kRelative, packet.m_type);
+	EXPECT_EQ(-5, packet.m_a);
+	EXPECT_EQ(100000, packet.m_b);
+}
+
+TEST(CMotionChannelTests, decode_encrypted_roundTrip)
+{
+	CMotionChannel server(0x1234, g_motion_key);
+	CMotionChannel client(0x1234, g_motion_key);
+	CString data = server.encode(CMotionChannel::kToClient, g_motion_packet);
+
+	UInt32 token = 0;
+	CMotionChannel::CPacket packet;
+	bool valid = client.decode(CMotionChannel::kToClient, data, packet);
+
+	EXPECT_TRUE(valid);
+	EXPECT_TRUE(CMotionChannel::getToken(data, token));
+	EXPECT_EQ(0x1234, token);
+	EXPECT_EQ(CMotionChannel::kSize + CMotionChannel::kMacSize, data.size());
+	EXPECT_EQ(42, packet.m_seq);
+	EXPECT_EQ(-5, packet.m_a);
+	EXPECT_EQ(100000, packet.m_b);
+}
+
+TEST(CMotionChannelTests, decode_wrongToken_rejected)
+{
+	CMotionChannel server(0x1234, NULL);
+	CMotionChannel client(0x4321, NULL);
+	CString data = server.encode(CMotionChannel::kToClient, g_motion_packet);
+
+	CMotionChannel::CPacket packet;
+	EXPECT_FALSE(client.decode(CMotionChannel::kToClient, data, packet));
+}
+
+TEST(CMotionChannelTests, decode_wrongKey_rejected)
+{
+	UInt8 otherKey[sizeof(g_motion_key)];
+	memcpy(otherKey, g_motion_key, sizeof(otherKey));
+	otherKey[0] ^= 1;
+	CMotionChannel server(0x1234, g_motion_key);
+	CMotionChannel client(0x1234, otherKey);
+	CString data = server.encode(CMotionChannel::kToClient, g_motion_packet);
+
+	CMotionChannel::CPacket packet;
+	EXPECT_FALSE(client.decode(CMotionChannel::kToClient, data, packet));
+}
+
+TEST(CMotionChannelTests, decode_flippedBit_rejected)
+{
+	CMotionChannel server(0x1234, g_motion_key);
+	CMotionChannel client(0x1234, g_motion_key);
+	CString data = server.encode(CMotionChannel::kToClient, g_motion_packet);
+
+	// every bit of the payload is covered by the mac
+	for (UInt32 i = 0; i < CMotionChannel::kSize * 8; ++i) {
+		CString changed = data;
+		changed[i / 8] ^= static_cast<char>(1 << (i % 8));
+
+		CMotionChannel::CPacket packet;
+		EXPECT_FALSE(client.decode(CMotionChannel::kToClient,
+							changed, packet)) << "bit " << i;
+	}
+}
+
+TEST(CMotionChannelTests, decode_reflected_rejected)
+{
+	// a datagram sent to the client can't be replayed to the server
+	CMotionChannel server(0x1234, g_motion_key);
+	CString data = server.encode(CMotionChannel::kToClient, g_motion_packet);
+
+	CMotionChannel::CPacket packet;
+	EXPECT_FALSE(server.decode(CMotionChannel::kToServer, data, packet));
+}
+
+TEST(CMotionChannelTests, isLost_tenthLoss_aboutTenth)
+{
+	CMotionChannel channel(0x1234, NULL);
+	EXPECT_FALSE(channel.isLost());
+
+	channel.setLoss(0.1);
+	UInt32 lost = 0;
+	for (UInt32 i = 0; i < 10000; ++i) {
+		if (channel.isLost()) {
+			++lost;
+		}
+	}
+
+	EXPECT_LT(900, lost);
+	EXPECT_GT(1100, lost);
+}
@@ -0,0 +1,224 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test/mock/io/MockStream.h"
+#include "synergy/PacketStreamFilter.h"
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "base/EventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Stopwatch.h"
+
+#include "test/global/gtest.h"
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class CPacketStreamFilterTests : public ::testing::Test {
+public:
+	virtual void		SetUp();
+
+	void				write(const void* buffer, UInt32 n);
+	void				writeBuffers(const CSharedBufferList& buffers);
+
+	// handle events until the frame timer fires
+	void				waitForFrame();
+
+	// write to m_filter in the first event and keep the queue busy
+	// until something is written or a second has passed
+	void				handleBusy(const CEvent&, void*);
+
+	// split what was written into packets
+	std::vector<CString> getPackets() const;
+
+public:
+	CEventQueue			m_events;
+	NiceMock<CMockStream> m_stream;
+	int					m_target;
+	CString				m_written;
+	UInt32				m_numWrites;
+
+	CPacketStreamFilter* m_filter;
+	CEvent::Type		m_busyType;
+	UInt32				m_busyEvents;
+	CStopwatch			m_busyTime;
+	double				m_frameTime;
+};
+
+void
+CPacketStreamFilterTests::SetUp()
+{
+	m_numWrites  = 0;
+	m_filter     = NULL;
+	m_busyType   = CEvent::kUnknown;
+	m_busyEvents = 0;
+	m_frameTime  = -1.0;
+	ON_CALL(m_stream, getEventTarget()).WillByDefault(Return(&m_target));
+	ON_CALL(m_stream, write(_, _)).WillByDefault(
+		Invoke(this, &CPacketStreamFilterTests::write));
+	ON_CALL(m_stream, writeBuffers(_)).WillByDefault(
+		Invoke(this, &CPacketStreamFilterTests::writeBuffers));
+}
+
+void
+CPacketStreamFilterTests::write(const void* buffer, UInt32 n)
+{
+	m_written.append(static_cast<const char*>(buffer), n);
+	++m_numWrites;
+}
+
+void
+CPacketStreamFilterTests::writeBuffers(const CSharedBufferList& buffers)
+{
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		m_written += buffers[i].toString();
+	}
+	++m_numWrites;
+}
+
+void
+CPacketStreamFilterTests::waitForFrame()
+{
+	CEvent event;
+	while (m_events.getEvent(event, 1.0)) {
+		bool timer = (event.getType() == CEvent::kTimer);
+		m_events.dispatchEvent(event);
+		if (timer) {
+			break;
+		}
+	}
+}
+
+void
+CPacketStreamFilterTests::handleBusy(const CEvent&, void*)
+{
+	if (m_busyEvents++ == 0) {
+		m_busyTime.reset();
+		CProtocolUtil::writef(m_filter, kMsgDKeyDown, 'a', 0, 0);
+	}
+	else if (m_numWrites != 0 && m_frameTime < 0.0) {
+		m_frameTime = m_busyTime.getTime();
+	}
+
+	if (m_frameTime >= 0.0 || m_busyTime.getTime() > 1.0) {
+		m_events.addEvent(CEvent(CEvent::kQuit));
+	}
+	else {
+		m_events.addEvent(CEvent(m_busyType, this));
+	}
+}
+
+std::vector<CString>
+CPacketStreamFilterTests::getPackets() const
+{
+	std::vector<CString> packets;
+	const UInt8* data = reinterpret_cast<const UInt8*>(m_written.data());
+	for (size_t i = 0; i + 4 <= m_written.size(); ) {
+		UInt32 size = ((UInt32)data[i] << 24) | ((UInt32)data[i + 1] << 16) |
+					  ((UInt32)data[i + 2] << 8) | (UInt32)data[i + 3];
+		packets.push_back(m_written.substr(i + 4, size));
+		i += 4 + size;
+	}
+	return packets;
+}
+
+TEST_F(CPacketStreamFilterTests, write_batchingOff_packetPerMessage)
+{
+	CPacketStreamFilter filter(&m_events, &m_stream, false);
+
+	CProtocolUtil::writef(&filter, kMsgDKeyDown, 'a', 0, 0);
+	CProtocolUtil::writef(&filter, kMsgDKeyUp, 'a', 0, 0);
+
+	std::vector<CString> packets = getPackets();
+	ASSERT_EQ(2, packets.size());
+	EXPECT_EQ(CProtocolUtil::formatf(kMsgDKeyDown, 'a', 0, 0), packets[0]);
+	EXPECT_EQ(CProtocolUtil::formatf(kMsgDKeyUp, 'a', 0, 0), packets[1]);
+}
+
+TEST_F(CPacketStreamFilterTests, write_batched_onePacketWhenTimerFires)
+{
+	CPacketStreamFilter filter(&m_events, &m_stream, false);
+	filter.setBatchDelay(0.0);
+
+	CProtocolUtil::writef(&filter, kMsgDMouseMove, 1, 2);
+	CProtocolUtil::writef(&filter, kMsgDKeyDown, 'a', 0, 0);
+	CProtocolUtil::writef(&filter, kMsgDKeyUp, 'a', 0, 0);
+	EXPECT_EQ(0, m_numWrites);
+
+	waitForFrame();
+
+	std::vector<CString> packets = getPackets();
+	ASSERT_EQ(1, packets.size());
+	EXPECT_EQ(1, m_numWrites);
+	EXPECT_EQ(CProtocolUtil::formatf(kMsgDMouseMove, 1, 2) +
+			CProtocolUtil::formatf(kMsgDKeyDown, 'a', 0, 0) +
+			CProtocolUtil::formatf(kMsgDKeyUp, 'a', 0, 0), packets[0]);
+	EXPECT_EQ(1, filter.getNumFrames());
+	EXPECT_EQ(3, filter.getNumFramedWrites());
+	EXPECT_EQ(3, filter.getMaxFramedWrites());
+}
+
+TEST_F(CPacketStreamFilterTests, write_largeMessage_frameSentFirst)
+{
+	CPacketStreamFilter filter(&m_events, &m_stream, false);
+	filter.setBatchDelay(0.002);
+
+	CString chunk(4096, 'x');
+	CProtocolUtil::writef(&filter, kMsgDKeyDown, 'a', 0, 0);
+	CProtocolUtil::writef(&filter, kMsgDFileTransfer, kFileChunk, &chunk);
+
+	std::vector<CString> packets = getPackets();
+	ASSERT_EQ(2, packets.size());
+	EXPECT_EQ(CProtocolUtil::formatf(kMsgDKeyDown, 'a', 0, 0), packets[0]);
+	EXPECT_EQ(4096 + 9, packets[1].size());
+}
+
+TEST_F(CPacketStreamFilterTests, flush_batched_frameSent)
+{
+	CPacketStreamFilter filter(&m_events, &m_stream, false);
+	filter.setBatchDelay(0.002);
+
+	CProtocolUtil::writef(&filter, kMsgDKeyDown, 'a', 0, 0);
+	filter.flush();
+
+	ASSERT_EQ(1, getPackets().size());
+	EXPECT_EQ(1, filter.getNumFrames());
+}
+
+TEST_F(CPacketStreamFilterTests, write_busyQueue_frameSentAfterDelay)
+{
+	CPacketStreamFilter filter(&m_events, &m_stream, false);
+	filter.setBatchDelay(0.01);
+	m_filter = &filter;
+
+	// the frame timer never fires while the queue is busy
+	m_events.registerTypeOnce(m_busyType, "CPacketStreamFilterTests::busy");
+	m_events.adoptHandler(m_busyType, this,
+							new TMethodEventJob<CPacketStreamFilterTests>(this,
+								&CPacketStreamFilterTests::handleBusy));
+	m_events.addEvent(CEvent(m_busyType, this));
+	m_events.loop();
+	m_events.removeHandlers(this);
+
+	ASSERT_EQ(1, getPackets().size());
+	EXPECT_LE(0.01, m_frameTime);
+	EXPECT_GT(0.25, m_frameTime);
+	EXPECT_LT(1, m_busyEvents);
+}
@@ -0,0 +1,167 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/mock/io/MockStream.h"
+#include "synergy/PriorityStreamFilter.h"
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "base/EventQueue.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::Return;
+
+// 100 Mbit/s
+const double g_priorityStreamFilter_bandwidth = 12.5e6;
+
+class CPriorityStreamFilterTests : public ::testing::Test {
+public:
+	virtual void		SetUp();
+
+	void				write(const void* buffer, UInt32 n);
+
+	// the wrapped stream sent everything it had
+	void				flushed();
+
+	// send a file chunk of \p size bytes of \p c
+	void				sendChunk(CPriorityStreamFilter&, UInt32 size, char c);
+
+public:
+	CEventQueue			m_events;
+	NiceMock<CMockStream> m_stream;
+	int					m_target;
+	std::vector<CString> m_written;
+	UInt32				m_queued;
+	double				m_maxKeyLatency;
+};
+
+void
+CPriorityStreamFilterTests::SetUp()
+{
+	m_queued        = 0;
+	m_maxKeyLatency = 0.0;
+	ON_CALL(m_stream, getEventTarget()).WillByDefault(Return(&m_target));
+	ON_CALL(m_stream, write(_, _)).WillByDefault(
+		Invoke(this, &CPriorityStreamFilterTests::write));
+}
+
+void
+CPriorityStreamFilterTests::write(const void* buffer, UInt32 n)
+{
+	CString message(static_cast<const char*>(buffer), n);
+	if (message.compare(0, 4, kMsgDKeyDown, 4) == 0) {
+		// a key waits for everything already queued to go out
+		double latency = m_queued / g_priorityStreamFilter_bandwidth;
+		if (latency > m_maxKeyLatency) {
+			m_maxKeyLatency = latency;
+		}
+		m_written.push_back(message);
+	}
+	else if (n < 64 * 1024) {
+		m_written.push_back(message);
+	}
+	m_queued += n;
+}
+
+void
+CPriorityStreamFilterTests::flushed()
+{
+	m_queued = 0;
+	m_events.addEvent(CEvent(m_events.forIStream().outputFlushed(),
+		&m_target, NULL, CEvent::kDeliverImmediately));
+}
+
+void
+CPriorityStreamFilterTests::sendChunk(CPriorityStreamFilter& filter,
+				UInt32 size, char c)
+{
+	CString chunk(size, c);
+	CProtocolUtil::writef(&filter, kMsgDFileTransfer, kFileChunk, &chunk);
+}
+
+TEST_F(CPriorityStreamFilterTests, write_chunkSlicedAndInputNotDelayed)
+{
+	CPriorityStreamFilter filter(&m_events, &m_stream, false);
+	UInt32 size = 2 * CPriorityStreamFilter::kFrameSize + 10;
+
+	sendChunk(filter, size, 'x');
+	CProtocolUtil::writef(&filter, kMsgDKeyDown, 'a', 0, 0);
+	flushed();
+	flushed();
+	flushed();
+
+	// first frame went out right away, the key went next
+	ASSERT_EQ(4, m_written.size());
+	EXPECT_EQ(0, m_written[1].compare(0, 4, kMsgDKeyDown, 4));
+
+	// the rest of the chunk followed in frames that add up to it
+	UInt32 total = 0;
+	for (size_t i = 0; i < m_written.size(); ++i) {
+		if (i == 1) {
+			continue;
+		}
+		const CString& frame = m_written[i];
+		const UInt8* header = reinterpret_cast<const UInt8*>(frame.data());
+		ASSERT_EQ(0, frame.compare(0, 4, kMsgDFileTransfer, 4));
+		EXPECT_EQ(kFileChunk, header[4]);
+		UInt32 n = (header[5] << 24) | (header[6] << 16) |
+					(header[7] << 8) | header[8];
+		EXPECT_EQ(frame.size() - 9, n);
+		EXPECT_GE(CPriorityStreamFilter::kFrameSize, n);
+		total += n;
+	}
+	EXPECT_EQ(size, total);
+	EXPECT_EQ(0, filter.getBulkSize());
+}
+
+TEST_F(CPriorityStreamFilterTests, write_keyLatencyDuring100MBFile)
+{
+	CPriorityStreamFilter filter(&m_events, &m_stream, false);
+
+	// queue a 100 MB file the way CFileChunker sends it
+	const UInt32 chunkSize = 512 * 1024;
+	const UInt32 numChunks = 200;
+	for (UInt32 i = 0; i < numChunks; ++i) {
+		sendChunk(filter, chunkSize, 'x');
+	}
+
+	// type a key for every 32 KB the link sends while the file drains
+	UInt32 keys = 0;
+	while (filter.getBulkSize() > 0 || m_queued > 0) {
+		CProtocolUtil::writef(&filter, kMsgDKeyDown, 'a', 0, 0);
+		++keys;
+		if (m_queued <= 32 * 1024) {
+			flushed();
+		}
+		else {
+			m_queued -= 32 * 1024;
+		}
+	}
+
+	LOG((CLOG_INFO "%d keys during %d MB transfer, max key latency %.2f ms",
+		keys, chunkSize * numChunks / (1024 * 1024), m_maxKeyLatency * 1000.0));
+
+	// without the filter the last keys would wait for the whole file,
+	// about 8 seconds.  now they wait for at most one frame.
+	double frameTime = (CPriorityStreamFilter::kFrameSize + 64) /
+						g_priorityStreamFilter_bandwidth;
+	EXPECT_GE(frameTime, m_maxKeyLatency);
+}
@@ -0,0 +1,98 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/RetryScheduler.h"
+
+#include "test/global/gtest.h"
+
+TEST(CRetrySchedulerTests, next_backsOffWithJitterUpToMax)
+{
+	CRetryScheduler scheduler(1.0, 8.0);
+	scheduler.setSeed(1);
+
+	double backoff = 1.0;
+	for (int i = 0; i < 10; ++i) {
+		double delay = scheduler.next();
+		EXPECT_LE(backoff / 2.0, delay);
+		EXPECT_GE(backoff, delay);
+		backoff = (backoff * 2.0 > 8.0) ? 8.0 : backoff * 2.0;
+	}
+	EXPECT_EQ(10, scheduler.getAttempts());
+
+	scheduler.reset();
+	EXPECT_EQ(0, scheduler.getAttempts());
+	EXPECT_GE(1.0, scheduler.next());
+}
+
+TEST(CRetrySchedulerTests, next_hintAndCleanCloseOverrideBackoffOnce)
+{
+	CRetryScheduler scheduler(1.0, 8.0);
+	scheduler.setSeed(2);
+	for (int i = 0; i < 5; ++i) {
+		scheduler.next();
+	}
+
+	scheduler.setCleanClose();
+	EXPECT_GE(1.0, scheduler.next());
+
+	scheduler.setHint(20.0);
+	double delay = scheduler.next();
+	EXPECT_LE(10.0, delay);
+	EXPECT_GE(20.0, delay);
+
+	// back to the backoff, which kept its place
+	EXPECT_LE(4.0, scheduler.next());
+}
+
+TEST(CRetrySchedulerTests, next_cleanCloseWithHint_retriesWithinHint)
+{
+	// a server restarting with many clients sends a clean close with a
+	// hint;  clients still come back right away, spread over the hint
+	double shortest = 2.0;
+	for (int i = 0; i < 100; ++i) {
+		CRetryScheduler scheduler(1.0, 8.0);
+		scheduler.setSeed(i + 1);
+		scheduler.setCleanClose();
+		scheduler.setHint(2.0);
+		double delay = scheduler.next();
+		EXPECT_LE(0.0, delay);
+		EXPECT_GT(2.0, delay);
+		if (delay < shortest) {
+			shortest = delay;
+		}
+	}
+	EXPECT_GT(0.1, shortest);
+}
+
+TEST(CRetrySchedulerTests, next_manyClients_spreadsReconnects)
+{
+	// clients that lost the same server at the same moment should not
+	// come back in the same second
+	const int numClients = 500;
+	int buckets[10] = { 0 };
+	for (int i = 0; i < numClients; ++i) {
+		CRetryScheduler scheduler(1.0, 16.0);
+		scheduler.setSeed(i + 1);
+		scheduler.setHint(10.0);
+		double delay = scheduler.next();
+		++buckets[static_cast<int>(delay) % 10];
+	}
+
+	for (int i = 5; i < 10; ++i) {
+		EXPECT_GT(numClients / 5 + numClients / 10, buckets[i]);
+	}
+}
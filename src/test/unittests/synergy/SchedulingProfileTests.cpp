@@ -0,0 +1,201 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014 Bolton Software Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file COPYING that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/SchedulingProfile.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/Stopwatch.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+#include <vector>
+#if defined(__linux__)
+#	include <pthread.h>
+#	include <sched.h>
+#	include <sys/resource.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+const UInt32 g_scheduling_numBusyThreads = 8;
+const UInt32 g_scheduling_numWakeups = 200;
+const double g_scheduling_sleep = 0.001;
+
+class CSchedulingProfileTests : public ::testing::Test {
+public:
+	CSchedulingProfileTests() :
+		m_stop(false), m_applied(false), m_maxLatency(0.0), m_meanLatency(0.0) { }
+
+	void				spin(void*);
+	void				probe(void*);
+	void				startChild(void*);
+	void				child(void*);
+
+public:
+	volatile bool		m_stop;
+	CSchedulingProfile	m_profile;
+	bool				m_applied;
+	double				m_maxLatency;
+	double				m_meanLatency;
+#if defined(__linux__)
+	int					m_childPolicy;
+	int					m_childNice;
+	cpu_set_t			m_childCPUs;
+#endif
+};
+
+void
+CSchedulingProfileTests::spin(void*)
+{
+	// synthetic cpu load
+	volatile UInt32 n = 0;
+	while (!m_stop) {
+		++n;
+	}
+}
+
+void
+CSchedulingProfileTests::probe(void*)
+{
+	// stands in for an input thread:  it sleeps briefly and measures how
+	// late it wakes up.
+	CThread self = CThread::getCurrentThread();
+	m_applied = m_profile.apply(self, "probe");
+
+	double total = 0.0;
+	for (UInt32 i = 0; i < g_scheduling_numWakeups; ++i) {
+		CStopwatch stopwatch;
+		ARCH->sleep(g_scheduling_sleep);
+		double latency = stopwatch.getTime() - g_scheduling_sleep;
+		total += latency;
+		if (latency > m_maxLatency) {
+			m_maxLatency = latency;
+		}
+	}
+	m_meanLatency = total / g_scheduling_numWakeups;
+}
+
+#if defined(__linux__)
+
+void
+CSchedulingProfileTests::startChild(void*)
+{
+	// stands in for the main thread, which starts other threads after
+	// the profile's applied to it
+	CThread self = CThread::getCurrentThread();
+	m_applied = m_profile.apply(self, "parent");
+
+	CThread thread(new TMethodJob<CSchedulingProfileTests>(
+		this, &CSchedulingProfileTests::child));
+	thread.wait();
+}
+
+void
+CSchedulingProfileTests::child(void*)
+{
+	struct sched_param param;
+	pthread_getschedparam(pthread_self(), &m_childPolicy, &param);
+	m_childNice = getpriority(PRIO_PROCESS, static_cast<int>(syscall(SYS_gettid)));
+	sched_getaffinity(0, sizeof(m_childCPUs), &m_childCPUs);
+}
+
+TEST_F(CSchedulingProfileTests, apply_threadStartedAfter_normalScheduling)
+{
+	m_profile.setPolicy("fifo");
+	m_profile.setCPU(0);
+
+	int nice = getpriority(PRIO_PROCESS, 0);
+	cpu_set_t cpus;
+	sched_getaffinity(0, sizeof(cpus), &cpus);
+
+	CThread parent(new TMethodJob<CSchedulingProfileTests>(
+		this, &CSchedulingProfileTests::startChild));
+	parent.wait();
+
+	LOG((CLOG_INFO "parent %s", m_applied ? "real-time" : "real-time not permitted"));
+	EXPECT_EQ(SCHED_OTHER, m_childPolicy);
+	EXPECT_EQ(nice, m_childNice);
+	EXPECT_TRUE(CPU_EQUAL(&cpus, &m_childCPUs));
+}
+
+TEST_F(CSchedulingProfileTests, apply_threadStartedAfterNice_normalNiceness)
+{
+	m_profile.setPolicy("nice");
+	m_profile.setPriority(-5);
+
+	int nice = getpriority(PRIO_PROCESS, 0);
+
+	CThread parent(new TMethodJob<CSchedulingProfileTests>(
+		this, &CSchedulingProfileTests::startChild));
+	parent.wait();
+
+	EXPECT_EQ(SCHED_OTHER, m_childPolicy);
+	EXPECT_EQ(nice, m_childNice);
+}
+
+#endif
+
+TEST_F(CSchedulingProfileTests, setPolicy_names_defaultPriorities)
+{
+	EXPECT_TRUE(m_profile.isDefault());
+
+	EXPECT_TRUE(m_profile.setPolicy("fifo"));
+	EXPECT_EQ(IArchMultithread::kSCHEDULE_FIFO, m_profile.getPolicy());
+	EXPECT_LT(0, m_profile.getPriority());
+
+	EXPECT_TRUE(m_profile.setPolicy("nice"));
+	EXPECT_GT(0, m_profile.getPriority());
+	m_profile.setPriority(-5);
+	EXPECT_EQ(-5, m_profile.getPriority());
+
+	EXPECT_FALSE(m_profile.setPolicy("realtime"));
+	EXPECT_EQ(IArchMultithread::kSCHEDULE_NICE, m_profile.getPolicy());
+	EXPECT_FALSE(m_profile.isDefault());
+}
+
+TEST_F(CSchedulingProfileTests, apply_cpuLoad_wakeupLatency)
+{
+	m_profile.setPolicy("fifo");
+
+	std::vector<CThread*> load;
+	for (UInt32 i = 0; i < g_scheduling_numBusyThreads; ++i) {
+		load.push_back(new CThread(new TMethodJob<CSchedulingProfileTests>(
+			this, &CSchedulingProfileTests::spin)));
+	}
+
+	CThread probe(new TMethodJob<CSchedulingProfileTests>(
+		this, &CSchedulingProfileTests::probe));
+	probe.wait();
+
+	m_stop = true;
+	for (UInt32 i = 0; i < load.size(); ++i) {
+		load[i]->wait();
+		delete load[i];
+	}
+
+	LOG((CLOG_INFO "wakeup latency with %d busy threads, %s: mean %.3fms, max %.3fms",
+		g_scheduling_numBusyThreads,
+		m_applied ? "real-time" : "real-time not permitted",
+		1000.0 * m_meanLatency, 1000.0 * m_maxLatency));
+
+	// only a real-time thread is sure to preempt the load
+	if (m_applied) {
+		EXPECT_GT(0.05, m_maxLatency);
+	}
+}